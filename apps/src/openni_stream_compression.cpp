@@ -96,6 +96,8 @@ char usage[] = "\n"
   "      -a       : enable color coding\n"
   "      -i rate  : i-frame rate\n"
   "      -b bits  : bits/color component\n"
+  "      -k depth : split octree at depth into independently coded chunks\n"
+  "      -j n     : number of en-/decoding threads\n"
   "      -t       : output statistics\n"
   "      -e       : show input cloud during encoding\n"
   "\n"
@@ -247,6 +249,8 @@ main (int argc, char **argv)
   unsigned int iFrameRate;
   bool doColorEncoding;
   unsigned int colorBitResolution;
+  unsigned int chunkDepth;
+  unsigned int threads;
 
   bool bShowInputCloud;
 
@@ -258,6 +262,8 @@ main (int argc, char **argv)
   iFrameRate = 30;
   doColorEncoding = false;
   colorBitResolution = 6;
+  chunkDepth = 0;
+  threads = 1;
   compressionProfile = pcl::octree::MED_RES_OFFLINE_COMPRESSION_WITHOUT_COLOR;
 
   bShowInputCloud = false;
@@ -336,6 +342,8 @@ main (int argc, char **argv)
   pcl::console::parse_argument (argc, argv, "-i", iFrameRate);
   pcl::console::parse_argument (argc, argv, "-o", octreeResolution);
   pcl::console::parse_argument (argc, argv, "-b", colorBitResolution);
+  pcl::console::parse_argument (argc, argv, "-k", chunkDepth);
+  pcl::console::parse_argument (argc, argv, "-j", threads);
 
   std::string profile;
   if (pcl::console::parse_argument (argc, argv, "-p", profile)>0)
@@ -389,6 +397,8 @@ main (int argc, char **argv)
   octreeCoder = new PointCloudCompression<PointXYZRGBA> (compressionProfile, showStatistics, pointResolution,
                                                          octreeResolution, doVoxelGridDownDownSampling, iFrameRate,
                                                          doColorEncoding, colorBitResolution);
+  octreeCoder->setChunkDepth (chunkDepth);
+  octreeCoder->setNumberOfThreads (threads);
 
 
   if (!bServerFileMode) 
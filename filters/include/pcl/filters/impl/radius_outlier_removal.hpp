@@ -63,10 +63,24 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilter (PointCloud &output)
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_);
 
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
-
+  // Only whether a point has min_pts_radius_ neighbors matters, so the counts stop there
+  std::vector<char> enough (indices_->size ());
+#pragma omp parallel for num_threads (threads_) schedule (dynamic, 256)
+  for (int cp = 0; cp < (int)indices_->size (); ++cp)
+  {
+    if (min_pts_radius_ <= 0)
+    {
+      enough[cp] = 1;
+      continue;
+    }
+    const PointT &p = input_->points[(*indices_)[cp]];
+    if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z))
+    {
+      enough[cp] = 0;
+      continue;
+    }
+    enough[cp] = tree_->radiusCount ((*indices_)[cp], search_radius_, min_pts_radius_) >= min_pts_radius_;
+  }
 
   output.points.resize (input_->points.size ());      // reserve enough space
   removed_indices_->resize (input_->points.size ());
@@ -77,9 +91,8 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilter (PointCloud &output)
   // Go over all the points and check which doesn't have enough neighbors
   for (size_t cp = 0; cp < indices_->size (); ++cp)
   {
-    int k = tree_->radiusSearch ((*indices_)[cp], search_radius_, nn_indices, nn_dists);
     // Check if the number of neighbors is larger than the user imposed limit
-    if (k < min_pts_radius_)
+    if (!enough[cp])
     {
       if (extract_removed_indices_)
       {
@@ -72,7 +72,8 @@ namespace pcl
     public:
       /** \brief Empty constructor. */
       RadiusOutlierRemoval (bool extract_removed_indices = false) :
-        Filter<PointT>::Filter (extract_removed_indices), search_radius_ (0.0), min_pts_radius_ (1), tree_ ()
+        Filter<PointT>::Filter (extract_removed_indices), search_radius_ (0.0), min_pts_radius_ (1), tree_ (),
+        threads_ (1)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -113,6 +114,40 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Provide a pointer to the search object. The filter only counts neighbors up to the minimum, so a
+        * pcl::search::VoxelHash with a resolution close to the search radius is usually faster than the default
+        * kd-tree.
+        * \param tree a pointer to the spatial search object.
+        */
+      inline void
+      setSearchMethod (const KdTreePtr &tree)
+      {
+        tree_ = tree;
+      }
+
+      /** \brief Get a pointer to the search method used. */
+      inline KdTreePtr
+      getSearchMethod ()
+      {
+        return (tree_);
+      }
+
+      /** \brief Set the number of threads used for the neighbor counts.
+        * \param nr_threads the number of threads to use (0 means 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
+      /** \brief Get the number of threads used for the neighbor counts. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
     protected:
       /** \brief The nearest neighbors search radius for each point. */
       double search_radius_;
@@ -125,6 +160,9 @@ namespace pcl
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
 
+      /** \brief The number of threads used for the neighbor counts (default: 1). */
+      unsigned int threads_;
+
       /** \brief Apply the filter
         * \param output the resultant point cloud message
         */
@@ -159,7 +197,7 @@ namespace pcl
       /** \brief Empty constructor. */
       RadiusOutlierRemoval (bool extract_removed_indices = false) :
         Filter<sensor_msgs::PointCloud2>::Filter (extract_removed_indices), 
-        search_radius_ (0.0), min_pts_radius_ (1), tree_ ()
+        search_radius_ (0.0), min_pts_radius_ (1), tree_ (), threads_ (1)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -199,6 +237,40 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Provide a pointer to the search object. The filter only counts neighbors up to the minimum, so a
+        * pcl::search::VoxelHash with a resolution close to the search radius is usually faster than the default
+        * kd-tree.
+        * \param tree a pointer to the spatial search object.
+        */
+      inline void
+      setSearchMethod (const KdTreePtr &tree)
+      {
+        tree_ = tree;
+      }
+
+      /** \brief Get a pointer to the search method used. */
+      inline KdTreePtr
+      getSearchMethod ()
+      {
+        return (tree_);
+      }
+
+      /** \brief Set the number of threads used for the neighbor counts.
+        * \param nr_threads the number of threads to use (0 means 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
+      /** \brief Get the number of threads used for the neighbor counts. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
     protected:
       /** \brief The nearest neighbors search radius for each point. */
       double search_radius_;
@@ -211,6 +283,9 @@ namespace pcl
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
 
+      /** \brief The number of threads used for the neighbor counts (default: 1). */
+      unsigned int threads_;
+
       void
       applyFilter (PointCloud2 &output);
   };
@@ -76,7 +76,8 @@ namespace pcl
     public:
       /** \brief Empty constructor. */
       StatisticalOutlierRemoval (bool extract_removed_indices = false) :
-        Filter<PointT>::Filter (extract_removed_indices), mean_k_ (2), std_mul_ (0.0), tree_ (), negative_ (false)
+        Filter<PointT>::Filter (extract_removed_indices), mean_k_ (2), std_mul_ (0.0), tree_ (), negative_ (false),
+        threads_ (1), keep_distances_ (false), distances_ (), distances_input_ (), distances_indices_ (), distances_k_ (0)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
@@ -134,6 +135,55 @@ namespace pcl
         return (negative_);
       }
 
+      /** \brief Set the number of threads used for the nearest neighbor searches.
+        * \note The threads query one search object concurrently, so its const nearestKSearch () has to be
+        * safe to call from several threads. The KdTree and OrganizedNeighbor objects created here are.
+        * \param nr_threads the number of threads to use (0 means 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
+      /** \brief Get the number of threads used for the nearest neighbor searches. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
+      /** \brief Set whether the mean neighbor distances of the points should be kept between calls to filter ().
+        * They are then only recomputed when the input cloud, the indices or the number of neighbors change, so
+        * sweeping setStddevMulThresh () or setNegative () costs a single pass over the data.
+        * \note The cloud is recognized by its pointer: call clearDistances () after modifying it in place.
+        * \param keep_distances true if the distances should be kept
+        */
+      inline void
+      setKeepDistances (bool keep_distances)
+      {
+        keep_distances_ = keep_distances;
+        if (!keep_distances_)
+          clearDistances ();
+      }
+
+      /** \brief Get whether the mean neighbor distances are kept between calls to filter (). */
+      inline bool
+      getKeepDistances ()
+      {
+        return (keep_distances_);
+      }
+
+      /** \brief Drop the kept mean neighbor distances, forcing the next call to filter () to recompute them. */
+      inline void
+      clearDistances ()
+      {
+        distances_.clear ();
+        distances_input_.reset ();
+        distances_indices_.reset ();
+        distances_k_ = 0;
+      }
+
     protected:
       /** \brief The number of points to use for mean distance estimation. */
       int mean_k_;
@@ -148,6 +198,20 @@ namespace pcl
       /** \brief If true, the outliers will be returned instead of the inliers (default: false). */
       bool negative_;
 
+      /** \brief The number of threads used for the nearest neighbor searches (default: 1). */
+      unsigned int threads_;
+
+      /** \brief If true, the mean neighbor distances are kept between calls to filter () (default: false). */
+      bool keep_distances_;
+
+      /** \brief The mean distance of each point in the indices to its neighbors. */
+      std::vector<float> distances_;
+
+      /** \brief The input cloud, indices and number of neighbors \a distances_ were computed for. */
+      PointCloudConstPtr distances_input_;
+      IndicesConstPtr distances_indices_;
+      int distances_k_;
+
       /** \brief Apply the filter
         * \param output the resultant point cloud message
         */
@@ -185,7 +249,8 @@ namespace pcl
       /** \brief Empty constructor. */
       StatisticalOutlierRemoval (bool extract_removed_indices = false) :
         Filter<sensor_msgs::PointCloud2>::Filter (extract_removed_indices), mean_k_ (2), 
-        std_mul_ (0.0), tree_ (), negative_ (false)
+        std_mul_ (0.0), tree_ (), negative_ (false), threads_ (1), keep_distances_ (false), distances_ (),
+        distances_input_ (), distances_indices_ (), distances_k_ (0)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
@@ -244,6 +309,55 @@ namespace pcl
         return (negative_);
       }
 
+      /** \brief Set the number of threads used for the nearest neighbor searches.
+        * \note The threads query one search object concurrently, so its const nearestKSearch () has to be
+        * safe to call from several threads. The KdTree and OrganizedNeighbor objects created here are.
+        * \param nr_threads the number of threads to use (0 means 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = nr_threads == 0 ? 1 : nr_threads;
+      }
+
+      /** \brief Get the number of threads used for the nearest neighbor searches. */
+      inline unsigned int
+      getNumberOfThreads ()
+      {
+        return (threads_);
+      }
+
+      /** \brief Set whether the mean neighbor distances of the points should be kept between calls to filter ().
+        * They are then only recomputed when the input cloud, the indices or the number of neighbors change, so
+        * sweeping setStddevMulThresh () or setNegative () costs a single pass over the data.
+        * \note The cloud is recognized by its pointer: call clearDistances () after modifying it in place.
+        * \param keep_distances true if the distances should be kept
+        */
+      inline void
+      setKeepDistances (bool keep_distances)
+      {
+        keep_distances_ = keep_distances;
+        if (!keep_distances_)
+          clearDistances ();
+      }
+
+      /** \brief Get whether the mean neighbor distances are kept between calls to filter (). */
+      inline bool
+      getKeepDistances ()
+      {
+        return (keep_distances_);
+      }
+
+      /** \brief Drop the kept mean neighbor distances, forcing the next call to filter () to recompute them. */
+      inline void
+      clearDistances ()
+      {
+        distances_.clear ();
+        distances_input_.reset ();
+        distances_indices_.reset ();
+        distances_k_ = 0;
+      }
+
     protected:
       /** \brief The number of points to use for mean distance estimation. */
       int mean_k_;
@@ -259,6 +373,20 @@ namespace pcl
       /** \brief If true, the outliers will be returned instead of the inliers (default: false). */
       bool negative_;
 
+      /** \brief The number of threads used for the nearest neighbor searches (default: 1). */
+      unsigned int threads_;
+
+      /** \brief If true, the mean neighbor distances are kept between calls to filter () (default: false). */
+      bool keep_distances_;
+
+      /** \brief The mean distance of each point in the indices to its neighbors. */
+      std::vector<float> distances_;
+
+      /** \brief The input cloud, indices and number of neighbors \a distances_ were computed for. */
+      PointCloud2ConstPtr distances_input_;
+      IndicesConstPtr distances_indices_;
+      int distances_k_;
+
       void
       applyFilter (PointCloud2 &output);
   };
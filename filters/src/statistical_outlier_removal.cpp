@@ -62,50 +62,67 @@ pcl::StatisticalOutlierRemoval<sensor_msgs::PointCloud2>::applyFilter (PointClou
     output.data.clear ();
     return;
   }
-  // Send the input dataset to the spatial locator
-  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
-  pcl::fromROSMsg (*input_, *cloud);
-
-  // Initialize the spatial locator
-  if (!tree_)
+  // The mean distances only depend on the data and mean_k_, so kept ones are reused as they are
+  if (!keep_distances_ || distances_input_ != input_ || distances_indices_ != indices_ ||
+      distances_k_ != mean_k_ || distances_.size () != indices_->size ())
   {
-    if (cloud->isOrganized ())
-      tree_.reset (new pcl::search::OrganizedNeighbor<pcl::PointXYZ> ());
-    else
-      tree_.reset (new pcl::search::KdTree<pcl::PointXYZ> (false));
-  }
+    // Send the input dataset to the spatial locator
+    pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
+    pcl::fromROSMsg (*input_, *cloud);
 
-  tree_->setInputCloud (cloud);
+    // Initialize the spatial locator
+    if (!tree_)
+    {
+      if (cloud->isOrganized ())
+        tree_.reset (new pcl::search::OrganizedNeighbor<pcl::PointXYZ> ());
+      else
+        tree_.reset (new pcl::search::KdTree<pcl::PointXYZ> (false));
+    }
 
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (mean_k_);
-  std::vector<float> nn_dists (mean_k_);
+    tree_->setInputCloud (cloud);
 
-  std::vector<float> distances (indices_->size ());
-  // Go over all the points and calculate the mean or smallest distance
-  for (size_t cp = 0; cp < indices_->size (); ++cp)
-  {
-    if (!pcl_isfinite (cloud->points[(*indices_)[cp]].x) || !pcl_isfinite (cloud->points[(*indices_)[cp]].y)
-        ||
-        !pcl_isfinite (cloud->points[(*indices_)[cp]].z))
+    distances_.resize (indices_->size ());
+    // Go over all the points and calculate the mean or smallest distance
+#pragma omp parallel num_threads (threads_)
     {
-      distances[cp] = 0;
-      continue;
+      // Allocate enough space to hold the results
+      std::vector<int> nn_indices (mean_k_);
+      std::vector<float> nn_dists (mean_k_);
+
+#pragma omp for schedule (dynamic, 256)
+      for (int cp = 0; cp < (int)indices_->size (); ++cp)
+      {
+        if (!pcl_isfinite (cloud->points[(*indices_)[cp]].x) || !pcl_isfinite (cloud->points[(*indices_)[cp]].y)
+            ||
+            !pcl_isfinite (cloud->points[(*indices_)[cp]].z))
+        {
+          distances_[cp] = 0;
+          continue;
+        }
+
+        if (tree_->nearestKSearch ((*indices_)[cp], mean_k_, nn_indices, nn_dists) == 0)
+        {
+          distances_[cp] = 0;
+          PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
+          continue;
+        }
+
+        // Minimum distance (if mean_k_ == 2) or mean distance
+        double dist_sum = 0;
+        for (int j = 1; j < mean_k_; ++j)
+          dist_sum += sqrt (nn_dists[j]);
+        distances_[cp] = dist_sum / (mean_k_ - 1);
+      }
     }
 
-    if (tree_->nearestKSearch ((*indices_)[cp], mean_k_, nn_indices, nn_dists) == 0)
+    if (keep_distances_)
     {
-      distances[cp] = 0;
-      PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
-      continue;
+      distances_input_ = input_;
+      distances_indices_ = indices_;
+      distances_k_ = mean_k_;
     }
-
-    // Minimum distance (if mean_k_ == 2) or mean distance
-    double dist_sum = 0;
-    for (int j = 1; j < mean_k_; ++j)
-      dist_sum += sqrt (nn_dists[j]);
-    distances[cp] = dist_sum / (mean_k_ - 1);
   }
+  const std::vector<float> &distances = distances_;
 
   // Estimate the mean and the standard deviation of the distance vector
   double mean, stddev;
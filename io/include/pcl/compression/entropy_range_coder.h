@@ -57,6 +57,27 @@ namespace pcl
   using boost::uint32_t;
   using boost::uint64_t;
 
+  namespace detail
+  {
+    /** \brief Read a single byte from the buffer of an input stream
+     * \note Bypasses the per-call overhead of std::istream::read. Flags the stream if its end is reached.
+     * \param inputByteStream_arg input stream
+     * \param inputBuffer_arg buffer of input stream
+     * \return byte read from stream, 0 if end of stream is reached
+     */
+    inline uint8_t
+    readRangeCoderByte (std::istream& inputByteStream_arg, std::streambuf* inputBuffer_arg)
+    {
+      const std::streambuf::int_type ch = inputBuffer_arg->sbumpc ();
+      if (std::streambuf::traits_type::eq_int_type (ch, std::streambuf::traits_type::eof ()))
+      {
+        inputByteStream_arg.setstate (std::ios::eofbit | std::ios::failbit);
+        return (0);
+      }
+      return ((uint8_t)std::streambuf::traits_type::to_char_type (ch));
+    }
+  }
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief @b AdaptiveRangeCoder compression class
    *  \note This class provides adaptive range coding functionality.
@@ -102,6 +123,125 @@ namespace pcl
   protected:
     typedef boost::uint32_t DWord; // 4 bytes
 
+    /** \brief Adaptive cumulative symbol frequency table
+     *  \note Symbol frequencies are kept in a binary indexed (Fenwick) tree, so that cumulative frequency lookup,
+     *  symbol search and frequency update take O(log n) instead of O(n) operations. Rescaling is performed on
+     *  the cumulative table and yields exactly the same frequencies as a plain cumulative frequency array.
+     */
+    class FrequencyTable
+    {
+    public:
+
+      /** \brief Reset table to equal symbol frequencies */
+      void
+      reset ()
+      {
+        for (unsigned int i = 0; i < 256; i++)
+          count_[i] = 1;
+        build ();
+      }
+
+      /** \brief Get total frequency of all symbols */
+      inline DWord
+      total () const
+      {
+        return (total_);
+      }
+
+      /** \brief Get cumulative frequency of all symbols below a symbol
+       *  \param symbol_arg: symbol (0..256)
+       */
+      inline DWord
+      cumulative (unsigned int symbol_arg) const
+      {
+        DWord sum = 0;
+        for (unsigned int i = symbol_arg; i > 0; i &= i - 1)
+          sum += tree_[i];
+        return (sum);
+      }
+
+      /** \brief Find the symbol whose cumulative frequency range contains a given count
+       *  \param count_arg: cumulative count
+       */
+      inline unsigned int
+      find (DWord count_arg) const
+      {
+        unsigned int pos = 0;
+        for (unsigned int step = 256; step > 0; step >>= 1)
+        {
+          if ((pos + step <= 256) && (tree_[pos + step] <= count_arg))
+          {
+            pos += step;
+            count_arg -= tree_[pos];
+          }
+        }
+        return (std::min (pos, 255u));
+      }
+
+      /** \brief Increase frequency of a symbol by one and rescale table if it reaches its numerical limits
+       *  \param symbol_arg: symbol
+       *  \param maxRange_arg: maximum total frequency
+       */
+      inline void
+      update (unsigned int symbol_arg, DWord maxRange_arg)
+      {
+        count_[symbol_arg]++;
+        total_++;
+        for (unsigned int i = symbol_arg + 1; i <= 256; i += i & (0u - i))
+          tree_[i]++;
+
+        if (total_ >= maxRange_arg)
+          rescale ();
+      }
+
+    protected:
+
+      /** \brief Halve cumulative frequencies while keeping them strictly increasing */
+      void
+      rescale ()
+      {
+        DWord freq[257];
+
+        freq[0] = 0;
+        for (unsigned int f = 1; f <= 256; f++)
+          freq[f] = freq[f - 1] + count_[f - 1];
+
+        for (unsigned int f = 1; f <= 256; f++)
+        {
+          freq[f] /= 2;
+          if (freq[f] <= freq[f - 1])
+            freq[f] = freq[f - 1] + 1;
+        }
+
+        for (unsigned int f = 1; f <= 256; f++)
+          count_[f - 1] = freq[f] - freq[f - 1];
+        build ();
+      }
+
+      /** \brief Rebuild binary indexed tree from symbol frequencies */
+      void
+      build ()
+      {
+        total_ = 0;
+        tree_[0] = 0;
+        for (unsigned int i = 1; i <= 256; i++)
+        {
+          tree_[i] = count_[i - 1];
+          total_ += count_[i - 1];
+        }
+        for (unsigned int i = 1; i <= 256; i++)
+        {
+          const unsigned int parent = i + (i & (0u - i));
+          if (parent <= 256)
+            tree_[parent] += tree_[i];
+        }
+      }
+
+      DWord count_[256];
+      DWord tree_[257];
+      DWord total_;
+    };
+
   private:
     /** vector containing compressed data
      */
@@ -125,7 +265,7 @@ namespace pcl
     /** \brief constructor. */
     StaticRangeCoder ()
     {
-      cFreqTable_.resize (65537);
+      cFreqTable_.resize (2);
     }
 
     /** \brief Empty deconstructor. */
@@ -167,9 +307,51 @@ namespace pcl
     unsigned long
     decodeStreamToCharVector (std::istream& inputByteStream_arg, std::vector<char>& outputByteVector_arg);
 
+    /** \brief Encode char buffer to preallocated memory
+     * \note This method uses a table-driven, four-way interleaved rANS coder with a static symbol model. It is
+     * several times faster than encodeCharVectorToStream but produces a different format, which starts with a
+     * format version byte and can only be read by decodeCharBuffer. Incompressible data is stored uncompressed.
+     * \param inputBuffer_arg input data
+     * \param inputSize_arg amount of bytes in input data
+     * \param outputBuffer_arg output memory
+     * \param outputCapacity_arg amount of bytes available in output memory, see getMaxEncodedBufferSize
+     * \return amount of bytes written to output memory, 0 if output capacity is insufficient
+     */
+    std::size_t
+    encodeCharBuffer (const char* inputBuffer_arg, std::size_t inputSize_arg, char* outputBuffer_arg,
+                      std::size_t outputCapacity_arg);
+
+    /** \brief Decode char buffer generated by encodeCharBuffer
+     * \param inputBuffer_arg compressed data
+     * \param inputSize_arg amount of bytes in compressed data
+     * \param outputBuffer_arg output memory
+     * \param outputSize_arg amount of bytes to be decoded
+     * \return amount of bytes read from compressed data, 0 on malformed or unknown input format
+     */
+    std::size_t
+    decodeCharBuffer (const char* inputBuffer_arg, std::size_t inputSize_arg, char* outputBuffer_arg,
+                      std::size_t outputSize_arg);
+
+    /** \brief Get the amount of output memory that is sufficient for encodeCharBuffer
+     * \param inputSize_arg amount of bytes in input data
+     * \return maximum amount of bytes written by encodeCharBuffer
+     */
+    static inline std::size_t
+    getMaxEncodedBufferSize (std::size_t inputSize_arg)
+    {
+      return (inputSize_arg + 1);
+    }
+
   protected:
     typedef boost::uint32_t DWord; // 4 bytes
 
+    /** \brief Format versions of encodeCharBuffer output */
+    enum
+    {
+      BUFFER_FORMAT_STORED = 0,
+      BUFFER_FORMAT_RANS4 = 1
+    };
+
     /** \brief Helper function to calculate the binary logarithm
      * \param n_arg: some value
      * \return binary logarithm (log2) of argument n_arg
@@ -60,9 +60,9 @@ namespace pcl
   AdaptiveRangeCoder::encodeCharVectorToStream (const std::vector<char>& inputByteVector_arg,
                                                 std::ostream& outputByteStream_arg)
   {
-    DWord freq[257];
+    FrequencyTable freq;
     uint8_t ch;
-    unsigned int i, j, f;
+    unsigned int i;
     char out;
 
     // define limits
@@ -87,8 +87,7 @@ namespace pcl
     range = (DWord)-1;
 
     // initialize cumulative frequency table
-    for (i = 0; i < 257; i++)
-      freq[i] = i;
+    freq.reset ();
 
     // scan input
     while (readPos < input_size)
@@ -98,8 +97,10 @@ namespace pcl
       ch = inputByteVector_arg[readPos++];
 
       // map range
-      low += freq[ch] * (range /= freq[256]);
-      range *= freq[ch + 1] - freq[ch];
+      const DWord symbolLow = freq.cumulative (ch);
+      const DWord symbolHigh = freq.cumulative (ch + 1);
+      low += symbolLow * (range /= freq.total ());
+      range *= symbolHigh - symbolLow;
 
       // check range limits
       while ((low ^ (low + range)) < top || ((range < bottom) && ((range = -low & (bottom - 1)), 1)))
@@ -110,21 +111,8 @@ namespace pcl
         outputCharVector_.push_back(out);
       }
 
-      // update frequency table
-      for (j = ch + 1; j < 257; j++)
-        freq[j]++;
-
-      // detect overflow
-      if (freq[256] >= maxRange)
-      {
-        // rescale
-        for (f = 1; f <= 256; f++)
-        {
-          freq[f] /= 2;
-          if (freq[f] <= freq[f - 1])
-            freq[f] = freq[f - 1] + 1;
-        }
-      }
+      // update frequency table, rescale on overflow
+      freq.update (ch, maxRange);
 
     }
 
@@ -149,8 +137,8 @@ namespace pcl
                                                 std::vector<char>& outputByteVector_arg)
   {
     uint8_t ch;
-    DWord freq[257];
-    unsigned int i, j, f;
+    FrequencyTable freq;
+    unsigned int i;
 
     // define limits
     const DWord top = (DWord)1 << 24;
@@ -165,6 +153,9 @@ namespace pcl
 
     unsigned long streamByteCount;
 
+    // read compressed bytes directly from the stream buffer
+    std::streambuf* inputBuffer = inputByteStream_arg.rdbuf ();
+
     streamByteCount = 0;
 
     outputBufPos = 0;
@@ -176,66 +167,44 @@ namespace pcl
     // init decoding
     for (i = 0; i < 4; i++)
     {
-      inputByteStream_arg.read ((char*)&ch, sizeof(char));
+      ch = detail::readRangeCoderByte (inputByteStream_arg, inputBuffer);
       streamByteCount += sizeof(char);
       code = (code << 8) | ch;
     }
 
     // init cumulative frequency table
-    for (i = 0; i <= 256; i++)
-      freq[i] = i;
+    freq.reset ();
 
     // decoding loop
     for (i = 0; i < output_size; i++)
     {
-      uint8_t symbol = 0;
-      uint8_t sSize = 256 / 2;
-
       // map code to range
-      DWord count = (code - low) / (range /= freq[256]);
+      DWord count = (code - low) / (range /= freq.total ());
 
       // find corresponding symbol
-      while (sSize > 0)
-      {
-        if (freq[symbol + sSize] <= count)
-        {
-          symbol += sSize;
-        }
-        sSize /= 2;
-      }
+      const unsigned int symbol = freq.find (count);
 
       // output symbol
       outputByteVector_arg[outputBufPos++] = symbol;
 
       // update range limits
-      low += freq[symbol] * range;
-      range *= freq[symbol + 1] - freq[symbol];
+      const DWord symbolLow = freq.cumulative (symbol);
+      const DWord symbolHigh = freq.cumulative (symbol + 1);
+      low += symbolLow * range;
+      range *= symbolHigh - symbolLow;
 
       // decode range limits
       while ((low ^ (low + range)) < top || ((range < bottom) && ((range = -low & (bottom - 1)), 1)))
       {
-        inputByteStream_arg.read ((char*)&ch, sizeof(char));
+        ch = detail::readRangeCoderByte (inputByteStream_arg, inputBuffer);
         streamByteCount += sizeof(char);
         code = code << 8 | ch;
         range <<= 8;
         low <<= 8;
       }
 
-      // update cumulative frequency table
-      for (j = symbol + 1; j < 257; j++)
-        freq[j]++;
-
-      // detect overflow
-      if (freq[256] >= maxRange)
-      {
-        // rescale
-        for (f = 1; f <= 256; f++)
-        {
-          freq[f] /= 2;
-          if (freq[f] <= freq[f - 1])
-            freq[f] = freq[f - 1] + 1;
-        }
-      }
+      // update cumulative frequency table, rescale on overflow
+      freq.update (symbol, maxRange);
     }
 
     return streamByteCount;
@@ -322,7 +291,7 @@ namespace pcl
     // rescale if numerical limits are reached
     while (cFreqTable_[frequencyTableSize - 1] >= maxRange)
     {
-      for (f = 1; f < cFreqTable_.size (); f++)
+      for (f = 1; f < frequencyTableSize; f++)
       {
         cFreqTable_[f] /= 2;
         ;
@@ -413,6 +382,9 @@ namespace pcl
 
     unsigned long streamByteCount;
 
+    // read compressed bytes directly from the stream buffer
+    std::streambuf* inputBuffer = inputByteStream_arg.rdbuf ();
+
     streamByteCount = 0;
 
     outputBufPos = 0;
@@ -448,7 +420,7 @@ namespace pcl
     // init code vector
     for (i = 0; i < 8; i++)
     {
-      inputByteStream_arg.read ((char*)&ch, sizeof(char));
+      ch = detail::readRangeCoderByte (inputByteStream_arg, inputBuffer);
       streamByteCount += sizeof(char);
       code = (code << 8) | ch;
     }
@@ -480,7 +452,7 @@ namespace pcl
       // check range limits
       while ((low ^ (low + range)) < top || ((range < bottom) && ((range = -low & (bottom - 1)), 1)))
       {
-        inputByteStream_arg.read ((char*)&ch, sizeof(char));
+        ch = detail::readRangeCoderByte (inputByteStream_arg, inputBuffer);
         streamByteCount += sizeof(char);
         code = code << 8 | ch;
         range <<= 8;
@@ -625,6 +597,9 @@ namespace pcl
 
     unsigned long streamByteCount;
 
+    // read compressed bytes directly from the stream buffer
+    std::streambuf* inputBuffer = inputByteStream_arg.rdbuf ();
+
     streamByteCount = 0;
 
     output_size = outputByteVector_arg.size ();
@@ -642,7 +617,7 @@ namespace pcl
     // init code
     for (i = 0; i < 4; i++)
     {
-      inputByteStream_arg.read ((char*)&ch, sizeof(char));
+      ch = detail::readRangeCoderByte (inputByteStream_arg, inputBuffer);
       streamByteCount += sizeof(char);
       code = (code << 8) | ch;
     }
@@ -674,7 +649,7 @@ namespace pcl
       // check range limits
       while ((low ^ (low + range)) < top || ((range < bottom) && ((range = -low & (bottom - 1)), 1)))
       {
-        inputByteStream_arg.read ((char*)&ch, sizeof(char));
+        ch = detail::readRangeCoderByte (inputByteStream_arg, inputBuffer);
         streamByteCount += sizeof(char);
         code = code << 8 | ch;
         range <<= 8;
@@ -687,6 +662,248 @@ namespace pcl
 
   }
 
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  std::size_t
+  StaticRangeCoder::encodeCharBuffer (const char* inputBuffer_arg, std::size_t inputSize_arg,
+                                      char* outputBuffer_arg, std::size_t outputCapacity_arg)
+  {
+    // rANS parameters: 12 bit symbol frequencies, 32 bit states normalized to [L, 256*L)
+    const unsigned int scaleBits = 12;
+    const DWord scale = (DWord)1 << scaleBits;
+    const DWord lowerBound = (DWord)1 << 23;
+
+    const uint8_t* input = (const uint8_t*)inputBuffer_arg;
+    uint8_t* output = (uint8_t*)outputBuffer_arg;
+
+    DWord freq[256];
+    DWord cumFreq[256];
+    unsigned int symbolCount;
+    std::size_t i;
+    unsigned int s;
+
+    // calculate symbol histogram
+    uint64_t hist[256];
+    memset (hist, 0, sizeof(hist));
+    for (i = 0; i < inputSize_arg; i++)
+      hist[input[i]]++;
+
+    // normalize frequencies to sum up to scale, every occurring symbol keeps a non-zero frequency
+    DWord freqSum = 0;
+    symbolCount = 0;
+    for (s = 0; s < 256; s++)
+    {
+      freq[s] = 0;
+      if (hist[s])
+      {
+        freq[s] = std::max<DWord> (1, (DWord)((hist[s] * scale) / std::max<uint64_t> (inputSize_arg, 1)));
+        freqSum += freq[s];
+        symbolCount++;
+      }
+    }
+
+    while (symbolCount && (freqSum != scale))
+    {
+      // adjust the most frequent symbol that can take the correction
+      unsigned int maxSymbol = 0;
+      for (s = 1; s < 256; s++)
+        if (freq[s] > freq[maxSymbol])
+          maxSymbol = s;
+
+      if (freqSum < scale)
+      {
+        freq[maxSymbol] += scale - freqSum;
+        freqSum = scale;
+      }
+      else
+      {
+        const DWord correction = std::min<DWord> (freqSum - scale, freq[maxSymbol] - 1);
+        freq[maxSymbol] -= correction;
+        freqSum -= correction;
+      }
+    }
+
+    cumFreq[0] = 0;
+    for (s = 1; s < 256; s++)
+      cumFreq[s] = cumFreq[s - 1] + freq[s - 1];
+
+    // header: format version, symbol count, (symbol, frequency) pairs, four coder states
+    const std::size_t headerSize = 1 + 2 + 3 * symbolCount + 4 * sizeof(DWord);
+
+    if (symbolCount && (outputCapacity_arg > headerSize + 2))
+    {
+      DWord state[4] = {lowerBound, lowerBound, lowerBound, lowerBound};
+
+      // encode backwards from the end of the output memory
+      uint8_t* outputPtr = output + outputCapacity_arg;
+      uint8_t* const outputLimit = output + headerSize + 2;
+
+      for (i = inputSize_arg; i > 0; i--)
+      {
+        const uint8_t symbol = input[i - 1];
+        const DWord symbolFreq = freq[symbol];
+        const DWord stateMax = ((lowerBound >> scaleBits) << 8) * symbolFreq;
+        DWord& x = state[(i - 1) & 3];
+
+        if (outputPtr < outputLimit)
+          break;
+
+        while (x >= stateMax)
+        {
+          *--outputPtr = (uint8_t)(x & 0xFF);
+          x >>= 8;
+        }
+        x = ((x / symbolFreq) << scaleBits) + (x % symbolFreq) + cumFreq[symbol];
+      }
+
+      const std::size_t streamSize = (output + outputCapacity_arg) - outputPtr;
+
+      if ((i == 0) && (headerSize + streamSize < inputSize_arg + 1))
+      {
+        uint8_t* headerPtr = output;
+
+        // move coded data behind header
+        memmove (output + headerSize, outputPtr, streamSize);
+
+        *headerPtr++ = BUFFER_FORMAT_RANS4;
+        *headerPtr++ = (uint8_t)(symbolCount & 0xFF);
+        *headerPtr++ = (uint8_t)(symbolCount >> 8);
+        for (s = 0; s < 256; s++)
+        {
+          if (freq[s])
+          {
+            *headerPtr++ = (uint8_t)s;
+            *headerPtr++ = (uint8_t)(freq[s] & 0xFF);
+            *headerPtr++ = (uint8_t)(freq[s] >> 8);
+          }
+        }
+        for (s = 0; s < 4; s++)
+        {
+          *headerPtr++ = (uint8_t)(state[s] >> 0);
+          *headerPtr++ = (uint8_t)(state[s] >> 8);
+          *headerPtr++ = (uint8_t)(state[s] >> 16);
+          *headerPtr++ = (uint8_t)(state[s] >> 24);
+        }
+
+        return (headerSize + streamSize);
+      }
+    }
+
+    // fall back to storing incompressible data
+    if (outputCapacity_arg < inputSize_arg + 1)
+      return (0);
+
+    output[0] = BUFFER_FORMAT_STORED;
+    if (inputSize_arg)
+      memcpy (output + 1, input, inputSize_arg);
+
+    return (inputSize_arg + 1);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  std::size_t
+  StaticRangeCoder::decodeCharBuffer (const char* inputBuffer_arg, std::size_t inputSize_arg,
+                                      char* outputBuffer_arg, std::size_t outputSize_arg)
+  {
+    const unsigned int scaleBits = 12;
+    const DWord scale = (DWord)1 << scaleBits;
+    const DWord mask = scale - 1;
+    const DWord lowerBound = (DWord)1 << 23;
+
+    const uint8_t* input = (const uint8_t*)inputBuffer_arg;
+    const uint8_t* const inputEnd = input + inputSize_arg;
+    uint8_t* output = (uint8_t*)outputBuffer_arg;
+
+    if (inputSize_arg < 1)
+      return (0);
+
+    const uint8_t format = *input++;
+
+    if (format == BUFFER_FORMAT_STORED)
+    {
+      if (inputSize_arg < outputSize_arg + 1)
+        return (0);
+      if (outputSize_arg)
+        memcpy (output, input, outputSize_arg);
+      return (outputSize_arg + 1);
+    }
+
+    if ((format != BUFFER_FORMAT_RANS4) || (inputEnd - input < 2))
+      return (0);
+
+    // read symbol frequencies
+    DWord freq[256];
+    DWord cumFreq[256];
+    uint8_t symbolLookup[4096];
+
+    const unsigned int symbolCount = input[0] | (input[1] << 8);
+    input += 2;
+
+    if ((symbolCount == 0) || (symbolCount > 256)
+        || ((std::size_t)(inputEnd - input) < 3 * symbolCount + 4 * sizeof(DWord)))
+      return (0);
+
+    memset (freq, 0, sizeof(freq));
+    DWord freqSum = 0;
+    for (unsigned int i = 0; i < symbolCount; i++)
+    {
+      const uint8_t symbol = input[0];
+      const DWord symbolFreq = input[1] | (input[2] << 8);
+      input += 3;
+
+      if ((freqSum + symbolFreq > scale) || freq[symbol])
+        return (0);
+
+      // fill symbol lookup table
+      cumFreq[symbol] = freqSum;
+      freq[symbol] = symbolFreq;
+      memset (symbolLookup + freqSum, symbol, symbolFreq);
+      freqSum += symbolFreq;
+    }
+
+    if (freqSum != scale)
+      return (0);
+
+    // read coder states
+    DWord state[4];
+    for (unsigned int i = 0; i < 4; i++)
+    {
+      state[i] = (DWord)input[0] | ((DWord)input[1] << 8) | ((DWord)input[2] << 16) | ((DWord)input[3] << 24);
+      input += 4;
+    }
+
+    DWord x0 = state[0], x1 = state[1], x2 = state[2], x3 = state[3];
+
+    // decode four interleaved symbols per iteration
+#define PCL_RANS_DECODE_STEP(x, idx) \
+    { \
+      const DWord slot = x & mask; \
+      const uint8_t symbol = symbolLookup[slot]; \
+      output[idx] = symbol; \
+      x = freq[symbol] * (x >> scaleBits) + slot - cumFreq[symbol]; \
+      while ((x < lowerBound) && (input < inputEnd)) \
+        x = (x << 8) | *input++; \
+    }
+
+    std::size_t i = 0;
+    for (; i + 4 <= outputSize_arg; i += 4)
+    {
+      PCL_RANS_DECODE_STEP (x0, i + 0);
+      PCL_RANS_DECODE_STEP (x1, i + 1);
+      PCL_RANS_DECODE_STEP (x2, i + 2);
+      PCL_RANS_DECODE_STEP (x3, i + 3);
+    }
+    if (i < outputSize_arg)
+      PCL_RANS_DECODE_STEP (x0, i++);
+    if (i < outputSize_arg)
+      PCL_RANS_DECODE_STEP (x1, i++);
+    if (i < outputSize_arg)
+      PCL_RANS_DECODE_STEP (x2, i++);
+
+#undef PCL_RANS_DECODE_STEP
+
+    return (input - (const uint8_t*)inputBuffer_arg);
+  }
+
 }
 
 #endif
@@ -39,6 +39,8 @@
 
 #include "pcl/octree/octree_pointcloud.h"
 #include "pcl/compression/entropy_range_coder.h"
+#include "pcl/common/time.h"
+#include "pcl/console/print.h"
 
 #include <iterator>
 #include <iostream>
@@ -46,6 +48,9 @@
 #include <string.h>
 #include <iostream>
 #include <stdio.h>
+#include <sstream>
+#include <limits>
+#include <algorithm>
 
 
 namespace pcl
@@ -60,6 +65,8 @@ namespace pcl
       PointCloudCompression<PointT, LeafT, OctreeT>::encodePointCloud (const PointCloudConstPtr &cloud_arg,
                                                                        std::ostream& compressedTreeDataOut_arg)
       {
+        const double startTime = pcl::getTime ();
+
         unsigned char recentTreeDepth;
         recentTreeDepth = this->getTreeDepth ();
 
@@ -97,39 +104,105 @@ namespace pcl
           iFrame_ = true;
         }
 
+        // adaptive GOP - start a new group of pictures if too many voxels changed
+        const bool trackTemporalChanges = adaptiveGOP_ || temporalPointCoding_;
+        changeRate_ = trackTemporalChanges ? this->computeChangeRate () : 0.0;
+        if (adaptiveGOP_ && !iFrame_ && (changeRate_ > iFrameChangeRate_))
+        {
+          iFrameCounter_ = 0;
+          iFrame_ = true;
+        }
+
+        // chunked frames do not reference the previous buffer and the decoder does not rebuild its octree
+        // from them - enforce I-frame encoding for this and the next frame
+        chunkedFrame_ = (chunkDepth_ > 0);
+        if (chunkedFrame_)
+        {
+          iFrame_ = true;
+          iFrameCounter_ = iFrameRate_;
+        }
+
+        // temporal point detail coding references the previous frame
+        pointDeltaFrame_ = temporalPointCoding_ && !iFrame_ && !doVoxelGridEnDecoding_;
+
         // increase frameID
         frameID_++;
 
-        // do octree encoding
-        if (!doVoxelGridEnDecoding_)
+        if (chunkedFrame_)
         {
-          pointCountDataVector_.clear ();
-          pointCountDataVector_.reserve (cloud_arg->points.size ());
+          // write frame header information to stream
+          this->writeFrameHeader (compressedTreeDataOut_arg);
+
+          // encode subtrees and send them with their index to output stream
+          this->encodeChunks (compressedTreeDataOut_arg);
+
+          // chunked frames are no reference for temporal coding
+          leafKeys_.clear ();
+          std::vector<char> noPointDiffData;
+          this->updateTemporalReference (noPointDiffData);
         }
+        else
+        {
+          leafKeys_.clear ();
+          if (trackTemporalChanges)
+            leafKeys_.reserve (this->leafCount_);
+          // do octree encoding
+          if (!doVoxelGridEnDecoding_)
+          {
+            pointCountDataVector_.clear ();
+            pointCountDataVector_.reserve (cloud_arg->points.size ());
+          }
 
-        // initialize color encoding
-        colorCoder_.initializeEncoding ();
-        colorCoder_.setPointCount (cloud_arg->points.size ());
-        colorCoder_.setVoxelCount (this->leafCount_);
+          // initialize color encoding
+          colorCoder_.initializeEncoding ();
+          colorCoder_.setPointCount (cloud_arg->points.size ());
+          colorCoder_.setVoxelCount (this->leafCount_);
+
+          // initialize point encoding
+          pointCoder_.initializeEncoding ();
+          pointCoder_.setPointCount (cloud_arg->points.size ());
+
+          // serialize octree
+          if (iFrame_) {
+            // i-frame encoding - encode tree structure without referencing previous buffer
+            this->serializeTree (binaryTreeDataVector_, false);
+          } else {
+            // p-frame encoding - XOR encoded tree structure
+            this->serializeTree (binaryTreeDataVector_, true);
+          }
 
-        // initialize point encoding
-        pointCoder_.initializeEncoding ();
-        pointCoder_.setPointCount (cloud_arg->points.size ());
+          if (trackTemporalChanges)
+          {
+            std::vector<char>& pointDiffData = pointCoder_.getDifferentialDataVector ();
+            std::vector<char> referencePointDiffData (pointDiffData);
+
+            if (pointDeltaFrame_)
+            {
+              // replace point detail by its difference to the previous frame
+              std::size_t pointDiffPos = 0;
+              prevLeafCursor_ = 0;
+              for (std::size_t i = 0; i < leafKeys_.size (); i++)
+              {
+                this->applyTemporalDelta (leafKeys_[i], pointCountDataVector_[i], &pointDiffData[0] + pointDiffPos, false);
+                pointDiffPos += 3 * pointCountDataVector_[i];
+              }
+            }
+
+            this->updateTemporalReference (referencePointDiffData);
+          }
 
-        // serialize octree
-        if (iFrame_) {
-          // i-frame encoding - encode tree structure without referencing previous buffer
-          this->serializeTree (binaryTreeDataVector_, false);
-        } else {
-          // p-frame encoding - XOR encoded tree structure
-          this->serializeTree (binaryTreeDataVector_, true);
-        }
+          // write frame header information to stream
+          this->writeFrameHeader (compressedTreeDataOut_arg);
 
-        // write frame header information to stream
-        this->writeFrameHeader (compressedTreeDataOut_arg);
+          // apply entropy coding to the content of all data vectors and send data to output stream
+          this->entropyEncoding (compressedTreeDataOut_arg);
+        }
 
-        // apply entropy coding to the content of all data vectors and send data to output stream
-        this->entropyEncoding (compressedTreeDataOut_arg);
+        // update statistics
+        frameSize_ = compressedPointDataLen_ + compressedColorDataLen_;
+        totalFrameSize_ += frameSize_;
+        codedFrameCount_++;
+        codingTime_ = (pcl::getTime () - startTime) * 1000.0;
 
         if (bShowStatistics)
         {
@@ -164,17 +237,35 @@ namespace pcl
           std::cerr << "Total compression percentage: " << (bytesPerXYZ + bytesPerColor) / (sizeof(int) + 3.0f
               * sizeof(float)) * 100.0f << "%" << std::endl;
           std::cerr << "Compression ratio: " << (float)(sizeof(int) + 3.0f  * sizeof(float))
-              / (float)(bytesPerXYZ + bytesPerColor)  << std::endl << std::endl;
+              / (float)(bytesPerXYZ + bytesPerColor)  << std::endl;
+          if (trackTemporalChanges)
+            std::cerr << "Voxel change rate: " << changeRate_ * 100.0 << "%" << std::endl;
+          std::cerr << "Average frame size: " << getAverageFrameSize () / 1024.0 << " kBytes" << std::endl;
+          std::cerr << "Encoding time: " << codingTime_ << " ms" << std::endl << std::endl;
         }
 
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename OctreeT>
-      void
+      bool
       PointCloudCompression<PointT, LeafT, OctreeT>::decodePointCloud (std::istream& compressedTreeDataIn_arg,
                                                              PointCloudPtr &cloud_arg)
       {
+        const float inf = std::numeric_limits<float>::max ();
+        return this->decodePointCloudRegion (compressedTreeDataIn_arg, Eigen::Vector3f (-inf, -inf, -inf),
+                                      Eigen::Vector3f (inf, inf, inf), cloud_arg);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      bool
+      PointCloudCompression<PointT, LeafT, OctreeT>::decodePointCloudRegion (std::istream& compressedTreeDataIn_arg,
+                                                                             const Eigen::Vector3f& min_pt_arg,
+                                                                             const Eigen::Vector3f& max_pt_arg,
+                                                                             PointCloudPtr &cloud_arg)
+      {
+        const double startTime = pcl::getTime ();
 
         // initialize octree
         this->switchBuffers ();
@@ -199,23 +290,62 @@ namespace pcl
         // read header from input stream
         this->readFrameHeader (compressedTreeDataIn_arg);
 
-        // decode data vectors from stream
-        this->entropyDecoding (compressedTreeDataIn_arg);
-
-        // initialize color and point encoding
-        colorCoder_.initializeDecoding ();
-        pointCoder_.initializeDecoding ();
+        if (chunkedFrame_)
+        {
+          // decode subtrees overlapping the region of interest
+          const bool decoded = this->decodeChunks (compressedTreeDataIn_arg, min_pt_arg, max_pt_arg);
 
-        // initialize output cloud
-        output_->points.clear ();
-        output_->points.reserve (pointCount_);
+          // chunked frames are no reference for temporal coding
+          leafKeys_.clear ();
+          std::vector<char> noPointDiffData;
+          this->updateTemporalReference (noPointDiffData);
 
-        if (iFrame_)
-          // i-frame decoding - decode tree structure without referencing previous buffer
-          this->deserializeTree (binaryTreeDataVector_, false);
+          if (!decoded)
+          {
+            PCL_ERROR ("[pcl::octree::PointCloudCompression::decodePointCloudRegion] Corrupted chunked frame!\n");
+            output_->points.clear ();
+            output_->width = output_->height = 0;
+            return (false);
+          }
+        }
         else
-          // p-frame decoding - decode XOR encoded tree structure
-          this->deserializeTree (binaryTreeDataVector_, true);
+        {
+          leafKeys_.clear ();
+          prevLeafCursor_ = 0;
+          pointDiffDecodePos_ = 0;
+          // decode data vectors from stream
+          if (!this->entropyDecoding (compressedTreeDataIn_arg))
+          {
+            PCL_ERROR ("[pcl::octree::PointCloudCompression::decodePointCloudRegion] Corrupted frame!\n");
+            output_->points.clear ();
+            output_->width = output_->height = 0;
+            return (false);
+          }
+
+          // initialize color and point encoding
+          colorCoder_.initializeDecoding ();
+          pointCoder_.initializeDecoding ();
+
+          // initialize output cloud
+          output_->points.clear ();
+          output_->points.reserve (pointCount_);
+
+          if (iFrame_)
+            // i-frame decoding - decode tree structure without referencing previous buffer
+            this->deserializeTree (binaryTreeDataVector_, false);
+          else
+            // p-frame decoding - decode XOR encoded tree structure
+            this->deserializeTree (binaryTreeDataVector_, true);
+
+          // decoded frame is the reference for temporal coding of the next frame
+          this->updateTemporalReference (pointCoder_.getDifferentialDataVector ());
+        }
+
+        // update statistics
+        frameSize_ = compressedPointDataLen_ + compressedColorDataLen_;
+        totalFrameSize_ += frameSize_;
+        codedFrameCount_++;
+        codingTime_ = (pcl::getTime () - startTime) * 1000.0;
 
         // assign point cloud properties
         output_->height = 1;
@@ -253,36 +383,59 @@ namespace pcl
                     << "%" << std::endl;
           std::cerr << "Compression ratio: " 
                     << (float)(sizeof(int) + 3.0f  * sizeof(float)) / (float)(bytesPerXYZ + bytesPerColor) 
-                    << std::endl << std::endl;
+                    << std::endl;
+          std::cerr << "Average frame size: " << getAverageFrameSize () / 1024.0 << " kBytes" << std::endl;
+          std::cerr << "Decoding time: " << codingTime_ << " ms" << std::endl << std::endl;
         }
+
+        return (true);
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename OctreeT>
       void
       PointCloudCompression<PointT, LeafT, OctreeT>::entropyEncoding (std::ostream& compressedTreeDataOut_arg)
+      {
+        this->entropyEncoding (compressedTreeDataOut_arg, entropyCoder_, binaryTreeDataVector_, pointCountDataVector_,
+                               pointCoder_, colorCoder_, compressedPointDataLen_, compressedColorDataLen_);
+
+        // flush output stream
+        compressedTreeDataOut_arg.flush ();
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::entropyEncoding (std::ostream& compressedTreeDataOut_arg,
+                                                                      StaticRangeCoder& entropyCoder_arg,
+                                                                      std::vector<char>& binaryTreeData_arg,
+                                                                      std::vector<unsigned int>& pointCountData_arg,
+                                                                      PointCoding<PointT>& pointCoder_arg,
+                                                                      ColorCoding<PointT>& colorCoder_arg,
+                                                                      uint64_t& compressedPointDataLen_arg,
+                                                                      uint64_t& compressedColorDataLen_arg)
       {
         uint64_t binaryTreeDataVector_size;
         uint64_t pointAvgColorDataVector_size;
 
-        compressedPointDataLen_ = 0;
-        compressedColorDataLen_ = 0;
+        compressedPointDataLen_arg = 0;
+        compressedColorDataLen_arg = 0;
 
         // encode binary octree structure
-        binaryTreeDataVector_size = binaryTreeDataVector_.size ();
+        binaryTreeDataVector_size = binaryTreeData_arg.size ();
         compressedTreeDataOut_arg.write ((const char*)&binaryTreeDataVector_size, sizeof(binaryTreeDataVector_size));
-        compressedPointDataLen_ += entropyCoder_.encodeCharVectorToStream (binaryTreeDataVector_,
-                                                                           compressedTreeDataOut_arg);
+        compressedPointDataLen_arg += this->encodeCharVector (entropyCoder_arg, binaryTreeData_arg,
+                                                              compressedTreeDataOut_arg);
 
         if (cloudWithColor_)
         {
           // encode averaged voxel color information
-          std::vector<char>& pointAvgColorDataVector = colorCoder_.getAverageDataVector ();
+          std::vector<char>& pointAvgColorDataVector = colorCoder_arg.getAverageDataVector ();
           pointAvgColorDataVector_size = pointAvgColorDataVector.size ();
           compressedTreeDataOut_arg.write ((const char*)&pointAvgColorDataVector_size,
                                            sizeof(pointAvgColorDataVector_size));
-          compressedColorDataLen_ += entropyCoder_.encodeCharVectorToStream (pointAvgColorDataVector,
-                                                                             compressedTreeDataOut_arg);
+          compressedColorDataLen_arg += this->encodeCharVector (entropyCoder_arg, pointAvgColorDataVector,
+                                                                compressedTreeDataOut_arg);
         }
 
 
@@ -293,59 +446,78 @@ namespace pcl
           uint64_t pointDiffColorDataVector_size;
 
           // encode amount of points per voxel
-          pointCountDataVector_size = pointCountDataVector_.size ();
+          pointCountDataVector_size = pointCountData_arg.size ();
           compressedTreeDataOut_arg.write ((const char*)&pointCountDataVector_size, sizeof(pointCountDataVector_size));
-          compressedPointDataLen_ += entropyCoder_.encodeIntVectorToStream (pointCountDataVector_,
-                                                                            compressedTreeDataOut_arg);
+          compressedPointDataLen_arg += entropyCoder_arg.encodeIntVectorToStream (pointCountData_arg,
+                                                                                  compressedTreeDataOut_arg);
 
           // encode differential point information
-          std::vector<char>& pointDiffDataVector = pointCoder_.getDifferentialDataVector ();
+          std::vector<char>& pointDiffDataVector = pointCoder_arg.getDifferentialDataVector ();
           pointDiffDataVector_size = pointDiffDataVector.size ();
           compressedTreeDataOut_arg.write ((const char*)&pointDiffDataVector_size, sizeof(pointDiffDataVector_size));
-          compressedPointDataLen_ += entropyCoder_.encodeCharVectorToStream (pointDiffDataVector,
-                                                                             compressedTreeDataOut_arg);
+          compressedPointDataLen_arg += this->encodeCharVector (entropyCoder_arg, pointDiffDataVector,
+                                                                compressedTreeDataOut_arg);
           if (cloudWithColor_)
           {
             // encode differential color information
-            std::vector<char>& pointDiffColorDataVector = colorCoder_.getDifferentialDataVector ();
+            std::vector<char>& pointDiffColorDataVector = colorCoder_arg.getDifferentialDataVector ();
             pointDiffColorDataVector_size = pointDiffColorDataVector.size ();
             compressedTreeDataOut_arg.write ((const char*)&pointDiffColorDataVector_size,
                                              sizeof(pointDiffColorDataVector_size));
-            compressedColorDataLen_ += entropyCoder_.encodeCharVectorToStream (pointDiffColorDataVector,
-                                                                               compressedTreeDataOut_arg);
+            compressedColorDataLen_arg += this->encodeCharVector (entropyCoder_arg, pointDiffColorDataVector,
+                                                                  compressedTreeDataOut_arg);
           }
 
         }
-
-        // flush output stream
-        compressedTreeDataOut_arg.flush ();
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename OctreeT>
-      void
+      bool
       PointCloudCompression<PointT, LeafT, OctreeT>::entropyDecoding (std::istream& compressedTreeDataIn_arg)
+      {
+        const bool decoded = this->entropyDecoding (compressedTreeDataIn_arg, entropyCoder_, binaryTreeDataVector_,
+                                                    pointCountDataVector_, pointCoder_, colorCoder_,
+                                                    compressedPointDataLen_, compressedColorDataLen_);
+
+        pointCountDataVectorIterator_ = pointCountDataVector_.begin ();
+        return (decoded);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      bool
+      PointCloudCompression<PointT, LeafT, OctreeT>::entropyDecoding (std::istream& compressedTreeDataIn_arg,
+                                                                      StaticRangeCoder& entropyCoder_arg,
+                                                                      std::vector<char>& binaryTreeData_arg,
+                                                                      std::vector<unsigned int>& pointCountData_arg,
+                                                                      PointCoding<PointT>& pointCoder_arg,
+                                                                      ColorCoding<PointT>& colorCoder_arg,
+                                                                      uint64_t& compressedPointDataLen_arg,
+                                                                      uint64_t& compressedColorDataLen_arg)
       {
         uint64_t binaryTreeDataVector_size;
         uint64_t pointAvgColorDataVector_size;
 
-        compressedPointDataLen_ = 0;
-        compressedColorDataLen_ = 0;
+        compressedPointDataLen_arg = 0;
+        compressedColorDataLen_arg = 0;
 
         // decode binary octree structure
         compressedTreeDataIn_arg.read ((char*)&binaryTreeDataVector_size, sizeof(binaryTreeDataVector_size));
-        binaryTreeDataVector_.resize (binaryTreeDataVector_size);
-        compressedPointDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                           binaryTreeDataVector_);
+        binaryTreeData_arg.resize (binaryTreeDataVector_size);
+        if (!this->decodeCharVector (entropyCoder_arg, compressedTreeDataIn_arg, binaryTreeData_arg,
+                                     compressedPointDataLen_arg))
+          return (false);
 
         if (dataWithColor_)
         {
           // decode averaged voxel color information
-          std::vector<char>& pointAvgColorDataVector = colorCoder_.getAverageDataVector ();
+          std::vector<char>& pointAvgColorDataVector = colorCoder_arg.getAverageDataVector ();
           compressedTreeDataIn_arg.read ((char*)&pointAvgColorDataVector_size, sizeof(pointAvgColorDataVector_size));
           pointAvgColorDataVector.resize (pointAvgColorDataVector_size);
-          compressedColorDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                             pointAvgColorDataVector);
+          if (!this->decodeCharVector (entropyCoder_arg, compressedTreeDataIn_arg, pointAvgColorDataVector,
+                                       compressedColorDataLen_arg))
+            return (false);
         }
 
         if (!doVoxelGridEnDecoding_)
@@ -356,29 +528,34 @@ namespace pcl
 
           // decode amount of points per voxel
           compressedTreeDataIn_arg.read ((char*)&pointCountDataVector_size, sizeof(pointCountDataVector_size));
-          pointCountDataVector_.resize (pointCountDataVector_size);
-          compressedPointDataLen_ += entropyCoder_.decodeStreamToIntVector (compressedTreeDataIn_arg, pointCountDataVector_);
-          pointCountDataVectorIterator_ = pointCountDataVector_.begin ();
+          pointCountData_arg.resize (pointCountDataVector_size);
+          compressedPointDataLen_arg += entropyCoder_arg.decodeStreamToIntVector (compressedTreeDataIn_arg,
+                                                                                  pointCountData_arg);
+          if (!compressedTreeDataIn_arg)
+            return (false);
 
           // decode differential point information
-          std::vector<char>& pointDiffDataVector = pointCoder_.getDifferentialDataVector ();
+          std::vector<char>& pointDiffDataVector = pointCoder_arg.getDifferentialDataVector ();
           compressedTreeDataIn_arg.read ((char*)&pointDiffDataVector_size, sizeof(pointDiffDataVector_size));
           pointDiffDataVector.resize (pointDiffDataVector_size);
-          compressedPointDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                             pointDiffDataVector);
+          if (!this->decodeCharVector (entropyCoder_arg, compressedTreeDataIn_arg, pointDiffDataVector,
+                                       compressedPointDataLen_arg))
+            return (false);
 
           if (dataWithColor_)
           {
             // decode differential color information
-            std::vector<char>& pointDiffColorDataVector = colorCoder_.getDifferentialDataVector ();
+            std::vector<char>& pointDiffColorDataVector = colorCoder_arg.getDifferentialDataVector ();
             compressedTreeDataIn_arg.read ((char*)&pointDiffColorDataVector_size, sizeof(pointDiffColorDataVector_size));
             pointDiffColorDataVector.resize (pointDiffColorDataVector_size);
-            compressedColorDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
-                                                                               pointDiffColorDataVector);
+            if (!this->decodeCharVector (entropyCoder_arg, compressedTreeDataIn_arg, pointDiffColorDataVector,
+                                         compressedColorDataLen_arg))
+              return (false);
           }
 
         }
 
+        return (true);
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
@@ -393,8 +570,9 @@ namespace pcl
         // encode point cloud header id
         compressedTreeDataOut_arg.write ((const char*)&frameID_, sizeof(frameID_));
 
-        // encode frame type (I/P-frame)
-        compressedTreeDataOut_arg.write ((const char*)&iFrame_, sizeof(iFrame_));
+        // encode frame type (0: P-frame, 1: I-frame, 2: chunked I-frame, 3: P-frame with temporal point coding)
+        unsigned char frameType = chunkedFrame_ ? 2 : (iFrame_ ? 1 : (pointDeltaFrame_ ? 3 : 0));
+        compressedTreeDataOut_arg.write ((const char*)&frameType, sizeof(frameType));
         if (iFrame_)
         {
           double minX, minY, minZ, maxX, maxY, maxZ;
@@ -456,7 +634,11 @@ namespace pcl
         // read header
         compressedTreeDataIn_arg.read ((char*)&frameID_, sizeof(frameID_));
 
-        compressedTreeDataIn_arg.read ((char*)&iFrame_, sizeof(iFrame_));
+        unsigned char frameType;
+        compressedTreeDataIn_arg.read ((char*)&frameType, sizeof(frameType));
+        iFrame_ = (frameType == 1) || (frameType == 2);
+        chunkedFrame_ = (frameType == 2);
+        pointDeltaFrame_ = (frameType == 3);
         if (iFrame_)
         {
           double minX, minY, minZ, maxX, maxY, maxZ;
@@ -493,21 +675,511 @@ namespace pcl
 
       }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      uint64_t
+      PointCloudCompression<PointT, LeafT, OctreeT>::encodeCharVector (StaticRangeCoder& entropyCoder_arg,
+                                                                       const std::vector<char>& inputByteVector_arg,
+                                                                       std::ostream& compressedTreeDataOut_arg) const
+      {
+        if (!chunkedFrame_)
+          return (entropyCoder_arg.encodeCharVectorToStream (inputByteVector_arg, compressedTreeDataOut_arg));
+
+        // chunked frames use the buffer based coder, prefixed with the size of the encoded data
+        std::vector<char> encodedData (StaticRangeCoder::getMaxEncodedBufferSize (inputByteVector_arg.size ()));
+        uint64_t encodedSize = entropyCoder_arg.encodeCharBuffer (inputByteVector_arg.empty () ? 0 : &inputByteVector_arg[0],
+                                                                  inputByteVector_arg.size (),
+                                                                  &encodedData[0], encodedData.size ());
+
+        compressedTreeDataOut_arg.write ((const char*)&encodedSize, sizeof(encodedSize));
+        compressedTreeDataOut_arg.write (&encodedData[0], encodedSize);
+
+        return (sizeof(encodedSize) + encodedSize);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      bool
+      PointCloudCompression<PointT, LeafT, OctreeT>::decodeCharVector (StaticRangeCoder& entropyCoder_arg,
+                                                                       std::istream& compressedTreeDataIn_arg,
+                                                                       std::vector<char>& outputByteVector_arg,
+                                                                       uint64_t& compressedDataLen_arg) const
+      {
+        if (!chunkedFrame_)
+        {
+          compressedDataLen_arg += entropyCoder_arg.decodeStreamToCharVector (compressedTreeDataIn_arg,
+                                                                              outputByteVector_arg);
+
+          // the range coder marks the stream as failed when it ends early
+          return (!compressedTreeDataIn_arg.fail ());
+        }
+
+        uint64_t encodedSize = 0;
+        compressedTreeDataIn_arg.read ((char*)&encodedSize, sizeof(encodedSize));
+
+        // chunks are decoded from memory, sizes exceeding the remaining chunk data are corrupted
+        if (!compressedTreeDataIn_arg || (encodedSize > (uint64_t)compressedTreeDataIn_arg.rdbuf ()->in_avail ()))
+          return (false);
+
+        std::vector<char> encodedData;
+        if (encodedSize)
+        {
+          encodedData.resize (encodedSize);
+          if (!compressedTreeDataIn_arg.read (&encodedData[0], encodedSize))
+            return (false);
+        }
+
+        if (!entropyCoder_arg.decodeCharBuffer (encodedSize ? &encodedData[0] : 0, encodedSize,
+                                                outputByteVector_arg.empty () ? 0 : &outputByteVector_arg[0],
+                                                outputByteVector_arg.size ()))
+          return (false);
+
+        compressedDataLen_arg += sizeof(encodedSize) + encodedSize;
+        return (true);
+      }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename OctreeT>
       void
-      PointCloudCompression<PointT, LeafT, OctreeT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+      PointCloudCompression<PointT, LeafT, OctreeT>::encodeChunks (std::ostream& compressedTreeDataOut_arg)
       {
+        typedef typename OctreePointCloud<PointT, LeafT, OctreeT>::LeafNodeIterator LeafNodeIterator;
+
+        const unsigned int treeDepth = this->getTreeDepth ();
+        const unsigned char chunkDepth = (unsigned char)std::min (chunkDepth_, treeDepth);
+        const unsigned int chunkShift = treeDepth - chunkDepth;
+
+        // collect leaf nodes in depth-first order - the leaves of each subtree form a contiguous range
+        std::vector<OctreeKey> leafKeys;
+        std::vector<const std::vector<int>*> leafIndices;
+        std::vector<std::size_t> chunkBegin;
+
+        leafKeys.reserve (this->leafCount_);
+        leafIndices.reserve (this->leafCount_);
+
+        LeafNodeIterator it (*this);
+        while (*++it)
+        {
+          const OctreeKey& key = it.getCurrentOctreeKey ();
+
+          // start a new chunk if the key prefix at chunk depth changes
+          if (leafKeys.empty () || (((key.x ^ leafKeys.back ().x) | (key.y ^ leafKeys.back ().y)
+              | (key.z ^ leafKeys.back ().z)) >> chunkShift))
+            chunkBegin.push_back (leafKeys.size ());
+
+          leafKeys.push_back (key);
+          leafIndices.push_back (&(*it)->getIdxVector ());
+        }
+        chunkBegin.push_back (leafKeys.size ());
+
+        const int chunkCount = (int)chunkBegin.size () - 1;
+        const unsigned int chunkDepthMask = chunkShift ? 1u << (chunkShift - 1) : 0;
+
+        std::vector<std::string> chunkData (chunkCount);
+        std::vector<uint64_t> chunkPointCount (chunkCount);
+        std::vector<uint64_t> chunkPointDataLen (chunkCount);
+        std::vector<uint64_t> chunkColorDataLen (chunkCount);
+
+        // encode subtrees in parallel, every thread works with its own coder instances
+#pragma omp parallel num_threads (this->threads_)
+        {
+          StaticRangeCoder entropyCoder;
+          PointCoding<PointT> pointCoder (pointCoder_);
+          ColorCoding<PointT> colorCoder (colorCoder_);
+          std::vector<char> binaryTreeData;
+          std::vector<unsigned int> pointCountData;
+
+#pragma omp for schedule (dynamic)
+          for (int c = 0; c < chunkCount; ++c)
+          {
+            pointCoder.initializeEncoding ();
+            colorCoder.initializeEncoding ();
+            binaryTreeData.clear ();
+            pointCountData.clear ();
+
+            // encode subtree structure below chunk root
+            this->serializeChunkRecursive (leafKeys, chunkBegin[c], chunkBegin[c + 1], chunkDepthMask, binaryTreeData);
+
+            // encode leaf nodes
+            uint64_t pointCount = 0;
+            for (std::size_t i = chunkBegin[c]; i < chunkBegin[c + 1]; ++i)
+            {
+              this->encodeLeaf (*leafIndices[i], leafKeys[i], pointCoder, colorCoder, pointCountData);
+              pointCount += leafIndices[i]->size ();
+            }
+            chunkPointCount[c] = doVoxelGridEnDecoding_ ? chunkBegin[c + 1] - chunkBegin[c] : pointCount;
+
+            std::ostringstream chunkStream;
+            this->entropyEncoding (chunkStream, entropyCoder, binaryTreeData, pointCountData, pointCoder, colorCoder,
+                                   chunkPointDataLen[c], chunkColorDataLen[c]);
+            chunkData[c] = chunkStream.str ();
+          }
+        }
+
+        // write chunk index
+        uint32_t chunkCount_out = (uint32_t)chunkCount;
+        compressedTreeDataOut_arg.write ((const char*)&chunkDepth, sizeof(chunkDepth));
+        compressedTreeDataOut_arg.write ((const char*)&chunkCount_out, sizeof(chunkCount_out));
+
+        compressedPointDataLen_ = sizeof(chunkDepth) + sizeof(chunkCount_out);
+        compressedColorDataLen_ = 0;
+
+        for (int c = 0; c < chunkCount; ++c)
+        {
+          const OctreeKey& key = leafKeys[chunkBegin[c]];
+          const uint32_t chunkX = key.x >> chunkShift;
+          const uint32_t chunkY = key.y >> chunkShift;
+          const uint32_t chunkZ = key.z >> chunkShift;
+          const uint64_t chunkByteCount = chunkData[c].size ();
+
+          compressedTreeDataOut_arg.write ((const char*)&chunkX, sizeof(chunkX));
+          compressedTreeDataOut_arg.write ((const char*)&chunkY, sizeof(chunkY));
+          compressedTreeDataOut_arg.write ((const char*)&chunkZ, sizeof(chunkZ));
+          compressedTreeDataOut_arg.write ((const char*)&chunkPointCount[c], sizeof(chunkPointCount[c]));
+          compressedTreeDataOut_arg.write ((const char*)&chunkByteCount, sizeof(chunkByteCount));
+
+          compressedPointDataLen_ += 3 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+        }
+
+        // write chunk data
+        for (int c = 0; c < chunkCount; ++c)
+        {
+          compressedTreeDataOut_arg.write (chunkData[c].data (), chunkData[c].size ());
+
+          compressedPointDataLen_ += chunkPointDataLen[c];
+          compressedColorDataLen_ += chunkColorDataLen[c];
+        }
+
+        // flush output stream
+        compressedTreeDataOut_arg.flush ();
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      bool
+      PointCloudCompression<PointT, LeafT, OctreeT>::decodeChunks (std::istream& compressedTreeDataIn_arg,
+                                                                   const Eigen::Vector3f& min_pt_arg,
+                                                                   const Eigen::Vector3f& max_pt_arg)
+      {
+        unsigned char chunkDepth;
+        uint32_t chunkCount;
+
+        // read chunk index
+        compressedTreeDataIn_arg.read ((char*)&chunkDepth, sizeof(chunkDepth));
+        compressedTreeDataIn_arg.read ((char*)&chunkCount, sizeof(chunkCount));
+
+        const unsigned int treeDepth = this->getTreeDepth ();
+        const unsigned int chunkShift = treeDepth - std::min<unsigned int> (chunkDepth, treeDepth);
+        const unsigned int chunkDepthMask = chunkShift ? 1u << (chunkShift - 1) : 0;
+        const double chunkSize = this->resolution_ * (double)(1u << chunkShift);
+
+        std::vector<OctreeKey> chunkKeys;
+        std::vector<uint64_t> chunkPointCount;
+        std::vector<uint64_t> chunkByteCount;
 
-      // reference to point indices vector stored within octree leaf
-      const std::vector<int>& leafIdx = leaf_arg.getIdxVector ();
+        chunkKeys.resize (chunkCount);
+        chunkPointCount.resize (chunkCount);
+        chunkByteCount.resize (chunkCount);
 
+        for (uint32_t c = 0; c < chunkCount; ++c)
+        {
+          uint32_t chunkX, chunkY, chunkZ;
+
+          compressedTreeDataIn_arg.read ((char*)&chunkX, sizeof(chunkX));
+          compressedTreeDataIn_arg.read ((char*)&chunkY, sizeof(chunkY));
+          compressedTreeDataIn_arg.read ((char*)&chunkZ, sizeof(chunkZ));
+          compressedTreeDataIn_arg.read ((char*)&chunkPointCount[c], sizeof(chunkPointCount[c]));
+          compressedTreeDataIn_arg.read ((char*)&chunkByteCount[c], sizeof(chunkByteCount[c]));
+
+          chunkKeys[c].x = chunkX << chunkShift;
+          chunkKeys[c].y = chunkY << chunkShift;
+          chunkKeys[c].z = chunkZ << chunkShift;
+        }
+
+        if (!compressedTreeDataIn_arg)
+          return (false);
+
+        // read all chunks overlapping the region of interest, skip the others
+        std::vector<std::string> chunkData;
+        std::vector<uint32_t> selectedChunks;
+        std::vector<std::size_t> chunkOutputOffset;
+        std::size_t outputSize = 0;
+
+        for (uint32_t c = 0; c < chunkCount; ++c)
+        {
+          const double chunkMin[3] = {chunkKeys[c].x * this->resolution_ + this->minX_,
+                                      chunkKeys[c].y * this->resolution_ + this->minY_,
+                                      chunkKeys[c].z * this->resolution_ + this->minZ_};
+
+          const bool overlap = (chunkMin[0] <= max_pt_arg[0]) && (chunkMin[0] + chunkSize >= min_pt_arg[0])
+                            && (chunkMin[1] <= max_pt_arg[1]) && (chunkMin[1] + chunkSize >= min_pt_arg[1])
+                            && (chunkMin[2] <= max_pt_arg[2]) && (chunkMin[2] + chunkSize >= min_pt_arg[2]);
+
+          if (overlap)
+          {
+            chunkData.push_back (std::string ());
+            chunkData.back ().resize (chunkByteCount[c]);
+            if (chunkByteCount[c])
+              compressedTreeDataIn_arg.read (&chunkData.back ()[0], chunkByteCount[c]);
+
+            selectedChunks.push_back (c);
+            chunkOutputOffset.push_back (outputSize);
+            outputSize += chunkPointCount[c];
+          }
+          else
+          {
+            compressedTreeDataIn_arg.ignore ((std::streamsize)chunkByteCount[c]);
+          }
+        }
+
+        if (!compressedTreeDataIn_arg)
+          return (false);
+
+        const int selectedCount = (int)selectedChunks.size ();
+
+        std::vector<uint64_t> chunkPointDataLen (selectedCount);
+        std::vector<uint64_t> chunkColorDataLen (selectedCount);
+        std::vector<char> chunkDecoded (selectedCount, 0);
+
+        output_->points.clear ();
+        output_->points.resize (outputSize);
+
+        // decode selected subtrees in parallel, every thread works with its own coder instances
+#pragma omp parallel num_threads (this->threads_)
+        {
+          StaticRangeCoder entropyCoder;
+          PointCoding<PointT> pointCoder (pointCoder_);
+          ColorCoding<PointT> colorCoder (colorCoder_);
+          std::vector<char> binaryTreeData;
+          std::vector<unsigned int> pointCountData;
+          std::vector<OctreeKey> leafKeys;
+          PointCloudPtr chunkCloud (new PointCloud ());
+
+#pragma omp for schedule (dynamic)
+          for (int c = 0; c < selectedCount; ++c)
+          {
+            const uint32_t chunkIdx = selectedChunks[c];
+
+            std::istringstream chunkStream (chunkData[c]);
+            if (!this->entropyDecoding (chunkStream, entropyCoder, binaryTreeData, pointCountData, pointCoder,
+                                        colorCoder, chunkPointDataLen[c], chunkColorDataLen[c]))
+              continue;
+
+            pointCoder.initializeDecoding ();
+            colorCoder.initializeDecoding ();
+
+            // decode subtree structure below chunk root
+            std::vector<char>::const_iterator binaryTreeIt = binaryTreeData.begin ();
+            leafKeys.clear ();
+            this->deserializeChunkRecursive (binaryTreeIt, chunkKeys[chunkIdx], chunkDepthMask, leafKeys);
+
+            // decode leaf nodes
+            std::vector<unsigned int>::const_iterator pointCountIt = pointCountData.begin ();
+            chunkCloud->points.clear ();
+            for (std::size_t i = 0; i < leafKeys.size (); ++i)
+              this->decodeLeaf (leafKeys[i], pointCoder, colorCoder, pointCountIt, chunkCloud);
+
+            // copy decoded points to their slot within the output cloud
+            const std::size_t pointCount = std::min<std::size_t> (chunkCloud->points.size (), chunkPointCount[chunkIdx]);
+            std::copy (chunkCloud->points.begin (), chunkCloud->points.begin () + pointCount,
+                       output_->points.begin () + chunkOutputOffset[c]);
+            chunkDecoded[c] = 1;
+          }
+        }
+
+        compressedPointDataLen_ = 0;
+        compressedColorDataLen_ = 0;
+        for (int c = 0; c < selectedCount; ++c)
+        {
+          if (!chunkDecoded[c])
+            return (false);
+
+          compressedPointDataLen_ += chunkPointDataLen[c];
+          compressedColorDataLen_ += chunkColorDataLen[c];
+        }
+
+        return (true);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::serializeChunkRecursive (const std::vector<OctreeKey>& leafKeys_arg,
+                                                                              std::size_t begin_arg,
+                                                                              std::size_t end_arg,
+                                                                              unsigned int depthMask_arg,
+                                                                              std::vector<char>& binaryTreeOut_arg) const
+      {
+        // leaf level reached
+        if (!depthMask_arg)
+          return;
+
+        // child leaf ranges are contiguous and ordered by child index
+        char childMask = 0;
+        std::size_t childBegin = begin_arg;
+        std::vector<std::size_t> childRanges;
+
+        while (childBegin < end_arg)
+        {
+          const OctreeKey& key = leafKeys_arg[childBegin];
+          const unsigned char childIdx = (unsigned char)((!!(key.x & depthMask_arg) << 2)
+                                                       | (!!(key.y & depthMask_arg) << 1)
+                                                       | (!!(key.z & depthMask_arg)));
+
+          std::size_t childEnd = childBegin + 1;
+          while ((childEnd < end_arg)
+              && !(((leafKeys_arg[childEnd].x ^ key.x) | (leafKeys_arg[childEnd].y ^ key.y)
+                  | (leafKeys_arg[childEnd].z ^ key.z)) & depthMask_arg))
+            ++childEnd;
+
+          childMask |= (char)(1 << childIdx);
+          childRanges.push_back (childEnd);
+          childBegin = childEnd;
+        }
+
+        // output child bit pattern and recurse into children
+        binaryTreeOut_arg.push_back (childMask);
+
+        childBegin = begin_arg;
+        for (std::size_t i = 0; i < childRanges.size (); ++i)
+        {
+          this->serializeChunkRecursive (leafKeys_arg, childBegin, childRanges[i], depthMask_arg >> 1, binaryTreeOut_arg);
+          childBegin = childRanges[i];
+        }
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::deserializeChunkRecursive (
+          std::vector<char>::const_iterator& binaryTreeIn_arg, const OctreeKey& key_arg, unsigned int depthMask_arg,
+          std::vector<OctreeKey>& leafKeys_arg) const
+      {
+        // leaf level reached
+        if (!depthMask_arg)
+        {
+          leafKeys_arg.push_back (key_arg);
+          return;
+        }
+
+        const unsigned char childMask = (unsigned char)*binaryTreeIn_arg++;
+
+        for (unsigned char childIdx = 0; childIdx < 8; childIdx++)
+        {
+          if (childMask & (1 << childIdx))
+          {
+            OctreeKey childKey = key_arg;
+            childKey.x |= (childIdx & 4) ? depthMask_arg : 0;
+            childKey.y |= (childIdx & 2) ? depthMask_arg : 0;
+            childKey.z |= (childIdx & 1) ? depthMask_arg : 0;
+
+            this->deserializeChunkRecursive (binaryTreeIn_arg, childKey, depthMask_arg >> 1, leafKeys_arg);
+          }
+        }
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      double
+      PointCloudCompression<PointT, LeafT, OctreeT>::computeChangeRate ()
+      {
+        typedef typename OctreePointCloud<PointT, LeafT, OctreeT>::LeafNodeIterator LeafNodeIterator;
+
+        std::size_t leafCount = 0;
+        std::size_t matchCount = 0;
+        std::size_t prevIdx = 0;
+
+        // both key sequences are in depth-first order, merge them
+        LeafNodeIterator it (*this);
+        while (*++it)
+        {
+          const OctreeKey& key = it.getCurrentOctreeKey ();
+
+          while ((prevIdx < prevLeafKeys_.size ()) && this->octreeKeyMortonLess (prevLeafKeys_[prevIdx], key))
+            prevIdx++;
+
+          if ((prevIdx < prevLeafKeys_.size ()) && (prevLeafKeys_[prevIdx] == key))
+            matchCount++;
+
+          leafCount++;
+        }
+
+        if (leafCount + prevLeafKeys_.size () == 0)
+          return (0.0);
+
+        // fraction of voxels that exist in only one of both frames
+        return (1.0 - (2.0 * matchCount) / (double)(leafCount + prevLeafKeys_.size ()));
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::applyTemporalDelta (const OctreeKey& key_arg,
+                                                                         std::size_t pointCount_arg,
+                                                                         char* pointDiffData_arg,
+                                                                         bool revert_arg)
+      {
+        // find voxel in previous frame
+        while ((prevLeafCursor_ < prevLeafKeys_.size ()) && this->octreeKeyMortonLess (prevLeafKeys_[prevLeafCursor_], key_arg))
+          prevLeafCursor_++;
+
+        if ((prevLeafCursor_ >= prevLeafKeys_.size ()) || !(prevLeafKeys_[prevLeafCursor_] == key_arg))
+          return;
+
+        const std::size_t prevBegin = prevLeafDiffOffset_[prevLeafCursor_];
+        const std::size_t prevEnd = prevLeafDiffOffset_[prevLeafCursor_ + 1];
+        if ((prevEnd - prevBegin != 3 * pointCount_arg) || (prevEnd > prevPointDiffData_.size ()))
+          return;
+
+        const char* prevData = &prevPointDiffData_[prevBegin];
+        if (revert_arg)
+        {
+          for (std::size_t i = 0; i < 3 * pointCount_arg; i++)
+            pointDiffData_arg[i] = (char)(pointDiffData_arg[i] + prevData[i]);
+        }
+        else
+        {
+          for (std::size_t i = 0; i < 3 * pointCount_arg; i++)
+            pointDiffData_arg[i] = (char)(pointDiffData_arg[i] - prevData[i]);
+        }
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::updateTemporalReference (std::vector<char>& pointDiffData_arg)
+      {
+        prevLeafKeys_.swap (leafKeys_);
+        leafKeys_.clear ();
+
+        // offsets of the voxels' point detail
+        prevLeafDiffOffset_.resize (prevLeafKeys_.size () + 1);
+        prevLeafDiffOffset_[0] = 0;
+        for (std::size_t i = 0; i < prevLeafKeys_.size (); i++)
+        {
+          const std::size_t pointCount = (!doVoxelGridEnDecoding_ && (i < pointCountDataVector_.size ()))
+                                         ? pointCountDataVector_[i] : 0;
+          prevLeafDiffOffset_[i + 1] = prevLeafDiffOffset_[i] + 3 * pointCount;
+        }
+
+        prevPointDiffData_.swap (pointDiffData_arg);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::encodeLeaf (const std::vector<int>& leafIdx_arg,
+                                                                 const OctreeKey& key_arg,
+                                                                 PointCoding<PointT>& pointCoder_arg,
+                                                                 ColorCoding<PointT>& colorCoder_arg,
+                                                                 std::vector<unsigned int>& pointCountData_arg) const
+      {
         if (!doVoxelGridEnDecoding_)
         {
           double lowerVoxelCorner[3];
 
           // encode amount of points within voxel
-          pointCountDataVector_.push_back ((int)leafIdx.size ());
+          pointCountData_arg.push_back ((int)leafIdx_arg.size ());
 
           // calculate lower voxel corner based on octree key
           lowerVoxelCorner[0] = ((double)key_arg.x) * this->resolution_ + this->minX_;
@@ -515,12 +1187,12 @@ namespace pcl
           lowerVoxelCorner[2] = ((double)key_arg.z) * this->resolution_ + this->minZ_;
 
           // differentially encode points to lower voxel corner
-          pointCoder_.encodePoints (leafIdx, lowerVoxelCorner, this->input_);
+          pointCoder_arg.encodePoints (leafIdx_arg, lowerVoxelCorner, this->input_);
 
           if (cloudWithColor_)
           {
             // encode color of points
-            colorCoder_.encodePoints (leafIdx, pointColorOffset_, this->input_);
+            colorCoder_arg.encodePoints (leafIdx_arg, pointColorOffset_, this->input_);
           }
 
         }
@@ -529,7 +1201,7 @@ namespace pcl
           if (cloudWithColor_)
           {
             // encode average color of all points within voxel
-            colorCoder_.encodeAverageOfPoints (leafIdx, pointColorOffset_, this->input_);
+            colorCoder_arg.encodeAverageOfPoints (leafIdx_arg, pointColorOffset_, this->input_);
           }
         }
 
@@ -538,7 +1210,11 @@ namespace pcl
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename OctreeT>
       void
-      PointCloudCompression<PointT, LeafT, OctreeT>::deserializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+      PointCloudCompression<PointT, LeafT, OctreeT>::decodeLeaf (const OctreeKey& key_arg,
+                                                                 PointCoding<PointT>& pointCoder_arg,
+                                                                 ColorCoding<PointT>& colorCoder_arg,
+                                                                 std::vector<unsigned int>::const_iterator& pointCountIterator_arg,
+                                                                 PointCloudPtr& cloud_arg) const
       {
         double lowerVoxelCorner[3];
         std::size_t pointCount, i, cloudSize;
@@ -549,16 +1225,16 @@ namespace pcl
         if (!doVoxelGridEnDecoding_)
         {
           // get current cloud size
-          cloudSize = this->output_->points.size ();
+          cloudSize = cloud_arg->points.size ();
 
           // get amount of point to be decoded
-          pointCount = *pointCountDataVectorIterator_;
-          pointCountDataVectorIterator_++;
+          pointCount = *pointCountIterator_arg;
+          pointCountIterator_arg++;
 
           // increase point cloud by amount of voxel points
           for (i = 0; i < pointCount; i++)
           {
-            this->output_->points.push_back (newPoint);
+            cloud_arg->points.push_back (newPoint);
           }
 
           // calculcate position of lower voxel corner
@@ -567,7 +1243,7 @@ namespace pcl
           lowerVoxelCorner[2] = ((double)key_arg.z) * this->resolution_ + this->minZ_;
 
           // decode differentially encoded points
-          pointCoder_.decodePoints (this->output_, lowerVoxelCorner, cloudSize, cloudSize + pointCount);
+          pointCoder_arg.decodePoints (cloud_arg, lowerVoxelCorner, cloudSize, cloudSize + pointCount);
 
         }
         else
@@ -578,7 +1254,7 @@ namespace pcl
           newPoint.z = ((double)key_arg.z + 0.5) * this->resolution_ + this->minZ_;
 
           // add point to point cloud
-          this->output_->points.push_back (newPoint);
+          cloud_arg->points.push_back (newPoint);
 
         }
 
@@ -587,22 +1263,53 @@ namespace pcl
           if (dataWithColor_)
           {
             // decode color information
-            colorCoder_.decodePoints (this->output_, this->output_->points.size () - pointCount,
-                                      this->output_->points.size (), pointColorOffset_);
+            colorCoder_arg.decodePoints (cloud_arg, cloud_arg->points.size () - pointCount,
+                                         cloud_arg->points.size (), pointColorOffset_);
           }
           else
           {
             // set default color information
-            colorCoder_.setDefaultColor (this->output_, this->output_->points.size () - pointCount,
-                                         this->output_->points.size (), pointColorOffset_);
+            colorCoder_arg.setDefaultColor (cloud_arg, cloud_arg->points.size () - pointCount,
+                                            cloud_arg->points.size (), pointColorOffset_);
           }
         }
 
       }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+      {
+        this->encodeLeaf (leaf_arg.getIdxVector (), key_arg, pointCoder_, colorCoder_, pointCountDataVector_);
+
+        if (adaptiveGOP_ || temporalPointCoding_)
+          leafKeys_.push_back (key_arg);
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename OctreeT>
+      void
+      PointCloudCompression<PointT, LeafT, OctreeT>::deserializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+      {
+        if (!doVoxelGridEnDecoding_)
+        {
+          std::vector<char>& pointDiffData = pointCoder_.getDifferentialDataVector ();
+          const std::size_t pointCount = *pointCountDataVectorIterator_;
+
+          // restore point detail coded relative to the previous frame
+          if (pointDeltaFrame_ && (pointDiffDecodePos_ + 3 * pointCount <= pointDiffData.size ()))
+            this->applyTemporalDelta (key_arg, pointCount, &pointDiffData[0] + pointDiffDecodePos_, true);
+
+          pointDiffDecodePos_ += 3 * pointCount;
+        }
+        leafKeys_.push_back (key_arg);
+
+        this->decodeLeaf (key_arg, pointCoder_, colorCoder_, pointCountDataVectorIterator_, output_);
+      }
   }
 }
 
 #define PCL_INSTANTIATE_PointCloudCompression(T) template class PCL_EXPORTS pcl::octree::PointCloudCompression<T>;
 
 #endif
-
@@ -110,7 +110,10 @@ namespace pcl
               doVoxelGridEnDecoding_ (doVoxelGridDownDownSampling_arg), iFrameRate_ (iFrameRate_arg),
               iFrameCounter_ (0), frameID_ (0), pointCount_ (0), iFrame_ (true),
               doColorEncoding_ (doColorEncoding_arg), cloudWithColor_ (false), dataWithColor_ (false),
-              pointColorOffset_ (0), bShowStatistics (showStatistics_arg)
+              pointColorOffset_ (0), chunkDepth_ (0), chunkedFrame_ (false), adaptiveGOP_ (false),
+              iFrameChangeRate_ (0.25), temporalPointCoding_ (false), pointDeltaFrame_ (false), prevLeafCursor_ (0),
+              pointDiffDecodePos_ (0), changeRate_ (0.0), frameSize_ (0), totalFrameSize_ (0), codedFrameCount_ (0),
+              codingTime_ (0.0), bShowStatistics (showStatistics_arg)
 
         {
           output_ = PointCloudPtr ();
@@ -181,10 +184,109 @@ namespace pcl
         /** \brief Decode point cloud from input stream
          *  \param compressedTreeDataIn_arg: binary input stream containing compressed data
          *  \param cloud_arg: reference to decoded point cloud
+         *  \return true on success, false if the compressed data is corrupted (the decoded point cloud is empty then)
          * */
-        void
+        bool
         decodePointCloud (std::istream& compressedTreeDataIn_arg, PointCloudPtr &cloud_arg);
 
+        /** \brief Decode only the part of a point cloud that lies within an axis-aligned box
+         *  \note Only chunked frames (see setChunkDepth) can be decoded partially: all chunks overlapping
+         *  the box are decoded, all others are skipped in the input stream. Frames that are not chunked
+         *  are decoded completely.
+         *  \param compressedTreeDataIn_arg: binary input stream containing compressed data
+         *  \param min_pt_arg: lower corner of the region of interest
+         *  \param max_pt_arg: upper corner of the region of interest
+         *  \param cloud_arg: reference to decoded point cloud
+         *  \return true on success, false if the compressed data is corrupted (the decoded point cloud is empty then)
+         * */
+        bool
+        decodePointCloudRegion (std::istream& compressedTreeDataIn_arg, const Eigen::Vector3f& min_pt_arg,
+                                const Eigen::Vector3f& max_pt_arg, PointCloudPtr &cloud_arg);
+
+        /** \brief Split the octree at the given depth into independently encoded subtrees (chunks).
+         *  \note The subtrees of a chunked frame are encoded and decoded in parallel (see setNumberOfThreads)
+         *  and can be decoded selectively with decodePointCloudRegion. Chunked frames are always intra coded.
+         *  Every chunk carries its own entropy coder tables, so small depths (1 to 3) work best.
+         *  \param chunkDepth_arg: octree depth of the subtree roots, 0 disables chunking (default)
+         * */
+        inline void
+        setChunkDepth (unsigned int chunkDepth_arg)
+        {
+          chunkDepth_ = chunkDepth_arg;
+        }
+
+        /** \brief Get the octree depth at which frames are split into independently encoded subtrees.
+         *  \return chunk depth, 0 if chunking is disabled
+         * */
+        inline unsigned int
+        getChunkDepth () const
+        {
+          return (chunkDepth_);
+        }
+
+        /** \brief Enable adaptive group of pictures (GOP) mode.
+         *  \note I-frames are inserted whenever the fraction of voxels that appeared or disappeared since the
+         *  previous frame exceeds the given change rate. The i-frame rate remains the maximum GOP length.
+         *  \param adaptiveGOP_arg: enable/disable adaptive I-frame selection
+         *  \param iFrameChangeRate_arg: voxel change rate (0..1) above which an I-frame is encoded
+         * */
+        inline void
+        setAdaptiveGOP (bool adaptiveGOP_arg, double iFrameChangeRate_arg = 0.25)
+        {
+          adaptiveGOP_ = adaptiveGOP_arg;
+          iFrameChangeRate_ = iFrameChangeRate_arg;
+        }
+
+        /** \brief Enable temporal coding of point detail information.
+         *  \note In P-frames, the point detail of a voxel that holds as many points as in the previous frame is
+         *  encoded as difference to the previous frame. This pays off for mostly static scenes captured by
+         *  sensors with a stable point order, such as lidar scans. Has no effect with voxel grid coding.
+         *  \param temporalPointCoding_arg: enable/disable temporal point detail coding
+         * */
+        inline void
+        setTemporalPointCoding (bool temporalPointCoding_arg)
+        {
+          temporalPointCoding_ = temporalPointCoding_arg;
+        }
+
+        /** \brief Get the fraction of voxels that appeared or disappeared in the last encoded frame.
+         *  \note Only measured if adaptive GOP or temporal point coding is enabled.
+         *  \return voxel change rate (0..1)
+         * */
+        inline double
+        getChangeRate () const
+        {
+          return (changeRate_);
+        }
+
+        /** \brief Get the amount of entropy coded bytes of the last en-/decoded frame.
+         *  \return frame size in bytes
+         * */
+        inline uint64_t
+        getFrameSize () const
+        {
+          return (frameSize_);
+        }
+
+        /** \brief Get the average amount of entropy coded bytes of all frames en-/decoded by this instance.
+         *  \note Multiply with the frame rate to obtain the bit rate of a stream.
+         *  \return average frame size in bytes
+         * */
+        inline double
+        getAverageFrameSize () const
+        {
+          return (codedFrameCount_ ? (double)totalFrameSize_ / (double)codedFrameCount_ : 0.0);
+        }
+
+        /** \brief Get the time spent to en-/decode the last frame.
+         *  \return coding time in milliseconds
+         * */
+        inline double
+        getCodingTime () const
+        {
+          return (codingTime_);
+        }
+
       protected:
 
         /** \brief Write frame information to output stream
@@ -207,10 +309,150 @@ namespace pcl
 
         /** \brief Entropy decoding of input binary stream and output to information vectors
          *  \param compressedTreeDataIn_arg: binary input stream
+         *  \return false if a data vector could not be decoded
          * */
-        void
+        bool
         entropyDecoding (std::istream& compressedTreeDataIn_arg);
 
+        /** \brief Apply entropy encoding to a set of data vectors and output to binary stream
+         *  \param compressedTreeDataOut_arg: binary output stream
+         *  \param entropyCoder_arg: range coder instance
+         *  \param binaryTreeData_arg: binary tree structure
+         *  \param pointCountData_arg: amount of points per voxel
+         *  \param pointCoder_arg: point coder holding the differential point information
+         *  \param colorCoder_arg: color coder holding the color information
+         *  \param compressedPointDataLen_arg: amount of bytes written for tree structure and points
+         *  \param compressedColorDataLen_arg: amount of bytes written for color information
+         * */
+        void
+        entropyEncoding (std::ostream& compressedTreeDataOut_arg, StaticRangeCoder& entropyCoder_arg,
+                         std::vector<char>& binaryTreeData_arg, std::vector<unsigned int>& pointCountData_arg,
+                         PointCoding<PointT>& pointCoder_arg, ColorCoding<PointT>& colorCoder_arg,
+                         uint64_t& compressedPointDataLen_arg, uint64_t& compressedColorDataLen_arg);
+
+        /** \brief Entropy decoding of input binary stream to a set of data vectors
+         *  \param compressedTreeDataIn_arg: binary input stream
+         *  \param entropyCoder_arg: range coder instance
+         *  \param binaryTreeData_arg: binary tree structure
+         *  \param pointCountData_arg: amount of points per voxel
+         *  \param pointCoder_arg: point coder receiving the differential point information
+         *  \param colorCoder_arg: color coder receiving the color information
+         *  \param compressedPointDataLen_arg: amount of bytes read for tree structure and points
+         *  \param compressedColorDataLen_arg: amount of bytes read for color information
+         *  \return false if a data vector could not be decoded
+         * */
+        bool
+        entropyDecoding (std::istream& compressedTreeDataIn_arg, StaticRangeCoder& entropyCoder_arg,
+                         std::vector<char>& binaryTreeData_arg, std::vector<unsigned int>& pointCountData_arg,
+                         PointCoding<PointT>& pointCoder_arg, ColorCoding<PointT>& colorCoder_arg,
+                         uint64_t& compressedPointDataLen_arg, uint64_t& compressedColorDataLen_arg);
+
+        /** \brief Entropy encode a char vector and output it to binary stream
+         *  \note Chunked frames use the buffer based coder of StaticRangeCoder, all other frames the stream coder.
+         *  \param entropyCoder_arg: range coder instance
+         *  \param inputByteVector_arg: data to be encoded
+         *  \param compressedTreeDataOut_arg: binary output stream
+         *  \return amount of bytes written to output stream
+         * */
+        uint64_t
+        encodeCharVector (StaticRangeCoder& entropyCoder_arg, const std::vector<char>& inputByteVector_arg,
+                          std::ostream& compressedTreeDataOut_arg) const;
+
+        /** \brief Entropy decode a char vector from binary stream
+         *  \param entropyCoder_arg: range coder instance
+         *  \param compressedTreeDataIn_arg: binary input stream
+         *  \param outputByteVector_arg: decoded data, needs to be resized to the amount of bytes to be decoded
+         *  \param compressedDataLen_arg: amount of bytes read from input stream is added to this counter
+         *  \return false if the input stream ends early or holds malformed data
+         * */
+        bool
+        decodeCharVector (StaticRangeCoder& entropyCoder_arg, std::istream& compressedTreeDataIn_arg,
+                          std::vector<char>& outputByteVector_arg, uint64_t& compressedDataLen_arg) const;
+
+        /** \brief Split the octree into subtrees, encode them in parallel and output them with a chunk index
+         *  \param compressedTreeDataOut_arg: binary output stream
+         * */
+        void
+        encodeChunks (std::ostream& compressedTreeDataOut_arg);
+
+        /** \brief Read the chunk index and decode all chunks overlapping a box in parallel
+         *  \param compressedTreeDataIn_arg: binary input stream
+         *  \param min_pt_arg: lower corner of the region of interest
+         *  \param max_pt_arg: upper corner of the region of interest
+         *  \return false if the chunk index or any selected chunk could not be decoded
+         * */
+        bool
+        decodeChunks (std::istream& compressedTreeDataIn_arg, const Eigen::Vector3f& min_pt_arg,
+                      const Eigen::Vector3f& max_pt_arg);
+
+        /** \brief Recursively output the binary description of the subtree spanned by a range of leaf keys
+         *  \param leafKeys_arg: leaf keys in depth-first order
+         *  \param begin_arg: first leaf of the subtree
+         *  \param end_arg: end of the leaf range
+         *  \param depthMask_arg: depth mask of the subtree root
+         *  \param binaryTreeOut_arg: binary output vector
+         * */
+        void
+        serializeChunkRecursive (const std::vector<OctreeKey>& leafKeys_arg, std::size_t begin_arg,
+                                 std::size_t end_arg, unsigned int depthMask_arg,
+                                 std::vector<char>& binaryTreeOut_arg) const;
+
+        /** \brief Recursively decode the binary description of a subtree to its leaf keys
+         *  \param binaryTreeIn_arg: iterator on binary input vector
+         *  \param key_arg: key of the subtree root
+         *  \param depthMask_arg: depth mask of the subtree root
+         *  \param leafKeys_arg: leaf keys in depth-first order
+         * */
+        void
+        deserializeChunkRecursive (std::vector<char>::const_iterator& binaryTreeIn_arg, const OctreeKey& key_arg,
+                                   unsigned int depthMask_arg, std::vector<OctreeKey>& leafKeys_arg) const;
+
+        /** \brief Encode the points of a single voxel
+         *  \param leafIdx_arg: indices of the points within the voxel
+         *  \param key_arg: octree key of the voxel
+         *  \param pointCoder_arg: point coder instance
+         *  \param colorCoder_arg: color coder instance
+         *  \param pointCountData_arg: vector receiving the amount of points per voxel
+         **/
+        void
+        encodeLeaf (const std::vector<int>& leafIdx_arg, const OctreeKey& key_arg, PointCoding<PointT>& pointCoder_arg,
+                    ColorCoding<PointT>& colorCoder_arg, std::vector<unsigned int>& pointCountData_arg) const;
+
+        /** \brief Decode the points of a single voxel and append them to a point cloud
+         *  \param key_arg: octree key of the voxel
+         *  \param pointCoder_arg: point coder instance
+         *  \param colorCoder_arg: color coder instance
+         *  \param pointCountIterator_arg: iterator on the amount of points per voxel
+         *  \param cloud_arg: point cloud to be extended
+         **/
+        void
+        decodeLeaf (const OctreeKey& key_arg, PointCoding<PointT>& pointCoder_arg, ColorCoding<PointT>& colorCoder_arg,
+                    std::vector<unsigned int>::const_iterator& pointCountIterator_arg, PointCloudPtr& cloud_arg) const;
+
+        /** \brief Count voxels that appeared or disappeared since the previous frame
+         *  \return voxel change rate (0..1)
+         * */
+        double
+        computeChangeRate ();
+
+        /** \brief Apply or revert the temporal difference of a voxel's point detail to the previous frame
+         *  \note Voxels have to be processed in depth-first order. Voxels that did not exist in the previous
+         *  frame or whose point count changed are left unchanged.
+         *  \param key_arg: octree key of the voxel
+         *  \param pointCount_arg: amount of points within the voxel
+         *  \param pointDiffData_arg: differential point information of the voxel
+         *  \param revert_arg: add (decoding) instead of subtract (encoding) the previous frame
+         * */
+        void
+        applyTemporalDelta (const OctreeKey& key_arg, std::size_t pointCount_arg, char* pointDiffData_arg,
+                            bool revert_arg);
+
+        /** \brief Make the current frame the reference for temporal coding of the next frame
+         *  \param pointDiffData_arg: differential point information of the current frame, swapped with the reference
+         * */
+        void
+        updateTemporalReference (std::vector<char>& pointDiffData_arg);
+
         /** \brief Encode leaf node information during serialization
          *  \param leaf_arg: reference to new leaf node
          *  \param key_arg: octree key of new leaf node
@@ -261,6 +503,47 @@ namespace pcl
         bool dataWithColor_;
         unsigned char pointColorOffset_;
 
+        /** \brief Octree depth at which frames are split into independently encoded subtrees, 0 = disabled */
+        unsigned int chunkDepth_;
+
+        /** \brief Flag indicating that the current frame was split into subtrees */
+        bool chunkedFrame_;
+
+        /** \brief Adaptive GOP mode: select I-frames by voxel change rate */
+        bool adaptiveGOP_;
+
+        /** \brief Voxel change rate above which an I-frame is encoded in adaptive GOP mode */
+        double iFrameChangeRate_;
+
+        /** \brief Encode point detail of P-frames relative to the previous frame */
+        bool temporalPointCoding_;
+
+        /** \brief Flag indicating that the point detail of the current frame is coded relative to the previous frame */
+        bool pointDeltaFrame_;
+
+        /** \brief Voxel keys of the current and the previous frame in depth-first order */
+        std::vector<OctreeKey> leafKeys_;
+        std::vector<OctreeKey> prevLeafKeys_;
+
+        /** \brief Offsets of the voxels' point detail within the previous frame's differential point information */
+        std::vector<std::size_t> prevLeafDiffOffset_;
+
+        /** \brief Differential point information of the previous frame */
+        std::vector<char> prevPointDiffData_;
+
+        /** \brief Position of the next voxel to be matched within the previous frame's voxel keys */
+        std::size_t prevLeafCursor_;
+
+        /** \brief Read position within the differential point information during decoding */
+        std::size_t pointDiffDecodePos_;
+
+        /** \brief Frame statistics */
+        double changeRate_;
+        uint64_t frameSize_;
+        uint64_t totalFrameSize_;
+        uint64_t codedFrameCount_;
+        double codingTime_;
+
         //bool activating statistics
         bool bShowStatistics;
         uint64_t compressedPointDataLen_;
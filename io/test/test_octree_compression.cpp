@@ -0,0 +1,295 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/compression/octree_pointcloud_compression.h>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+using namespace pcl;
+using namespace pcl::octree;
+
+typedef PointCloudCompression<PointXYZRGB> Compression;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+generateCloud (PointCloud<PointXYZRGB>::Ptr& cloud_arg, std::size_t pointCount_arg)
+{
+  cloud_arg.reset (new PointCloud<PointXYZRGB>);
+  cloud_arg->points.resize (pointCount_arg);
+  cloud_arg->width = pointCount_arg;
+  cloud_arg->height = 1;
+
+  for (std::size_t i = 0; i < pointCount_arg; i++)
+  {
+    PointXYZRGB& point = cloud_arg->points[i];
+    point.x = 2.0f * ((float)rand () / (float)RAND_MAX);
+    point.y = 2.0f * ((float)rand () / (float)RAND_MAX);
+    point.z = 2.0f * ((float)rand () / (float)RAND_MAX);
+    point.r = (uint8_t)(rand () % 256);
+    point.g = (uint8_t)(rand () % 256);
+    point.b = (uint8_t)(rand () % 256);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+expectEqualClouds (const PointCloud<PointXYZRGB>& a, const PointCloud<PointXYZRGB>& b)
+{
+  ASSERT_EQ (a.points.size (), b.points.size ());
+  for (std::size_t i = 0; i < a.points.size (); i++)
+  {
+    EXPECT_EQ (a.points[i].x, b.points[i].x);
+    EXPECT_EQ (a.points[i].y, b.points[i].y);
+    EXPECT_EQ (a.points[i].z, b.points[i].z);
+    EXPECT_EQ (a.points[i].rgba, b.points[i].rgba);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Chunked_Compression_Test)
+{
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  const compression_Profiles_e profiles[] = {MED_RES_ONLINE_COMPRESSION_WITH_COLOR,
+                                             LOW_RES_ONLINE_COMPRESSION_WITH_COLOR,
+                                             MED_RES_OFFLINE_COMPRESSION_WITHOUT_COLOR};
+
+  for (unsigned int p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++)
+  {
+    Compression encoder (profiles[p]);
+    Compression chunkedEncoder (profiles[p]);
+    Compression decoder (profiles[p]);
+    Compression chunkedDecoder (profiles[p]);
+
+    chunkedEncoder.setChunkDepth (2);
+    chunkedEncoder.setNumberOfThreads (4);
+    chunkedDecoder.setNumberOfThreads (4);
+
+    for (unsigned int frame = 0; frame < 4; frame++)
+    {
+      PointCloud<PointXYZRGB>::Ptr cloud;
+      generateCloud (cloud, 10000);
+
+      // the last frame is not chunked and must be decodable after chunked frames
+      if (frame == 3)
+        chunkedEncoder.setChunkDepth (0);
+
+      std::stringstream compressedData;
+      std::stringstream compressedChunkedData;
+      encoder.encodePointCloud (cloud, compressedData);
+      chunkedEncoder.encodePointCloud (cloud, compressedChunkedData);
+
+      PointCloud<PointXYZRGB>::Ptr decoded (new PointCloud<PointXYZRGB>);
+      PointCloud<PointXYZRGB>::Ptr decodedChunked (new PointCloud<PointXYZRGB>);
+      decoder.decodePointCloud (compressedData, decoded);
+      chunkedDecoder.decodePointCloud (compressedChunkedData, decodedChunked);
+
+      // chunked coding produces the same points in the same order
+      expectEqualClouds (*decoded, *decodedChunked);
+
+      if (frame < 3)
+      {
+        // region decoding returns at least all points within the region
+        const Eigen::Vector3f min_pt (0.2f, 0.3f, 0.4f);
+        const Eigen::Vector3f max_pt (0.7f, 0.9f, 1.0f);
+
+        compressedChunkedData.seekg (0);
+        PointCloud<PointXYZRGB>::Ptr region (new PointCloud<PointXYZRGB>);
+        Compression regionDecoder (profiles[p]);
+        regionDecoder.decodePointCloudRegion (compressedChunkedData, min_pt, max_pt, region);
+
+        std::size_t insideDecoded = 0;
+        std::size_t insideRegion = 0;
+        for (std::size_t i = 0; i < decoded->points.size (); i++)
+          if (decoded->points[i].getVector3fMap ().cwiseMax (min_pt) == decoded->points[i].getVector3fMap ()
+              && decoded->points[i].getVector3fMap ().cwiseMin (max_pt) == decoded->points[i].getVector3fMap ())
+            insideDecoded++;
+        for (std::size_t i = 0; i < region->points.size (); i++)
+          if (region->points[i].getVector3fMap ().cwiseMax (min_pt) == region->points[i].getVector3fMap ()
+              && region->points[i].getVector3fMap ().cwiseMin (max_pt) == region->points[i].getVector3fMap ())
+            insideRegion++;
+
+        EXPECT_GT (insideDecoded, 0u);
+        EXPECT_EQ (insideDecoded, insideRegion);
+        EXPECT_LT (region->points.size (), decoded->points.size ());
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Corrupted_Chunked_Compression_Test)
+{
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  PointCloud<PointXYZRGB>::Ptr cloud;
+  generateCloud (cloud, 10000);
+
+  Compression encoder (MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+  encoder.setChunkDepth (2);
+
+  std::stringstream compressedData;
+  encoder.encodePointCloud (cloud, compressedData);
+  const std::string data = compressedData.str ();
+
+  // intact frames decode successfully
+  {
+    std::istringstream input (data);
+    PointCloud<PointXYZRGB>::Ptr decoded (new PointCloud<PointXYZRGB>);
+    Compression decoder (MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+    EXPECT_TRUE (decoder.decodePointCloud (input, decoded));
+    EXPECT_EQ (decoded->points.size (), cloud->points.size ());
+  }
+
+  // truncated frames are reported and produce no points
+  {
+    std::istringstream input (data.substr (0, data.size () * 3 / 4));
+    PointCloud<PointXYZRGB>::Ptr decoded (new PointCloud<PointXYZRGB>);
+    Compression decoder (MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+    EXPECT_FALSE (decoder.decodePointCloud (input, decoded));
+    EXPECT_EQ (decoded->points.size (), 0u);
+  }
+
+  // zeroed chunk data is reported as well
+  {
+    std::string corrupted (data);
+    std::fill (corrupted.begin () + corrupted.size () / 2, corrupted.end (), 0);
+    std::istringstream input (corrupted);
+    PointCloud<PointXYZRGB>::Ptr decoded (new PointCloud<PointXYZRGB>);
+    Compression decoder (MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+    EXPECT_FALSE (decoder.decodePointCloud (input, decoded));
+    EXPECT_EQ (decoded->points.size (), 0u);
+  }
+
+  // truncated frames without chunks are reported too
+  {
+    Compression streamEncoder (MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+    std::stringstream streamData;
+    streamEncoder.encodePointCloud (cloud, streamData);
+    const std::string stream = streamData.str ();
+
+    std::istringstream input (stream.substr (0, stream.size () * 3 / 4));
+    PointCloud<PointXYZRGB>::Ptr decoded (new PointCloud<PointXYZRGB>);
+    Compression decoder (MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+    EXPECT_FALSE (decoder.decodePointCloud (input, decoded));
+    EXPECT_EQ (decoded->points.size (), 0u);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Temporal_Compression_Test)
+{
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  const compression_Profiles_e profiles[] = {LOW_RES_ONLINE_COMPRESSION_WITH_COLOR,
+                                             MED_RES_ONLINE_COMPRESSION_WITH_COLOR,
+                                             HIGH_RES_OFFLINE_COMPRESSION_WITH_COLOR};
+
+  for (unsigned int p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++)
+  {
+    const bool voxelGrid = (profiles[p] == LOW_RES_ONLINE_COMPRESSION_WITH_COLOR);
+
+    Compression encoder (profiles[p]);
+    Compression temporalEncoder (profiles[p]);
+    Compression decoder (profiles[p]);
+    Compression temporalDecoder (profiles[p]);
+
+    temporalEncoder.setAdaptiveGOP (true, 0.5);
+    temporalEncoder.setTemporalPointCoding (true);
+
+    PointCloud<PointXYZRGB>::Ptr staticCloud;
+    generateCloud (staticCloud, 10000);
+
+    for (unsigned int frame = 0; frame < 6; frame++)
+    {
+      PointCloud<PointXYZRGB>::Ptr cloud (new PointCloud<PointXYZRGB> (*staticCloud));
+
+      // frames 3 and 4 move points slightly, frame 5 shows an entirely new scene
+      if ((frame == 3) || (frame == 4))
+      {
+        for (std::size_t i = 0; i < cloud->points.size (); i++)
+          cloud->points[i].x += 0.0001f * ((float)rand () / (float)RAND_MAX - 0.5f);
+      }
+      else if (frame == 5)
+        generateCloud (cloud, 10000);
+
+      std::stringstream compressedData;
+      std::stringstream compressedTemporalData;
+      encoder.encodePointCloud (cloud, compressedData);
+      temporalEncoder.encodePointCloud (cloud, compressedTemporalData);
+
+      PointCloud<PointXYZRGB>::Ptr decoded (new PointCloud<PointXYZRGB>);
+      PointCloud<PointXYZRGB>::Ptr decodedTemporal (new PointCloud<PointXYZRGB>);
+      decoder.decodePointCloud (compressedData, decoded);
+      temporalDecoder.decodePointCloud (compressedTemporalData, decodedTemporal);
+
+      // temporal coding is lossless with respect to the regular point detail coding
+      expectEqualClouds (*decoded, *decodedTemporal);
+
+      if ((frame == 1) || (frame == 2))
+      {
+        EXPECT_EQ (temporalEncoder.getChangeRate (), 0.0);
+
+        // unchanged point detail is coded as zero deltas
+        if (!voxelGrid)
+        {
+          EXPECT_LT (temporalEncoder.getFrameSize (), encoder.getFrameSize ());
+        }
+      }
+      else if (frame == 5)
+      {
+        EXPECT_GT (temporalEncoder.getChangeRate (), 0.5);
+      }
+    }
+
+    EXPECT_GT (temporalEncoder.getAverageFrameSize (), 0.0);
+    EXPECT_GE (temporalEncoder.getCodingTime (), 0.0);
+  }
+}
+
+/* ---[ */
+int
+  main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -168,7 +168,62 @@ TEST (PCL, Static_Range_Coder_Test)
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Buffer_Range_Coder_Test)
+{
+  size_t i, t;
+
+  // empty, tiny, skewed, single symbol and incompressible input
+  const size_t vectorSizes[] = {0, 1, 3, 1001, 1000, 100003};
+
+  pcl::StaticRangeCoder rangeCoder;
 
+  for (t = 0; t < sizeof(vectorSizes) / sizeof(vectorSizes[0]); t++)
+  {
+    const size_t vectorSize = vectorSizes[t];
+    std::vector<char> inputData (vectorSize);
+    std::vector<char> outputData (vectorSize + 1, 0);
+
+    for (i = 0; i < vectorSize; i++)
+    {
+      if (t == 3)
+        inputData[i] = 42;
+      else if (t == 4)
+        inputData[i] = (char)rand() & 0xFF;
+      else
+        inputData[i] = (char)((rand() % 5) * (rand() % 3));
+    }
+
+    std::vector<char> encodedData (pcl::StaticRangeCoder::getMaxEncodedBufferSize (vectorSize));
+
+    // encode to preallocated memory
+    size_t writeByteLen = rangeCoder.encodeCharBuffer (vectorSize ? &inputData[0] : 0, vectorSize,
+                                                       &encodedData[0], encodedData.size ());
+    EXPECT_GT (writeByteLen, 0u);
+    EXPECT_LE (writeByteLen, encodedData.size ());
+
+    if (t == 5)
+    {
+      EXPECT_LT (writeByteLen, vectorSize / 2);
+    }
+
+    // decode and compare
+    size_t readByteLen = rangeCoder.decodeCharBuffer (&encodedData[0], writeByteLen, &outputData[0], vectorSize);
+    EXPECT_EQ (writeByteLen, readByteLen);
+
+    for (i = 0; i < vectorSize; i++)
+    {
+      EXPECT_EQ (inputData[i], outputData[i]);
+    }
+    EXPECT_EQ (0, outputData[vectorSize]);
+
+    // insufficient output memory is reported
+    if (vectorSize > 0)
+    {
+      EXPECT_EQ (0u, rangeCoder.encodeCharBuffer (&inputData[0], vectorSize, &encodedData[0], 0));
+    }
+  }
+}
 
 /* ---[ */
 int
@@ -180,6 +180,35 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
   return (neighbors_in_radius);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int 
+pcl::KdTreeFLANN<PointT, Dist>::radiusCount (const PointT &point, double radius, unsigned int max_nn) const
+{
+  assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to radiusCount!");
+
+  std::vector<float> query (dim_);
+  point_representation_->vectorize ((PointT)point, query);
+
+  // A bound that all points satisfy needs no storage
+  if (max_nn >= (unsigned int)total_nr_points_)
+    max_nn = 0;
+
+  // Without output columns FLANN only counts the neighbors. With max_nn columns it keeps the
+  // max_nn nearest ones and narrows the search radius once it has found that many.
+  std::vector<int> indices (max_nn);
+  std::vector<float> dists (max_nn);
+  flann::Matrix<int> indices_mat (max_nn ? &indices[0] : NULL, 1, max_nn);
+  flann::Matrix<float> dists_mat (max_nn ? &dists[0] : NULL, 1, max_nn);
+  int neighbors_in_radius = flann_index_->radiusSearch (flann::Matrix<float> (&query[0], 1, dim_),
+                                                        indices_mat,
+                                                        dists_mat,
+                                                        radius * radius, 
+                                                        param_radius_);
+  if (max_nn != 0)
+    neighbors_in_radius = std::min (neighbors_in_radius, (int)max_nn);
+  return (neighbors_in_radius);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> void 
 pcl::KdTreeFLANN<PointT, Dist>::cleanup ()
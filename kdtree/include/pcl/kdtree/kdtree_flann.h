@@ -157,6 +157,17 @@ namespace pcl
       radiusSearch (const PointT &point, double radius, std::vector<int> &k_indices,
                     std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
 
+      /** \brief Count the nearest neighbors of the query point in a given radius, without returning them.
+        * 
+        * \param[in] point a given \a valid (i.e., finite) query point
+        * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+        * \param[in] max_nn if non-zero, bounds the count to this value. The search then narrows its radius
+        * once it has found \a max_nn neighbors, which visits fewer nodes than counting all of them.
+        * \return number of neighbors found in radius, at most \a max_nn if it is non-zero
+        */
+      int 
+      radiusCount (const PointT &point, double radius, unsigned int max_nn = 0) const;
+
     private:
       /** \brief Internal cleanup method. */
       void 
@@ -47,11 +47,11 @@ namespace pcl
     using namespace std;
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
-    Octree2BufBase<DataT, LeafT>::Octree2BufBase ()
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
+    Octree2BufBase<DataT, LeafT, NodePoolT>::Octree2BufBase ()
     {
       // Initialization of globals
-      rootNode_ = new OctreeBranch ();
+      createBranch (rootNode_);
       leafCount_ = 0;
       branchCount_ = 1;
       objectCount_ = 0;
@@ -63,19 +63,17 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
-    Octree2BufBase<DataT, LeafT>::~Octree2BufBase ()
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
+    Octree2BufBase<DataT, LeafT, NodePoolT>::~Octree2BufBase ()
     {
-      // deallocate tree structure
-      deleteTree ();
-      delete (rootNode_);
+      // deallocate tree structure - all nodes including the root node are owned by the node pools
       poolCleanUp ();
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::setMaxVoxelIndex (unsigned int maxVoxelIndex_arg)
+    Octree2BufBase<DataT, LeafT, NodePoolT>::setMaxVoxelIndex (unsigned int maxVoxelIndex_arg)
     {
       unsigned int treeDepth;
 
@@ -91,9 +89,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::setTreeDepth (unsigned int depth_arg)
+    Octree2BufBase<DataT, LeafT, NodePoolT>::setTreeDepth (unsigned int depth_arg)
     {
       assert (depth_arg > 0);
 
@@ -105,9 +103,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::add (const unsigned int idxX_arg, const unsigned int idxY_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::add (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                        const unsigned int idxZ_arg, const DataT& data_arg)
     {
       OctreeKey key;
@@ -122,9 +120,21 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
+    void
+    Octree2BufBase<DataT, LeafT, NodePoolT>::add (const std::vector<OctreeKey>& key_vector_arg,
+                                       const std::vector<DataT>& data_vector_arg)
+    {
+      assert (key_vector_arg.size () == data_vector_arg.size ());
+
+      for (size_t i = 0; i < key_vector_arg.size (); i++)
+        add (key_vector_arg[i], data_vector_arg[i]);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     bool
-    Octree2BufBase<DataT, LeafT>::get (const unsigned int idxX_arg, const unsigned int idxY_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::get (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                        const unsigned int idxZ_arg, DataT& data_arg) const
     {
       OctreeKey key;
@@ -147,9 +157,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     bool
-    Octree2BufBase<DataT, LeafT>::existLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::existLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                              const unsigned int idxZ_arg) const
     {
       OctreeKey key;
@@ -162,9 +172,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::removeLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::removeLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                               const unsigned int idxZ_arg)
     {
       OctreeKey key;
@@ -177,14 +187,15 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deleteTree ( bool freeMemory_arg )
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deleteTree ( bool freeMemory_arg )
     {
       if (rootNode_)
       {
-        // reset octree
-        deleteBranch (*rootNode_);
+        // reset octree - all nodes of both buffers including the root node are owned by the node pools
+        branchPool_.releaseAll ();
+        leafPool_.releaseAll ();
         leafCount_ = 0;
         branchCount_ = 1;
         objectCount_ = 0;
@@ -198,12 +209,14 @@ namespace pcl
       // delete node pool
       if (freeMemory_arg)
         poolCleanUp ();
+
+      createBranch (rootNode_);
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::switchBuffers ()
+    Octree2BufBase<DataT, LeafT, NodePoolT>::switchBuffers ()
     {
       if (treeDirtyFlag_)
       {
@@ -223,9 +236,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeTree (std::vector<char>& binaryTreeOut_arg, bool doXOREncoding_arg)
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeTree (std::vector<char>& binaryTreeOut_arg, bool doXOREncoding_arg)
     {
       OctreeKey newKey;
       newKey.x = newKey.y = newKey.z = 0;
@@ -241,9 +254,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeTree (std::vector<char>& binaryTreeOut_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeTree (std::vector<char>& binaryTreeOut_arg,
                                                  std::vector<DataT>& dataVector_arg, bool doXOREncoding_arg)
     {
       OctreeKey newKey;
@@ -256,7 +269,7 @@ namespace pcl
       dataVector_arg.reserve (objectCount_);
       binaryTreeOut_arg.reserve (this->branchCount_);
 
-      Octree2BufBase<DataT, LeafT>::serializeTreeRecursive (binaryTreeOut_arg, rootNode_, newKey,
+      Octree2BufBase<DataT, LeafT, NodePoolT>::serializeTreeRecursive (binaryTreeOut_arg, rootNode_, newKey,
                                                             dataVector_arg, doXOREncoding_arg);
 
       // serializeTreeRecursive cleans-up unused octree nodes in previous octree
@@ -264,9 +277,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeLeafs (std::vector<DataT>& dataVector_arg)
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeLeafs (std::vector<DataT>& dataVector_arg)
     {
       OctreeKey newKey;
       newKey.x = newKey.y = newKey.z = 0;
@@ -283,9 +296,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deserializeTree (std::vector<char>& binaryTreeIn_arg, bool doXORDecoding_arg)
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deserializeTree (std::vector<char>& binaryTreeIn_arg, bool doXORDecoding_arg)
     {
       OctreeKey newKey;
       newKey.x = newKey.y = newKey.z = 0;
@@ -306,9 +319,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deserializeTree (std::vector<char>& binaryTreeIn_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deserializeTree (std::vector<char>& binaryTreeIn_arg,
                                                    std::vector<DataT>& dataVector_arg, bool doXORDecoding_arg)
     {
       OctreeKey newKey;
@@ -337,9 +350,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deserializeTreeAndOutputLeafData (std::vector<char>& binaryTreeIn_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deserializeTreeAndOutputLeafData (std::vector<char>& binaryTreeIn_arg,
                                                                     std::vector<DataT>& dataVector_arg,
                                                                     bool doXORDecoding_arg)
     {
@@ -363,9 +376,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeNewLeafs (std::vector<DataT>& dataVector_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeNewLeafs (std::vector<DataT>& dataVector_arg,
                                                      const int minPointsPerLeaf_arg)
     {
       OctreeKey newKey;
@@ -383,9 +396,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     LeafT*
-    Octree2BufBase<DataT, LeafT>::getLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::getLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
                                                     OctreeBranch* branch_arg, bool branchReset_arg)
     {
       // index to branch child
@@ -495,9 +508,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     LeafT*
-    Octree2BufBase<DataT, LeafT>::findLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::findLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
                                                      OctreeBranch* branch_arg) const
     {
       // return leaf node
@@ -535,9 +548,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     bool
-    Octree2BufBase<DataT, LeafT>::deleteLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deleteLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
                                                        OctreeBranch* branch_arg)
     {
       // index to branch child
@@ -593,9 +606,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
                                                           OctreeBranch* branch_arg, const OctreeKey& key_arg,
                                                           bool doXOREncoding_arg)
     {
@@ -672,9 +685,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
                                                           OctreeBranch* branch_arg, const OctreeKey& key_arg,
                                                           typename std::vector<DataT>& dataVector_arg,
                                                           bool doXOREncoding_arg)
@@ -754,9 +767,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeLeafsRecursive (OctreeBranch* branch_arg, const OctreeKey& key_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeLeafsRecursive (OctreeBranch* branch_arg, const OctreeKey& key_arg,
                                                            typename std::vector<DataT>& dataVector_arg)
     {
       // child iterator
@@ -819,9 +832,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeNewLeafsRecursive (OctreeBranch* branch_arg, const OctreeKey& key_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeNewLeafsRecursive (OctreeBranch* branch_arg, const OctreeKey& key_arg,
                                                               std::vector<DataT>& dataVector_arg,
                                                               const int minPointsPerLeaf_arg)
     {
@@ -890,9 +903,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deserializeTreeRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deserializeTreeRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
                                                             OctreeBranch* branch_arg,
                                                             const unsigned int depthMask_arg,
                                                             const OctreeKey& key_arg, bool branchReset_arg,
@@ -1023,9 +1036,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deserializeTreeRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deserializeTreeRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
                                                             OctreeBranch* branch_arg,
                                                             const unsigned int depthMask_arg,
                                                             const OctreeKey& key_arg,
@@ -1160,9 +1173,9 @@ namespace pcl
     }
     
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deserializeTreeAndOutputLeafDataRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deserializeTreeAndOutputLeafDataRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
                                                                              OctreeBranch* branch_arg,
                                                                              const unsigned int depthMask_arg,
                                                                              const OctreeKey& key_arg,
@@ -1295,26 +1308,26 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
     {
       // nothing to do
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg,
                                                          std::vector<DataT>& dataVector_arg)
     {
       leaf_arg.getData (dataVector_arg);
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::serializeNewLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::serializeNewLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg,
                                                             const int minPointsPerLeaf_arg,
                                                             std::vector<DataT>& dataVector_arg)
     {
@@ -1340,9 +1353,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deserializeLeafCallback (
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deserializeLeafCallback (
                                                            OctreeLeaf& leaf_arg,
                                                            const OctreeKey& key_arg,
                                                            typename std::vector<DataT>::const_iterator& dataVectorIterator_arg,
@@ -1369,9 +1382,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deserializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deserializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
     {
 
       DataT newDataT;
@@ -1384,9 +1397,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::deserializeTreeAndSerializeLeafCallback (OctreeLeaf& leaf_arg,
+    Octree2BufBase<DataT, LeafT, NodePoolT>::deserializeTreeAndSerializeLeafCallback (OctreeLeaf& leaf_arg,
                                                                            const OctreeKey& key_arg,
                                                                            std::vector<DataT>& dataVector_arg)
     {
@@ -1402,9 +1415,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    Octree2BufBase<DataT, LeafT>::treeCleanUpRecursive (OctreeBranch* branch_arg)
+    Octree2BufBase<DataT, LeafT, NodePoolT>::treeCleanUpRecursive (OctreeBranch* branch_arg)
     {
 
       // child iterator
@@ -53,12 +53,12 @@ namespace pcl
     using namespace std;
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
-      OctreeBase<DataT, LeafT, BranchT>::OctreeBase ()
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::OctreeBase ()
       {
 
         // Initialization of globals
-        rootNode_ = new OctreeBranch ();
+        createBranch (rootNode_);
         leafCount_ = 0;
         depthMask_ = 0;
         branchCount_ = 1;
@@ -68,20 +68,18 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
-      OctreeBase<DataT, LeafT, BranchT>::~OctreeBase ()
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::~OctreeBase ()
       {
 
-        // deallocate tree structure
-        deleteTree ();
-        delete (rootNode_);
+        // deallocate tree structure - all nodes including the root node are owned by the node pools
         poolCleanUp ();
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::setMaxVoxelIndex (unsigned int maxVoxelIndex_arg)
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::setMaxVoxelIndex (unsigned int maxVoxelIndex_arg)
       {
         unsigned int treeDepth;
 
@@ -97,9 +95,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::setTreeDepth (unsigned int depth_arg)
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::setTreeDepth (unsigned int depth_arg)
       {
 
         assert (depth_arg>0);
@@ -113,9 +111,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::add (const unsigned int idxX_arg, const unsigned int idxY_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::add (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                      const unsigned int idxZ_arg, const DataT& data_arg)
       {
 
@@ -134,9 +132,87 @@ namespace pcl
 
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
+      void
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::add (const std::vector<OctreeKey>& key_vector_arg,
+                                              const std::vector<DataT>& data_vector_arg)
+      {
+        size_t i;
+
+        assert (key_vector_arg.size () == data_vector_arg.size ());
+
+        // bottom-up construction requires an empty octree and keys in depth-first (Morton) order
+        bool bulkBuild = (leafCount_ == 0) && (octreeDepth_ > 0) && (getBranchBitPattern (*rootNode_) == 0);
+        for (i = 1; bulkBuild && (i < key_vector_arg.size ()); i++)
+          bulkBuild = !octreeKeyMortonLess (key_vector_arg[i], key_vector_arg[i - 1]);
+
+        if (!bulkBuild)
+        {
+          for (i = 0; i < key_vector_arg.size (); i++)
+            add (key_vector_arg[i], data_vector_arg[i]);
+          return;
+        }
+
+        // branch nodes along the path to the current leaf, indexed by tree depth
+        std::vector<OctreeBranch*> branchPath (octreeDepth_);
+        branchPath[0] = rootNode_;
+
+        LeafT* leaf = 0;
+
+        for (i = 0; i < key_vector_arg.size (); i++)
+        {
+          const OctreeKey& key = key_vector_arg[i];
+
+          // first tree depth at which the path to this key leaves the path to the previous key
+          unsigned int depth = 0;
+          if (leaf)
+          {
+            const OctreeKey& prevKey = key_vector_arg[i - 1];
+            unsigned int keyDiff = (key.x ^ prevKey.x) | (key.y ^ prevKey.y) | (key.z ^ prevKey.z);
+
+            if (keyDiff)
+            {
+              depth = octreeDepth_;
+              while (keyDiff)
+              {
+                keyDiff >>= 1;
+                depth--;
+              }
+            }
+            else
+            {
+              // same voxel as previous key
+              leaf->setData (data_vector_arg[i]);
+              objectCount_++;
+              continue;
+            }
+          }
+
+          // keys are sorted, so all nodes below the diverging depth are new
+          unsigned int depthMask = depthMask_ >> depth;
+          for (; depth < octreeDepth_ - 1; depth++, depthMask >>= 1)
+          {
+            unsigned char childIdx = ((!!(key.x & depthMask)) << 2) | ((!!(key.y & depthMask)) << 1)
+                | (!!(key.z & depthMask));
+
+            createBranchChild (*branchPath[depth], childIdx, branchPath[depth + 1]);
+            branchCount_++;
+          }
+
+          unsigned char childIdx = ((!!(key.x & 1)) << 2) | ((!!(key.y & 1)) << 1) | (!!(key.z & 1));
+
+          createLeafChild (*branchPath[octreeDepth_ - 1], childIdx, leaf);
+          leafCount_++;
+
+          leaf->setData (data_vector_arg[i]);
+          objectCount_++;
+        }
+      }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       bool
-      OctreeBase<DataT, LeafT, BranchT>::get (const unsigned int idxX_arg, const unsigned int idxY_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::get (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                      const unsigned int idxZ_arg, DataT& data_arg) const
       {
         OctreeKey key;
@@ -160,9 +236,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       bool
-      OctreeBase<DataT, LeafT, BranchT>::existLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::existLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                            const unsigned int idxZ_arg) const
       {
         OctreeKey key;
@@ -175,9 +251,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::removeLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::removeLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                             const unsigned int idxZ_arg)
       {
         OctreeKey key;
@@ -190,15 +266,16 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deleteTree (  bool freeMemory_arg )
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deleteTree (  bool freeMemory_arg )
       {
 
         if (rootNode_)
         {
-          // reset octree
-          deleteBranch (*rootNode_);
+          // reset octree - all nodes including the root node are owned by the node pools
+          branchPool_.releaseAll ();
+          leafPool_.releaseAll ();
           leafCount_ = 0;
           branchCount_ = 1;
           objectCount_ = 0;
@@ -209,12 +286,14 @@ namespace pcl
         if (freeMemory_arg)
           poolCleanUp ();
 
+        createBranch (rootNode_);
+
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::serializeTree (std::vector<char>& binaryTreeOut_arg)
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::serializeTree (std::vector<char>& binaryTreeOut_arg)
       {
         OctreeKey newKey;
         newKey.x = newKey.y = newKey.z = 0;
@@ -227,9 +306,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::serializeTree (std::vector<char>& binaryTreeOut_arg, std::vector<DataT>& dataVector_arg)
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::serializeTree (std::vector<char>& binaryTreeOut_arg, std::vector<DataT>& dataVector_arg)
       {
         OctreeKey newKey;
         newKey.x = newKey.y = newKey.z = 0;
@@ -241,13 +320,13 @@ namespace pcl
         dataVector_arg.reserve (this->objectCount_);
         binaryTreeOut_arg.reserve (this->branchCount_);
 
-        OctreeBase<DataT, LeafT, BranchT>::serializeTreeRecursive (binaryTreeOut_arg, rootNode_, newKey, dataVector_arg);
+        OctreeBase<DataT, LeafT, BranchT, NodePoolT>::serializeTreeRecursive (binaryTreeOut_arg, rootNode_, newKey, dataVector_arg);
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::serializeLeafs (std::vector<DataT>& dataVector_arg)
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::serializeLeafs (std::vector<DataT>& dataVector_arg)
       {
 
         OctreeKey newKey;
@@ -262,9 +341,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deserializeTree (std::vector<char>& binaryTreeIn_arg)
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deserializeTree (std::vector<char>& binaryTreeIn_arg)
       {
 
         OctreeKey newKey;
@@ -282,9 +361,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deserializeTree (std::vector<char>& binaryTreeIn_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deserializeTree (std::vector<char>& binaryTreeIn_arg,
                                                  std::vector<DataT>& dataVector_arg)
       {
         OctreeKey newKey;
@@ -309,9 +388,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deserializeTreeAndOutputLeafData (std::vector<char>& binaryTreeIn_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deserializeTreeAndOutputLeafData (std::vector<char>& binaryTreeIn_arg,
                                                                   std::vector<DataT>& dataVector_arg)
       {
 
@@ -331,9 +410,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       LeafT*
-      OctreeBase<DataT, LeafT, BranchT>::getLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::getLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
                                                   OctreeBranch* branch_arg)
       {
 
@@ -404,9 +483,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       LeafT*
-      OctreeBase<DataT, LeafT, BranchT>::findLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::findLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
                                                    OctreeBranch* branch_arg) const
       {
         // index to branch child
@@ -446,9 +525,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       bool
-      OctreeBase<DataT, LeafT, BranchT>::deleteLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deleteLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
                                                      OctreeBranch* branch_arg)
       {
         // index to branch child
@@ -477,8 +556,8 @@ namespace pcl
 
             if (!bBranchOccupied)
             {
-              // child branch does not own any sub-child nodes anymore -> delete child branch
-              delete (childBranch);
+              // child branch does not own any sub-child nodes anymore -> return it to the branch pool
+              branchPool_.release (childBranch);
               setBranchChild (*branch_arg, childIdx, 0);
               branchCount_--;
             }
@@ -508,9 +587,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
                                                         const OctreeBranch* branch_arg, const OctreeKey& key_arg)
       {
 
@@ -567,9 +646,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
                                                         const OctreeBranch* branch_arg, const OctreeKey& key_arg,
                                                         typename std::vector<DataT>& dataVector_arg)
       {
@@ -627,9 +706,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::serializeLeafsRecursive (const OctreeBranch* branch_arg, const OctreeKey& key_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::serializeLeafsRecursive (const OctreeBranch* branch_arg, const OctreeKey& key_arg,
                                                          std::vector<DataT>& dataVector_arg)
       {
         // child iterator
@@ -676,9 +755,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deserializeTreeRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deserializeTreeRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
                                                           OctreeBranch* branch_arg, const unsigned int depthMask_arg,
                                                           const OctreeKey& key_arg)
       {
@@ -736,9 +815,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deserializeTreeRecursive (
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deserializeTreeRecursive (
                                                           typename std::vector<char>::const_iterator& binaryTreeIn_arg,
                                                           OctreeBranch* branch_arg,
                                                           const unsigned int depthMask_arg,
@@ -800,9 +879,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deserializeTreeAndOutputLeafDataRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deserializeTreeAndOutputLeafDataRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
                                                                            OctreeBranch* branch_arg,
                                                                            const unsigned int depthMask_arg,
                                                                            const OctreeKey& key_arg,
@@ -863,27 +942,27 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
       {
         // nothing to do
       }
 
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg,
                                                        std::vector<DataT>& dataVector_arg)
       {
         leaf_arg.getData (dataVector_arg);
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deserializeLeafCallback (
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deserializeLeafCallback (
                                                          OctreeLeaf& leaf_arg,
                                                          const OctreeKey& key_arg,
                                                          typename std::vector<DataT>::const_iterator& dataVectorIterator_arg,
@@ -910,9 +989,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deserializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deserializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
       {
 
         DataT newDataT;
@@ -926,9 +1005,9 @@ namespace pcl
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT, typename BranchT>
+    template<typename DataT, typename LeafT, typename BranchT, template<typename > class NodePoolT>
       void
-      OctreeBase<DataT, LeafT, BranchT>::deserializeTreeAndSerializeLeafCallback (OctreeLeaf& leaf_arg,
+      OctreeBase<DataT, LeafT, BranchT, NodePoolT>::deserializeTreeAndSerializeLeafCallback (OctreeLeaf& leaf_arg,
                                                                          const OctreeKey& key_arg,
                                                                          std::vector<DataT>& dataVector_arg)
       {
@@ -53,12 +53,12 @@ namespace pcl
     using namespace std;
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
-    OctreeLowMemBase<DataT, LeafT>::OctreeLowMemBase ()
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::OctreeLowMemBase ()
     {
 
       // Initialization of globals
-      rootNode_ = new OctreeBranch ();
+      createBranch (rootNode_);
       leafCount_ = 0;
       depthMask_ = 0;
       branchCount_ = 1;
@@ -68,19 +68,19 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
-    OctreeLowMemBase<DataT, LeafT>::~OctreeLowMemBase ()
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::~OctreeLowMemBase ()
     {
 
-      // deallocate tree structure
-      deleteTree ();
-      delete (rootNode_);
+      // deallocate tree structure - the root node is owned by the branch node pool
+      deleteBranch (*rootNode_);
+      poolCleanUp ();
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::setMaxVoxelIndex (unsigned int maxVoxelIndex_arg)
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::setMaxVoxelIndex (unsigned int maxVoxelIndex_arg)
     {
       unsigned int treeDepth;
 
@@ -96,9 +96,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::setTreeDepth (unsigned int depth_arg)
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::setTreeDepth (unsigned int depth_arg)
     {
 
       assert (depth_arg>0);
@@ -112,9 +112,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::add (const unsigned int idxX_arg, const unsigned int idxY_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::add (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                          const unsigned int idxZ_arg, const DataT& data_arg)
     {
 
@@ -133,9 +133,21 @@ namespace pcl
 
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
+    void
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::add (const std::vector<OctreeKey>& key_vector_arg,
+                                         const std::vector<DataT>& data_vector_arg)
+    {
+      assert (key_vector_arg.size () == data_vector_arg.size ());
+
+      for (size_t i = 0; i < key_vector_arg.size (); i++)
+        add (key_vector_arg[i], data_vector_arg[i]);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     bool
-    OctreeLowMemBase<DataT, LeafT>::get (const unsigned int idxX_arg, const unsigned int idxY_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::get (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                          const unsigned int idxZ_arg, DataT& data_arg) const
     {
       OctreeKey key;
@@ -159,9 +171,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     bool
-    OctreeLowMemBase<DataT, LeafT>::existLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::existLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                                const unsigned int idxZ_arg) const
     {
       OctreeKey key;
@@ -174,9 +186,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::removeLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::removeLeaf (const unsigned int idxX_arg, const unsigned int idxY_arg,
                                                 const unsigned int idxZ_arg)
     {
       OctreeKey key;
@@ -189,14 +201,14 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deleteTree ( )
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deleteTree (bool freeMemory_arg)
     {
 
       if (rootNode_)
       {
-        // reset octree
+        // reset octree, child pointer arrays of the branches are freed on the way
         deleteBranch (*rootNode_);
         leafCount_ = 0;
         branchCount_ = 1;
@@ -204,12 +216,20 @@ namespace pcl
 
       }
 
+      // delete node pool
+      if (freeMemory_arg)
+      {
+        deleteBranch (*rootNode_);
+        poolCleanUp ();
+        createBranch (rootNode_);
+      }
+
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::serializeTree (std::vector<char>& binaryTreeOut_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::serializeTree (std::vector<char>& binaryTreeOut_arg,
                                                    bool doXOREncoding_arg)
     {
       OctreeKey newKey;
@@ -223,9 +243,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::serializeTree (std::vector<char>& binaryTreeOut_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::serializeTree (std::vector<char>& binaryTreeOut_arg,
                                                    std::vector<DataT>& dataVector_arg, bool doXOREncoding_arg)
     {
       OctreeKey newKey;
@@ -238,13 +258,13 @@ namespace pcl
       dataVector_arg.reserve (this->objectCount_);
       binaryTreeOut_arg.reserve (this->branchCount_);
 
-      OctreeLowMemBase<DataT, LeafT>::serializeTreeRecursive (binaryTreeOut_arg, rootNode_, newKey, dataVector_arg);
+      OctreeLowMemBase<DataT, LeafT, NodePoolT>::serializeTreeRecursive (binaryTreeOut_arg, rootNode_, newKey, dataVector_arg);
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::serializeLeafs (std::vector<DataT>& dataVector_arg)
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::serializeLeafs (std::vector<DataT>& dataVector_arg)
     {
 
       OctreeKey newKey;
@@ -259,9 +279,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deserializeTree (std::vector<char>& binaryTreeIn_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deserializeTree (std::vector<char>& binaryTreeIn_arg,
                                                      bool doXORDecoding_arg)
     {
 
@@ -280,9 +300,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deserializeTree (std::vector<char>& binaryTreeIn_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deserializeTree (std::vector<char>& binaryTreeIn_arg,
                                                      std::vector<DataT>& dataVector_arg,
                                                      bool doXORDecoding_arg)
     {
@@ -308,9 +328,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deserializeTreeAndOutputLeafData (std::vector<char>& binaryTreeIn_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deserializeTreeAndOutputLeafData (std::vector<char>& binaryTreeIn_arg,
                                                                       std::vector<DataT>& dataVector_arg)
     {
 
@@ -330,9 +350,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     LeafT*
-    OctreeLowMemBase<DataT, LeafT>::getLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::getLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
                                                       OctreeBranch* branch_arg)
     {
 
@@ -403,9 +423,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     LeafT*
-    OctreeLowMemBase<DataT, LeafT>::findLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::findLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
                                                        OctreeBranch* branch_arg) const
     {
       // index to branch child
@@ -445,9 +465,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     bool
-    OctreeLowMemBase<DataT, LeafT>::deleteLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deleteLeafRecursive (const OctreeKey& key_arg, const unsigned int depthMask_arg,
                                                          OctreeBranch* branch_arg)
     {
       // index to branch child
@@ -477,7 +497,7 @@ namespace pcl
           if (!bBranchOccupied)
           {
             // child branch does not own any sub-child nodes anymore -> delete child branch
-            delete (childBranch);
+            branchPool_.release (childBranch);
             setBranchChild (*branch_arg, childIdx, 0);
             branchCount_--;
           }
@@ -507,9 +527,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
                                                             const OctreeBranch* branch_arg, const OctreeKey& key_arg)
     {
 
@@ -563,9 +583,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::serializeTreeRecursive (std::vector<char>& binaryTreeOut_arg,
                                                             const OctreeBranch* branch_arg, const OctreeKey& key_arg,
                                                             typename std::vector<DataT>& dataVector_arg)
     {
@@ -622,9 +642,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::serializeLeafsRecursive (const OctreeBranch* branch_arg, const OctreeKey& key_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::serializeLeafsRecursive (const OctreeBranch* branch_arg, const OctreeKey& key_arg,
                                                              std::vector<DataT>& dataVector_arg)
     {
       // child iterator
@@ -671,9 +691,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deserializeTreeRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deserializeTreeRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
                                                               OctreeBranch* branch_arg, const unsigned int depthMask_arg,
                                                               const OctreeKey& key_arg)
     {
@@ -731,9 +751,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deserializeTreeRecursive (
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deserializeTreeRecursive (
       typename std::vector<char>::const_iterator& binaryTreeIn_arg,
       OctreeBranch* branch_arg,
       const unsigned int depthMask_arg,
@@ -795,9 +815,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deserializeTreeAndOutputLeafDataRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deserializeTreeAndOutputLeafDataRecursive (typename std::vector<char>::const_iterator& binaryTreeIn_arg,
                                                                                OctreeBranch* branch_arg,
                                                                                const unsigned int depthMask_arg,
                                                                                const OctreeKey& key_arg,
@@ -858,27 +878,27 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
     {
       // nothing to do
     }
 
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::serializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg,
                                                            std::vector<DataT>& dataVector_arg)
     {
       leaf_arg.getData (dataVector_arg);
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deserializeLeafCallback (
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deserializeLeafCallback (
       OctreeLeaf& leaf_arg,
       const OctreeKey& key_arg,
       typename std::vector<DataT>::const_iterator& dataVectorIterator_arg,
@@ -905,9 +925,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deserializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deserializeLeafCallback (OctreeLeaf& leaf_arg, const OctreeKey& key_arg)
     {
 
       DataT newDataT;
@@ -921,9 +941,9 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT>
+    template<typename DataT, typename LeafT, template<typename > class NodePoolT>
     void
-    OctreeLowMemBase<DataT, LeafT>::deserializeTreeAndSerializeLeafCallback (OctreeLeaf& leaf_arg,
+    OctreeLowMemBase<DataT, LeafT, NodePoolT>::deserializeTreeAndSerializeLeafCallback (OctreeLeaf& leaf_arg,
                                                                              const OctreeKey& key_arg,
                                                                              std::vector<DataT>& dataVector_arg)
     {
@@ -40,6 +40,7 @@
 #define OCTREE_POINTCLOUD_HPP_
 
 #include <vector>
+#include <algorithm>
 #include <assert.h>
 
 #include "pcl/common/common.h"
@@ -48,7 +49,7 @@
 template<typename PointT, typename LeafT, typename OctreeT>
 pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::OctreePointCloud (const double resolution) :
     OctreeT (), epsilon_ (0), resolution_ (resolution), minX_ (0.0f), maxX_ (resolution), minY_ (0.0f),
-    maxY_ (resolution), minZ_ (0.0f), maxZ_ (resolution), maxKeys_ (1), boundingBoxDefined_ (false)
+    maxY_ (resolution), minZ_ (0.0f), maxZ_ (resolution), maxKeys_ (1), boundingBoxDefined_ (false), threads_ (1)
 {
   assert ( resolution > 0.0f );
   input_ = PointCloudConstPtr ();
@@ -64,35 +65,180 @@ pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::~OctreePointCloud ()
 template<typename PointT, typename LeafT, typename OctreeT> void
 pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::addPointsFromInputCloud ()
 {
-  size_t i;
+  size_t i, e;
 
   assert (this->leafCount_==0);
+
+  // collect finite points in insertion order
+  std::vector<int> pointIndices;
   if (indices_)
   {
-    std::vector<int>::const_iterator current = indices_->begin ();
-    while (current != indices_->end ())
+    pointIndices.reserve (indices_->size ());
+    for (std::vector<int>::const_iterator current = indices_->begin (); current != indices_->end (); ++current)
     {
       if ((input_->points[*current].x == input_->points[*current].x) && (input_->points[*current].y
           == input_->points[*current].y) && (input_->points[*current].z == input_->points[*current].z))
-      {
-        // add points to octree
-        this->addPointIdx (*current);
-        ++current;
-      }
+        pointIndices.push_back (*current);
     }
   }
   else
   {
+    pointIndices.reserve (input_->points.size ());
     for (i = 0; i < input_->points.size (); i++)
     {
       if ((input_->points[i].x == input_->points[i].x) && (input_->points[i].y == input_->points[i].y)
           && (input_->points[i].z == input_->points[i].z))
+        pointIndices.push_back ((int)i);
+    }
+  }
+
+  if (pointIndices.empty ())
+    return;
+
+  // nodes that are already in the octree, e.g. the previous buffer of a double buffered octree, can't be moved
+  // below a new root node by the bulk construction. If such an octree has to grow, the points are added one by one.
+  const bool keepNodes = this->rootHasChildren ();
+  const double prevMinX = minX_, prevMinY = minY_, prevMinZ = minZ_;
+  const double prevMaxX = maxX_, prevMaxY = maxY_, prevMaxZ = maxZ_;
+  const unsigned int prevDepth = this->octreeDepth_;
+  const unsigned int prevKeys = maxKeys_;
+  const bool prevBoundingBoxDefined = boundingBoxDefined_;
+
+  // replay the bounding box adaption of incremental insertion. Each time the octree grows by another level,
+  // the keys of all points added before are shifted, which is tracked per bounding box epoch.
+  std::vector<size_t> epochBegin;
+  std::vector<double> epochMin;
+  std::vector<unsigned int> epochMaxKeys;
+  std::vector<unsigned int> epochShift;
+
+  for (i = 0; i < pointIndices.size (); i++)
+  {
+    const PointT& point = input_->points[pointIndices[i]];
+
+    unsigned char childIdx;
+    bool adopted = false;
+
+    while (adoptBoundingBoxStep (point, i == 0, childIdx))
+    {
+      adopted = true;
+      if (i == 0)
+        continue;
+
+      if (keepNodes)
+      {
+        minX_ = prevMinX;
+        minY_ = prevMinY;
+        minZ_ = prevMinZ;
+        maxX_ = prevMaxX;
+        maxY_ = prevMaxY;
+        maxZ_ = prevMaxZ;
+        this->setTreeDepth (prevDepth);
+        maxKeys_ = prevKeys;
+        boundingBoxDefined_ = prevBoundingBoxDefined;
+
+        for (e = 0; e < pointIndices.size (); e++)
+          this->addPointIdx (pointIndices[e]);
+        return;
+      }
+
+      const unsigned int prevMaxKeys = maxKeys_ >> 1;
+      for (e = 0; e < epochBegin.size (); e++)
+      {
+        epochShift[3 * e + 0] += (childIdx & 4) ? prevMaxKeys : 0;
+        epochShift[3 * e + 1] += (childIdx & 2) ? prevMaxKeys : 0;
+        epochShift[3 * e + 2] += (childIdx & 1) ? prevMaxKeys : 0;
+      }
+    }
+
+    if ((i == 0) || adopted)
+    {
+      epochBegin.push_back (i);
+      epochMin.push_back (minX_);
+      epochMin.push_back (minY_);
+      epochMin.push_back (minZ_);
+      epochMaxKeys.push_back (maxKeys_);
+      epochShift.resize (epochShift.size () + 3, 0);
+    }
+  }
+  epochBegin.push_back (pointIndices.size ());
+
+  // compute octree keys like genOctreeKeyforPoint would have at insertion time
+  std::vector<OctreeKey> keys (pointIndices.size ());
+  for (e = 0; e + 1 < epochBegin.size (); e++)
+  {
+    const double minX = epochMin[3 * e + 0];
+    const double minY = epochMin[3 * e + 1];
+    const double minZ = epochMin[3 * e + 2];
+    const unsigned int maxKey = epochMaxKeys[e] - 1;
+    const unsigned int * shift = &epochShift[3 * e];
+
+#pragma omp parallel for schedule (static) num_threads (threads_)
+    for (int idx = (int)epochBegin[e]; idx < (int)epochBegin[e + 1]; idx++)
+    {
+      const PointT& point = input_->points[pointIndices[idx]];
+      keys[idx].x = min ((unsigned int)((point.x - minX) / this->resolution_), maxKey) + shift[0];
+      keys[idx].y = min ((unsigned int)((point.y - minY) / this->resolution_), maxKey) + shift[1];
+      keys[idx].z = min ((unsigned int)((point.z - minZ) / this->resolution_), maxKey) + shift[2];
+    }
+  }
+
+  // stable LSD radix sort by Morton code, two tree levels (64 buckets) per pass
+  const int chunks = (int)threads_;
+  const size_t pointCount = keys.size ();
+  std::vector<OctreeKey> sortedKeys (pointCount);
+  std::vector<int> sortedIndices (pointCount);
+  std::vector<size_t> bucketOffsets (64 * chunks);
+
+  for (unsigned int bit = 0; bit < this->octreeDepth_; bit += 2)
+  {
+    std::fill (bucketOffsets.begin (), bucketOffsets.end (), 0);
+
+#pragma omp parallel for schedule (static, 1) num_threads (threads_)
+    for (int chunk = 0; chunk < chunks; chunk++)
+    {
+      size_t* histogram = &bucketOffsets[64 * chunk];
+      for (size_t idx = pointCount * chunk / chunks; idx < pointCount * (chunk + 1) / chunks; idx++)
+        histogram[getMortonDigit (keys[idx], bit)]++;
+    }
+
+    // exclusive prefix sum over (bucket, chunk) keeps the sort stable
+    size_t offset = 0;
+    bool singleBucket = false;
+    for (int bucket = 0; bucket < 64; bucket++)
+    {
+      size_t bucketSize = 0;
+      for (int chunk = 0; chunk < chunks; chunk++)
+      {
+        const size_t count = bucketOffsets[64 * chunk + bucket];
+        bucketOffsets[64 * chunk + bucket] = offset;
+        offset += count;
+        bucketSize += count;
+      }
+      singleBucket |= (bucketSize == pointCount);
+    }
+
+    // all keys share this digit
+    if (singleBucket)
+      continue;
+
+#pragma omp parallel for schedule (static, 1) num_threads (threads_)
+    for (int chunk = 0; chunk < chunks; chunk++)
+    {
+      size_t* offsets = &bucketOffsets[64 * chunk];
+      for (size_t idx = pointCount * chunk / chunks; idx < pointCount * (chunk + 1) / chunks; idx++)
       {
-        // add points to octree
-        this->addPointIdx ((unsigned int)i);
+        const size_t target = offsets[getMortonDigit (keys[idx], bit)]++;
+        sortedKeys[target] = keys[idx];
+        sortedIndices[target] = pointIndices[idx];
       }
     }
+
+    keys.swap (sortedKeys);
+    pointIndices.swap (sortedIndices);
   }
+
+  // build octree bottom-up from the sorted keys
+  this->add (keys, pointIndices);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -416,90 +562,95 @@ pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::getBoundingBox (
 template<typename PointT, typename LeafT, typename OctreeT> void
 pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::adoptBoundingBoxToPoint (const PointT& pointIdx_arg)
 {
-
-  const float minValue = std::numeric_limits<float>::epsilon();
+  unsigned char childIdx;
 
   // increase octree size until point fits into bounding box
-  while (true)
+  while (adoptBoundingBoxStep (pointIdx_arg, this->leafCount_ == 0, childIdx))
   {
-    bool bLowerBoundViolationX = (pointIdx_arg.x < minX_);
-    bool bLowerBoundViolationY = (pointIdx_arg.y < minY_);
-    bool bLowerBoundViolationZ = (pointIdx_arg.z < minZ_);
-
-    bool bUpperBoundViolationX = (pointIdx_arg.x >= maxX_);
-    bool bUpperBoundViolationY = (pointIdx_arg.y >= maxY_);
-    bool bUpperBoundViolationZ = (pointIdx_arg.z >= maxZ_);
-
-    // do we violate any bounds?
-    if (bLowerBoundViolationX || bLowerBoundViolationY || bLowerBoundViolationZ || bUpperBoundViolationX
-        || bUpperBoundViolationY || bUpperBoundViolationZ || (!boundingBoxDefined_))
+    if (this->leafCount_ > 0)
     {
+      // octree not empty - the current root node becomes a child of a new root node
+      OctreeBranch* newRootBranch;
 
-      double octreeSideLen;
-      unsigned char childIdx;
+      this->createBranch (newRootBranch);
+      this->branchCount_++;
 
-      if (this->leafCount_ > 0)
-      {
-        // octree not empty - we add another tree level and thus increase its size by a factor of 2*2*2
-        childIdx = ((!bUpperBoundViolationX) << 2) | ((!bUpperBoundViolationY) << 1) | ((!bUpperBoundViolationZ));
+      this->setBranchChild (*newRootBranch, childIdx, this->rootNode_);
+
+      this->rootNode_ = newRootBranch;
+    }
+  }
+}
 
-        OctreeBranch* newRootBranch;
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename OctreeT> bool
+pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::adoptBoundingBoxStep (const PointT& point_arg,
+                                                                             bool emptyTree_arg,
+                                                                             unsigned char& childIdx_arg)
+{
+  const float minValue = std::numeric_limits<float>::epsilon();
 
-        this->createBranch (newRootBranch);
-        this->branchCount_++;
+  bool bLowerBoundViolationX = (point_arg.x < minX_);
+  bool bLowerBoundViolationY = (point_arg.y < minY_);
+  bool bLowerBoundViolationZ = (point_arg.z < minZ_);
 
-        this->setBranchChild (*newRootBranch, childIdx, this->rootNode_);
+  bool bUpperBoundViolationX = (point_arg.x >= maxX_);
+  bool bUpperBoundViolationY = (point_arg.y >= maxY_);
+  bool bUpperBoundViolationZ = (point_arg.z >= maxZ_);
 
-        this->rootNode_ = newRootBranch;
+  // do we violate any bounds?
+  if (!(bLowerBoundViolationX || bLowerBoundViolationY || bLowerBoundViolationZ || bUpperBoundViolationX
+      || bUpperBoundViolationY || bUpperBoundViolationZ || (!boundingBoxDefined_)))
+    return (false);
 
-        octreeSideLen = (double)maxKeys_ * resolution_ ;
+  double octreeSideLen;
 
-        if (!bUpperBoundViolationX)
-          minX_ -= octreeSideLen;
+  if (!emptyTree_arg)
+  {
+    // octree not empty - we add another tree level and thus increase its size by a factor of 2*2*2
+    childIdx_arg = ((!bUpperBoundViolationX) << 2) | ((!bUpperBoundViolationY) << 1) | ((!bUpperBoundViolationZ));
 
-        if (!bUpperBoundViolationY)
-          minY_ -= octreeSideLen;
+    octreeSideLen = (double)maxKeys_ * resolution_ ;
 
-        if (!bUpperBoundViolationZ)
-          minZ_ -= octreeSideLen;
+    if (!bUpperBoundViolationX)
+      minX_ -= octreeSideLen;
 
-       // configure tree depth of octree
-        this->octreeDepth_ ++;
-        this->setTreeDepth (this->octreeDepth_);
-        maxKeys_ = (1 << this->octreeDepth_);
+    if (!bUpperBoundViolationY)
+      minY_ -= octreeSideLen;
 
-        // recalculate bounding box width
-        octreeSideLen = (double)maxKeys_ * resolution_ - minValue;
+    if (!bUpperBoundViolationZ)
+      minZ_ -= octreeSideLen;
 
-        // increase octree bounding box
-        maxX_ = minX_ + octreeSideLen;
-        maxY_ = minY_ + octreeSideLen;
-        maxZ_ = minZ_ + octreeSideLen;
+    // configure tree depth of octree
+    this->octreeDepth_ ++;
+    this->setTreeDepth (this->octreeDepth_);
+    maxKeys_ = (1 << this->octreeDepth_);
 
-      }
-      else
-      {
-        // octree is empty - we set the center of the bounding box to our first pixel
-        this->minX_ = pointIdx_arg.x - this->resolution_ / 2;
-        this->minY_ = pointIdx_arg.y - this->resolution_ / 2;
-        this->minZ_ = pointIdx_arg.z - this->resolution_ / 2;
+    // recalculate bounding box width
+    octreeSideLen = (double)maxKeys_ * resolution_ - minValue;
 
-        this->maxX_ = pointIdx_arg.x + this->resolution_ / 2;
-        this->maxY_ = pointIdx_arg.y + this->resolution_ / 2;
-        this->maxZ_ = pointIdx_arg.z + this->resolution_ / 2;
+    // increase octree bounding box
+    maxX_ = minX_ + octreeSideLen;
+    maxY_ = minY_ + octreeSideLen;
+    maxZ_ = minZ_ + octreeSideLen;
+  }
+  else
+  {
+    // octree is empty - we set the center of the bounding box to our first pixel
+    this->minX_ = point_arg.x - this->resolution_ / 2;
+    this->minY_ = point_arg.y - this->resolution_ / 2;
+    this->minZ_ = point_arg.z - this->resolution_ / 2;
 
-        getKeyBitSize();
-      }
+    this->maxX_ = point_arg.x + this->resolution_ / 2;
+    this->maxY_ = point_arg.y + this->resolution_ / 2;
+    this->maxZ_ = point_arg.z + this->resolution_ / 2;
 
-      boundingBoxDefined_ = true;
-    }
-    else
-      // no bound violations anymore - leave while loop
-      break;
+    getKeyBitSize();
   }
-  
-  
 
+  boundingBoxDefined_ = true;
+
+  return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -775,6 +926,220 @@ pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::getOccupiedVoxelCentersRe
   return (voxelCount);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename OctreeT> void
+pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::getIntersectedVoxels (
+    const std::vector<Eigen::Vector3f>& origins_arg, const std::vector<Eigen::Vector3f>& directions_arg,
+    double maxRayParam_arg, int maxVoxelCount_arg, std::vector<IntersectedVoxel>& voxels_arg,
+    std::vector<int>& rayOffsets_arg) const
+{
+  assert (origins_arg.size () == directions_arg.size ());
+
+  const int rayCount = static_cast<int> (origins_arg.size ());
+
+  // group rays by the octant of their direction vector
+  std::vector<unsigned char> rayOctants (rayCount);
+  size_t octantOffsets[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+  for (int i = 0; i < rayCount; i++)
+  {
+    const Eigen::Vector3f& direction = directions_arg[i];
+    rayOctants[i] = static_cast<unsigned char> (((direction.x () < 0.0f) << 2) | ((direction.y () < 0.0f) << 1)
+        | (direction.z () < 0.0f));
+    octantOffsets[rayOctants[i] + 1]++;
+  }
+  for (int octant = 0; octant < 8; octant++)
+    octantOffsets[octant + 1] += octantOffsets[octant];
+
+  std::vector<int> rayOrder (rayCount);
+  for (int i = 0; i < rayCount; i++)
+    rayOrder[octantOffsets[rayOctants[i]]++] = i;
+
+  // rays are cast in blocks, each block collects its voxels in a separate buffer
+  const int blockSize = 256;
+  const int blockCount = (rayCount + blockSize - 1) / blockSize;
+
+  std::vector<std::vector<IntersectedVoxel> > blockVoxels (blockCount);
+  std::vector<int> rayVoxelOffsets (rayCount);
+  std::vector<int> rayVoxelCounts (rayCount);
+
+#pragma omp parallel for schedule (dynamic) num_threads (threads_)
+  for (int block = 0; block < blockCount; block++)
+  {
+    const int blockEnd = std::min ((block + 1) * blockSize, rayCount);
+    for (int j = block * blockSize; j < blockEnd; j++)
+    {
+      const int ray = rayOrder[j];
+      rayVoxelOffsets[ray] = static_cast<int> (blockVoxels[block].size ());
+      rayVoxelCounts[ray] = getIntersectedVoxels (origins_arg[ray], directions_arg[ray], maxRayParam_arg,
+                                                  maxVoxelCount_arg, blockVoxels[block]);
+    }
+  }
+
+  // gather voxels in ray order
+  rayOffsets_arg.resize (rayCount + 1);
+  rayOffsets_arg[0] = 0;
+  for (int i = 0; i < rayCount; i++)
+    rayOffsets_arg[i + 1] = rayOffsets_arg[i] + rayVoxelCounts[i];
+
+  voxels_arg.resize (rayOffsets_arg[rayCount]);
+
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int j = 0; j < rayCount; j++)
+  {
+    const int ray = rayOrder[j];
+    typename std::vector<IntersectedVoxel>::const_iterator rayVoxels = blockVoxels[j / blockSize].begin ()
+        + rayVoxelOffsets[ray];
+    std::copy (rayVoxels, rayVoxels + rayVoxelCounts[ray], voxels_arg.begin () + rayOffsets_arg[ray]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename OctreeT> int
+pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::getIntersectedVoxels (
+    Eigen::Vector3f origin_arg, Eigen::Vector3f direction_arg, double maxRayParam_arg, int maxVoxelCount_arg,
+    std::vector<IntersectedVoxel>& voxels_arg) const
+{
+  OctreeKey key;
+  key.x = key.y = key.z = 0;
+
+  // Voxel childIdx remapping
+  unsigned char a = 0;
+
+  double minX, minY, minZ, maxX, maxY, maxZ;
+
+  initIntersectedVoxel (origin_arg, direction_arg, minX, minY, minZ, maxX, maxY, maxZ, a);
+
+  if ((maxVoxelCount_arg > 0) && (std::max (std::max (minX, minY), minZ) < std::min (std::min (maxX, maxY), maxZ)))
+    return (getIntersectedVoxelsRecursive (minX, minY, minZ, maxX, maxY, maxZ, a, this->rootNode_, key,
+                                           maxRayParam_arg, maxVoxelCount_arg, voxels_arg));
+
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename OctreeT> int
+pcl::octree::OctreePointCloud<PointT, LeafT, OctreeT>::getIntersectedVoxelsRecursive (
+    double minX, double minY, double minZ, double maxX, double maxY, double maxZ, unsigned char a,
+    const OctreeNode* node_arg, const OctreeKey& key_arg, double maxRayParam_arg, int maxVoxelCount_arg,
+    std::vector<IntersectedVoxel>& voxels_arg) const
+{
+  if (maxX < 0.0 || maxY < 0.0 || maxZ < 0.0)
+    return (0);
+
+  // voxel is entered behind the end of the ray
+  if (std::max (std::max (minX, minY), minZ) >= maxRayParam_arg)
+    return (0);
+
+  // If leaf node, store voxel and increment intersection count
+  if (node_arg->getNodeType () == LEAF_NODE)
+  {
+    IntersectedVoxel voxel;
+    voxel.key = key_arg;
+    voxel.leaf = (const OctreeLeaf*)node_arg;
+
+    voxels_arg.push_back (voxel);
+
+    return (1);
+  }
+
+  // Voxel intersection count for branches children
+  int voxelCount = 0;
+
+  // Voxel mid lines
+  double midX = 0.5 * (minX + maxX);
+  double midY = 0.5 * (minY + maxY);
+  double midZ = 0.5 * (minZ + maxZ);
+
+  // First voxel node ray will intersect
+  int currNode = getFirstIntersectedNode (minX, minY, minZ, midX, midY, midZ);
+
+  // Child index, node and key
+  unsigned char childIdx;
+  const OctreeNode *childNode;
+  OctreeKey childKey;
+
+  do
+  {
+    if (currNode != 0)
+      childIdx = currNode ^ a;
+    else
+      childIdx = a;
+
+    // childNode == 0 if childNode doesn't exist
+    childNode = this->getBranchChild ((OctreeBranch&)*node_arg, childIdx);
+
+    // Generate new key for current branch voxel
+    childKey.x = (key_arg.x << 1) | (!!(childIdx & (1 << 2)));
+    childKey.y = (key_arg.y << 1) | (!!(childIdx & (1 << 1)));
+    childKey.z = (key_arg.z << 1) | (!!(childIdx & (1 << 0)));
+
+    // Recursively call each intersected child node, selecting the next
+    //   node intersected by the ray.  Children that do not intersect will
+    //   not be traversed.
+
+    switch (currNode)
+    {
+      case 0:
+        if (childNode)
+          voxelCount += getIntersectedVoxelsRecursive (minX, minY, minZ, midX, midY, midZ, a, childNode, childKey,
+                                                       maxRayParam_arg, maxVoxelCount_arg - voxelCount, voxels_arg);
+        currNode = getNextIntersectedNode (midX, midY, midZ, 4, 2, 1);
+        break;
+
+      case 1:
+        if (childNode)
+          voxelCount += getIntersectedVoxelsRecursive (minX, minY, midZ, midX, midY, maxZ, a, childNode, childKey,
+                                                       maxRayParam_arg, maxVoxelCount_arg - voxelCount, voxels_arg);
+        currNode = getNextIntersectedNode (midX, midY, maxZ, 5, 3, 8);
+        break;
+
+      case 2:
+        if (childNode)
+          voxelCount += getIntersectedVoxelsRecursive (minX, midY, minZ, midX, maxY, midZ, a, childNode, childKey,
+                                                       maxRayParam_arg, maxVoxelCount_arg - voxelCount, voxels_arg);
+        currNode = getNextIntersectedNode (midX, maxY, midZ, 6, 8, 3);
+        break;
+
+      case 3:
+        if (childNode)
+          voxelCount += getIntersectedVoxelsRecursive (minX, midY, midZ, midX, maxY, maxZ, a, childNode, childKey,
+                                                       maxRayParam_arg, maxVoxelCount_arg - voxelCount, voxels_arg);
+        currNode = getNextIntersectedNode (midX, maxY, maxZ, 7, 8, 8);
+        break;
+
+      case 4:
+        if (childNode)
+          voxelCount += getIntersectedVoxelsRecursive (midX, minY, minZ, maxX, midY, midZ, a, childNode, childKey,
+                                                       maxRayParam_arg, maxVoxelCount_arg - voxelCount, voxels_arg);
+        currNode = getNextIntersectedNode (maxX, midY, midZ, 8, 6, 5);
+        break;
+
+      case 5:
+        if (childNode)
+          voxelCount += getIntersectedVoxelsRecursive (midX, minY, midZ, maxX, midY, maxZ, a, childNode, childKey,
+                                                       maxRayParam_arg, maxVoxelCount_arg - voxelCount, voxels_arg);
+        currNode = getNextIntersectedNode (maxX, midY, maxZ, 8, 7, 8);
+        break;
+
+      case 6:
+        if (childNode)
+          voxelCount += getIntersectedVoxelsRecursive (midX, midY, minZ, maxX, maxY, midZ, a, childNode, childKey,
+                                                       maxRayParam_arg, maxVoxelCount_arg - voxelCount, voxels_arg);
+        currNode = getNextIntersectedNode (maxX, maxY, midZ, 8, 8, 7);
+        break;
+
+      case 7:
+        if (childNode)
+          voxelCount += getIntersectedVoxelsRecursive (midX, midY, midZ, maxX, maxY, maxZ, a, childNode, childKey,
+                                                       maxRayParam_arg, maxVoxelCount_arg - voxelCount, voxels_arg);
+        currNode = 8;
+        break;
+    }
+  } while ((currNode < 8) && (voxelCount < maxVoxelCount_arg));
+
+  return (voxelCount);
+}
+
 #define PCL_INSTANTIATE_OctreePointCloudSingleBufferWithLeafDataTVector(T) template class PCL_EXPORTS pcl::octree::OctreePointCloud<T, pcl::octree::OctreeLeafDataTVector<int> , pcl::octree::OctreeBase<int, pcl::octree::OctreeLeafDataTVector<int> > >;
 #define PCL_INSTANTIATE_OctreePointCloudDoubleBufferWithLeafDataTVector(T) template class PCL_EXPORTS pcl::octree::OctreePointCloud<T, pcl::octree::OctreeLeafDataTVector<int> , pcl::octree::Octree2BufBase<int, pcl::octree::OctreeLeafDataTVector<int> > >;
 #define PCL_INSTANTIATE_OctreePointCloudLowMemWithLeafDataTVector(T)       template class PCL_EXPORTS pcl::octree::OctreePointCloud<T, pcl::octree::OctreeLeafDataTVector<int> , pcl::octree::OctreeLowMemBase<int, pcl::octree::OctreeLeafDataTVector<int> > >;
@@ -0,0 +1,662 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ */
+
+#ifndef PCL_OCTREE_POINTCLOUD_LINEAR_IMPL_H_
+#define PCL_OCTREE_POINTCLOUD_LINEAR_IMPL_H_
+
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> template<typename LeafT, typename OctreeT> void
+pcl::octree::OctreePointCloudLinear<PointT>::freeze (const OctreePointCloud<PointT, LeafT, OctreeT> &octree_arg)
+{
+  typedef typename OctreePointCloud<PointT, LeafT, OctreeT>::LeafNodeIterator LeafNodeIterator;
+
+  releaseStorage ();
+
+  input_ = octree_arg.getInputCloud ();
+  input_indices_ = octree_arg.getIndices ();
+  octreeDepth_ = octree_arg.getTreeDepth ();
+  resolution_ = octree_arg.getResolution ();
+  octree_arg.getBoundingBox (minX_, minY_, minZ_, maxX_, maxY_, maxZ_);
+
+  std::vector<std::vector<LevelNode> > levels (octreeDepth_ + 1);
+
+  // the depth-first iterator visits children in ascending child index order, which yields the leaves sorted
+  // by their Morton code. Copy their point indices and points in this order.
+  LeafNodeIterator it (octree_arg);
+  while (*++it)
+  {
+    LevelNode leaf;
+    leaf.x = it.getCurrentOctreeKey ().x;
+    leaf.y = it.getCurrentOctreeKey ().y;
+    leaf.z = it.getCurrentOctreeKey ().z;
+    leaf.firstChild = 0;
+    leaf.childMask = 0;
+    leaf.pointBegin = static_cast<unsigned int> (indices_.size ());
+    it.getData (indices_);
+    leaf.pointEnd = static_cast<unsigned int> (indices_.size ());
+    levels[octreeDepth_].push_back (leaf);
+  }
+
+  points_.resize (indices_.size ());
+  for (size_t i = 0; i < indices_.size (); ++i)
+    points_[i] = getPointByIndex (indices_[i]);
+
+  leafCount_ = static_cast<unsigned int> (levels[octreeDepth_].size ());
+
+  // create branch levels bottom-up; siblings are adjacent in the sorted child level
+  for (int depth = static_cast<int> (octreeDepth_) - 1; depth >= 0; --depth)
+  {
+    const std::vector<LevelNode>& children = levels[depth + 1];
+    std::vector<LevelNode>& parents = levels[depth];
+
+    for (size_t i = 0; i < children.size (); ++i)
+    {
+      const LevelNode& child = children[i];
+      const unsigned char childIdx = static_cast<unsigned char> (((child.x & 1) << 2) | ((child.y & 1) << 1)
+          | (child.z & 1));
+
+      if (parents.empty () || parents.back ().x != (child.x >> 1) || parents.back ().y != (child.y >> 1)
+          || parents.back ().z != (child.z >> 1))
+      {
+        LevelNode parent;
+        parent.x = child.x >> 1;
+        parent.y = child.y >> 1;
+        parent.z = child.z >> 1;
+        parent.firstChild = static_cast<unsigned int> (i);
+        parent.pointBegin = child.pointBegin;
+        parent.childMask = 0;
+        parents.push_back (parent);
+      }
+
+      parents.back ().childMask |= static_cast<unsigned char> (1 << childIdx);
+      parents.back ().pointEnd = child.pointEnd;
+    }
+  }
+
+  // an empty octree still has a root node
+  if (levels[0].empty ())
+  {
+    LevelNode root;
+    root.x = root.y = root.z = 0;
+    root.firstChild = root.pointBegin = root.pointEnd = 0;
+    root.childMask = 0;
+    levels[0].push_back (root);
+  }
+
+  // concatenate levels top-down and convert level-local child positions into node array positions
+  size_t nodeCount = 0;
+  for (size_t depth = 0; depth < levels.size (); ++depth)
+    nodeCount += levels[depth].size ();
+  nodes_.reserve (nodeCount);
+
+  unsigned int levelOffset = 0;
+  for (size_t depth = 0; depth < levels.size (); ++depth)
+  {
+    const unsigned int nextLevelOffset = levelOffset + static_cast<unsigned int> (levels[depth].size ());
+
+    for (size_t i = 0; i < levels[depth].size (); ++i)
+    {
+      const LevelNode& levelNode = levels[depth][i];
+
+      LinearNode node;
+      node.firstChild = levelNode.childMask ? nextLevelOffset + levelNode.firstChild : 0;
+      node.pointBegin = levelNode.pointBegin;
+      node.pointEnd = levelNode.pointEnd;
+      node.childMask = levelNode.childMask;
+      nodes_.push_back (node);
+    }
+
+    // release construction memory early
+    std::vector<LevelNode> ().swap (levels[depth]);
+    levelOffset = nextLevelOffset;
+  }
+
+  nodeCount_ = static_cast<unsigned int> (nodes_.size ());
+  pointCount_ = static_cast<unsigned int> (points_.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinear<PointT>::saveImage (const std::string& file_name) const
+{
+  if (nodeCount_ == 0)
+    return (false);
+
+  LinearImageHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, imageMagic (), sizeof (header.magic));
+  header.version = imageVersion;
+  header.byteOrder = imageByteOrder;
+  header.pointSize = sizeof (PointT);
+  header.nodeSize = sizeof (LinearNode);
+  header.octreeDepth = octreeDepth_;
+  header.leafCount = leafCount_;
+  header.nodeCount = nodeCount_;
+  header.pointCount = pointCount_;
+  header.nodeOffset = alignImageOffset (sizeof (LinearImageHeader));
+  header.pointOffset = alignImageOffset (header.nodeOffset + header.nodeCount * sizeof (LinearNode));
+  header.indexOffset = alignImageOffset (header.pointOffset + header.pointCount * sizeof (PointT));
+  header.resolution = resolution_;
+  header.minX = minX_; header.minY = minY_; header.minZ = minZ_;
+  header.maxX = maxX_; header.maxY = maxY_; header.maxZ = maxZ_;
+
+  std::ofstream fs (file_name.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!fs.is_open ())
+    return (false);
+
+  const char padding[imageAlignment] = {0};
+  boost::uint64_t position = 0;
+
+  // write a section at its aligned file offset
+  struct Section
+  {
+    boost::uint64_t offset;
+    const void* data;
+    boost::uint64_t size;
+  } sections[4] = {
+    {0, &header, sizeof (header)},
+    {header.nodeOffset, getNodes (), header.nodeCount * sizeof (LinearNode)},
+    {header.pointOffset, getPoints (), header.pointCount * sizeof (PointT)},
+    {header.indexOffset, getPointIndices (), header.pointCount * sizeof (int)}
+  };
+
+  for (int i = 0; i < 4; ++i)
+  {
+    fs.write (padding, static_cast<std::streamsize> (sections[i].offset - position));
+    if (sections[i].size)
+      fs.write (static_cast<const char*> (sections[i].data), static_cast<std::streamsize> (sections[i].size));
+    position = sections[i].offset + sections[i].size;
+  }
+
+  fs.close ();
+  return (!fs.fail ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinear<PointT>::mapImage (const std::string& file_name)
+{
+  boost::shared_ptr<OctreeMappedFile> mappedFile (new OctreeMappedFile ());
+  if (!mappedFile->open (file_name))
+    return (false);
+
+  const char* data = mappedFile->getData ();
+  const boost::uint64_t size = mappedFile->getSize ();
+
+  if (size < sizeof (LinearImageHeader))
+    return (false);
+
+  LinearImageHeader header;
+  std::memcpy (&header, data, sizeof (header));
+
+  if (std::memcmp (header.magic, imageMagic (), sizeof (header.magic)) != 0 || header.version != imageVersion
+      || header.byteOrder != imageByteOrder || header.pointSize != sizeof (PointT)
+      || header.nodeSize != sizeof (LinearNode))
+    return (false);
+
+  // reject truncated or inconsistent images before touching any section
+  if (header.nodeCount == 0 || header.leafCount > header.nodeCount || header.octreeDepth >= 32
+      || header.nodeCount > std::numeric_limits<unsigned int>::max ()
+      || header.pointCount > static_cast<boost::uint64_t> (std::numeric_limits<int>::max ())
+      || header.nodeOffset % imageAlignment || header.pointOffset % imageAlignment
+      || header.indexOffset % imageAlignment
+      || header.nodeOffset < sizeof (LinearImageHeader)
+      || header.nodeOffset + header.nodeCount * sizeof (LinearNode) > header.pointOffset
+      || header.pointOffset + header.pointCount * sizeof (PointT) > header.indexOffset
+      || header.indexOffset + header.pointCount * sizeof (int) > size)
+    return (false);
+
+  releaseStorage ();
+
+  mappedFile_ = mappedFile;
+  mappedNodes_ = reinterpret_cast<const LinearNode*> (data + header.nodeOffset);
+  mappedPoints_ = reinterpret_cast<const PointT*> (data + header.pointOffset);
+  mappedIndices_ = reinterpret_cast<const int*> (data + header.indexOffset);
+
+  nodeCount_ = static_cast<unsigned int> (header.nodeCount);
+  pointCount_ = static_cast<unsigned int> (header.pointCount);
+  leafCount_ = header.leafCount;
+  octreeDepth_ = header.octreeDepth;
+  resolution_ = header.resolution;
+  minX_ = header.minX; minY_ = header.minY; minZ_ = header.minZ;
+  maxX_ = header.maxX; maxY_ = header.maxY; maxZ_ = header.maxZ;
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinear<PointT>::loadImage (const std::string& file_name)
+{
+  if (!mapImage (file_name))
+    return (false);
+
+  // copy the mapped sections into owned storage and drop the mapping
+  std::vector<LinearNode> nodes (mappedNodes_, mappedNodes_ + nodeCount_);
+  AlignedPointTVector points (mappedPoints_, mappedPoints_ + pointCount_);
+  std::vector<int> indices (mappedIndices_, mappedIndices_ + pointCount_);
+
+  mappedFile_.reset ();
+  mappedNodes_ = NULL;
+  mappedPoints_ = NULL;
+  mappedIndices_ = NULL;
+
+  nodes_.swap (nodes);
+  points_.swap (points);
+  indices_.swap (indices);
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::releaseStorage ()
+{
+  input_.reset ();
+  input_indices_.reset ();
+
+  nodes_.clear ();
+  points_.clear ();
+  indices_.clear ();
+
+  mappedFile_.reset ();
+  mappedNodes_ = NULL;
+  mappedPoints_ = NULL;
+  mappedIndices_ = NULL;
+
+  nodeCount_ = pointCount_ = leafCount_ = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinear<PointT>::voxelSearch (const PointT& point,
+                                                          std::vector<int>& pointIdx_data) const
+{
+  pointIdx_data.clear ();
+
+  if (nodeCount_ == 0)
+    return (false);
+
+  const LinearNode* nodes = getNodes ();
+  const int* indices = getPointIndices ();
+
+  // reject points outside of the octree bounding box
+  if (point.x < minX_ || point.y < minY_ || point.z < minZ_ ||
+      point.x >= maxX_ || point.y >= maxY_ || point.z >= maxZ_)
+    return (false);
+
+  // generate key like OctreePointCloud::genOctreeKeyforPoint
+  const unsigned int maxKey = (1u << octreeDepth_) - 1;
+  const unsigned int keyX = std::min (static_cast<unsigned int> ((point.x - minX_) / resolution_), maxKey);
+  const unsigned int keyY = std::min (static_cast<unsigned int> ((point.y - minY_) / resolution_), maxKey);
+  const unsigned int keyZ = std::min (static_cast<unsigned int> ((point.z - minZ_) / resolution_), maxKey);
+
+  unsigned int nodeIdx = 0;
+  for (unsigned int depth = 0; depth < octreeDepth_; ++depth)
+  {
+    const unsigned int bit = octreeDepth_ - 1 - depth;
+    const unsigned char childIdx = static_cast<unsigned char> ((((keyX >> bit) & 1) << 2)
+        | (((keyY >> bit) & 1) << 1) | ((keyZ >> bit) & 1));
+
+    const LinearNode& node = nodes[nodeIdx];
+    if (!(node.childMask & (1 << childIdx)))
+      return (false);
+
+    nodeIdx = getChildPosition (node, childIdx);
+  }
+
+  const LinearNode& leaf = nodes[nodeIdx];
+  pointIdx_data.assign (indices + leaf.pointBegin, indices + leaf.pointEnd);
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::nearestKSearch (const PointT &p_q, int k,
+                                                             std::vector<int> &k_indices,
+                                                             std::vector<float> &k_sqr_distances) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+
+  if (k <= 0 || pointCount_ == 0)
+    return (0);
+
+  const LinearNode* nodes = getNodes ();
+  const PointT* points = getPoints ();
+  const int* indices = getPointIndices ();
+
+  const size_t K = static_cast<size_t> (k);
+
+  // bounded max-heap of (squared distance, point position) candidates
+  std::vector<std::pair<double, unsigned int> > candidates;
+  candidates.reserve (std::min (K, static_cast<size_t> (pointCount_)));
+
+  std::vector<StackEntry> stack;
+  stack.reserve (8 * (octreeDepth_ + 1));
+
+  StackEntry root;
+  root.node = 0;
+  root.depth = 0;
+  root.x = root.y = root.z = 0;
+  root.value = 0.0;
+  stack.push_back (root);
+
+  Eigen::Vector3d min_pt, max_pt;
+  double maxSquaredDist;
+
+  while (!stack.empty ())
+  {
+    const StackEntry entry = stack.back ();
+    stack.pop_back ();
+
+    // prune voxels farther away than the current K-th candidate
+    if (candidates.size () == K && entry.value > candidates.front ().first)
+      continue;
+
+    const LinearNode& node = nodes[entry.node];
+
+    if (entry.depth == octreeDepth_)
+    {
+      for (unsigned int i = node.pointBegin; i < node.pointEnd; ++i)
+      {
+        const double squaredDist = pointSquaredDist (points[i], p_q);
+
+        if (candidates.size () < K)
+        {
+          candidates.push_back (std::make_pair (squaredDist, i));
+          std::push_heap (candidates.begin (), candidates.end ());
+        }
+        else if (squaredDist < candidates.front ().first)
+        {
+          std::pop_heap (candidates.begin (), candidates.end ());
+          candidates.back () = std::make_pair (squaredDist, i);
+          std::push_heap (candidates.begin (), candidates.end ());
+        }
+      }
+      continue;
+    }
+
+    // push children so that the closest voxel is visited next
+    const size_t segmentBegin = stack.size ();
+    for (unsigned char childIdx = 0; childIdx < 8; ++childIdx)
+    {
+      if (!(node.childMask & (1 << childIdx)))
+        continue;
+
+      StackEntry child;
+      genChildEntry (entry, node, childIdx, child);
+      genVoxelBounds (child, min_pt, max_pt);
+      child.value = boxSquaredDist (p_q, min_pt, max_pt, maxSquaredDist);
+
+      if (candidates.size () < K || child.value <= candidates.front ().first)
+        stack.push_back (child);
+    }
+    std::sort (stack.begin () + segmentBegin, stack.end ());
+  }
+
+  std::sort_heap (candidates.begin (), candidates.end ());
+
+  // same result order as OctreePointCloudSearch: farthest neighbor first
+  k_indices.reserve (candidates.size ());
+  k_sqr_distances.reserve (candidates.size ());
+  for (size_t i = candidates.size (); i-- > 0; )
+  {
+    k_indices.push_back (indices[candidates[i].second]);
+    k_sqr_distances.push_back (static_cast<float> (candidates[i].first));
+  }
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::radiusSearch (const PointT &p_q, const double radius,
+                                                           std::vector<int> &k_indices,
+                                                           std::vector<float> &k_sqr_distances,
+                                                           unsigned int max_nn) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+
+  if (pointCount_ == 0)
+    return (0);
+
+  const LinearNode* nodes = getNodes ();
+  const PointT* points = getPoints ();
+  const int* indices = getPointIndices ();
+
+  const double radiusSquared = radius * radius;
+
+  std::vector<StackEntry> stack;
+  stack.reserve (8 * (octreeDepth_ + 1));
+
+  Eigen::Vector3d min_pt, max_pt;
+  double maxSquaredDist;
+
+  StackEntry root;
+  root.node = 0;
+  root.depth = 0;
+  root.x = root.y = root.z = 0;
+  genVoxelBounds (root, min_pt, max_pt);
+  if (boxSquaredDist (p_q, min_pt, max_pt, maxSquaredDist) > radiusSquared)
+    return (0);
+  root.value = maxSquaredDist;
+  stack.push_back (root);
+
+  while (!stack.empty ())
+  {
+    const StackEntry entry = stack.back ();
+    stack.pop_back ();
+
+    const LinearNode& node = nodes[entry.node];
+
+    // leaves and voxels lying completely within the search sphere cover a contiguous point range
+    if (entry.depth == octreeDepth_ || entry.value <= radiusSquared)
+    {
+      for (unsigned int i = node.pointBegin; i < node.pointEnd; ++i)
+      {
+        const double squaredDist = pointSquaredDist (points[i], p_q);
+
+        if (squaredDist > radiusSquared)
+          continue;
+
+        k_indices.push_back (indices[i]);
+        k_sqr_distances.push_back (static_cast<float> (squaredDist));
+
+        if (max_nn != 0 && k_indices.size () == max_nn)
+          return (static_cast<int> (k_indices.size ()));
+      }
+      continue;
+    }
+
+    // push children in reverse order to visit them in ascending child index order
+    for (int childIdx = 7; childIdx >= 0; --childIdx)
+    {
+      if (!(node.childMask & (1 << childIdx)))
+        continue;
+
+      StackEntry child;
+      genChildEntry (entry, node, static_cast<unsigned char> (childIdx), child);
+      genVoxelBounds (child, min_pt, max_pt);
+
+      if (boxSquaredDist (p_q, min_pt, max_pt, maxSquaredDist) > radiusSquared)
+        continue;
+
+      child.value = maxSquaredDist;
+      stack.push_back (child);
+    }
+  }
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::getIntersectedVoxelIndices (Eigen::Vector3f origin,
+                                                                         Eigen::Vector3f direction,
+                                                                         std::vector<int> &k_indices) const
+{
+  k_indices.clear ();
+
+  if (pointCount_ == 0)
+    return (0);
+
+  const LinearNode* nodes = getNodes ();
+  const int* indices = getPointIndices ();
+
+  // Account for division by zero when direction vector is 0.0
+  const double epsilon = 1e-10;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (direction[axis] == 0.0f)
+      direction[axis] = epsilon;
+  }
+
+  const Eigen::Vector3d rayOrigin = origin.cast<double> ();
+  const Eigen::Vector3d invDirection = direction.cast<double> ().cwiseInverse ();
+
+  std::vector<StackEntry> stack;
+  stack.reserve (8 * (octreeDepth_ + 1));
+
+  Eigen::Vector3d min_pt, max_pt;
+  int voxelCount = 0;
+
+  StackEntry root;
+  root.node = 0;
+  root.depth = 0;
+  root.x = root.y = root.z = 0;
+  root.value = 0.0;
+  stack.push_back (root);
+
+  while (!stack.empty ())
+  {
+    const StackEntry entry = stack.back ();
+    stack.pop_back ();
+
+    const LinearNode& node = nodes[entry.node];
+
+    if (entry.depth == octreeDepth_)
+    {
+      k_indices.insert (k_indices.end (), indices + node.pointBegin, indices + node.pointEnd);
+      ++voxelCount;
+      continue;
+    }
+
+    // push intersected children ordered by ray entry parameter
+    const size_t segmentBegin = stack.size ();
+    for (unsigned char childIdx = 0; childIdx < 8; ++childIdx)
+    {
+      if (!(node.childMask & (1 << childIdx)))
+        continue;
+
+      StackEntry child;
+      genChildEntry (entry, node, childIdx, child);
+      genVoxelBounds (child, min_pt, max_pt);
+
+      const Eigen::Vector3d t0 = (min_pt - rayOrigin).cwiseProduct (invDirection);
+      const Eigen::Vector3d t1 = (max_pt - rayOrigin).cwiseProduct (invDirection);
+      const double tEnter = t0.cwiseMin (t1).maxCoeff ();
+      const double tExit = t0.cwiseMax (t1).minCoeff ();
+
+      if (tEnter >= tExit || tExit < 0.0)
+        continue;
+
+      child.value = tEnter;
+      stack.push_back (child);
+    }
+    std::sort (stack.begin () + segmentBegin, stack.end ());
+  }
+
+  return (voxelCount);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> const PointT&
+pcl::octree::OctreePointCloudLinear<PointT>::getPointByIndex (const unsigned int index_arg) const
+{
+  assert (input_);
+
+  if (input_indices_ == 0)
+  {
+    assert (index_arg < (unsigned int)input_->points.size ());
+    return (input_->points[index_arg]);
+  }
+  else
+  {
+    assert (index_arg < (unsigned int)input_indices_->size ());
+    return (input_->points[(*input_indices_)[index_arg]]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> double
+pcl::octree::OctreePointCloudLinear<PointT>::boxSquaredDist (const PointT& point, const Eigen::Vector3d& min_pt,
+                                                             const Eigen::Vector3d& max_pt,
+                                                             double& maxSquaredDist) const
+{
+  const double coords[3] = { point.x, point.y, point.z };
+
+  double squaredDist = 0.0;
+  maxSquaredDist = 0.0;
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const double toMin = coords[axis] - min_pt[axis];
+    const double toMax = max_pt[axis] - coords[axis];
+
+    if (toMin < 0.0)
+      squaredDist += toMin * toMin;
+    else if (toMax < 0.0)
+      squaredDist += toMax * toMax;
+
+    const double farthest = std::max (std::fabs (toMin), std::fabs (toMax));
+    maxSquaredDist += farthest * farthest;
+  }
+
+  return (squaredDist);
+}
+
+#endif    // PCL_OCTREE_POINTCLOUD_LINEAR_IMPL_H_
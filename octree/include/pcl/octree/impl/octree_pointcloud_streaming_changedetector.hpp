@@ -0,0 +1,296 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ */
+
+#ifndef PCL_OCTREE_POINTCLOUD_STREAMING_CHANGEDETECTOR_IMPL_H_
+#define PCL_OCTREE_POINTCLOUD_STREAMING_CHANGEDETECTOR_IMPL_H_
+
+#include <pcl/pcl_macros.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT>
+pcl::octree::OctreePointCloudStreamingChangeDetector<PointT>::OctreePointCloudStreamingChangeDetector (
+    const double resolution_arg) :
+  resolution_ (resolution_arg), minX_ (0.0), minY_ (0.0), minZ_ (0.0), maxX_ (0.0), maxY_ (0.0), maxZ_ (0.0),
+  appearFrames_ (2), disappearFrames_ (2), minPointsPerVoxel_ (1), threads_ (1), pendingKeys_ (), voxels_ (),
+  expiryWheel_ (), occupiedCount_ (0), frameCount_ (0), pendingMutex_ (), stateMutex_ ()
+{
+  assert (resolution_ > 0.0);
+  gridSize_[0] = gridSize_[1] = gridSize_[2] = 0;
+  reset ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudStreamingChangeDetector<PointT>::defineBoundingBox (
+    const double minX_arg, const double minY_arg, const double minZ_arg,
+    const double maxX_arg, const double maxY_arg, const double maxZ_arg)
+{
+  assert (maxX_arg >= minX_arg);
+  assert (maxY_arg >= minY_arg);
+  assert (maxZ_arg >= minZ_arg);
+
+  const unsigned int maxGridSize = 1u << keyBits_;
+  const double extent[3] = {maxX_arg - minX_arg, maxY_arg - minY_arg, maxZ_arg - minZ_arg};
+
+  {
+    boost::mutex::scoped_lock lock (stateMutex_);
+
+    minX_ = minX_arg;
+    minY_ = minY_arg;
+    minZ_ = minZ_arg;
+    maxX_ = maxX_arg;
+    maxY_ = maxY_arg;
+    maxZ_ = maxZ_arg;
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+      const double size = std::ceil (extent[i] / resolution_);
+      gridSize_[i] = static_cast<unsigned int> (std::max (1.0, std::min (size, (double)maxGridSize)));
+    }
+  }
+
+  reset ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudStreamingChangeDetector<PointT>::setHysteresis (unsigned int appearFrames_arg,
+                                                                             unsigned int disappearFrames_arg)
+{
+  {
+    boost::mutex::scoped_lock lock (stateMutex_);
+    appearFrames_ = std::max (appearFrames_arg, 1u);
+    disappearFrames_ = std::max (disappearFrames_arg, 1u);
+  }
+
+  reset ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudStreamingChangeDetector<PointT>::reset ()
+{
+  boost::mutex::scoped_lock stateLock (stateMutex_);
+  boost::mutex::scoped_lock pendingLock (pendingMutex_);
+
+  pendingKeys_.clear ();
+  voxels_.clear ();
+  occupiedCount_ = 0;
+  frameCount_ = 0;
+
+  // a voxel state never expires more than max (appearFrames_, disappearFrames_) frames after it was updated
+  expiryWheel_.clear ();
+  expiryWheel_.resize (std::max (appearFrames_, disappearFrames_) + 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudStreamingChangeDetector<PointT>::genVoxelKey (const PointT& point_arg,
+                                                                           boost::uint64_t& key_arg) const
+{
+  if (!pcl_isfinite (point_arg.x) || !pcl_isfinite (point_arg.y) || !pcl_isfinite (point_arg.z))
+    return (false);
+
+  const double pos[3] = {(point_arg.x - minX_) / resolution_, (point_arg.y - minY_) / resolution_,
+                         (point_arg.z - minZ_) / resolution_};
+
+  key_arg = 0;
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    if (!(pos[i] >= 0.0) || !(pos[i] < (double)gridSize_[i]))
+      return (false);
+    key_arg = (key_arg << keyBits_) | static_cast<boost::uint64_t> (pos[i]);
+  }
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudStreamingChangeDetector<PointT>::addPoints (const PointCloud& cloud_arg)
+{
+  const int pointCount = static_cast<int> (cloud_arg.points.size ());
+  std::vector<boost::uint64_t> keys (pointCount);
+  std::vector<char> valid (pointCount);
+
+  // keying is independent per point and runs without holding a lock
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int i = 0; i < pointCount; i++)
+    valid[i] = genVoxelKey (cloud_arg.points[i], keys[i]);
+
+  int validCount = 0;
+  for (int i = 0; i < pointCount; i++)
+    if (valid[i])
+      keys[validCount++] = keys[i];
+
+  boost::mutex::scoped_lock lock (pendingMutex_);
+  pendingKeys_.insert (pendingKeys_.end (), keys.begin (), keys.begin () + validCount);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> unsigned int
+pcl::octree::OctreePointCloudStreamingChangeDetector<PointT>::finishFrame (std::vector<VoxelEvent>& events_arg)
+{
+  events_arg.clear ();
+
+  boost::mutex::scoped_lock stateLock (stateMutex_);
+
+  // take over the pending keys, so that producers can continue with the next frame
+  std::vector<boost::uint64_t> keys;
+  {
+    boost::mutex::scoped_lock pendingLock (pendingMutex_);
+    keys.swap (pendingKeys_);
+  }
+
+  const unsigned int frame = frameCount_++;
+  const boost::uint64_t axisMask = (static_cast<boost::uint64_t> (1) << keyBits_) - 1;
+
+  std::sort (keys.begin (), keys.end ());
+
+  // update the voxels observed in this frame
+  std::size_t begin = 0;
+  while (begin < keys.size ())
+  {
+    const boost::uint64_t key = keys[begin];
+    std::size_t end = begin + 1;
+    while (end < keys.size () && keys[end] == key)
+      end++;
+
+    const unsigned int pointCount = static_cast<unsigned int> (end - begin);
+    begin = end;
+
+    if (pointCount < minPointsPerVoxel_)
+      continue;
+
+    std::pair<typename VoxelMap::iterator, bool> inserted = voxels_.insert (std::make_pair (key, VoxelState ()));
+    VoxelState& state = inserted.first->second;
+
+    if (inserted.second)
+    {
+      state.score = 0;
+      state.occupied = false;
+    }
+    else
+    {
+      // evidence decays by one for every frame the voxel was missed
+      const unsigned int missed = frame - state.lastFrame - 1;
+      state.score = (state.score > missed) ? state.score - missed : 0;
+    }
+
+    state.score = std::min (state.score + 1, appearFrames_);
+    state.lastFrame = frame;
+
+    if (!state.occupied && state.score >= appearFrames_)
+    {
+      state.occupied = true;
+      occupiedCount_++;
+
+      VoxelEvent event;
+      event.x = static_cast<unsigned int> ((key >> (2 * keyBits_)) & axisMask);
+      event.y = static_cast<unsigned int> ((key >> keyBits_) & axisMask);
+      event.z = static_cast<unsigned int> (key & axisMask);
+      event.appeared = true;
+      event.pointCount = pointCount;
+      event.frame = frame;
+      events_arg.push_back (event);
+    }
+
+    state.expireFrame = frame + (state.occupied ? disappearFrames_ : state.score);
+    scheduleExpiry (key, state.expireFrame);
+  }
+
+  // expire the voxels that were not observed for long enough. Voxels updated in this frame were rescheduled
+  // to a later slot, their entries in the current slot are stale.
+  std::vector<boost::uint64_t>& slot = expiryWheel_[frame % expiryWheel_.size ()];
+  for (std::size_t i = 0; i < slot.size (); i++)
+  {
+    typename VoxelMap::iterator it = voxels_.find (slot[i]);
+    if (it == voxels_.end () || it->second.expireFrame != frame)
+      continue;
+
+    if (it->second.occupied)
+    {
+      occupiedCount_--;
+
+      VoxelEvent event;
+      event.x = static_cast<unsigned int> ((slot[i] >> (2 * keyBits_)) & axisMask);
+      event.y = static_cast<unsigned int> ((slot[i] >> keyBits_) & axisMask);
+      event.z = static_cast<unsigned int> (slot[i] & axisMask);
+      event.appeared = false;
+      event.pointCount = 0;
+      event.frame = frame;
+      events_arg.push_back (event);
+    }
+
+    voxels_.erase (it);
+  }
+  slot.clear ();
+
+  return (frame);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudStreamingChangeDetector<PointT>::isVoxelOccupiedAtPoint (const PointT& point_arg) const
+{
+  boost::uint64_t key;
+
+  boost::mutex::scoped_lock lock (stateMutex_);
+
+  if (!genVoxelKey (point_arg, key))
+    return (false);
+
+  typename VoxelMap::const_iterator it = voxels_.find (key);
+  return (it != voxels_.end () && it->second.occupied);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudStreamingChangeDetector<PointT>::getVoxelCenter (const VoxelEvent& event_arg,
+                                                                              PointT& center_arg) const
+{
+  center_arg.x = static_cast<float> (minX_ + (event_arg.x + 0.5) * resolution_);
+  center_arg.y = static_cast<float> (minY_ + (event_arg.y + 0.5) * resolution_);
+  center_arg.z = static_cast<float> (minZ_ + (event_arg.z + 0.5) * resolution_);
+}
+
+#endif    // PCL_OCTREE_POINTCLOUD_STREAMING_CHANGEDETECTOR_IMPL_H_
@@ -44,6 +44,9 @@
 
 #include <pcl/common/common.h>
 #include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafT, typename OctreeT>
@@ -83,41 +86,30 @@ template<typename PointT, typename LeafT, typename OctreeT>
   int
   pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::nearestKSearch (const PointT &p_q, int k,
                                                                                std::vector<int> &k_indices,
-                                                                               std::vector<float> &k_sqr_distances)
+                                                                               std::vector<float> &k_sqr_distances) const
   {
-    unsigned int i;
-    unsigned int resultCount;
-
-    prioPointQueueEntry pointEntry;
-    std::vector<prioPointQueueEntry> pointCandidates;
-
-    assert(this->leafCount_>0);
-
-    OctreeKey key;
-    key.x = key.y = key.z = 0;
-
-    // initalize smallest point distance in search with high value
-    double smallestDist = numeric_limits<double>::max ();
-
     k_indices.clear ();
     k_sqr_distances.clear ();
 
-    getKNearestNeighborRecursive (p_q, k, this->rootNode_, key, 1, smallestDist, pointCandidates);
-
-    resultCount = pointCandidates.size ();
+    if ((k <= 0) || (this->leafCount_ == 0))
+      return (0);
 
-    for (i = 0; i < resultCount; i++)
-    {
-      pointEntry = pointCandidates.back ();
+    std::vector<KNNCandidate> candidates;
+    std::vector<int> leafIndices;
+    candidates.reserve (k);
 
-      k_indices.push_back (pointEntry.pointIdx_);
-      k_sqr_distances.push_back (pointEntry.pointDistance_);
+    getKNearestNeighborIterative (p_q, k, numeric_limits<double>::infinity (), candidates, leafIndices);
 
-      pointCandidates.pop_back ();
+    // return farthest neighbor first
+    k_indices.reserve (candidates.size ());
+    k_sqr_distances.reserve (candidates.size ());
+    for (size_t i = candidates.size (); i-- > 0; )
+    {
+      k_indices.push_back (candidates[i].second);
+      k_sqr_distances.push_back (static_cast<float> (candidates[i].first));
     }
 
-    return k_indices.size ();
-
+    return (static_cast<int> (k_indices.size ()));
   }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -125,12 +117,97 @@ template<typename PointT, typename LeafT, typename OctreeT>
   int
   pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::nearestKSearch (int index, int k,
                                                                                std::vector<int> &k_indices,
-                                                                               std::vector<float> &k_sqr_distances)
+                                                                               std::vector<float> &k_sqr_distances) const
   {
     const PointT search_point = this->getPointByIndex (index);
     return (nearestKSearch (search_point, k, k_indices, k_sqr_distances));
   }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename OctreeT>
+  void
+  pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::nearestKSearch (
+      const PointCloud &cloud, const std::vector<int> &indices, int k, std::vector<std::vector<int> > &k_indices,
+      std::vector<std::vector<float> > &k_sqr_distances) const
+  {
+    const size_t queryCount = indices.empty () ? cloud.points.size () : indices.size ();
+
+    k_indices.resize (queryCount);
+    k_sqr_distances.resize (queryCount);
+
+    if ((k <= 0) || (this->leafCount_ == 0))
+    {
+      for (size_t i = 0; i < queryCount; i++)
+      {
+        k_indices[i].clear ();
+        k_sqr_distances[i].clear ();
+      }
+      return;
+    }
+
+    const unsigned int K = k;
+
+    // sort queries along the Morton curve
+    std::vector<std::pair<uint64_t, size_t> > queryOrder (queryCount);
+    for (size_t i = 0; i < queryCount; i++)
+    {
+      const PointT& query = cloud.points[indices.empty () ? i : indices[i]];
+      queryOrder[i] = std::make_pair (genMortonCode (query), i);
+    }
+    std::sort (queryOrder.begin (), queryOrder.end ());
+
+    // consecutive queries of a block reuse the previous result to bound their search radius
+    const int blockSize = 64;
+    const int blockCount = static_cast<int> ((queryCount + blockSize - 1) / blockSize);
+
+#pragma omp parallel num_threads (this->threads_)
+    {
+      std::vector<KNNCandidate> candidates;
+      std::vector<int> leafIndices;
+      candidates.reserve (K);
+
+#pragma omp for schedule (dynamic)
+      for (int block = 0; block < blockCount; block++)
+      {
+        const size_t blockBegin = static_cast<size_t> (block) * blockSize;
+        const size_t blockEnd = std::min (blockBegin + blockSize, queryCount);
+
+        for (size_t j = blockBegin; j < blockEnd; j++)
+        {
+          const size_t queryIdx = queryOrder[j].second;
+          const PointT& query = cloud.points[indices.empty () ? queryIdx : indices[queryIdx]];
+
+          // the K neighbors of the previous query enclose at least K points
+          double maxSquaredDist = numeric_limits<double>::infinity ();
+          if (j > blockBegin)
+          {
+            const std::vector<int>& prevIndices = k_indices[queryOrder[j - 1].second];
+            if (prevIndices.size () == K)
+            {
+              maxSquaredDist = 0.0;
+              for (size_t i = 0; i < prevIndices.size (); i++)
+                maxSquaredDist = std::max (maxSquaredDist,
+                                           pointSquaredDist (this->getPointByIndex (prevIndices[i]), query));
+            }
+          }
+
+          getKNearestNeighborIterative (query, K, maxSquaredDist, candidates, leafIndices);
+
+          // return farthest neighbor first
+          std::vector<int>& resultIndices = k_indices[queryIdx];
+          std::vector<float>& resultDistances = k_sqr_distances[queryIdx];
+          resultIndices.resize (candidates.size ());
+          resultDistances.resize (candidates.size ());
+          for (size_t i = 0; i < candidates.size (); i++)
+          {
+            resultIndices[candidates.size () - 1 - i] = candidates[i].second;
+            resultDistances[candidates.size () - 1 - i] = static_cast<float> (candidates[i].first);
+          }
+        }
+      }
+    }
+  }
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafT, typename OctreeT>
   void
@@ -211,114 +288,145 @@ template<typename PointT, typename LeafT, typename OctreeT>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafT, typename OctreeT>
-  double
-  pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::getKNearestNeighborRecursive (
-      const PointT & point, unsigned int K, const OctreeBranch* node, const OctreeKey& key, unsigned int treeDepth,
-      const double squaredSearchRadius, std::vector<prioPointQueueEntry>& pointCandidates) const
+  void
+  pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::getKNearestNeighborIterative (
+      const PointT& point, unsigned int K, double maxSquaredDist, std::vector<KNNCandidate>& candidates,
+      std::vector<int>& leafIndices) const
   {
-    std::vector<prioBranchQueueEntry> searchEntryHeap;
-    searchEntryHeap.resize (8);
+    // the root node is always a branch, even in an octree of depth zero
+    const unsigned int leafDepth = std::max (this->octreeDepth_, 1u);
 
-    unsigned char childIdx;
+    KNNStackEntry stack[KNN_STACK_SIZE];
+    size_t stackSize = 0;
 
-    OctreeKey newKey;
+    candidates.clear ();
 
-    double smallestSquaredDist = squaredSearchRadius;
+    stack[0].node = this->rootNode_;
+    stack[0].key.x = stack[0].key.y = stack[0].key.z = 0;
+    stack[0].depth = 0;
+    stack[0].value = 0.0;
+    stackSize = 1;
 
-    // get spatial voxel information
-    double voxelSquaredDiameter = this->getVoxelSquaredDiameter (treeDepth);
-
-    // iterate over all children
-    for (childIdx = 0; childIdx < 8; childIdx++)
+    while (stackSize > 0)
     {
-      if (this->branchHasChild (*node, childIdx))
-      {
-        PointT voxelCenter;
-
-        searchEntryHeap[childIdx].key.x = (key.x << 1) + (!!(childIdx & (1 << 2)));
-        searchEntryHeap[childIdx].key.y = (key.y << 1) + (!!(childIdx & (1 << 1)));
-        searchEntryHeap[childIdx].key.z = (key.z << 1) + (!!(childIdx & (1 << 0)));
+      const KNNStackEntry entry = stack[--stackSize];
 
-        // generate voxel center point for voxel at key
-        this->genVoxelCenterFromOctreeKey (searchEntryHeap[childIdx].key, treeDepth, voxelCenter);
+      // prune voxels farther away than the current K-th candidate
+      const double searchSquaredDist = (candidates.size () == K) ? candidates.front ().first : maxSquaredDist;
+      if (entry.value - this->epsilon_ > searchSquaredDist)
+        continue;
 
-        // generate new priority queue element
-        searchEntryHeap[childIdx].node = this->getBranchChild (*node, childIdx);
-        searchEntryHeap[childIdx].pointDistance = pointSquaredDist (voxelCenter, point);
-      }
-      else
+      if (entry.depth == leafDepth)
       {
-        searchEntryHeap[childIdx].pointDistance = numeric_limits<double>::infinity ();
-      }
-    }
+        // we reached leaf node level
+        const OctreeLeaf* leaf = static_cast<const OctreeLeaf*> (entry.node);
 
-    std::sort (searchEntryHeap.begin (), searchEntryHeap.end ());
+        leafIndices.clear ();
+        leaf->getData (leafIndices);
 
-    // iterate over all children in priority queue
-    // check if the distance to seach candidate is smaller than the best point distance (smallestSquaredDist)
-    while ((!searchEntryHeap.empty ())
-        && (searchEntryHeap.back ().pointDistance
-            < smallestSquaredDist + voxelSquaredDiameter / 4.0 + sqrt (smallestSquaredDist * voxelSquaredDiameter)
-                - this->epsilon_))
-    {
-      const OctreeNode* childNode;
+        for (size_t i = 0; i < leafIndices.size (); i++)
+        {
+          const double squaredDist = pointSquaredDist (this->getPointByIndex (leafIndices[i]), point);
 
-      // read from priority queue element
-      childNode = searchEntryHeap.back ().node;
-      newKey = searchEntryHeap.back ().key;
+          if (candidates.size () < K)
+          {
+            if (squaredDist > maxSquaredDist)
+              continue;
 
-      if (treeDepth < this->octreeDepth_)
-      {
-        // we have not reached maximum tree depth
-        smallestSquaredDist = getKNearestNeighborRecursive (point, K, (OctreeBranch*)childNode, newKey, treeDepth + 1,
-                                                            smallestSquaredDist, pointCandidates);
+            candidates.push_back (KNNCandidate (squaredDist, leafIndices[i]));
+            std::push_heap (candidates.begin (), candidates.end ());
+          }
+          else if (squaredDist < candidates.front ().first)
+          {
+            std::pop_heap (candidates.begin (), candidates.end ());
+            candidates.back () = KNNCandidate (squaredDist, leafIndices[i]);
+            std::push_heap (candidates.begin (), candidates.end ());
+          }
+        }
+        continue;
       }
-      else
+
+      // push children so that the closest voxel is visited next
+      const OctreeBranch* branch = static_cast<const OctreeBranch*> (entry.node);
+      const size_t segmentBegin = stackSize;
+      for (unsigned char childIdx = 0; childIdx < 8; childIdx++)
       {
-        // we reached leaf node level
+        if (!this->branchHasChild (*branch, childIdx))
+          continue;
 
-        double squaredDist;
-        size_t i;
-        vector<int> decodedPointVector;
+        KNNStackEntry& child = stack[stackSize];
+        child.key.x = (entry.key.x << 1) | (!!(childIdx & (1 << 2)));
+        child.key.y = (entry.key.y << 1) | (!!(childIdx & (1 << 1)));
+        child.key.z = (entry.key.z << 1) | (!!(childIdx & (1 << 0)));
+        child.depth = entry.depth + 1;
+        child.value = voxelSquaredDist (point, child.key, child.depth);
 
-        OctreeLeaf* childLeaf = (OctreeLeaf*)childNode;
+        if (child.value - this->epsilon_ > searchSquaredDist)
+          continue;
 
-        // decode leaf node into decodedPointVector
-        childLeaf->getData (decodedPointVector);
+        child.node = this->getBranchChild (*branch, childIdx);
+        stackSize++;
+      }
+      std::sort (stack + segmentBegin, stack + stackSize);
+    }
 
-        // Linearly iterate over all decoded (unsorted) points
-        for (i = 0; i < decodedPointVector.size (); i++)
-        {
+    std::sort_heap (candidates.begin (), candidates.end ());
+  }
 
-          const PointT& candidatePoint = this->getPointByIndex (decodedPointVector[i]);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename OctreeT>
+  double
+  pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::voxelSquaredDist (const PointT& point,
+                                                                                 const OctreeKey& key,
+                                                                                 unsigned int treeDepth) const
+  {
+    // calculate voxel size of current tree depth
+    const double voxelSideLen = std::ldexp (this->resolution_, (int)this->octreeDepth_ - (int)treeDepth);
 
-          // calculate point distance to search point
-          squaredDist = pointSquaredDist (candidatePoint, point);
+    const double minCoord[3] = {key.x * voxelSideLen + this->minX_, key.y * voxelSideLen + this->minY_,
+                                key.z * voxelSideLen + this->minZ_};
+    const double pointCoord[3] = {point.x, point.y, point.z};
 
-          // check if a closer match is found
-          if (squaredDist < smallestSquaredDist)
-          {
-            prioPointQueueEntry pointEntry;
+    double squaredDist = 0.0;
+    for (int i = 0; i < 3; i++)
+    {
+      double dist = 0.0;
+      if (pointCoord[i] < minCoord[i])
+        dist = minCoord[i] - pointCoord[i];
+      else if (pointCoord[i] > minCoord[i] + voxelSideLen)
+        dist = pointCoord[i] - (minCoord[i] + voxelSideLen);
+      squaredDist += dist * dist;
+    }
 
-            pointEntry.pointDistance_ = squaredDist;
-            pointEntry.pointIdx_ = decodedPointVector[i];
-            pointCandidates.push_back (pointEntry);
-          }
-        }
+    return (squaredDist);
+  }
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafT, typename OctreeT>
+  uint64_t
+  pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::genMortonCode (const PointT& point) const
+  {
+    PointT clampedPoint;
+    clampedPoint.x = std::min (std::max (point.x, (float)this->minX_), (float)this->maxX_);
+    clampedPoint.y = std::min (std::max (point.y, (float)this->minY_), (float)this->maxY_);
+    clampedPoint.z = std::min (std::max (point.z, (float)this->minZ_), (float)this->maxZ_);
 
-        std::sort (pointCandidates.begin (), pointCandidates.end ());
+    OctreeKey key;
+    this->genOctreeKeyforPoint (clampedPoint, key);
 
-        if (pointCandidates.size () > K)
-          pointCandidates.resize (K);
+    // keep the 21 most significant key bits
+    const unsigned int shift = (this->octreeDepth_ > 21) ? this->octreeDepth_ - 21 : 0;
+    const unsigned int bitCount = this->octreeDepth_ - shift;
 
-        if (pointCandidates.size () == K)
-          smallestSquaredDist = pointCandidates.back ().pointDistance_;
-      }
-      // pop element from priority queue
-      searchEntryHeap.pop_back ();
+    // interleave bits, x first, like the child index of octree branches
+    uint64_t code = 0;
+    for (unsigned int bit = bitCount; bit-- > 0; )
+    {
+      code = (code << 3) | ((uint64_t)((key.x >> (bit + shift)) & 1) << 2)
+          | ((uint64_t)((key.y >> (bit + shift)) & 1) << 1) | (uint64_t)((key.z >> (bit + shift)) & 1);
     }
 
-    return (smallestSquaredDist);
+    return (code);
   }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -605,23 +713,15 @@ template<typename PointT, typename LeafT, typename OctreeT>
     pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::getIntersectedVoxelCenters (
         Eigen::Vector3f origin, Eigen::Vector3f direction, AlignedPointTVector &voxelCenterList) const
     {
-      OctreeKey key;
-      key.x = key.y = key.z = 0;
-
-      voxelCenterList.clear ();
-
-      // Voxel childIdx remapping
-      unsigned char a = 0;
+      std::vector<IntersectedVoxel> voxels;
+      this->getIntersectedVoxels (origin, direction, numeric_limits<double>::max (), numeric_limits<int>::max (),
+                                  voxels);
 
-      double minX, minY, minZ, maxX, maxY, maxZ;
+      voxelCenterList.resize (voxels.size ());
+      for (size_t i = 0; i < voxels.size (); i++)
+        this->genLeafNodeCenterFromOctreeKey (voxels[i].key, voxelCenterList[i]);
 
-      initIntersectedVoxel (origin, direction, minX, minY, minZ, maxX, maxY, maxZ, a);
-
-      if (max (max (minX, minY), minZ) < min (min (maxX, maxY), maxZ))
-        return getIntersectedVoxelCentersRecursive (minX, minY, minZ, maxX, maxY, maxZ, a, this->rootNode_, key,
-                                                    voxelCenterList);
-
-      return (0);
+      return (static_cast<int> (voxels.size ()));
     }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -630,261 +730,60 @@ template<typename PointT, typename LeafT, typename OctreeT>
     pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::getIntersectedVoxelIndices (
         Eigen::Vector3f origin, Eigen::Vector3f direction, std::vector<int> &k_indices) const
     {
-      OctreeKey key;
-      key.x = key.y = key.z = 0;
+      std::vector<IntersectedVoxel> voxels;
+      this->getIntersectedVoxels (origin, direction, numeric_limits<double>::max (), numeric_limits<int>::max (),
+                                  voxels);
 
       k_indices.clear ();
+      for (size_t i = 0; i < voxels.size (); i++)
+        voxels[i].leaf->getData (k_indices);
 
-      // Voxel childIdx remapping
-      unsigned char a = 0;
-      double minX, minY, minZ, maxX, maxY, maxZ;
-
-      initIntersectedVoxel (origin, direction, minX, minY, minZ, maxX, maxY, maxZ, a);
-
-      if (max (max (minX, minY), minZ) < min (min (maxX, maxY), maxZ))
-        return getIntersectedVoxelIndicesRecursive (minX, minY, minZ, maxX, maxY, maxZ, a, this->rootNode_, key,
-                                                    k_indices);
-      return (0);
+      return (static_cast<int> (voxels.size ()));
     }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
   template<typename PointT, typename LeafT, typename OctreeT>
-    int
-    pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::getIntersectedVoxelCentersRecursive (
-        double minX, double minY, double minZ, double maxX, double maxY, double maxZ, unsigned char a,
-        const OctreeNode* node, const OctreeKey& key, AlignedPointTVector &voxelCenterList) const
+    void
+    pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::getIntersectedVoxelCenters (
+        const std::vector<Eigen::Vector3f> &origins, const std::vector<Eigen::Vector3f> &directions,
+        AlignedPointTVector &voxelCenterList, std::vector<int> &rayOffsets, bool firstHitOnly) const
     {
-      if (maxX < 0.0 || maxY < 0.0 || maxZ < 0.0)
-        return (0);
-
-      // If leaf node, get voxel center and increment intersection count
-      if (node->getNodeType () == LEAF_NODE)
-      {
-        PointT newPoint;
-
-        this->genLeafNodeCenterFromOctreeKey (key, newPoint);
-
-        voxelCenterList.push_back (newPoint);
-
-        return (1);
-      }
-
-      // Voxel intersection count for branches children
-      int voxelCount = 0;
-
-      // Voxel mid lines
-      double midX = 0.5 * (minX + maxX);
-      double midY = 0.5 * (minY + maxY);
-      double midZ = 0.5 * (minZ + maxZ);
-
-      // First voxel node ray will intersect
-      int currNode = getFirstIntersectedNode (minX, minY, minZ, midX, midY, midZ);
-
-      // Child index, node and key
-      unsigned char childIdx;
-      const OctreeNode *childNode;
-      OctreeKey childKey;
-
-      do
-      {
-        if (currNode != 0)
-          childIdx = currNode ^ a;
-        else
-          childIdx = a;
-
-        // childNode == 0 if childNode doesn't exist
-        childNode = this->getBranchChild ((OctreeBranch&)*node, childIdx);
+      std::vector<IntersectedVoxel> voxels;
+      this->getIntersectedVoxels (origins, directions, numeric_limits<double>::max (),
+                                  firstHitOnly ? 1 : numeric_limits<int>::max (), voxels, rayOffsets);
 
-        // Generate new key for current branch voxel
-        childKey.x = (key.x << 1) | (!!(childIdx & (1 << 2)));
-        childKey.y = (key.y << 1) | (!!(childIdx & (1 << 1)));
-        childKey.z = (key.z << 1) | (!!(childIdx & (1 << 0)));
+      voxelCenterList.resize (voxels.size ());
 
-        // Recursively call each intersected child node, selecting the next
-        //   node intersected by the ray.  Children that do not intersect will
-        //   not be traversed.
-
-        switch (currNode)
-        {
-          case 0:
-            if (childNode)
-              voxelCount += getIntersectedVoxelCentersRecursive (minX, minY, minZ, midX, midY, midZ, a, childNode,
-                                                                 childKey, voxelCenterList);
-            currNode = getNextIntersectedNode (midX, midY, midZ, 4, 2, 1);
-            break;
-
-          case 1:
-            if (childNode)
-              voxelCount += getIntersectedVoxelCentersRecursive (minX, minY, midZ, midX, midY, maxZ, a, childNode,
-                                                                 childKey, voxelCenterList);
-            currNode = getNextIntersectedNode (midX, midY, maxZ, 5, 3, 8);
-            break;
-
-          case 2:
-            if (childNode)
-              voxelCount += getIntersectedVoxelCentersRecursive (minX, midY, minZ, midX, maxY, midZ, a, childNode,
-                                                                 childKey, voxelCenterList);
-            currNode = getNextIntersectedNode (midX, maxY, midZ, 6, 8, 3);
-            break;
-
-          case 3:
-            if (childNode)
-              voxelCount += getIntersectedVoxelCentersRecursive (minX, midY, midZ, midX, maxY, maxZ, a, childNode,
-                                                                 childKey, voxelCenterList);
-            currNode = getNextIntersectedNode (midX, maxY, maxZ, 7, 8, 8);
-            break;
-
-          case 4:
-            if (childNode)
-              voxelCount += getIntersectedVoxelCentersRecursive (midX, minY, minZ, maxX, midY, midZ, a, childNode,
-                                                                 childKey, voxelCenterList);
-            currNode = getNextIntersectedNode (maxX, midY, midZ, 8, 6, 5);
-            break;
-
-          case 5:
-            if (childNode)
-              voxelCount += getIntersectedVoxelCentersRecursive (midX, minY, midZ, maxX, midY, maxZ, a, childNode,
-                                                                 childKey, voxelCenterList);
-            currNode = getNextIntersectedNode (maxX, midY, maxZ, 8, 7, 8);
-            break;
-
-          case 6:
-            if (childNode)
-              voxelCount += getIntersectedVoxelCentersRecursive (midX, midY, minZ, maxX, maxY, midZ, a, childNode,
-                                                                 childKey, voxelCenterList);
-            currNode = getNextIntersectedNode (maxX, maxY, midZ, 8, 8, 7);
-            break;
-
-          case 7:
-            if (childNode)
-              voxelCount += getIntersectedVoxelCentersRecursive (midX, midY, midZ, maxX, maxY, maxZ, a, childNode,
-                                                                 childKey, voxelCenterList);
-            currNode = 8;
-            break;
-        }
-      } while (currNode < 8);
-      return (voxelCount);
+#pragma omp parallel for schedule (static) num_threads (this->threads_)
+      for (int i = 0; i < static_cast<int> (voxels.size ()); i++)
+        this->genLeafNodeCenterFromOctreeKey (voxels[i].key, voxelCenterList[i]);
     }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
   template<typename PointT, typename LeafT, typename OctreeT>
-    int
-    pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::getIntersectedVoxelIndicesRecursive (
-        double minX, double minY, double minZ, double maxX, double maxY, double maxZ, unsigned char a,
-        const OctreeNode* node, const OctreeKey& key, std::vector<int> &k_indices) const
+    void
+    pcl::octree::OctreePointCloudSearch<PointT, LeafT, OctreeT>::getIntersectedVoxelIndices (
+        const std::vector<Eigen::Vector3f> &origins, const std::vector<Eigen::Vector3f> &directions,
+        std::vector<int> &k_indices, std::vector<int> &rayOffsets, bool firstHitOnly) const
     {
-      if (maxX < 0.0 || maxY < 0.0 || maxZ < 0.0)
-        return (0);
+      std::vector<IntersectedVoxel> voxels;
+      this->getIntersectedVoxels (origins, directions, numeric_limits<double>::max (),
+                                  firstHitOnly ? 1 : numeric_limits<int>::max (), voxels, rayOffsets);
 
-      // If leaf node, get voxel center and increment intersection count
-      if (node->getNodeType () == LEAF_NODE)
+      // rayOffsets address voxels, translate them to point indices
+      k_indices.clear ();
+      int voxelBegin = 0;
+      for (size_t ray = 0; ray + 1 < rayOffsets.size (); ray++)
       {
-        OctreeLeaf* leaf = (OctreeLeaf*)node;
-        vector<int> indices;
+        const int voxelEnd = rayOffsets[ray + 1];
+        rayOffsets[ray] = static_cast<int> (k_indices.size ());
 
-        // decode leaf node into decodedPointVector
-        leaf->getData (indices);
-        for (size_t i = 0; i < indices.size (); i++)
-        {
-          k_indices.push_back (indices[i]);
-        }
+        for (int i = voxelBegin; i < voxelEnd; i++)
+          voxels[i].leaf->getData (k_indices);
 
-        return (1);
+        voxelBegin = voxelEnd;
       }
-
-      // Voxel intersection count for branches children
-      int voxelCount = 0;
-
-      // Voxel mid lines
-      double midX = 0.5 * (minX + maxX);
-      double midY = 0.5 * (minY + maxY);
-      double midZ = 0.5 * (minZ + maxZ);
-
-      // First voxel node ray will intersect
-      int currNode = getFirstIntersectedNode (minX, minY, minZ, midX, midY, midZ);
-
-      // Child index, node and key
-      unsigned char childIdx;
-      const OctreeNode *childNode;
-      OctreeKey childKey;
-      do
-      {
-        if (currNode != 0)
-          childIdx = currNode ^ a;
-        else
-          childIdx = a;
-
-        // childNode == 0 if childNode doesn't exist
-        childNode = this->getBranchChild ((OctreeBranch&)*node, childIdx);
-        // Generate new key for current branch voxel
-        childKey.x = (key.x << 1) | (!!(childIdx & (1 << 2)));
-        childKey.y = (key.y << 1) | (!!(childIdx & (1 << 1)));
-        childKey.z = (key.z << 1) | (!!(childIdx & (1 << 0)));
-
-        // Recursively call each intersected child node, selecting the next
-        //   node intersected by the ray.  Children that do not intersect will
-        //   not be traversed.
-        switch (currNode)
-        {
-          case 0:
-            if (childNode)
-              voxelCount += getIntersectedVoxelIndicesRecursive (minX, minY, minZ, midX, midY, midZ, a, childNode,
-                                                                 childKey, k_indices);
-            currNode = getNextIntersectedNode (midX, midY, midZ, 4, 2, 1);
-            break;
-
-          case 1:
-            if (childNode)
-              voxelCount += getIntersectedVoxelIndicesRecursive (minX, minY, midZ, midX, midY, maxZ, a, childNode,
-                                                                 childKey, k_indices);
-            currNode = getNextIntersectedNode (midX, midY, maxZ, 5, 3, 8);
-            break;
-
-          case 2:
-            if (childNode)
-              voxelCount += getIntersectedVoxelIndicesRecursive (minX, midY, minZ, midX, maxY, midZ, a, childNode,
-                                                                 childKey, k_indices);
-            currNode = getNextIntersectedNode (midX, maxY, midZ, 6, 8, 3);
-            break;
-
-          case 3:
-            if (childNode)
-              voxelCount += getIntersectedVoxelIndicesRecursive (minX, midY, midZ, midX, maxY, maxZ, a, childNode,
-                                                                 childKey, k_indices);
-            currNode = getNextIntersectedNode (midX, maxY, maxZ, 7, 8, 8);
-            break;
-
-          case 4:
-            if (childNode)
-              voxelCount += getIntersectedVoxelIndicesRecursive (midX, minY, minZ, maxX, midY, midZ, a, childNode,
-                                                                 childKey, k_indices);
-            currNode = getNextIntersectedNode (maxX, midY, midZ, 8, 6, 5);
-            break;
-
-          case 5:
-            if (childNode)
-              voxelCount += getIntersectedVoxelIndicesRecursive (midX, minY, midZ, maxX, midY, maxZ, a, childNode,
-                                                                 childKey, k_indices);
-            currNode = getNextIntersectedNode (maxX, midY, maxZ, 8, 7, 8);
-            break;
-
-          case 6:
-            if (childNode)
-              voxelCount += getIntersectedVoxelIndicesRecursive (midX, midY, minZ, maxX, maxY, midZ, a, childNode,
-                                                                 childKey, k_indices);
-            currNode = getNextIntersectedNode (maxX, maxY, midZ, 8, 8, 7);
-            break;
-
-          case 7:
-            if (childNode)
-              voxelCount += getIntersectedVoxelIndicesRecursive (midX, midY, midZ, maxX, maxY, maxZ, a, childNode,
-                                                                 childKey, k_indices);
-            currNode = 8;
-            break;
-        }
-      } while (currNode < 8);
-
-      return (voxelCount);
+      rayOffsets.back () = static_cast<int> (k_indices.size ());
     }
 
 #endif    // PCL_OCTREE_SEARCH_IMPL_H_
@@ -53,8 +53,10 @@
 #include <pcl/octree/octree_pointcloud_singlepoint.h>
 #include <pcl/octree/octree_pointcloud_pointvector.h>
 #include <pcl/octree/octree_pointcloud_changedetector.h>
+#include <pcl/octree/octree_pointcloud_streaming_changedetector.h>
 #include <pcl/octree/octree_pointcloud_voxelcentroid.h>
 
 #include <pcl/octree/octree_search.h>
+#include <pcl/octree/octree_pointcloud_linear.h>
 
 #endif
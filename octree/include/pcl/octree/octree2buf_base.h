@@ -39,9 +39,11 @@
 #ifndef OCTREE_TREE_2BUF_BASE_H
 #define OCTREE_TREE_2BUF_BASE_H
 
+#include <cstddef>
 #include <vector>
 
 #include "octree_nodes.h"
+#include "octree_node_pool.h"
 
 #include "octree_iterator.h"
 
@@ -62,7 +64,7 @@ namespace pcl
       * \ingroup octree
       * \author Julius Kammerl (julius@kammerl.de)
       */
-    template<typename DataT, typename LeafT = OctreeLeafDataT<DataT> >
+    template<typename DataT, typename LeafT = OctreeLeafDataT<DataT>, template<typename > class NodePoolT = OctreeNodePool>
     class Octree2BufBase
       {
 
@@ -99,7 +101,8 @@ namespace pcl
           leafCount_ = source.leafCount_;
           branchCount_ = source.branchCount_;
           objectCount_ = source.objectCount_;
-          rootNode_ = new (OctreeBranch) (*(source.rootNode_));
+          createBranch (rootNode_);
+          copyBranchRecursive (*(source.rootNode_), *rootNode_);
           depthMask_ = source.depthMask_;
           octreeDepth_ = source.octreeDepth_;
           bufferSelector_ = source.bufferSelector_;
@@ -107,6 +110,26 @@ namespace pcl
           treeDirtyFlag_ = source.treeDirtyFlag_;
         }
 
+        /** \brief Copy operator. The tree is deep copied into the node pools of this octree. */
+        inline Octree2BufBase&
+        operator = (const Octree2BufBase& source)
+        {
+          if (this != &source)
+          {
+            deleteTree ();
+            copyBranchRecursive (*(source.rootNode_), *rootNode_);
+            leafCount_ = source.leafCount_;
+            branchCount_ = source.branchCount_;
+            objectCount_ = source.objectCount_;
+            depthMask_ = source.depthMask_;
+            octreeDepth_ = source.octreeDepth_;
+            bufferSelector_ = source.bufferSelector_;
+            resetTree_ = source.resetTree_;
+            treeDirtyFlag_ = source.treeDirtyFlag_;
+          }
+          return (*this);
+        }
+
         /** \brief Set the maximum amount of voxels per dimension.
          *  \param maxVoxelIndex_arg: maximum amount of voxels per dimension
          * */
@@ -184,11 +207,21 @@ namespace pcl
         }
 
         /** \brief Delete the octree structure and its leaf nodes.
-         *  \param freeMemory_arg: if "true", allocated octree nodes are deleted, otherwise they are pushed to the octree node pool
+         *  \note All nodes of both buffers are returned to the node pools at once, the tree is not traversed.
+         *  \param freeMemory_arg: if "true", the memory of the node pools is freed, otherwise nodes are kept for reuse
          * */
         void
         deleteTree ( bool freeMemory_arg = false );
 
+        /** \brief Get the memory held by the octree node pools, including unused nodes.
+         *  \return memory usage in bytes
+         * */
+        inline std::size_t
+        getMemoryUsage () const
+        {
+          return (branchPool_.getMemoryUsage () + leafPool_.getMemoryUsage ());
+        }
+
         /** \brief Delete octree structure of previous buffer. */
         inline void
         deletePreviousBuffer ()
@@ -351,6 +384,13 @@ namespace pcl
           return this->rootNode_;
         }
 
+        /** \brief Check if the root node has any child nodes in the current or the previous buffer */
+        bool
+        rootHasChildren () const
+        {
+          return ((getBranchBitPattern (*rootNode_, 0) | getBranchBitPattern (*rootNode_, 1)) != 0);
+        }
+
         /** \brief Virtual method for generating an octree key for a given DataT object.
          *  \param data_arg: reference to DataT object
          *  \param key_arg: write generated octree key to this octree key reference
@@ -409,6 +449,13 @@ namespace pcl
           }
         }
 
+        /** \brief Add vector of DataT objects to vector of octree keys.
+         *  \param key_vector_arg: vector of octree keys addressing leaf nodes.
+         *  \param data_vector_arg: DataT objects to be added.
+         * */
+        void
+        add (const std::vector<OctreeKey>& key_vector_arg, const std::vector<DataT>& data_vector_arg);
+
         /** \brief Find leaf node
          *  \param key_arg: octree key addressing a leaf node.
          *  \return pointer to leaf node. If leaf node is not found, this pointer returns 0.
@@ -630,14 +677,14 @@ namespace pcl
                 // free child branch recursively
                 deleteBranch (*(OctreeBranch*)branchChild);
 
-                // push unused branch to branch pool
-                unusedBranchesPool_.push_back ((OctreeBranch*)branchChild);
+                // return unused branch to branch pool
+                branchPool_.release ((OctreeBranch*)branchChild);
               }
                 break;
 
               case LEAF_NODE:
-                // push unused leaf to branch pool
-                unusedLeafsPool_.push_back ((OctreeLeaf*)branchChild);
+                // return unused leaf to leaf pool
+                leafPool_.release ((OctreeLeaf*)branchChild);
                 break;
 
               default:
@@ -670,14 +717,14 @@ namespace pcl
                 // free child branch recursively
                 deleteBranch (*(OctreeBranch*)branchChild);
 
-                // push unused branch to branch pool
-                unusedBranchesPool_.push_back ((OctreeBranch*)branchChild);
+                // return unused branch to branch pool
+                branchPool_.release ((OctreeBranch*)branchChild);
               }
                 break;
 
               case LEAF_NODE:
-                // push unused leaf to branch pool
-                unusedLeafsPool_.push_back ((OctreeLeaf*)branchChild);
+                // return unused leaf to leaf pool
+                leafPool_.release ((OctreeLeaf*)branchChild);
                 break;
 
 	      default:
@@ -729,16 +776,7 @@ namespace pcl
         createBranchChild (OctreeBranch& branch_arg, const unsigned char childIdx_arg,
                            OctreeBranch*& newBranchChild_arg)
         {
-          if (!unusedBranchesPool_.size ())
-          {
-            newBranchChild_arg = (OctreeBranch*)new OctreeBranch ();
-          }
-          else
-          {
-            newBranchChild_arg = unusedBranchesPool_.back ();
-            unusedBranchesPool_.pop_back ();
-            branchReset (*newBranchChild_arg);
-          }
+          createBranch (newBranchChild_arg);
 
           setBranchChild (branch_arg, childIdx_arg, (OctreeNode*)newBranchChild_arg);
         }
@@ -749,20 +787,9 @@ namespace pcl
         inline void
         createBranch (OctreeBranch*& newBranchChild_arg)
         {
-
-          if (!unusedBranchesPool_.size ())
-          {
-            // branch pool is empty
-            // we need to create a new octree branch class
-            newBranchChild_arg = (OctreeBranch*)new OctreeBranch ();
-          }
-          else
-          {
-            // reuse branch from branch pool
-            newBranchChild_arg = unusedBranchesPool_.back ();
-            unusedBranchesPool_.pop_back ();
-            branchReset (*newBranchChild_arg);
-          }
+          // pooled branches may be reused
+          newBranchChild_arg = branchPool_.allocate ();
+          branchReset (*newBranchChild_arg);
         }
 
         /** \brief Fetch and add a new leaf child to a branch class
@@ -773,19 +800,8 @@ namespace pcl
         inline void
         createLeafChild (OctreeBranch& branch_arg, const unsigned char childIdx_arg, OctreeLeaf*& newLeafChild_arg)
         {
-          if (!unusedLeafsPool_.size ())
-          {
-            // leaf pool is empty
-            // we need to create a new octree leaf class
-            newLeafChild_arg = (OctreeLeaf*)new OctreeLeaf ();
-          }
-          else
-          {
-            // reuse leaf node from branch pool
-            newLeafChild_arg = unusedLeafsPool_.back ();
-            unusedLeafsPool_.pop_back ();
-          }
-
+          // pooled leaves may be reused
+          newLeafChild_arg = leafPool_.allocate ();
           newLeafChild_arg->reset ();
 
           setBranchChild (branch_arg, childIdx_arg, (OctreeNode*)newLeafChild_arg);
@@ -801,22 +817,52 @@ namespace pcl
         }
 
         /** \brief Delete all branch nodes and leaf nodes from octree node pools
+         *  \note Must only be called on an empty octree.
          * */
         inline void
         poolCleanUp ()
         {
-          // delete all branch instances from branch pool
-          while (!unusedBranchesPool_.empty ())
-          {
-            delete (unusedBranchesPool_.back ());
-            unusedBranchesPool_.pop_back ();
-          }
+          branchPool_.clear ();
+          leafPool_.clear ();
+        }
 
-          // delete all leaf instances from leaf pool
-          while (!unusedLeafsPool_.empty ())
+        /** \brief Recursively copy the child nodes of both buffers of a branch of another octree into a branch of
+         *  this octree. Child nodes referenced by both buffers are copied once.
+         *  \param source_arg: branch to copy from
+         *  \param target_arg: empty branch to copy to
+         * */
+        void
+        copyBranchRecursive (const OctreeBranch& source_arg, OctreeBranch& target_arg)
+        {
+          for (unsigned char b = 0; b < 2; b++)
           {
-            delete (unusedLeafsPool_.back ());
-            unusedLeafsPool_.pop_back ();
+            for (unsigned char childIdx = 0; childIdx < 8; childIdx++)
+            {
+              const OctreeNode* childNode = getBranchChild (source_arg, b, childIdx);
+              if (!childNode)
+                continue;
+
+              if ((b == 1) && (childNode == getBranchChild (source_arg, 0, childIdx)))
+              {
+                // reference was copied
+                setBranchChild (target_arg, 1, childIdx, getBranchChild (target_arg, 0, childIdx));
+                continue;
+              }
+
+              if (childNode->getNodeType () == BRANCH_NODE)
+              {
+                OctreeBranch* newBranch;
+                createBranch (newBranch);
+                setBranchChild (target_arg, b, childIdx, newBranch);
+                copyBranchRecursive (*(const OctreeBranch*)childNode, *newBranch);
+              }
+              else
+              {
+                OctreeLeaf* newLeaf = leafPool_.allocate ();
+                *newLeaf = *(const OctreeLeaf*)childNode;
+                setBranchChild (target_arg, b, childIdx, newLeaf);
+              }
+            }
           }
         }
 
@@ -1017,6 +1063,30 @@ namespace pcl
           return log (n_arg) / log (2.0);
         }
 
+        /** \brief Compare two octree keys by their position in depth-first (Morton) order.
+         *  \param keyA_arg: first octree key
+         *  \param keyB_arg: second octree key
+         *  \return "true" if keyA_arg is visited before keyB_arg
+         */
+        inline bool
+        octreeKeyMortonLess (const OctreeKey& keyA_arg, const OctreeKey& keyB_arg) const
+        {
+          const unsigned int diffX = keyA_arg.x ^ keyB_arg.x;
+          const unsigned int diffY = keyA_arg.y ^ keyB_arg.y;
+          const unsigned int diffZ = keyA_arg.z ^ keyB_arg.z;
+
+          // the axis with the most significant differing bit decides; x precedes y precedes z on equal bits
+          if ((diffX < diffY) && (diffX < (diffX ^ diffY)))
+          {
+            if ((diffY < diffZ) && (diffY < (diffY ^ diffZ)))
+              return (keyA_arg.z < keyB_arg.z);
+            return (keyA_arg.y < keyB_arg.y);
+          }
+          if ((diffX < diffZ) && (diffX < (diffX ^ diffZ)))
+            return (keyA_arg.z < keyB_arg.z);
+          return (keyA_arg.x < keyB_arg.x);
+        }
+
         /** \brief Test if octree is able to dynamically change its depth. This is required for adaptive bounding box adjustment.
          *  \return "false" - not resizeable due to XOR serialization
          **/
@@ -1046,11 +1116,11 @@ namespace pcl
         /** \brief Depth mask based on octree depth   **/
         unsigned int depthMask_;
 
-        /** \brief Vector pools of unused branch nodes   **/
-        std::vector<OctreeBranch*> unusedBranchesPool_;
+        /** \brief Pool of branch nodes   **/
+        NodePoolT<OctreeBranch> branchPool_;
 
-        /** \brief Vector pools of unused leaf nodes   **/
-        std::vector<LeafT*> unusedLeafsPool_;
+        /** \brief Pool of leaf nodes   **/
+        NodePoolT<LeafT> leafPool_;
 
         /** \brief Currently active octree buffer  **/
         unsigned char bufferSelector_;
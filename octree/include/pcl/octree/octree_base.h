@@ -43,6 +43,7 @@
 #include <vector>
 
 #include "octree_nodes.h"
+#include "octree_node_pool.h"
 
 #include "octree_iterator.h"
 
@@ -57,11 +58,13 @@ namespace pcl
      *  \note The tree depth defines the maximum amount of octree voxels / leaf nodes (should be initially defined).
      *  \note All leaf nodes are addressed by integer indices.
      *  \note Note: The tree depth equates to the bit length of the voxel indices.
+     *  \note Branch and leaf nodes are allocated from node pools of type NodePoolT, see OctreeNodePool.
      *  \ingroup octree
      *  \author Julius Kammerl (julius@kammerl.de)
      */
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT = OctreeLeafDataT<DataT>, typename OctreeBranchT = OctreeBranch >
+    template<typename DataT, typename LeafT = OctreeLeafDataT<DataT>, typename OctreeBranchT = OctreeBranch,
+             template<typename > class NodePoolT = OctreeNodePool>
     class OctreeBase
     {
 
@@ -99,11 +102,29 @@ namespace pcl
         leafCount_ = source.leafCount_;
         branchCount_ = source.branchCount_;
         objectCount_ = source.objectCount_;
-        rootNode_ = new (OctreeBranch) (*(source.rootNode_));
+        createBranch (rootNode_);
+        copyBranchRecursive (*(source.rootNode_), *rootNode_);
         depthMask_ = source.depthMask_;
         octreeDepth_ = source.octreeDepth_;
       }
 
+      /** \brief Copy operator. The tree is deep copied into the node pools of this octree. */
+      inline OctreeBase&
+      operator = (const OctreeBase& source)
+      {
+        if (this != &source)
+        {
+          deleteTree ();
+          copyBranchRecursive (*(source.rootNode_), *rootNode_);
+          leafCount_ = source.leafCount_;
+          branchCount_ = source.branchCount_;
+          objectCount_ = source.objectCount_;
+          depthMask_ = source.depthMask_;
+          octreeDepth_ = source.octreeDepth_;
+        }
+        return (*this);
+      }
+
       /** \brief Set the maximum amount of voxels per dimension.
        *  \param maxVoxelIndex_arg: maximum amount of voxels per dimension
        * */
@@ -181,11 +202,21 @@ namespace pcl
       }
 
       /** \brief Delete the octree structure and its leaf nodes.
-       *  \param freeMemory_arg: if "true", allocated octree nodes are deleted, otherwise they are pushed to the octree node pool
+       *  \note All nodes are returned to the node pools at once, the tree is not traversed.
+       *  \param freeMemory_arg: if "true", the memory of the node pools is freed, otherwise nodes are kept for reuse
        * */
       void
       deleteTree ( bool freeMemory_arg = false );
 
+      /** \brief Get the memory held by the octree node pools, including unused nodes.
+       *  \return memory usage in bytes
+       * */
+      inline std::size_t
+      getMemoryUsage () const
+      {
+        return (branchPool_.getMemoryUsage () + leafPool_.getMemoryUsage ());
+      }
+
       /** \brief Serialize octree into a binary output vector describing its branch node structure.
        *  \param binaryTreeOut_arg: reference to output vector for writing binary tree structure.
        * */
@@ -263,6 +294,13 @@ namespace pcl
         return this->rootNode_;
       }
 
+      /** \brief Check if the root node has any child nodes */
+      bool
+      rootHasChildren () const
+      {
+        return (getBranchBitPattern (*rootNode_) != 0);
+      }
+
       /** \brief Virtual method for generating an octree key for a given DataT object.
        *  \param data_arg: reference to DataT object
        *  \param key_arg: write generated octree key to this octree key reference
@@ -322,6 +360,9 @@ namespace pcl
       }
 
       /** \brief Add vector of DataT objects to vector of octree keys.
+       *  \note If the octree is empty and the keys are sorted in depth-first (Morton) order, the octree is built
+       *  bottom-up in a single pass without traversing from the root for every key. Otherwise, the elements are
+       *  added one by one. Both ways result in the same octree.
        *  \param key_vector_arg: vector of octree keys addressing leaf nodes.
        *  \param data_vector_arg: DataT objects to be added.
        * */
@@ -454,14 +495,14 @@ namespace pcl
             {
               // free child branch recursively
               deleteBranch (*(OctreeBranch*)branchChild);
-              // push unused branch to branch pool
-              unusedBranchesPool_.push_back ((OctreeBranch*)branchChild);
+              // return unused branch to branch pool
+              branchPool_.release ((OctreeBranch*)branchChild);
             }
             break;
 
             case LEAF_NODE:
-              // push unused leaf to branch pool
-              unusedLeafsPool_.push_back ((OctreeLeaf*)branchChild);
+              // return unused leaf to leaf pool
+              leafPool_.release ((OctreeLeaf*)branchChild);
               break;
               
             default:
@@ -494,19 +535,9 @@ namespace pcl
       inline void
       createBranch (OctreeBranch*& newBranchChild_arg)
       {
-        if (!unusedBranchesPool_.size ())
-        {
-          // branch pool is empty
-          // we need to create a new octree branch class
-          newBranchChild_arg = (OctreeBranch*)new OctreeBranch ();
-        }
-        else
-        {
-          // reuse branch from branch pool
-          newBranchChild_arg = unusedBranchesPool_.back ();
-          unusedBranchesPool_.pop_back ();
-          branchReset (*newBranchChild_arg);
-        }
+        // pooled branches may be reused
+        newBranchChild_arg = branchPool_.allocate ();
+        branchReset (*newBranchChild_arg);
       }
 
       /** \brief Create and add a new branch child to a branch class
@@ -530,20 +561,8 @@ namespace pcl
       inline void
       createLeafChild (OctreeBranch& branch_arg, const unsigned char childIdx_arg, OctreeLeaf*& newLeafChild_arg)
       {
-
-        if (!unusedLeafsPool_.size ())
-        {
-          // leaf pool is empty
-          // we need to create a new octree leaf class
-          newLeafChild_arg = (OctreeLeaf*)new OctreeLeaf ();
-        }
-        else
-        {
-          // reuse leaf node from branch pool
-          newLeafChild_arg = unusedLeafsPool_.back ();
-          unusedLeafsPool_.pop_back ();
-        }
-
+        // pooled leaves may be reused
+        newLeafChild_arg = leafPool_.allocate ();
         newLeafChild_arg->reset ();
 
         setBranchChild (branch_arg, childIdx_arg, (OctreeNode*)newLeafChild_arg);
@@ -559,22 +578,40 @@ namespace pcl
       }
 
       /** \brief Delete all branch nodes and leaf nodes from octree node pools
+       *  \note Must only be called on an empty octree.
        * */
       inline void
       poolCleanUp ()
       {
-        // delete all branch instances from branch pool
-        while (!unusedBranchesPool_.empty ())
-        {
-          delete (unusedBranchesPool_.back ());
-          unusedBranchesPool_.pop_back ();
-        }
+        branchPool_.clear ();
+        leafPool_.clear ();
+      }
 
-        // delete all leaf instances from leaf pool
-        while (!unusedLeafsPool_.empty ())
+      /** \brief Recursively copy the child nodes of a branch of another octree into a branch of this octree.
+       *  \param source_arg: branch to copy from
+       *  \param target_arg: empty branch to copy to
+       * */
+      void
+      copyBranchRecursive (const OctreeBranch& source_arg, OctreeBranch& target_arg)
+      {
+        for (unsigned char childIdx = 0; childIdx < 8; childIdx++)
         {
-          delete (unusedLeafsPool_.back ());
-          unusedLeafsPool_.pop_back ();
+          const OctreeNode* childNode = source_arg[childIdx];
+          if (!childNode)
+            continue;
+
+          if (childNode->getNodeType () == BRANCH_NODE)
+          {
+            OctreeBranch* newBranch;
+            createBranchChild (target_arg, childIdx, newBranch);
+            copyBranchRecursive (*(const OctreeBranch*)childNode, *newBranch);
+          }
+          else
+          {
+            OctreeLeaf* newLeaf;
+            createLeafChild (target_arg, childIdx, newLeaf);
+            *newLeaf = *(const OctreeLeaf*)childNode;
+          }
         }
       }
 
@@ -724,6 +761,30 @@ namespace pcl
       // Helpers
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+      /** \brief Compare two octree keys by their position in depth-first (Morton) order.
+       *  \param keyA_arg: first octree key
+       *  \param keyB_arg: second octree key
+       *  \return "true" if keyA_arg is visited before keyB_arg
+       */
+      inline bool
+      octreeKeyMortonLess (const OctreeKey& keyA_arg, const OctreeKey& keyB_arg) const
+      {
+        const unsigned int diffX = keyA_arg.x ^ keyB_arg.x;
+        const unsigned int diffY = keyA_arg.y ^ keyB_arg.y;
+        const unsigned int diffZ = keyA_arg.z ^ keyB_arg.z;
+
+        // the axis with the most significant differing bit decides; x precedes y precedes z on equal bits
+        if ((diffX < diffY) && (diffX < (diffX ^ diffY)))
+        {
+          if ((diffY < diffZ) && (diffY < (diffY ^ diffZ)))
+            return (keyA_arg.z < keyB_arg.z);
+          return (keyA_arg.y < keyB_arg.y);
+        }
+        if ((diffX < diffZ) && (diffX < (diffX ^ diffZ)))
+          return (keyA_arg.z < keyB_arg.z);
+        return (keyA_arg.x < keyB_arg.x);
+      }
+
       /** \brief Helper function to calculate the binary logarithm
        * \param n_arg: some value
        * \return binary logarithm (log2) of argument n_arg
@@ -765,11 +826,11 @@ namespace pcl
       /** \brief Octree depth */
       unsigned int octreeDepth_;
 
-      /** \brief Vector pools of unused branch nodes   **/
-      std::vector<OctreeBranch*> unusedBranchesPool_;
+      /** \brief Pool of branch nodes   **/
+      NodePoolT<OctreeBranch> branchPool_;
 
-      /** \brief Vector pools of unused leaf nodes   **/
-      std::vector<LeafT*> unusedLeafsPool_;
+      /** \brief Pool of leaf nodes   **/
+      NodePoolT<LeafT> leafPool_;
 
       };
   }
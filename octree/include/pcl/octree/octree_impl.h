@@ -50,5 +50,7 @@
 #include <pcl/octree/impl/octree_iterator.hpp>
 
 #include <pcl/octree/impl/octree_search.hpp>
+#include <pcl/octree/impl/octree_pointcloud_linear.hpp>
+#include <pcl/octree/impl/octree_pointcloud_streaming_changedetector.hpp>
 
 #endif
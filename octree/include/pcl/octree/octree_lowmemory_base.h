@@ -43,6 +43,7 @@
 #include <vector>
 
 #include "octree_nodes.h"
+#include "octree_node_pool.h"
 
 #include "octree_iterator.h"
 
@@ -55,11 +56,13 @@ namespace pcl
      *  \note The tree depth defines the maximum amount of octree voxels / leaf nodes (should be initially defined).
      *  \note All leaf nodes are addressed by integer indices.
      *  \note Note: The tree depth equates to the bit length of the voxel indices.
+     *  \note Branch and leaf nodes are allocated from node pools of type NodePoolT, see OctreeNodePool.
      *  \ingroup octree
      *  \author Julius Kammerl (julius@kammerl.de)
      */
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename DataT, typename LeafT = OctreeLeafDataT<DataT> >
+    template<typename DataT, typename LeafT = OctreeLeafDataT<DataT>,
+             template<typename > class NodePoolT = OctreeNodePool>
       class OctreeLowMemBase
       {
 
@@ -96,11 +99,29 @@ namespace pcl
         	leafCount_ = source.leafCount_;
         	branchCount_ = source.branchCount_;
         	objectCount_ = source.objectCount_;
-        	rootNode_ = new (OctreeBranch) (*(source.rootNode_));
+        	createBranch (rootNode_);
+        	copyBranchRecursive (*(source.rootNode_), *rootNode_);
         	depthMask_ = source.depthMask_;
         	octreeDepth_ = source.octreeDepth_;
         }
 
+        /** \brief Copy operator. The tree is deep copied into the node pools of this octree. */
+        inline OctreeLowMemBase&
+        operator = (const OctreeLowMemBase& source)
+        {
+          if (this != &source)
+          {
+            deleteTree ();
+            copyBranchRecursive (*(source.rootNode_), *rootNode_);
+            leafCount_ = source.leafCount_;
+            branchCount_ = source.branchCount_;
+            objectCount_ = source.objectCount_;
+            depthMask_ = source.depthMask_;
+            octreeDepth_ = source.octreeDepth_;
+          }
+          return (*this);
+        }
+
 
         /** \brief Set the maximum amount of voxels per dimension.
          *  \param maxVoxelIndex_arg: maximum amount of voxels per dimension
@@ -179,9 +200,20 @@ namespace pcl
         }
 
         /** \brief Delete the octree structure and its leaf nodes.
+         *  \param freeMemory_arg: if "true", the memory of the node pools is freed, otherwise nodes are kept for reuse
          * */
         void
-        deleteTree ( );
+        deleteTree (bool freeMemory_arg = false);
+
+        /** \brief Get the memory held by the octree node pools, including unused nodes.
+         *  \note Child pointer arrays of branch nodes are not included.
+         *  \return memory usage in bytes
+         * */
+        inline std::size_t
+        getMemoryUsage () const
+        {
+          return (branchPool_.getMemoryUsage () + leafPool_.getMemoryUsage ());
+        }
 
         /** \brief Serialize octree into a binary output vector describing its branch node structure.
          *  \param binaryTreeOut_arg: reference to output vector for writing binary tree structure.
@@ -337,6 +369,13 @@ namespace pcl
           return this->rootNode_;
         }
 
+        /** \brief Check if the root node has any child nodes */
+        bool
+        rootHasChildren () const
+        {
+          return (getBranchBitPattern (*rootNode_) != 0);
+        }
+
         /** \brief Virtual method for generating an octree key for a given DataT object.
          *  \param data_arg: reference to DataT object
          *  \param key_arg: write generated octree key to this octree key reference
@@ -637,17 +676,18 @@ namespace pcl
               case BRANCH_NODE:
                 // free child branch recursively
                 deleteBranch (*(OctreeBranch*)branchChild);
+                // return unused branch to branch pool
+                branchPool_.release ((OctreeBranch*)branchChild);
                 break;
               case LEAF_NODE:
+                // return unused leaf to leaf pool
+                leafPool_.release ((OctreeLeaf*)branchChild);
                 break;
               default:
 		break;
 
             }
 
-            // delete branch child
-            delete (branchChild);
-
             // set branch child pointer to 0
             setBranchChild (branch_arg, childIdx_arg, 0);
           }
@@ -674,10 +714,9 @@ namespace pcl
         inline void
         createBranch (OctreeBranch*& newBranchChild_arg)
         {
-
-          // we need to create a new octree branch class
-          newBranchChild_arg = (OctreeBranch*)new OctreeBranch ();
-
+          // pooled branches may be reused
+          newBranchChild_arg = branchPool_.allocate ();
+          branchReset (*newBranchChild_arg);
         }
 
         /** \brief Create and add a new branch child to a branch class
@@ -702,8 +741,8 @@ namespace pcl
         createLeafChild (OctreeBranch& branch_arg, const unsigned char childIdx_arg, OctreeLeaf*& newLeafChild_arg)
         {
 
-          // we need to create a new octree leaf class
-          newLeafChild_arg = (OctreeLeaf*)new OctreeLeaf ();
+          // pooled leaves may be reused
+          newLeafChild_arg = leafPool_.allocate ();
           newLeafChild_arg->reset();
 
           setBranchChild (branch_arg, childIdx_arg, (OctreeNode*)newLeafChild_arg);
@@ -719,6 +758,43 @@ namespace pcl
           branch_arg.reset();
         }
 
+        /** \brief Delete all branch nodes and leaf nodes from octree node pools
+         *  \note Must only be called on an empty octree.
+         * */
+        inline void
+        poolCleanUp ()
+        {
+          branchPool_.clear ();
+          leafPool_.clear ();
+        }
+
+        /** \brief Recursively copy the child nodes of a branch of another octree into a branch of this octree.
+         *  \param source_arg: branch to copy from
+         *  \param target_arg: empty branch to copy to
+         * */
+        void
+        copyBranchRecursive (const OctreeBranch& source_arg, OctreeBranch& target_arg)
+        {
+          for (unsigned char childIdx = 0; childIdx < 8; childIdx++)
+          {
+            if (!branchHasChild (source_arg, childIdx))
+              continue;
+
+            const OctreeNode* childNode = getBranchChild (source_arg, childIdx);
+            if (childNode->getNodeType () == BRANCH_NODE)
+            {
+              OctreeBranch* newBranch;
+              createBranchChild (target_arg, childIdx, newBranch);
+              copyBranchRecursive (*(const OctreeBranch*)childNode, *newBranch);
+            }
+            else
+            {
+              OctreeLeaf* newLeaf;
+              createLeafChild (target_arg, childIdx, newLeaf);
+              *newLeaf = *(const OctreeLeaf*)childNode;
+            }
+          }
+        }
 
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         // Recursive octree methods
@@ -908,11 +984,11 @@ namespace pcl
         /** \brief Octree depth */
         unsigned int octreeDepth_;
 
-        /** \brief Vector pools of unused branch nodes   **/
-        std::vector<OctreeBranch*> unusedBranchesPool_;
+        /** \brief Pool of branch nodes   **/
+        NodePoolT<OctreeBranch> branchPool_;
 
-        /** \brief Vector pools of unused leaf nodes   **/
-        std::vector<LeafT*> unusedLeafsPool_;
+        /** \brief Pool of leaf nodes   **/
+        NodePoolT<LeafT> leafPool_;
 
       };
   }
@@ -0,0 +1,104 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ */
+
+#ifndef PCL_OCTREE_MAPPED_FILE_H_
+#define PCL_OCTREE_MAPPED_FILE_H_
+
+#include <pcl/pcl_macros.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace pcl
+{
+  namespace octree
+  {
+    /** \brief @b Read-only memory mapping of a complete file
+      * \note The mapping is shared, i.e. several processes mapping the same file share the physical pages.
+      * \ingroup octree
+      */
+    class PCL_EXPORTS OctreeMappedFile : boost::noncopyable
+    {
+      public:
+        /** \brief Empty constructor. */
+        OctreeMappedFile ();
+
+        /** \brief Class destructor, unmaps the file. */
+        ~OctreeMappedFile ();
+
+        /** \brief Map a file read-only. A previously mapped file is unmapped first.
+          * \param[in] file_name the name of the file to map
+          * \return "true" on success; "false" otherwise
+          */
+        bool
+        open (const std::string& file_name);
+
+        /** \brief Unmap the file. */
+        void
+        close ();
+
+        /** \brief Get the start of the mapped file, NULL if no file is mapped. */
+        inline const char*
+        getData () const
+        {
+          return (data_);
+        }
+
+        /** \brief Get the size of the mapped file in bytes. */
+        inline std::size_t
+        getSize () const
+        {
+          return (size_);
+        }
+
+      protected:
+        /** \brief Start of the mapping. */
+        const char* data_;
+
+        /** \brief Size of the mapping in bytes. */
+        std::size_t size_;
+
+        /** \brief File mapping handle (Windows only). */
+        void* mapping_;
+    };
+  }
+}
+
+#endif    // PCL_OCTREE_MAPPED_FILE_H_
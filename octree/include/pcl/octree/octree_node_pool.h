@@ -0,0 +1,216 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ */
+
+#ifndef OCTREE_NODE_POOL_H
+#define OCTREE_NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace pcl
+{
+  namespace octree
+  {
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Slab allocator for octree nodes
+     * \note Nodes are carved from contiguous blocks of memory and are constructed on first use only. Released nodes
+     * are kept constructed and are handed out again by \a allocate - users are expected to reset them. All nodes can
+     * be released at once by \a releaseAll in O(1), \a clear destroys all nodes and returns the memory blocks to the
+     * system.
+     * \note typename: NodeT: octree node type, e.g. branch or leaf class
+     * \ingroup octree
+     */
+    template<typename NodeT>
+    class OctreeNodePool
+    {
+    public:
+
+      /** \brief Constructor.
+       *  \param blockSize_arg: amount of nodes per memory block
+       */
+      explicit
+      OctreeNodePool (std::size_t blockSize_arg = 1024) :
+        blockSize_ (blockSize_arg > 0 ? blockSize_arg : 1), blockCursor_ (0), nodeCursor_ (0)
+      {
+      }
+
+      /** \brief Destructor. Destroys all nodes and frees all memory blocks. */
+      ~OctreeNodePool ()
+      {
+        clear ();
+      }
+
+      /** \brief Get a node from the pool.
+       *  \return pointer to a released or newly constructed node
+       */
+      inline NodeT*
+      allocate ()
+      {
+        NodeT* node;
+
+        if (!freeNodes_.empty ())
+        {
+          // reuse released node
+          node = freeNodes_.back ();
+          freeNodes_.pop_back ();
+          return (node);
+        }
+
+        if (blockCursor_ == blocks_.size ())
+        {
+          // all blocks are in use - allocate a new one
+          Block block;
+          block.nodes = allocator_.allocate (blockSize_);
+          block.constructedCount = 0;
+          blocks_.push_back (block);
+        }
+
+        Block& block = blocks_[blockCursor_];
+        node = block.nodes + nodeCursor_;
+
+        // construct node on first use
+        if (nodeCursor_ == block.constructedCount)
+        {
+          new (node) NodeT ();
+          block.constructedCount++;
+        }
+
+        if (++nodeCursor_ == blockSize_)
+        {
+          blockCursor_++;
+          nodeCursor_ = 0;
+        }
+
+        return (node);
+      }
+
+      /** \brief Return a node to the pool.
+       *  \param node_arg: pointer to node that was handed out by \a allocate
+       */
+      inline void
+      release (NodeT* node_arg)
+      {
+        freeNodes_.push_back (node_arg);
+      }
+
+      /** \brief Return all nodes to the pool at once. Nodes keep their memory and state. */
+      inline void
+      releaseAll ()
+      {
+        freeNodes_.clear ();
+        blockCursor_ = 0;
+        nodeCursor_ = 0;
+      }
+
+      /** \brief Destroy all nodes and free all memory blocks. */
+      void
+      clear ()
+      {
+        for (std::size_t b = 0; b < blocks_.size (); b++)
+        {
+          for (std::size_t i = 0; i < blocks_[b].constructedCount; i++)
+            blocks_[b].nodes[i].~NodeT ();
+
+          allocator_.deallocate (blocks_[b].nodes, blockSize_);
+        }
+
+        blocks_.clear ();
+        std::vector<NodeT*> ().swap (freeNodes_);
+        blockCursor_ = 0;
+        nodeCursor_ = 0;
+      }
+
+      /** \brief Get the amount of nodes handed out by \a allocate and not released yet. */
+      inline std::size_t
+      getNodeCount () const
+      {
+        return (blockCursor_ * blockSize_ + nodeCursor_ - freeNodes_.size ());
+      }
+
+      /** \brief Get the amount of memory held by the pool in bytes. Memory allocated by the nodes themselves is not
+       *  accounted for.
+       */
+      inline std::size_t
+      getMemoryUsage () const
+      {
+        return (blocks_.capacity () * sizeof (Block) + blocks_.size () * blockSize_ * sizeof (NodeT)
+            + freeNodes_.capacity () * sizeof (NodeT*));
+      }
+
+    private:
+
+      /** \brief Pools are bound to their octree and cannot be copied. */
+      OctreeNodePool (const OctreeNodePool&);
+
+      OctreeNodePool&
+      operator= (const OctreeNodePool&);
+
+      /** \brief Contiguous memory block of nodes. */
+      struct Block
+      {
+        NodeT* nodes;
+        std::size_t constructedCount;
+      };
+
+      /** \brief Amount of nodes per memory block. */
+      std::size_t blockSize_;
+
+      /** \brief Memory blocks. */
+      std::vector<Block> blocks_;
+
+      /** \brief Block holding the next unused node. */
+      std::size_t blockCursor_;
+
+      /** \brief Position of the next unused node in its block. */
+      std::size_t nodeCursor_;
+
+      /** \brief Released nodes. */
+      std::vector<NodeT*> freeNodes_;
+
+      /** \brief Allocator for memory blocks, respects the alignment of nodes storing fixed-size Eigen types. */
+      Eigen::aligned_allocator<NodeT> allocator_;
+    };
+
+  }
+}
+
+#endif
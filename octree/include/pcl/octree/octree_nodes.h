@@ -314,7 +314,7 @@ namespace pcl
        *  \return reference to internal DataT Vector
        * */
       virtual const std::vector<DataT>&
-        getIdxVector ()
+        getIdxVector () const
       {
         return leafDataTVector_;
       }
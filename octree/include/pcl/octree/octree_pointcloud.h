@@ -209,7 +209,18 @@ namespace pcl
           return this->octreeDepth_;
         }
 
-        /** \brief Add points from input point cloud to octree. */
+        /** \brief Set the number of threads used to compute octree keys in addPointsFromInputCloud and to cast rays.
+          * \param[in] nr_threads the number of threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+        /** \brief Add points from input point cloud to octree.
+          * \note The octree keys of all points are computed up front, sorted by their Morton code and the octree is
+          * built bottom-up. The resulting octree is the same as when adding the points one by one.
+          * If the octree already holds nodes (e.g. the previous buffer of a double buffered octree) and has to grow,
+          * the points are added one by one instead.
+          */
         void
         addPointsFromInputCloud ();
 
@@ -443,6 +454,16 @@ namespace pcl
         void
         adoptBoundingBoxToPoint (const PointT& pointIdx_arg);
 
+        /** \brief Perform a single bounding box adaption step towards a point without modifying the octree nodes.
+          * \param[in] point_arg point that should be within bounding box
+          * \param[in] emptyTree_arg "true" if the octree does not contain any points
+          * \param[out] childIdx_arg child index of the previous root node below the new root node, in case the
+          * octree was grown by another level
+          * \return "true" if the bounding box was changed; "false" if the point fits into the bounding box
+          */
+        bool
+        adoptBoundingBoxStep (const PointT& point_arg, bool emptyTree_arg, unsigned char& childIdx_arg);
+
         /** \brief Generate octree key for voxel at a given point
           * \param[in] point_arg the point addressing a voxel
           * \param[out] key_arg write octree key to this reference
@@ -460,6 +481,20 @@ namespace pcl
         genOctreeKeyforPoint (const double pointX_arg, const double pointY_arg, const double pointZ_arg,
                               OctreeKey & key_arg) const;
 
+        /** \brief Extract the child indices of two consecutive tree levels from an octree key.
+          * \param[in] key_arg octree key
+          * \param[in] bit_arg key bit addressing the lower of both tree levels
+          * \return 6-bit digit of the Morton code of the octree key
+          */
+        inline unsigned int
+        getMortonDigit (const OctreeKey& key_arg, unsigned int bit_arg) const
+        {
+          const unsigned int x = key_arg.x >> bit_arg;
+          const unsigned int y = key_arg.y >> bit_arg;
+          const unsigned int z = key_arg.z >> bit_arg;
+          return (((x & 2) << 4) | ((y & 2) << 3) | ((z & 2) << 2) | ((x & 1) << 2) | ((y & 1) << 1) | (z & 1));
+        }
+
         /** \brief Virtual method for generating octree key for a given point index.
           * \note This method enables to assign indices to leaf nodes during octree deserialization.
           * \param[in] data_arg index value representing a point in the dataset given by \a setInputCloud
@@ -505,6 +540,217 @@ namespace pcl
                                           const OctreeKey& key_arg,
                                           std::vector<PointT, Eigen::aligned_allocator<PointT> > &voxelCenterList_arg) const;
 
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Ray casting
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Leaf node voxel intersected by a ray. */
+        struct IntersectedVoxel
+        {
+          /** \brief Octree key addressing the leaf node. */
+          OctreeKey key;
+
+          /** \brief Pointer to the leaf node. */
+          const OctreeLeaf* leaf;
+        };
+
+        /** \brief Cast many rays through the octree and collect the intersected leaf node voxels of each ray.
+          * \note Rays are grouped by the octant of their direction, so that consecutive rays visit the child nodes in
+          * the same order. Groups of rays are distributed over the threads set by \a setNumberOfThreads.
+          * \param[in] origins_arg ray origins
+          * \param[in] directions_arg ray direction vectors, one per ray origin
+          * \param[in] maxRayParam_arg only voxels entered before (origin + maxRayParam_arg * direction) are collected
+          * \param[in] maxVoxelCount_arg maximum number of voxels collected per ray
+          * \param[out] voxels_arg intersected voxels of all rays, ordered along each ray
+          * \param[out] rayOffsets_arg the voxels of ray i are found at [rayOffsets_arg[i], rayOffsets_arg[i + 1]) in
+          * \a voxels_arg
+          */
+        void
+        getIntersectedVoxels (const std::vector<Eigen::Vector3f>& origins_arg,
+                              const std::vector<Eigen::Vector3f>& directions_arg, double maxRayParam_arg,
+                              int maxVoxelCount_arg, std::vector<IntersectedVoxel>& voxels_arg,
+                              std::vector<int>& rayOffsets_arg) const;
+
+        /** \brief Cast a ray through the octree and append the intersected leaf node voxels to a vector.
+          * \param[in] origin_arg ray origin
+          * \param[in] direction_arg ray direction vector
+          * \param[in] maxRayParam_arg only voxels entered before (origin + maxRayParam_arg * direction) are collected
+          * \param[in] maxVoxelCount_arg maximum number of voxels collected
+          * \param[out] voxels_arg intersected voxels are appended to this vector, ordered along the ray
+          * \return number of intersected voxels
+          */
+        int
+        getIntersectedVoxels (Eigen::Vector3f origin_arg, Eigen::Vector3f direction_arg, double maxRayParam_arg,
+                              int maxVoxelCount_arg, std::vector<IntersectedVoxel>& voxels_arg) const;
+
+        /** \brief Recursively search the tree for all intersected leaf nodes.
+          * This algorithm is based off the paper An Efficient Parametric Algorithm for Octree Traversal:
+          * http://wscg.zcu.cz/wscg2000/Papers_2000/X31.pdf
+          * \param[in] minX octree nodes X coordinate of lower bounding box corner
+          * \param[in] minY octree nodes Y coordinate of lower bounding box corner
+          * \param[in] minZ octree nodes Z coordinate of lower bounding box corner
+          * \param[in] maxX octree nodes X coordinate of upper bounding box corner
+          * \param[in] maxY octree nodes Y coordinate of upper bounding box corner
+          * \param[in] maxZ octree nodes Z coordinate of upper bounding box corner
+          * \param[in] a child index remapping of the ray direction
+          * \param[in] node_arg current octree node to be explored
+          * \param[in] key_arg octree key addressing the current node
+          * \param[in] maxRayParam_arg only voxels entered before this ray parameter are collected
+          * \param[in] maxVoxelCount_arg maximum number of voxels collected below the current node
+          * \param[out] voxels_arg intersected voxels are appended to this vector
+          * \return number of voxels found
+          */
+        int
+        getIntersectedVoxelsRecursive (double minX, double minY, double minZ, double maxX, double maxY, double maxZ,
+                                       unsigned char a, const OctreeNode* node_arg, const OctreeKey& key_arg,
+                                       double maxRayParam_arg, int maxVoxelCount_arg,
+                                       std::vector<IntersectedVoxel>& voxels_arg) const;
+
+        /** \brief Initialize raytracing algorithm
+          * \param origin
+          * \param direction
+          * \param[in] minX octree nodes X coordinate of lower bounding box corner
+          * \param[in] minY octree nodes Y coordinate of lower bounding box corner
+          * \param[in] minZ octree nodes Z coordinate of lower bounding box corner
+          * \param[in] maxX octree nodes X coordinate of upper bounding box corner
+          * \param[in] maxY octree nodes Y coordinate of upper bounding box corner
+          * \param[in] maxZ octree nodes Z coordinate of upper bounding box corner
+          * \param a
+          */
+        inline void
+        initIntersectedVoxel (Eigen::Vector3f &origin, Eigen::Vector3f &direction,
+                              double &minX, double &minY, double &minZ,
+                              double &maxX, double &maxY, double &maxZ,
+                              unsigned char &a) const
+        {
+          // Account for division by zero when direction vector is 0.0
+          const double epsilon = 1e-10;
+          if (direction.x () == 0.0)
+            direction.x () = epsilon;
+          if (direction.y () == 0.0)
+            direction.y () = epsilon;
+          if (direction.z () == 0.0)
+            direction.z () = epsilon;
+
+          // Voxel childIdx remapping
+          a = 0;
+
+          // Handle negative axis direction vector
+          if (direction.x () < 0.0)
+          {
+            origin.x () = this->minX_ + this->maxX_ - origin.x ();
+            direction.x () = -direction.x ();
+            a |= 4;
+          }
+          if (direction.y () < 0.0)
+          {
+            origin.y () = this->minY_ + this->maxY_ - origin.y ();
+            direction.y () = -direction.y ();
+            a |= 2;
+          }
+          if (direction.z () < 0.0)
+          {
+            origin.z () = this->minZ_ + this->maxZ_ - origin.z ();
+            direction.z () = -direction.z ();
+            a |= 1;
+          }
+          minX = (this->minX_ - origin.x ()) / direction.x ();
+          maxX = (this->maxX_ - origin.x ()) / direction.x ();
+          minY = (this->minY_ - origin.y ()) / direction.y ();
+          maxY = (this->maxY_ - origin.y ()) / direction.y ();
+          minZ = (this->minZ_ - origin.z ()) / direction.z ();
+          maxZ = (this->maxZ_ - origin.z ()) / direction.z ();
+        }
+
+        /** \brief Find first child node ray will enter
+          * \param[in] minX octree nodes X coordinate of lower bounding box corner
+          * \param[in] minY octree nodes Y coordinate of lower bounding box corner
+          * \param[in] minZ octree nodes Z coordinate of lower bounding box corner
+          * \param[in] midX octree nodes X coordinate of bounding box mid line
+          * \param[in] midY octree nodes Y coordinate of bounding box mid line
+          * \param[in] midZ octree nodes Z coordinate of bounding box mid line
+          * \return the first child node ray will enter
+          */
+        inline int
+        getFirstIntersectedNode (double minX, double minY, double minZ, double midX, double midY, double midZ) const
+        {
+          int currNode = 0;
+
+          if (minX > minY)
+          {
+            if (minX > minZ)
+            {
+              // max(minX, minY, minZ) is minX. Entry plane is YZ.
+              if (midY < minX)
+                currNode |= 2;
+              if (midZ < minX)
+                currNode |= 1;
+            }
+            else
+            {
+              // max(minX, minY, minZ) is minZ. Entry plane is XY.
+              if (midX < minZ)
+                currNode |= 4;
+              if (midY < minZ)
+                currNode |= 2;
+            }
+          }
+          else
+          {
+            if (minY > minZ)
+            {
+              // max(minX, minY, minZ) is minY. Entry plane is XZ.
+              if (midX < minY)
+                currNode |= 4;
+              if (midZ < minY)
+                currNode |= 1;
+            }
+            else
+            {
+              // max(minX, minY, minZ) is minZ. Entry plane is XY.
+              if (midX < minZ)
+                currNode |= 4;
+              if (midY < minZ)
+                currNode |= 2;
+            }
+          }
+
+          return currNode;
+        }
+
+        /** \brief Get the next visited node given the current node upper
+          *   bounding box corner. This function accepts three float values, and
+          *   three int values. The function returns the ith integer where the
+          *   ith float value is the minimum of the three float values.
+          * \param[in] x current nodes X coordinate of upper bounding box corner
+          * \param[in] y current nodes Y coordinate of upper bounding box corner
+          * \param[in] z current nodes Z coordinate of upper bounding box corner
+          * \param[in] a next node if exit Plane YZ
+          * \param[in] b next node if exit Plane XZ
+          * \param[in] c next node if exit Plane XY
+          * \return the next child node ray will enter or 8 if exiting
+          */
+        inline int
+        getNextIntersectedNode (double x, double y, double z, int a, int b, int c) const
+        {
+          if (x < y)
+          {
+            if (x < z)
+              return a;
+            else
+              return c;
+          }
+          else
+          {
+            if (y < z)
+              return b;
+            else
+              return c;
+          }
+
+          return 0;
+        }
+
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         // Globals
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -535,6 +781,9 @@ namespace pcl
 
         /** \brief Flag indicating if octree has defined bounding box. */
         bool boundingBoxDefined_;
+
+        /** \brief The number of threads used to compute octree keys and to cast rays. */
+        unsigned int threads_;
     };
   }
 }
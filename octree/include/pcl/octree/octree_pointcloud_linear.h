@@ -0,0 +1,584 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ */
+
+#ifndef PCL_OCTREE_POINTCLOUD_LINEAR_H_
+#define PCL_OCTREE_POINTCLOUD_LINEAR_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include "octree_pointcloud.h"
+#include "octree_mapped_file.h"
+
+#include <boost/cstdint.hpp>
+
+#include <string>
+#include <vector>
+
+namespace pcl
+{
+  namespace octree
+  {
+    /** \brief @b Linear (pointer-free) octree for read-mostly point cloud search
+      * \note This class holds a frozen copy of a built OctreePointCloud. All nodes are stored in a single
+      * contiguous array in level order: the children of a branch are adjacent, sorted by their Morton code and
+      * addressed through an 8-bit child mask and the offset of the first child. The points are copied and
+      * reordered by leaf, so that every node covers a contiguous range of them.
+      * \note The tree is immutable; call freeze () again to rebuild it from a modified octree.
+      * \note A frozen tree can be stored as a binary image with saveImage (). mapImage () memory maps such an
+      * image and queries it in place, so that large prebuilt maps are available immediately and the mapped pages
+      * are shared between processes. Images are tied to the point type and the byte order of the writer.
+      * \note typename: PointT: type of point used in pointcloud
+      * \ingroup octree
+      */
+    template<typename PointT>
+    class OctreePointCloudLinear
+    {
+      public:
+        typedef pcl::PointCloud<PointT> PointCloud;
+        typedef boost::shared_ptr<PointCloud> PointCloudPtr;
+        typedef boost::shared_ptr<const PointCloud> PointCloudConstPtr;
+
+        typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
+        typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
+
+        typedef boost::shared_ptr<OctreePointCloudLinear<PointT> > Ptr;
+        typedef boost::shared_ptr<const OctreePointCloudLinear<PointT> > ConstPtr;
+
+        typedef std::vector<PointT, Eigen::aligned_allocator<PointT> > AlignedPointTVector;
+
+        /** \brief @b Linear octree node
+          * \note For branch nodes, \a childMask has bit i set if child i exists, and \a firstChild is the position
+          * of the first existing child in the node array. Leaf nodes have an empty child mask.
+          */
+        struct LinearNode
+        {
+          /** \brief Position of the first child node in the node array. */
+          unsigned int firstChild;
+          /** \brief First position of the points below this node in the reordered point array. */
+          unsigned int pointBegin;
+          /** \brief One past the last position of the points below this node in the reordered point array. */
+          unsigned int pointEnd;
+          /** \brief Bit pattern of existing child nodes. */
+          unsigned char childMask;
+        };
+
+        /** \brief Empty constructor. */
+        OctreePointCloudLinear () :
+          input_ (), input_indices_ (), nodes_ (), points_ (), indices_ (), mappedFile_ (), mappedNodes_ (NULL),
+          mappedPoints_ (NULL), mappedIndices_ (NULL), nodeCount_ (0), pointCount_ (0), leafCount_ (0),
+          octreeDepth_ (0), resolution_ (0.0), minX_ (0.0), minY_ (0.0), minZ_ (0.0), maxX_ (0.0), maxY_ (0.0),
+          maxZ_ (0.0)
+        {
+        }
+
+        /** \brief Empty class destructor. */
+        virtual
+        ~OctreePointCloudLinear ()
+        {
+        }
+
+        /** \brief Convert a built octree into its linear representation. The source octree is not modified
+          * and can be deleted afterwards.
+          * \param[in] octree_arg the octree to freeze. Its input cloud must stay valid only if the index based
+          * query methods of this class are used.
+          */
+        template<typename LeafT, typename OctreeT> void
+        freeze (const OctreePointCloud<PointT, LeafT, OctreeT> &octree_arg);
+
+        /** \brief Write the tree, the reordered points and their indices to a binary image file.
+          * \param[in] file_name the name of the image file
+          * \return "true" on success; "false" if the tree is empty or the file could not be written
+          */
+        bool
+        saveImage (const std::string& file_name) const;
+
+        /** \brief Memory map a binary image file written by saveImage () and query it in place. The file is
+          * mapped read-only and must not be modified while it is mapped. The mapping is released when another
+          * tree is frozen, mapped or loaded, or when the last copy of this object is destroyed.
+          * \param[in] file_name the name of the image file
+          * \return "true" on success; "false" if the file could not be mapped or is not a valid image for PointT
+          */
+        bool
+        mapImage (const std::string& file_name);
+
+        /** \brief Read a binary image file written by saveImage () into memory.
+          * \param[in] file_name the name of the image file
+          * \return "true" on success; "false" if the file could not be read or is not a valid image for PointT
+          */
+        bool
+        loadImage (const std::string& file_name);
+
+        /** \brief Check if the tree is queried in place from a memory mapped image. */
+        inline bool
+        isMapped () const
+        {
+          return (mappedFile_ != 0);
+        }
+
+        /** \brief Provide the input cloud used by the index based query methods. freeze () sets the input cloud
+          * of the source octree; trees read from an image have none.
+          * \param[in] cloud_arg the point cloud the octree point indices refer to
+          * \param[in] indices_arg optional indices the octree point indices are relative to
+          */
+        inline void
+        setInputCloud (const PointCloudConstPtr &cloud_arg, const IndicesConstPtr &indices_arg = IndicesConstPtr ())
+        {
+          input_ = cloud_arg;
+          input_indices_ = indices_arg;
+        }
+
+        /** \brief Search for neighbors within a voxel at given point
+          * \param[in] point point addressing a leaf node voxel
+          * \param[out] pointIdx_data the resultant indices of the neighboring voxel points
+          * \return "true" if leaf node exist; "false" otherwise
+          */
+        bool
+        voxelSearch (const PointT& point, std::vector<int>& pointIdx_data) const;
+
+        /** \brief Search for neighbors within a voxel at given point referenced by a point index
+          * \param[in] index the index in input cloud defining the query point
+          * \param[out] pointIdx_data the resultant indices of the neighboring voxel points
+          * \return "true" if leaf node exist; "false" otherwise
+          */
+        inline bool
+        voxelSearch (const int index, std::vector<int>& pointIdx_data) const
+        {
+          return (voxelSearch (getPointByIndex (index), pointIdx_data));
+        }
+
+        /** \brief Search for k-nearest neighbors at the query point.
+          * \param[in] cloud the point cloud data
+          * \param[in] index the index in \a cloud representing the query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        inline int
+        nearestKSearch (const PointCloud &cloud, int index, int k, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const
+        {
+          return (nearestKSearch (cloud.points[index], k, k_indices, k_sqr_distances));
+        }
+
+        /** \brief Search for k-nearest neighbors at given query point.
+          * \note Results are ordered like in OctreePointCloudSearch, i.e. the closest neighbor comes last.
+          * \param[in] p_q the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &p_q, int k, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for k-nearest neighbors at query point
+          * \param[in] index index representing the query point in the dataset of the frozen octree.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        inline int
+        nearestKSearch (int index, int k, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+        {
+          return (nearestKSearch (getPointByIndex (index), k, k_indices, k_sqr_distances));
+        }
+
+        /** \brief Search for all neighbors of query point that are within a given radius.
+          * \param[in] cloud the point cloud data
+          * \param[in] index the index in \a cloud representing the query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        inline int
+        radiusSearch (const PointCloud &cloud, int index, double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
+        {
+          return (radiusSearch (cloud.points[index], radius, k_indices, k_sqr_distances, max_nn));
+        }
+
+        /** \brief Search for all neighbors of query point that are within a given radius.
+          * \note Neighbors are returned in the same order as by OctreePointCloudSearch.
+          * \param[in] p_q the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT &p_q, const double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
+
+        /** \brief Search for all neighbors of query point that are within a given radius.
+          * \param[in] index index representing the query point in the dataset of the frozen octree.
+          * \param[in] radius radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        inline int
+        radiusSearch (int index, const double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
+        {
+          return (radiusSearch (getPointByIndex (index), radius, k_indices, k_sqr_distances, max_nn));
+        }
+
+        /** \brief Get indices of all voxels that are intersected by a ray (origin, direction).
+          * \param[in] origin ray origin
+          * \param[in] direction ray direction vector
+          * \param[out] k_indices resulting indices, ordered along the ray
+          * \return number of intersected voxels
+          */
+        int
+        getIntersectedVoxelIndices (Eigen::Vector3f origin, Eigen::Vector3f direction,
+                                    std::vector<int> &k_indices) const;
+
+        /** \brief Get the reordered point copies. Points of a leaf are stored contiguously, leaves follow in
+          * Morton order.
+          */
+        inline const PointT*
+        getPoints () const
+        {
+          return (mappedFile_ ? mappedPoints_ : (points_.empty () ? NULL : &points_[0]));
+        }
+
+        /** \brief Get the octree point indices corresponding to the reordered points. */
+        inline const int*
+        getPointIndices () const
+        {
+          return (mappedFile_ ? mappedIndices_ : (indices_.empty () ? NULL : &indices_[0]));
+        }
+
+        /** \brief Return the amount of reordered points. */
+        inline unsigned int
+        getPointCount () const
+        {
+          return (pointCount_);
+        }
+
+        /** \brief Get the linear node array. The root node is stored at position 0. */
+        inline const LinearNode*
+        getNodes () const
+        {
+          return (mappedFile_ ? mappedNodes_ : (nodes_.empty () ? NULL : &nodes_[0]));
+        }
+
+        /** \brief Return the amount of nodes. */
+        inline unsigned int
+        getNodeCount () const
+        {
+          return (nodeCount_);
+        }
+
+        /** \brief Return the amount of leaf nodes. */
+        inline unsigned int
+        getLeafCount () const
+        {
+          return (leafCount_);
+        }
+
+        /** \brief Return the amount of branch nodes. */
+        inline unsigned int
+        getBranchCount () const
+        {
+          return (nodeCount_ - leafCount_);
+        }
+
+        /** \brief Get the maximum depth of the octree. */
+        inline unsigned int
+        getTreeDepth () const
+        {
+          return (octreeDepth_);
+        }
+
+        /** \brief Get the octree resolution at lowest octree level. */
+        inline double
+        getResolution () const
+        {
+          return (resolution_);
+        }
+
+        /** \brief Get bounding box of the octree.
+          * \param[out] minX_arg X coordinate of lower bounding box corner
+          * \param[out] minY_arg Y coordinate of lower bounding box corner
+          * \param[out] minZ_arg Z coordinate of lower bounding box corner
+          * \param[out] maxX_arg X coordinate of upper bounding box corner
+          * \param[out] maxY_arg Y coordinate of upper bounding box corner
+          * \param[out] maxZ_arg Z coordinate of upper bounding box corner
+          */
+        inline void
+        getBoundingBox (double& minX_arg, double& minY_arg, double& minZ_arg,
+                        double& maxX_arg, double& maxY_arg, double& maxZ_arg) const
+        {
+          minX_arg = minX_; minY_arg = minY_; minZ_arg = minZ_;
+          maxX_arg = maxX_; maxY_arg = maxY_; maxZ_arg = maxZ_;
+        }
+
+        /** \brief Get the heap memory footprint of nodes, point copies and indices in bytes. Memory mapped
+          * images are not accounted.
+          */
+        inline size_t
+        getMemoryFootprint () const
+        {
+          return (nodes_.capacity () * sizeof (LinearNode) + points_.capacity () * sizeof (PointT)
+              + indices_.capacity () * sizeof (int));
+        }
+
+      protected:
+        /** \brief @b Traversal stack entry
+          * \note Holds a node position together with its depth, its octree key and a priority value.
+          */
+        struct StackEntry
+        {
+          unsigned int node;
+          unsigned int depth;
+          unsigned int x, y, z;
+          double value;
+
+          /** \brief Operator< for ordering entries by descending value, so that the smallest value is popped
+            * from the back of a sorted stack segment first.
+            */
+          bool
+          operator< (const StackEntry& rhs) const
+          {
+            return (value > rhs.value);
+          }
+        };
+
+        /** \brief @b Node of a single tree level during construction
+          * \note \a firstChild is relative to the next tree level.
+          */
+        struct LevelNode
+        {
+          unsigned int x, y, z;
+          unsigned int firstChild;
+          unsigned int pointBegin;
+          unsigned int pointEnd;
+          unsigned char childMask;
+        };
+
+        /** \brief @b Header of a binary image file
+          * \note The node, point and index sections follow at the given file offsets, aligned to
+          * imageAlignment bytes.
+          */
+        struct LinearImageHeader
+        {
+          char magic[8];
+          boost::uint32_t version;
+          boost::uint32_t byteOrder;
+          boost::uint32_t pointSize;
+          boost::uint32_t nodeSize;
+          boost::uint32_t octreeDepth;
+          boost::uint32_t leafCount;
+          boost::uint64_t nodeCount;
+          boost::uint64_t pointCount;
+          boost::uint64_t nodeOffset;
+          boost::uint64_t pointOffset;
+          boost::uint64_t indexOffset;
+          double resolution;
+          double minX, minY, minZ, maxX, maxY, maxZ;
+        };
+
+        /** \brief Current image format version. */
+        static const boost::uint32_t imageVersion = 1;
+
+        /** \brief Byte order marker of image files. */
+        static const boost::uint32_t imageByteOrder = 0x01020304;
+
+        /** \brief Alignment of the image sections in bytes. */
+        static const unsigned int imageAlignment = 64;
+
+        /** \brief Magic bytes at the start of image files. */
+        static inline const char*
+        imageMagic ()
+        {
+          return ("PCLLOCT");
+        }
+
+        /** \brief Round a file offset up to the image section alignment. */
+        static inline boost::uint64_t
+        alignImageOffset (boost::uint64_t offset_arg)
+        {
+          return ((offset_arg + imageAlignment - 1) / imageAlignment * imageAlignment);
+        }
+
+        /** \brief Release owned and mapped tree storage and the input cloud. */
+        void
+        releaseStorage ();
+
+        /** \brief Retrieve a query point from the input cloud of the frozen octree.
+          * \param[in] index_arg index of the point, relative to the octree indices if these were given
+          */
+        const PointT&
+        getPointByIndex (const unsigned int index_arg) const;
+
+        /** \brief Position of child \a childIdx_arg of a branch in the node array.
+          * \param[in] node_arg the branch node
+          * \param[in] childIdx_arg child index; the child must exist
+          */
+        inline unsigned int
+        getChildPosition (const LinearNode& node_arg, unsigned char childIdx_arg) const
+        {
+          unsigned int bits = node_arg.childMask & ((1u << childIdx_arg) - 1u);
+          // population count of the lower child bits
+          bits = bits - ((bits >> 1) & 0x55u);
+          bits = (bits & 0x33u) + ((bits >> 2) & 0x33u);
+          bits = (bits + (bits >> 4)) & 0x0Fu;
+          return (node_arg.firstChild + bits);
+        }
+
+        /** \brief Compute lower and upper corner of the voxel addressed by a stack entry.
+          * \param[in] entry_arg stack entry holding key and depth
+          * \param[out] min_pt lower voxel corner
+          * \param[out] max_pt upper voxel corner
+          */
+        inline void
+        genVoxelBounds (const StackEntry& entry_arg, Eigen::Vector3d& min_pt, Eigen::Vector3d& max_pt) const
+        {
+          const double side = resolution_ * static_cast<double> (1u << (octreeDepth_ - entry_arg.depth));
+          // keys are clamped to the last voxel, widen by one float epsilon to keep the bounds conservative
+          const double slack = side * std::numeric_limits<float>::epsilon ();
+          min_pt = Eigen::Vector3d (minX_ + entry_arg.x * side - slack,
+                                    minY_ + entry_arg.y * side - slack,
+                                    minZ_ + entry_arg.z * side - slack);
+          max_pt = Eigen::Vector3d (min_pt.x () + side + 2.0 * slack,
+                                    min_pt.y () + side + 2.0 * slack,
+                                    min_pt.z () + side + 2.0 * slack);
+        }
+
+        /** \brief Create the stack entry of a child voxel.
+          * \param[in] parent_arg stack entry of the parent branch
+          * \param[in] parentNode_arg the parent branch node
+          * \param[in] childIdx_arg child index
+          * \param[out] child_arg resulting child entry; its value is left uninitialized
+          */
+        inline void
+        genChildEntry (const StackEntry& parent_arg, const LinearNode& parentNode_arg, unsigned char childIdx_arg,
+                       StackEntry& child_arg) const
+        {
+          child_arg.node = getChildPosition (parentNode_arg, childIdx_arg);
+          child_arg.depth = parent_arg.depth + 1;
+          child_arg.x = (parent_arg.x << 1) | (!!(childIdx_arg & (1 << 2)));
+          child_arg.y = (parent_arg.y << 1) | (!!(childIdx_arg & (1 << 1)));
+          child_arg.z = (parent_arg.z << 1) | (!!(childIdx_arg & (1 << 0)));
+        }
+
+        /** \brief Helper function to calculate the squared distance between two points
+          * \param[in] pointA point A
+          * \param[in] pointB point B
+          * \return squared distance between point A and point B
+          */
+        inline double
+        pointSquaredDist (const PointT& pointA, const PointT& pointB) const
+        {
+          double distX = pointA.x - pointB.x;
+          double distY = pointA.y - pointB.y;
+          double distZ = pointA.z - pointB.z;
+          return (distX * distX + distY * distY + distZ * distZ);
+        }
+
+        /** \brief Squared distance between a point and the closest/farthest point of an axis aligned box.
+          * \param[in] point query point
+          * \param[in] min_pt lower box corner
+          * \param[in] max_pt upper box corner
+          * \param[out] maxSquaredDist squared distance to the farthest box corner
+          * \return squared distance to the box, 0 if the point is inside
+          */
+        double
+        boxSquaredDist (const PointT& point, const Eigen::Vector3d& min_pt, const Eigen::Vector3d& max_pt,
+                        double& maxSquaredDist) const;
+
+        /** \brief Input cloud of the frozen octree, used to resolve index based queries. */
+        PointCloudConstPtr input_;
+
+        /** \brief Indices of the frozen octree, used to resolve index based queries. */
+        IndicesConstPtr input_indices_;
+
+        /** \brief Node array in level order, root first. */
+        std::vector<LinearNode> nodes_;
+
+        /** \brief Point copies reordered by leaf. */
+        AlignedPointTVector points_;
+
+        /** \brief Octree point index of every reordered point. */
+        std::vector<int> indices_;
+
+        /** \brief Memory mapped image, shared between copies of this object. */
+        boost::shared_ptr<OctreeMappedFile> mappedFile_;
+
+        /** \brief Node array within the mapped image. */
+        const LinearNode* mappedNodes_;
+
+        /** \brief Reordered points within the mapped image. */
+        const PointT* mappedPoints_;
+
+        /** \brief Point indices within the mapped image. */
+        const int* mappedIndices_;
+
+        /** \brief Amount of nodes. */
+        unsigned int nodeCount_;
+
+        /** \brief Amount of reordered points. */
+        unsigned int pointCount_;
+
+        /** \brief Amount of leaf nodes. */
+        unsigned int leafCount_;
+
+        /** \brief Octree depth. */
+        unsigned int octreeDepth_;
+
+        /** \brief Octree resolution. */
+        double resolution_;
+
+        /** \brief Octree bounding box. */
+        double minX_, minY_, minZ_, maxX_, maxY_, maxZ_;
+    };
+  }
+}
+
+#define PCL_INSTANTIATE_OctreePointCloudLinear(T) template class PCL_EXPORTS pcl::octree::OctreePointCloudLinear<T>;
+
+#endif    // PCL_OCTREE_POINTCLOUD_LINEAR_H_
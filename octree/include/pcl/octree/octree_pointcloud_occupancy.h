@@ -39,6 +39,11 @@
 #ifndef OCTREE_OCCUPANCY_H
 #define OCTREE_OCCUPANCY_H
 
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
 #include "octree_pointcloud.h"
 
 #include "octree_base.h"
@@ -98,10 +103,10 @@ namespace pcl
         	OctreeKey key;
 
             // make sure bounding box is big enough
-            adoptBoundingBoxToPoint (point_arg);
+            this->adoptBoundingBoxToPoint (point_arg);
 
             // generate key
-            genOctreeKeyforPoint (point_arg, key);
+            this->genOctreeKeyforPoint (point_arg, key);
 
             // add point to octree at key
             this->add (key, 0);
@@ -125,6 +130,73 @@ namespace pcl
             }
         }
 
+        /** \brief Remove occupied voxels that are passed by the rays from a sensor origin to the points of a point cloud.
+         *  \note Voxels containing points of the point cloud are never removed. Rays are cast in parallel by the
+         *  threads set by \a setNumberOfThreads before the octree is modified.
+         *  \param origin_arg: sensor origin
+         *  \param cloud_arg:  input point cloud
+         *  \return number of removed voxels
+         * */
+        int carveFreeVoxelsFromCloud( const Eigen::Vector3f& origin_arg, PointCloudPtr cloud_arg ) {
+            typedef typename OctreePointCloud<PointT, LeafT, OctreeT>::IntersectedVoxel IntersectedVoxel;
+
+            std::vector<Eigen::Vector3f> origins;
+            std::vector<Eigen::Vector3f> directions;
+            std::vector<const LeafT*> endLeafs;
+            size_t i;
+
+            origins.reserve (cloud_arg->points.size ());
+            directions.reserve (cloud_arg->points.size ());
+
+            for (i = 0; i < cloud_arg->points.size (); i++)
+            {
+              const PointT& point = cloud_arg->points[i];
+
+              // check for NaNs
+              if ((point.x == point.x) && (point.y == point.y) && (point.z == point.z)) {
+                // rays end at the points
+                origins.push_back (origin_arg);
+                directions.push_back (Eigen::Vector3f (point.x, point.y, point.z) - origin_arg);
+
+                // voxels at the points remain occupied
+                if ((point.x >= this->minX_) && (point.x < this->maxX_) &&
+                    (point.y >= this->minY_) && (point.y < this->maxY_) &&
+                    (point.z >= this->minZ_) && (point.z < this->maxZ_))
+                {
+                  const LeafT* leaf = this->findLeafAtPoint (point);
+                  if (leaf)
+                    endLeafs.push_back (leaf);
+                }
+              }
+            }
+
+            std::vector<IntersectedVoxel> voxels;
+            std::vector<int> rayOffsets;
+            this->getIntersectedVoxels (origins, directions, 1.0, std::numeric_limits<int>::max (), voxels, rayOffsets);
+
+            std::sort (endLeafs.begin (), endLeafs.end ());
+
+            // collect each passed voxel once
+            std::vector<std::pair<const LeafT*, size_t> > freeLeafs;
+            for (i = 0; i < voxels.size (); i++)
+              if (!std::binary_search (endLeafs.begin (), endLeafs.end (), voxels[i].leaf))
+                freeLeafs.push_back (std::make_pair (voxels[i].leaf, i));
+
+            std::sort (freeLeafs.begin (), freeLeafs.end ());
+
+            int removedCount = 0;
+            for (i = 0; i < freeLeafs.size (); i++)
+            {
+              if ((i > 0) && (freeLeafs[i].first == freeLeafs[i - 1].first))
+                continue;
+
+              this->removeLeaf (voxels[freeLeafs[i].second].key);
+              removedCount++;
+            }
+
+            return (removedCount);
+        }
+
       };
   }
 
@@ -0,0 +1,314 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ */
+
+#ifndef PCL_OCTREE_POINTCLOUD_STREAMING_CHANGEDETECTOR_H_
+#define PCL_OCTREE_POINTCLOUD_STREAMING_CHANGEDETECTOR_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <vector>
+
+namespace pcl
+{
+  namespace octree
+  {
+    /** \brief @b Streaming voxel change detector for continuous monitoring
+      * \note Unlike OctreePointCloudChangeDetector, this class does not rebuild a tree per frame. It keeps a
+      * persistent per-voxel state on a fixed voxel grid inside a user defined bounding box and updates it with
+      * every incoming frame. A voxel is reported as appeared after it was observed in \a appearFrames frames
+      * (missed frames decrease its evidence again), and as disappeared after it was not observed for
+      * \a disappearFrames consecutive frames.
+      * \note The work done per frame is bounded by the number of points in the frame plus the number of voxels
+      * that expire in this frame; it does not depend on the amount of tracked voxels.
+      * \note addPoints () may be called concurrently from several threads while another thread runs
+      * finishFrame (). Points added during finishFrame () are accounted to the next frame.
+      * \note typename: PointT: type of point used in pointcloud
+      * \ingroup octree
+      */
+    template<typename PointT>
+    class OctreePointCloudStreamingChangeDetector
+    {
+      public:
+        typedef pcl::PointCloud<PointT> PointCloud;
+        typedef boost::shared_ptr<PointCloud> PointCloudPtr;
+        typedef boost::shared_ptr<const PointCloud> PointCloudConstPtr;
+
+        typedef boost::shared_ptr<OctreePointCloudStreamingChangeDetector<PointT> > Ptr;
+        typedef boost::shared_ptr<const OctreePointCloudStreamingChangeDetector<PointT> > ConstPtr;
+
+        /** \brief @b Voxel change event reported by finishFrame (). */
+        struct VoxelEvent
+        {
+          /** \brief Voxel index along the x axis of the bounding box. */
+          unsigned int x;
+          /** \brief Voxel index along the y axis of the bounding box. */
+          unsigned int y;
+          /** \brief Voxel index along the z axis of the bounding box. */
+          unsigned int z;
+          /** \brief "true" if the voxel became occupied, "false" if it became free. */
+          bool appeared;
+          /** \brief Number of points observed in the voxel in this frame (0 for disappear events). */
+          unsigned int pointCount;
+          /** \brief Frame in which the event was raised. */
+          unsigned int frame;
+        };
+
+        /** \brief Constructor.
+          * \param[in] resolution_arg edge length of the voxels
+          */
+        OctreePointCloudStreamingChangeDetector (const double resolution_arg);
+
+        /** \brief Empty class destructor. */
+        virtual
+        ~OctreePointCloudStreamingChangeDetector ()
+        {
+        }
+
+        /** \brief Define the monitored bounding box. Points outside of it are ignored. The box must not span
+          * more than 2^21 voxels along any axis. Resets the detector.
+          * \param[in] minX_arg X coordinate of lower bounding box corner
+          * \param[in] minY_arg Y coordinate of lower bounding box corner
+          * \param[in] minZ_arg Z coordinate of lower bounding box corner
+          * \param[in] maxX_arg X coordinate of upper bounding box corner
+          * \param[in] maxY_arg Y coordinate of upper bounding box corner
+          * \param[in] maxZ_arg Z coordinate of upper bounding box corner
+          */
+        void
+        defineBoundingBox (const double minX_arg, const double minY_arg, const double minZ_arg,
+                           const double maxX_arg, const double maxY_arg, const double maxZ_arg);
+
+        /** \brief Set the hysteresis of the voxel state changes. Resets the detector.
+          * \param[in] appearFrames_arg amount of observations needed before a voxel is reported as appeared
+          * \param[in] disappearFrames_arg amount of consecutive frames without observation before an occupied
+          * voxel is reported as disappeared
+          */
+        void
+        setHysteresis (unsigned int appearFrames_arg, unsigned int disappearFrames_arg);
+
+        /** \brief Set the minimum amount of points within a voxel for it to count as observed in a frame.
+          * \param[in] minPointsPerVoxel_arg minimum amount of points per voxel and frame
+          */
+        inline void
+        setMinPointsPerVoxel (unsigned int minPointsPerVoxel_arg)
+        {
+          minPointsPerVoxel_ = (minPointsPerVoxel_arg > 0) ? minPointsPerVoxel_arg : 1;
+        }
+
+        /** \brief Get the minimum amount of points within a voxel for it to count as observed in a frame. */
+        inline unsigned int
+        getMinPointsPerVoxel () const
+        {
+          return (minPointsPerVoxel_);
+        }
+
+        /** \brief Set the number of threads used for keying the points in addPoints ().
+          * \param[in] nr_threads the number of threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads)
+        {
+          threads_ = nr_threads == 0 ? 1 : nr_threads;
+        }
+
+        /** \brief Add points to the current frame. A frame may be delivered in several chunks.
+          * \param[in] cloud_arg the points to add
+          */
+        void
+        addPoints (const PointCloud& cloud_arg);
+
+        /** \brief Close the current frame, update the voxel states and report the state changes.
+          * \param[out] events_arg the voxel events of this frame
+          * \return number of the frame that was closed
+          */
+        unsigned int
+        finishFrame (std::vector<VoxelEvent>& events_arg);
+
+        /** \brief Add a complete frame and report its voxel state changes.
+          * \param[in] cloud_arg the points of the frame
+          * \param[out] events_arg the voxel events of this frame
+          * \return number of the processed frame
+          */
+        inline unsigned int
+        processFrame (const PointCloud& cloud_arg, std::vector<VoxelEvent>& events_arg)
+        {
+          addPoints (cloud_arg);
+          return (finishFrame (events_arg));
+        }
+
+        /** \brief Check if the voxel at a given point is currently reported as occupied.
+          * \param[in] point_arg point addressing the voxel
+          * \return "true" if the voxel is occupied; "false" otherwise
+          */
+        bool
+        isVoxelOccupiedAtPoint (const PointT& point_arg) const;
+
+        /** \brief Get the center of a voxel.
+          * \param[in] event_arg event referencing the voxel
+          * \param[out] center_arg the voxel center
+          */
+        void
+        getVoxelCenter (const VoxelEvent& event_arg, PointT& center_arg) const;
+
+        /** \brief Get the amount of voxels that are currently reported as occupied. */
+        inline std::size_t
+        getOccupiedVoxelCount () const
+        {
+          boost::mutex::scoped_lock lock (stateMutex_);
+          return (occupiedCount_);
+        }
+
+        /** \brief Get the amount of voxels with a state, including voxels that did not appear yet. */
+        inline std::size_t
+        getTrackedVoxelCount () const
+        {
+          boost::mutex::scoped_lock lock (stateMutex_);
+          return (voxels_.size ());
+        }
+
+        /** \brief Get the amount of frames processed so far. */
+        inline unsigned int
+        getFrameCount () const
+        {
+          boost::mutex::scoped_lock lock (stateMutex_);
+          return (frameCount_);
+        }
+
+        /** \brief Get the voxel resolution. */
+        inline double
+        getResolution () const
+        {
+          return (resolution_);
+        }
+
+        /** \brief Forget all voxel states and pending points and restart with frame 0. */
+        void
+        reset ();
+
+      protected:
+
+        /** \brief @b Tracked voxel state */
+        struct VoxelState
+        {
+          /** \brief Observation evidence, at most appearFrames_. */
+          unsigned int score;
+          /** \brief Last frame the voxel was observed in. */
+          unsigned int lastFrame;
+          /** \brief Frame at which the state expires if the voxel is not observed again. */
+          unsigned int expireFrame;
+          /** \brief "true" if the voxel is reported as occupied. */
+          bool occupied;
+        };
+
+        typedef boost::unordered_map<boost::uint64_t, VoxelState> VoxelMap;
+
+        /** \brief Compute the packed voxel key of a point.
+          * \param[in] point_arg the point
+          * \param[out] key_arg the packed voxel key
+          * \return "true" if the point is finite and inside the bounding box; "false" otherwise
+          */
+        bool
+        genVoxelKey (const PointT& point_arg, boost::uint64_t& key_arg) const;
+
+        /** \brief Schedule the expiry of a voxel state.
+          * \param[in] key_arg packed voxel key
+          * \param[in] expireFrame_arg frame at which the state expires
+          */
+        inline void
+        scheduleExpiry (boost::uint64_t key_arg, unsigned int expireFrame_arg)
+        {
+          expiryWheel_[expireFrame_arg % expiryWheel_.size ()].push_back (key_arg);
+        }
+
+        /** \brief Amount of bits per axis in a packed voxel key. */
+        static const unsigned int keyBits_ = 21;
+
+        /** \brief Voxel resolution. */
+        double resolution_;
+
+        /** \brief Monitored bounding box. */
+        double minX_, minY_, minZ_, maxX_, maxY_, maxZ_;
+
+        /** \brief Amount of voxels along each axis of the bounding box. */
+        unsigned int gridSize_[3];
+
+        /** \brief Amount of observations before a voxel appears. */
+        unsigned int appearFrames_;
+
+        /** \brief Amount of missed frames before an occupied voxel disappears. */
+        unsigned int disappearFrames_;
+
+        /** \brief Minimum amount of points for a voxel observation. */
+        unsigned int minPointsPerVoxel_;
+
+        /** \brief Amount of threads used for keying. */
+        unsigned int threads_;
+
+        /** \brief Voxel keys of the points added to the current frame. */
+        std::vector<boost::uint64_t> pendingKeys_;
+
+        /** \brief Voxel states. */
+        VoxelMap voxels_;
+
+        /** \brief Expiry schedule: slot f % size holds the keys possibly expiring in frame f. Entries of voxels
+          * that were observed again after scheduling are stale and skipped. */
+        std::vector<std::vector<boost::uint64_t> > expiryWheel_;
+
+        /** \brief Amount of voxels reported as occupied. */
+        std::size_t occupiedCount_;
+
+        /** \brief Number of the next frame. */
+        unsigned int frameCount_;
+
+        /** \brief Guards pendingKeys_. */
+        mutable boost::mutex pendingMutex_;
+
+        /** \brief Guards the voxel states, serializes finishFrame (). */
+        mutable boost::mutex stateMutex_;
+    };
+  }
+}
+
+#define PCL_INSTANTIATE_OctreePointCloudStreamingChangeDetector(T) template class PCL_EXPORTS pcl::octree::OctreePointCloudStreamingChangeDetector<T>;
+
+#endif    // PCL_OCTREE_POINTCLOUD_STREAMING_CHANGEDETECTOR_H_
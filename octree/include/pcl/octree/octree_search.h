@@ -142,7 +142,7 @@ namespace pcl
           */
         int
         nearestKSearch (const PointT &p_q, int k, std::vector<int> &k_indices,
-                        std::vector<float> &k_sqr_distances);
+                        std::vector<float> &k_sqr_distances) const;
 
         /** \brief Search for k-nearest neighbors at query point
           * \param[in] index index representing the query point in the dataset given by \a setInputCloud.
@@ -155,7 +155,24 @@ namespace pcl
           */
         int
         nearestKSearch (int index, int k, std::vector<int> &k_indices,
-                        std::vector<float> &k_sqr_distances);
+                        std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for k-nearest neighbors of many query points.
+          * \note Queries are processed in Morton order of their position. The neighbors found for a query bound the
+          * search radius of the next one, so that spatially coherent queries visit only few voxels. Queries are
+          * distributed over the threads set by \a setNumberOfThreads.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices in \a cloud representing the query points; all points if empty
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i] corresponds to the
+          * neighbors of query point i
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, k_sqr_distances[i]
+          * corresponds to the neighbors of query point i
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        std::vector<std::vector<int> > &k_indices,
+                        std::vector<std::vector<float> > &k_sqr_distances) const;
 
         /** \brief Search for approx. nearest neighbor at the query point.
           * \param[in] cloud the point cloud data
@@ -251,6 +268,36 @@ namespace pcl
         getIntersectedVoxelIndices (Eigen::Vector3f origin, Eigen::Vector3f direction,
                                     std::vector<int> &k_indices) const;
 
+        /** \brief Get the centers of the voxels that are intersected by many rays (origin, direction).
+          * \note Rays are cast in parallel by the threads set by \a setNumberOfThreads.
+          * \param[in] origins ray origins
+          * \param[in] directions ray direction vectors, one per ray origin
+          * \param[out] voxelCenterList voxel centers of all rays, ordered along each ray
+          * \param[out] rayOffsets the voxel centers of ray i are found at [rayOffsets[i], rayOffsets[i + 1]) in
+          * \a voxelCenterList
+          * \param[in] firstHitOnly if "true", only the first voxel hit by each ray is returned
+          */
+        void
+        getIntersectedVoxelCenters (const std::vector<Eigen::Vector3f> &origins,
+                                    const std::vector<Eigen::Vector3f> &directions,
+                                    AlignedPointTVector &voxelCenterList, std::vector<int> &rayOffsets,
+                                    bool firstHitOnly = false) const;
+
+        /** \brief Get the indices of the points in the voxels that are intersected by many rays (origin, direction).
+          * \note Rays are cast in parallel by the threads set by \a setNumberOfThreads.
+          * \param[in] origins ray origins
+          * \param[in] directions ray direction vectors, one per ray origin
+          * \param[out] k_indices point indices of all rays, ordered along each ray
+          * \param[out] rayOffsets the point indices of ray i are found at [rayOffsets[i], rayOffsets[i + 1]) in
+          * \a k_indices
+          * \param[in] firstHitOnly if "true", only the points of the first voxel hit by each ray are returned
+          */
+        void
+        getIntersectedVoxelIndices (const std::vector<Eigen::Vector3f> &origins,
+                                    const std::vector<Eigen::Vector3f> &directions,
+                                    std::vector<int> &k_indices, std::vector<int> &rayOffsets,
+                                    bool firstHitOnly = false) const;
+
 
         /** \brief Search for points within rectangular search area
          * \param[in] min_pt lower corner of search area
@@ -262,92 +309,42 @@ namespace pcl
         boxSearch (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, std::vector<int> &k_indices) const;
 
       protected:
+        typedef typename OctreePointCloud<PointT, LeafT, OctreeT>::IntersectedVoxel IntersectedVoxel;
+
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         // Octree-based search routines & helpers
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-        /** \brief @b Priority queue entry for branch nodes
-         *  \note This class defines priority queue entries for the nearest neighbor search.
-         *  \author Julius Kammerl (julius@kammerl.de)
-         */
-        class prioBranchQueueEntry
-        {
-          public:
-            /** \brief Empty constructor  */
-            prioBranchQueueEntry ()
-            {
-            }
-
-            /** \brief Constructor for initializing priority queue entry.
-              * \param node pointer to octree node
-              * \param key octree key addressing voxel in octree structure
-              * \param[in] pointDistance distance of query point to voxel center
-              */
-            prioBranchQueueEntry (OctreeNode* node, OctreeKey& key, double pointDistance)
-            {
-              node = node;
-              pointDistance = pointDistance;
-              key = key;
-            }
-
-            /** \brief Operator< for comparing priority queue entries with each other. 
-              * \param[in] rhs the priority queue to compare this against
-              */
-            bool
-            operator< (const prioBranchQueueEntry rhs) const
-            {
-              return (this->pointDistance > rhs.pointDistance);
-            }
-
-            /** \brief Pointer to octree node. */
-            const OctreeNode* node;
-
-            /** \brief Distance to query point. */
-            double pointDistance;
-
-            /** \brief Octree key. */
-            OctreeKey key;
-        };
-
-        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-        /** \brief @b Priority queue entry for point candidates
-          * \note This class defines priority queue entries for the nearest neighbor point candidates.
-          * \author Julius Kammerl (julius@kammerl.de)
+        /** \brief @b Traversal stack entry of the iterative nearest neighbor search
+          * \note Entries are ordered by descending distance, so that the closest voxel is popped from the back of a
+          * sorted stack segment first.
           */
-        class prioPointQueueEntry
+        struct KNNStackEntry
         {
-          public:
-
-            /** \brief Empty constructor  */
-            prioPointQueueEntry ()
-            {
-            }
-
-            /** \brief Constructor for initializing priority queue entry.
-              * \param pointIdx an index representing a point in the dataset given by \a setInputCloud
-              * \param[in] pointDistance distance of query point to voxel center
-              */
-            prioPointQueueEntry (unsigned int& pointIdx, double pointDistance)
-            {
-              pointIdx_ = pointIdx;
-              pointDistance_ = pointDistance;
-            }
-
-            /** \brief Operator< for comparing priority queue entries with each other.
-              * \param rhs priority queue to compare this against 
-              */
-            bool
-            operator< (const prioPointQueueEntry& rhs) const
-            {
-              return (this->pointDistance_ < rhs.pointDistance_);
-            }
-
-            /** \brief Index representing a point in the dataset given by \a setInputCloud. */
-            int pointIdx_;
-
-            /** \brief Distance to query point. */
-            double pointDistance_;
+          /** \brief Pointer to octree node. */
+          const OctreeNode* node;
+
+          /** \brief Octree key. */
+          OctreeKey key;
+
+          /** \brief Depth of the node in the octree. */
+          unsigned int depth;
+
+          /** \brief Squared distance of the query point to the voxel. */
+          double value;
+
+          bool
+          operator< (const KNNStackEntry& rhs) const
+          {
+            return (value > rhs.value);
+          }
         };
 
+        /** \brief Nearest neighbor candidate: squared distance and point index. */
+        typedef std::pair<double, int> KNNCandidate;
+
+        /** \brief Maximum traversal stack size: each expanded branch adds at most seven entries per octree level. */
+        static const unsigned int KNN_STACK_SIZE = 8 * 32;
+
         /** \brief Helper function to calculate the squared distance between two points
           * \param[in] pointA point A
           * \param[in] pointB point B
@@ -376,21 +373,34 @@ namespace pcl
                                            unsigned int treeDepth, std::vector<int>& k_indices,
                                            std::vector<float>& k_sqr_distances, unsigned int max_nn) const;
 
-        /** \brief Recursive search method that explores the octree and finds the K nearest neighbors
+        /** \brief Iterative search method that explores the octree depth-first and finds the K nearest neighbors
+          * \note The children of each branch are visited in order of their distance to the query point, voxels
+          * farther away than the current K-th candidate are pruned.
           * \param[in] point query point
           * \param[in] K amount of nearest neighbors to be found
-          * \param[in] node current octree node to be explored
-          * \param[in] key octree key addressing a leaf node.
-          * \param[in] treeDepth current depth/level in the octree
-          * \param[in] squaredSearchRadius squared search radius distance
-          * \param[out] pointCandidates priority queue of nearest neigbor point candidates
-          * \return squared search radius based on current point candidate set found
+          * \param[in] maxSquaredDist squared distance known to contain at least K points, or infinity
+          * \param[out] candidates bounded max-heap of nearest neighbor candidates, sorted ascending on return
+          * \param[in] leafIndices buffer for the point indices of a leaf node
+          */
+        void
+        getKNearestNeighborIterative (const PointT& point, unsigned int K, double maxSquaredDist,
+                                      std::vector<KNNCandidate>& candidates, std::vector<int>& leafIndices) const;
+
+        /** \brief Calculate the squared distance of a point to a voxel.
+          * \param[in] point query point
+          * \param[in] key octree key addressing the voxel
+          * \param[in] treeDepth depth of the voxel in the octree
+          * \return squared distance, zero if the point is inside the voxel
           */
         double
-        getKNearestNeighborRecursive (const PointT& point, unsigned int K, const OctreeBranch* node,
-                                      const OctreeKey& key, unsigned int treeDepth,
-                                      const double squaredSearchRadius,
-                                      std::vector<prioPointQueueEntry>& pointCandidates) const;
+        voxelSquaredDist (const PointT& point, const OctreeKey& key, unsigned int treeDepth) const;
+
+        /** \brief Generate the position of a point along the Morton curve of the octree's bounding box.
+          * \param[in] point query point, clamped to the bounding box
+          * \return Morton code interleaving up to 21 leaf key bits per axis
+          */
+        uint64_t
+        genMortonCode (const PointT& point) const;
 
         /** \brief Recursive search method that explores the octree and finds the approximate nearest neighbor
           * \param[in] point query point
@@ -404,27 +414,6 @@ namespace pcl
         approxNearestSearchRecursive (const PointT& point, const OctreeBranch* node, const OctreeKey& key,
                                       unsigned int treeDepth, int& result_index, float& sqr_distance);
 
-        /** \brief Recursively search the tree for all intersected leaf nodes and return a vector of voxel centers.
-          * This algorithm is based off the paper An Efficient Parametric Algorithm for Octree Traversal:
-          * http://wscg.zcu.cz/wscg2000/Papers_2000/X31.pdf
-          * \param[in] minX octree nodes X coordinate of lower bounding box corner
-          * \param[in] minY octree nodes Y coordinate of lower bounding box corner
-          * \param[in] minZ octree nodes Z coordinate of lower bounding box corner
-          * \param[in] maxX octree nodes X coordinate of upper bounding box corner
-          * \param[in] maxY octree nodes Y coordinate of upper bounding box corner
-          * \param[in] maxZ octree nodes Z coordinate of upper bounding box corner
-          * \param[in] a
-          * \param[in] node current octree node to be explored
-          * \param[in] key octree key addressing a leaf node.
-          * \param[out] voxelCenterList results are written to this vector of PointT elements
-          * \return number of voxels found
-          */
-        int
-        getIntersectedVoxelCentersRecursive (double minX, double minY, double minZ, double maxX, double maxY,
-                                             double maxZ, unsigned char a, const OctreeNode* node,
-                                             const OctreeKey& key, AlignedPointTVector &voxelCenterList) const;
-
-
         /** \brief Recursive search method that explores the octree and finds points within a rectangular search area
          * \param[in] min_pt lower corner of search area
          * \param[in] max_pt upper corner of search area
@@ -437,172 +426,6 @@ namespace pcl
         boxSearchRecursive (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, const OctreeBranch* node,
                             const OctreeKey& key, unsigned int treeDepth, std::vector<int>& k_indices) const;
 
-        /** \brief Recursively search the tree for all intersected leaf nodes and return a vector of indices.
-          * This algorithm is based off the paper An Efficient Parametric Algorithm for Octree Traversal:
-          * http://wscg.zcu.cz/wscg2000/Papers_2000/X31.pdf
-          * \param[in] minX octree nodes X coordinate of lower bounding box corner
-          * \param[in] minY octree nodes Y coordinate of lower bounding box corner
-          * \param[in] minZ octree nodes Z coordinate of lower bounding box corner
-          * \param[in] maxX octree nodes X coordinate of upper bounding box corner
-          * \param[in] maxY octree nodes Y coordinate of upper bounding box corner
-          * \param[in] maxZ octree nodes Z coordinate of upper bounding box corner
-          * \param[in] a
-          * \param[in] node current octree node to be explored
-          * \param[in] key octree key addressing a leaf node.
-          * \param[out] k_indices resulting indices
-          * \return number of voxels found
-          */
-        int
-        getIntersectedVoxelIndicesRecursive (double minX, double minY, double minZ,
-                                             double maxX, double maxY, double maxZ,
-                                             unsigned char a, const OctreeNode* node, const OctreeKey& key,
-                                             std::vector<int> &k_indices) const;
-
-        /** \brief Initialize raytracing algorithm
-          * \param origin
-          * \param direction
-          * \param[in] minX octree nodes X coordinate of lower bounding box corner
-          * \param[in] minY octree nodes Y coordinate of lower bounding box corner
-          * \param[in] minZ octree nodes Z coordinate of lower bounding box corner
-          * \param[in] maxX octree nodes X coordinate of upper bounding box corner
-          * \param[in] maxY octree nodes Y coordinate of upper bounding box corner
-          * \param[in] maxZ octree nodes Z coordinate of upper bounding box corner
-          * \param a
-          */
-        inline void
-        initIntersectedVoxel (Eigen::Vector3f &origin, Eigen::Vector3f &direction,
-                              double &minX, double &minY, double &minZ,
-                              double &maxX, double &maxY, double &maxZ,
-                              unsigned char &a) const
-        {
-          // Account for division by zero when direction vector is 0.0
-          const double epsilon = 1e-10;
-          if (direction.x () == 0.0)
-            direction.x () = epsilon;
-          if (direction.y () == 0.0)
-            direction.y () = epsilon;
-          if (direction.z () == 0.0)
-            direction.z () = epsilon;
-
-          // Voxel childIdx remapping
-          a = 0;
-
-          // Handle negative axis direction vector
-          if (direction.x () < 0.0)
-          {
-            origin.x () = this->minX_ + this->maxX_ - origin.x ();
-            direction.x () = -direction.x ();
-            a |= 4;
-          }
-          if (direction.y () < 0.0)
-          {
-            origin.y () = this->minY_ + this->maxY_ - origin.y ();
-            direction.y () = -direction.y ();
-            a |= 2;
-          }
-          if (direction.z () < 0.0)
-          {
-            origin.z () = this->minZ_ + this->maxZ_ - origin.z ();
-            direction.z () = -direction.z ();
-            a |= 1;
-          }
-          minX = (this->minX_ - origin.x ()) / direction.x ();
-          maxX = (this->maxX_ - origin.x ()) / direction.x ();
-          minY = (this->minY_ - origin.y ()) / direction.y ();
-          maxY = (this->maxY_ - origin.y ()) / direction.y ();
-          minZ = (this->minZ_ - origin.z ()) / direction.z ();
-          maxZ = (this->maxZ_ - origin.z ()) / direction.z ();
-        }
-
-        /** \brief Find first child node ray will enter
-          * \param[in] minX octree nodes X coordinate of lower bounding box corner
-          * \param[in] minY octree nodes Y coordinate of lower bounding box corner
-          * \param[in] minZ octree nodes Z coordinate of lower bounding box corner
-          * \param[in] midX octree nodes X coordinate of bounding box mid line
-          * \param[in] midY octree nodes Y coordinate of bounding box mid line
-          * \param[in] midZ octree nodes Z coordinate of bounding box mid line
-          * \return the first child node ray will enter
-          */
-        inline int
-        getFirstIntersectedNode (double minX, double minY, double minZ, double midX, double midY, double midZ) const
-        {
-          int currNode = 0;
-
-          if (minX > minY)
-          {
-            if (minX > minZ)
-            {
-              // max(minX, minY, minZ) is minX. Entry plane is YZ.
-              if (midY < minX)
-                currNode |= 2;
-              if (midZ < minX)
-                currNode |= 1;
-            }
-            else
-            {
-              // max(minX, minY, minZ) is minZ. Entry plane is XY.
-              if (midX < minZ)
-                currNode |= 4;
-              if (midY < minZ)
-                currNode |= 2;
-            }
-          }
-          else
-          {
-            if (minY > minZ)
-            {
-              // max(minX, minY, minZ) is minY. Entry plane is XZ.
-              if (midX < minY)
-                currNode |= 4;
-              if (midZ < minY)
-                currNode |= 1;
-            }
-            else
-            {
-              // max(minX, minY, minZ) is minZ. Entry plane is XY.
-              if (midX < minZ)
-                currNode |= 4;
-              if (midY < minZ)
-                currNode |= 2;
-            }
-          }
-
-          return currNode;
-        }
-
-        /** \brief Get the next visited node given the current node upper
-          *   bounding box corner. This function accepts three float values, and
-          *   three int values. The function returns the ith integer where the
-          *   ith float value is the minimum of the three float values.
-          * \param[in] x current nodes X coordinate of upper bounding box corner
-          * \param[in] y current nodes Y coordinate of upper bounding box corner
-          * \param[in] z current nodes Z coordinate of upper bounding box corner
-          * \param[in] a next node if exit Plane YZ
-          * \param[in] b next node if exit Plane XZ
-          * \param[in] c next node if exit Plane XY
-          * \return the next child node ray will enter or 8 if exiting
-          */
-        inline int
-        getNextIntersectedNode (double x, double y, double z, int a, int b, int c) const
-        {
-          if (x < y)
-          {
-            if (x < z)
-              return a;
-            else
-              return c;
-          }
-          else
-          {
-            if (y < z)
-              return b;
-            else
-              return c;
-          }
-
-          return 0;
-        }
-
       };
   }
 }
@@ -55,6 +55,8 @@ template class PCL_EXPORTS pcl::octree::Octree2BufBase<int, pcl::octree::OctreeL
 template class PCL_EXPORTS pcl::octree::OctreeLowMemBase<int, pcl::octree::OctreeLeafDataTVector<int> >;
 
 PCL_INSTANTIATE(OctreePointCloudSearch, PCL_XYZ_POINT_TYPES)
+PCL_INSTANTIATE(OctreePointCloudLinear, PCL_XYZ_POINT_TYPES)
+PCL_INSTANTIATE(OctreePointCloudStreamingChangeDetector, PCL_XYZ_POINT_TYPES)
 
 PCL_INSTANTIATE(OctreePointCloudSingleBufferWithLeafDataTVector, PCL_XYZ_POINT_TYPES)
 PCL_INSTANTIATE(OctreePointCloudDoubleBufferWithLeafDataTVector, PCL_XYZ_POINT_TYPES)
@@ -0,0 +1,140 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ */
+
+#include <pcl/octree/octree_mapped_file.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+# include <io.h>
+# include <windows.h>
+# define pcl_open                    _open
+# define pcl_close(fd)               _close(fd)
+#else
+# include <sys/mman.h>
+# include <unistd.h>
+# define pcl_open                    ::open
+# define pcl_close(fd)               ::close(fd)
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::octree::OctreeMappedFile::OctreeMappedFile () :
+  data_ (NULL), size_ (0), mapping_ (NULL)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::octree::OctreeMappedFile::~OctreeMappedFile ()
+{
+  close ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::octree::OctreeMappedFile::open (const std::string& file_name)
+{
+  close ();
+
+#ifdef _WIN32
+  int fd = pcl_open (file_name.c_str (), _O_RDONLY | _O_BINARY);
+#else
+  int fd = pcl_open (file_name.c_str (), O_RDONLY);
+#endif
+  if (fd == -1)
+    return (false);
+
+  struct stat file_stat;
+  if (fstat (fd, &file_stat) != 0 || file_stat.st_size <= 0)
+  {
+    pcl_close (fd);
+    return (false);
+  }
+  const std::size_t size = static_cast<std::size_t> (file_stat.st_size);
+
+#ifdef _WIN32
+  HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  if (fm == NULL)
+  {
+    pcl_close (fd);
+    return (false);
+  }
+  char *map = static_cast<char*> (MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0));
+  if (map == NULL)
+  {
+    CloseHandle (fm);
+    pcl_close (fd);
+    return (false);
+  }
+  mapping_ = fm;
+#else
+  char *map = static_cast<char*> (mmap (0, size, PROT_READ, MAP_SHARED, fd, 0));
+  if (map == MAP_FAILED)
+  {
+    pcl_close (fd);
+    return (false);
+  }
+#endif
+
+  // the mapping stays valid after the file descriptor is closed
+  pcl_close (fd);
+
+  data_ = map;
+  size_ = size;
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::octree::OctreeMappedFile::close ()
+{
+  if (data_ == NULL)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile (data_);
+  CloseHandle (static_cast<HANDLE> (mapping_));
+  mapping_ = NULL;
+#else
+  munmap (const_cast<char*> (data_), size_);
+#endif
+
+  data_ = NULL;
+  size_ = 0;
+}
@@ -570,6 +570,94 @@ TEST (PCL, Octree_LowMem_Test)
 
 }
 
+template<typename OctreeT> void
+checkOctreeNodePool ()
+{
+  unsigned int i;
+
+  OctreeT octreeA;
+  octreeA.setTreeDepth (8);
+
+  for (i = 0; i < 256; i++)
+    octreeA.add (i, 255 - i, (i * 7) % 256, static_cast<int> (i));
+
+  // copies must not share nodes with the source octree
+  {
+    OctreeT octreeB (octreeA);
+    ASSERT_EQ(octreeB.getLeafCount (), octreeA.getLeafCount ());
+    ASSERT_EQ(octreeB.getBranchCount (), octreeA.getBranchCount ());
+
+    for (i = 0; i < 256; i++)
+    {
+      int data = -1;
+      ASSERT_EQ(octreeB.existLeaf (i, 255 - i, (i * 7) % 256), true);
+      octreeB.get (i, 255 - i, (i * 7) % 256, data);
+      ASSERT_EQ(data, static_cast<int> (i));
+    }
+
+    octreeB.deleteTree ();
+  }
+
+  // assignment replaces the content of the target octree
+  {
+    OctreeT octreeC;
+    octreeC.setTreeDepth (8);
+    octreeC.add (1, 2, 3, -1);
+
+    octreeC = octreeA;
+    ASSERT_EQ(octreeC.getLeafCount (), octreeA.getLeafCount ());
+    ASSERT_EQ(octreeC.getBranchCount (), octreeA.getBranchCount ());
+    ASSERT_EQ(octreeC.existLeaf (1, 2, 3), false);
+
+    for (i = 0; i < 256; i++)
+    {
+      int data = -1;
+      octreeC.get (i, 255 - i, (i * 7) % 256, data);
+      ASSERT_EQ(data, static_cast<int> (i));
+    }
+
+    octreeC.deleteTree ();
+  }
+
+  for (i = 0; i < 256; i++)
+  {
+    int data = -1;
+    octreeA.get (i, 255 - i, (i * 7) % 256, data);
+    ASSERT_EQ(data, static_cast<int> (i));
+  }
+
+  // rebuilding a deleted octree reuses the pooled nodes
+  size_t memoryUsage = 0;
+  for (unsigned int run = 0; run < 3; run++)
+  {
+    octreeA.deleteTree ();
+    ASSERT_EQ(octreeA.getLeafCount (), 0u);
+    ASSERT_EQ(octreeA.existLeaf (0, 255, 0), false);
+
+    octreeA.setTreeDepth (8);
+    for (i = 0; i < 256; i++)
+      octreeA.add (i, 255 - i, (i * 7) % 256, static_cast<int> (i));
+
+    ASSERT_EQ(octreeA.getLeafCount (), 256u);
+    if (run > 0)
+    {
+      ASSERT_EQ(octreeA.getMemoryUsage (), memoryUsage);
+    }
+    memoryUsage = octreeA.getMemoryUsage ();
+  }
+
+  // freeing the pools releases their memory
+  octreeA.deleteTree (true);
+  ASSERT_LT(octreeA.getMemoryUsage (), memoryUsage);
+}
+
+TEST (PCL, Octree_Node_Pool_Test)
+{
+  checkOctreeNodePool<OctreeBase<int> > ();
+  checkOctreeNodePool<Octree2BufBase<int> > ();
+  checkOctreeNodePool<OctreeLowMemBase<int> > ();
+}
+
 TEST (PCL, Octree2Buf_Base_Double_Buffering_Test)
 {
 
@@ -907,6 +995,83 @@ TEST (PCL, Octree_Pointcloud_Test)
 
 }
 
+template<typename OctreeT> void
+compareBulkAndIncrementalOctree (const PointCloud<PointXYZ>::Ptr& cloudIn, double resolution)
+{
+  // bulk construction
+  OctreeT octreeBulk (resolution);
+  octreeBulk.setNumberOfThreads (4);
+  octreeBulk.setInputCloud (cloudIn);
+  octreeBulk.addPointsFromInputCloud ();
+
+  // point by point construction
+  OctreeT octreeIncremental (resolution);
+  octreeIncremental.setInputCloud (cloudIn);
+  for (size_t i = 0; i < cloudIn->points.size (); i++)
+  {
+    if (pcl_isfinite (cloudIn->points[i].x))
+      octreeIncremental.addPointFromCloud ((int)i, typename OctreeT::IndicesPtr ());
+  }
+
+  ASSERT_EQ (octreeBulk.getLeafCount (), octreeIncremental.getLeafCount ());
+  ASSERT_EQ (octreeBulk.getBranchCount (), octreeIncremental.getBranchCount ());
+  ASSERT_EQ (octreeBulk.getTreeDepth (), octreeIncremental.getTreeDepth ());
+
+  double minBulk[3], maxBulk[3], minIncremental[3], maxIncremental[3];
+  octreeBulk.getBoundingBox (minBulk[0], minBulk[1], minBulk[2], maxBulk[0], maxBulk[1], maxBulk[2]);
+  octreeIncremental.getBoundingBox (minIncremental[0], minIncremental[1], minIncremental[2],
+                                    maxIncremental[0], maxIncremental[1], maxIncremental[2]);
+  for (int axis = 0; axis < 3; axis++)
+  {
+    ASSERT_EQ (minBulk[axis], minIncremental[axis]);
+    ASSERT_EQ (maxBulk[axis], maxIncremental[axis]);
+  }
+
+  std::vector<char> treeBinaryBulk, treeBinaryIncremental;
+  std::vector<int> leafVectorBulk, leafVectorIncremental;
+  octreeBulk.serializeTree (treeBinaryBulk, leafVectorBulk);
+  octreeIncremental.serializeTree (treeBinaryIncremental, leafVectorIncremental);
+
+  ASSERT_EQ (treeBinaryBulk, treeBinaryIncremental);
+  ASSERT_EQ (leafVectorBulk, leafVectorIncremental);
+}
+
+TEST (PCL, Octree_Pointcloud_Bulk_Construction_Test)
+{
+  const unsigned int test_runs = 10;
+  unsigned int test_id;
+
+  // instantiate point cloud
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+
+  size_t i;
+
+  srand (time (NULL));
+
+  for (test_id = 0; test_id < test_runs; test_id++)
+  {
+    // generate point cloud with an irregular extent, so that the octree grows during insertion
+    cloudIn->width = 5000;
+    cloudIn->height = 1;
+    cloudIn->points.resize (cloudIn->width * cloudIn->height);
+    for (i = 0; i < cloudIn->points.size (); i++)
+    {
+      double scale = (i % 100 == 0) ? 50.0 : 5.0;
+      cloudIn->points[i] = PointXYZ (scale * ((double)rand () / (double)RAND_MAX) - scale / 2.0,
+                                     scale * ((double)rand () / (double)RAND_MAX),
+                                     scale * ((double)rand () / (double)RAND_MAX) - scale);
+    }
+    cloudIn->points[rand () % cloudIn->points.size ()].x = std::numeric_limits<float>::quiet_NaN ();
+
+    double resolution = 0.05 + 0.5 * ((double)rand () / (double)RAND_MAX);
+
+    compareBulkAndIncrementalOctree<OctreePointCloud<PointXYZ> > (cloudIn, resolution);
+    compareBulkAndIncrementalOctree<OctreePointCloud<PointXYZ>::DoubleBuffer> (cloudIn, resolution);
+    compareBulkAndIncrementalOctree<OctreePointCloudSinglePoint<PointXYZ> > (cloudIn, resolution);
+    compareBulkAndIncrementalOctree<OctreePointCloudVoxelCentroid<PointXYZ> > (cloudIn, resolution);
+  }
+}
+
 TEST (PCL, Octree_Pointcloud_Density_Test)
 {
 
@@ -1084,6 +1249,54 @@ TEST(PCL, Octree_Pointcloud_Occupancy_Test)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Occupancy_Free_Space_Carving)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  PointCloud<PointXYZ>::Ptr obstacles (new PointCloud<PointXYZ> ());
+
+  OctreePointCloudOccupancy<PointXYZ> octree (0.1f);
+  octree.setNumberOfThreads (2);
+
+  // keep points and rays off the voxel boundaries
+  const Eigen::Vector3f origin (5.013f, 4.987f, 1.021f);
+
+  // scanned wall
+  for (int x = 0; x < 13; x++)
+    for (int y = 0; y < 13; y++)
+      cloudIn->points.push_back (PointXYZ (2.037f + 0.5f * x, 2.061f + 0.5f * y, 8.043f));
+
+  // obstacles in front of the wall that were not seen by the scan
+  for (size_t i = 0; i < cloudIn->points.size (); i += 7)
+  {
+    const Eigen::Vector3f p = origin + 0.5f * (cloudIn->points[i].getVector3fMap () - origin);
+    obstacles->points.push_back (PointXYZ (p.x (), p.y (), p.z ()));
+  }
+
+  octree.setOccupiedVoxelsAtPointsFromCloud (cloudIn);
+  octree.setOccupiedVoxelsAtPointsFromCloud (obstacles);
+
+  // voxel off all rays
+  const PointXYZ hidden (9.5f, 9.5f, 1.0f);
+  octree.setOccupiedVoxelAtPoint (hidden);
+
+  const unsigned int leafCount = octree.getLeafCount ();
+
+  int removedCount = octree.carveFreeVoxelsFromCloud (origin, cloudIn);
+  ASSERT_EQ(removedCount, static_cast<int> (obstacles->points.size ()));
+  ASSERT_EQ(octree.getLeafCount (), leafCount - obstacles->points.size ());
+
+  for (size_t i = 0; i < obstacles->points.size (); i++)
+    ASSERT_EQ(octree.isVoxelOccupiedAtPoint (obstacles->points[i]), false);
+
+  for (size_t i = 0; i < cloudIn->points.size (); i++)
+    ASSERT_EQ(octree.isVoxelOccupiedAtPoint (cloudIn->points[i]), true);
+
+  ASSERT_EQ(octree.isVoxelOccupiedAtPoint (hidden), true);
+
+  // nothing left to carve
+  ASSERT_EQ(octree.carveFreeVoxelsFromCloud (origin, cloudIn), 0);
+}
+
 TEST (PCL, Octree_Pointcloud_Change_Detector_Test)
 {
   // instantiate point cloud
@@ -1145,6 +1358,162 @@ TEST (PCL, Octree_Pointcloud_Change_Detector_Test)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Change_Detector_Bulk_Growth_Test)
+{
+  PointCloud<PointXYZ>::Ptr cloudA (new PointCloud<PointXYZ> ());
+  PointCloud<PointXYZ>::Ptr cloudB (new PointCloud<PointXYZ> ());
+
+  OctreePointCloudChangeDetector<PointXYZ> octreeBulk (0.01f);
+  OctreePointCloudChangeDetector<PointXYZ> octreeIncremental (0.01f);
+
+  size_t i;
+
+  srand (time (NULL));
+
+  for (i = 0; i < 1000; i++)
+  {
+    cloudA->points.push_back (PointXYZ (5.0 * ((double)rand () / (double)RAND_MAX),
+                                        10.0 * ((double)rand () / (double)RAND_MAX),
+                                        10.0 * ((double)rand () / (double)RAND_MAX)));
+  }
+
+  // second frame: the same points followed by a few far away points, so that the octree holding the previous
+  // buffer has to grow after the first point
+  cloudB->points = cloudA->points;
+  for (i = 0; i < 6; i++)
+    cloudB->points.push_back (PointXYZ (-20.0 - (double)i, 30.0 + (double)i, 40.0 + (double)i));
+
+  octreeBulk.setInputCloud (cloudA);
+  octreeBulk.addPointsFromInputCloud ();
+  octreeBulk.switchBuffers ();
+  octreeBulk.setInputCloud (cloudB);
+  octreeBulk.addPointsFromInputCloud ();
+
+  octreeIncremental.setInputCloud (cloudA);
+  for (i = 0; i < cloudA->points.size (); i++)
+    octreeIncremental.addPointFromCloud ((int)i, OctreePointCloudChangeDetector<PointXYZ>::IndicesPtr ());
+  octreeIncremental.switchBuffers ();
+  octreeIncremental.setInputCloud (cloudB);
+  for (i = 0; i < cloudB->points.size (); i++)
+    octreeIncremental.addPointFromCloud ((int)i, OctreePointCloudChangeDetector<PointXYZ>::IndicesPtr ());
+
+  vector<int> newPointIdxVectorBulk;
+  vector<int> newPointIdxVectorIncremental;
+
+  octreeBulk.getPointIndicesFromNewVoxels (newPointIdxVectorBulk);
+  octreeIncremental.getPointIndicesFromNewVoxels (newPointIdxVectorIncremental);
+
+  // only the far away points are new
+  ASSERT_EQ (newPointIdxVectorBulk.size (), (std::size_t)6);
+  for (i = 0; i < newPointIdxVectorBulk.size (); i++)
+  {
+    ASSERT_EQ ((newPointIdxVectorBulk[i] >= 1000), true);
+  }
+
+  std::sort (newPointIdxVectorBulk.begin (), newPointIdxVectorBulk.end ());
+  std::sort (newPointIdxVectorIncremental.begin (), newPointIdxVectorIncremental.end ());
+  ASSERT_EQ (newPointIdxVectorBulk == newPointIdxVectorIncremental, true);
+}
+
+TEST (PCL, Octree_Pointcloud_Streaming_Change_Detector_Test)
+{
+  typedef OctreePointCloudStreamingChangeDetector<PointXYZ>::VoxelEvent VoxelEvent;
+
+  OctreePointCloudStreamingChangeDetector<PointXYZ> detector (1.0);
+  detector.defineBoundingBox (0.0, 0.0, 0.0, 10.0, 10.0, 10.0);
+  detector.setHysteresis (2, 3);
+
+  // static background: two points in each of ten voxels, delivered in two chunks per frame
+  PointCloud<PointXYZ> backgroundA, backgroundB;
+  for (unsigned int i = 0; i < 10; i++)
+  {
+    backgroundA.push_back (PointXYZ (i + 0.25f, 0.5f, 0.5f));
+    backgroundB.push_back (PointXYZ (i + 0.75f, 0.5f, 0.5f));
+  }
+
+  // points outside of the bounding box and invalid points are ignored
+  backgroundB.push_back (PointXYZ (-1.0f, 0.5f, 0.5f));
+  backgroundB.push_back (PointXYZ (0.5f, 0.5f, 10.5f));
+  backgroundB.push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 0.5f, 0.5f));
+
+  PointCloud<PointXYZ> intruder;
+  intruder.push_back (PointXYZ (5.5f, 5.5f, 5.5f));
+
+  PointCloud<PointXYZ> noise;
+  noise.push_back (PointXYZ (2.5f, 7.5f, 1.5f));
+
+  vector<VoxelEvent> events;
+  for (unsigned int frame = 0; frame < 20; frame++)
+  {
+    if (frame < 15)
+    {
+      detector.addPoints (backgroundA);
+      detector.addPoints (backgroundB);
+    }
+    if (frame == 5 || frame == 6)
+      detector.addPoints (intruder);
+    if (frame == 10 || frame == 12 || frame == 14)
+      detector.addPoints (noise);
+
+    ASSERT_EQ (detector.finishFrame (events), frame);
+
+    if (frame == 1)
+    {
+      // the background appears after its second observation
+      ASSERT_EQ (events.size (), (std::size_t)10);
+      for (size_t i = 0; i < events.size (); i++)
+      {
+        ASSERT_TRUE (events[i].appeared);
+        ASSERT_EQ (events[i].pointCount, 2u);
+        ASSERT_EQ (events[i].y, 0u);
+        ASSERT_EQ (events[i].z, 0u);
+      }
+      ASSERT_EQ (detector.getOccupiedVoxelCount (), (std::size_t)10);
+    }
+    else if (frame == 6)
+    {
+      ASSERT_EQ (events.size (), (std::size_t)1);
+      ASSERT_TRUE (events[0].appeared);
+      ASSERT_EQ (events[0].x, 5u);
+      ASSERT_EQ (events[0].y, 5u);
+      ASSERT_EQ (events[0].z, 5u);
+      ASSERT_EQ (events[0].frame, 6u);
+
+      PointXYZ center;
+      detector.getVoxelCenter (events[0], center);
+      ASSERT_NEAR (center.x, 5.5f, 1e-4);
+      ASSERT_NEAR (center.y, 5.5f, 1e-4);
+      ASSERT_NEAR (center.z, 5.5f, 1e-4);
+
+      ASSERT_TRUE (detector.isVoxelOccupiedAtPoint (intruder.points[0]));
+    }
+    else if (frame == 9)
+    {
+      // the intruder disappears after three frames without observation
+      ASSERT_EQ (events.size (), (std::size_t)1);
+      ASSERT_FALSE (events[0].appeared);
+      ASSERT_EQ (events[0].x, 5u);
+      ASSERT_FALSE (detector.isVoxelOccupiedAtPoint (intruder.points[0]));
+    }
+    else if (frame == 17)
+    {
+      // the background disappears three frames after its last observation in frame 14
+      ASSERT_EQ (events.size (), (std::size_t)10);
+      for (size_t i = 0; i < events.size (); i++)
+        ASSERT_FALSE (events[i].appeared);
+    }
+    else
+    {
+      // the static background and the sporadic noise voxel never raise events
+      ASSERT_EQ (events.size (), (std::size_t)0);
+    }
+  }
+
+  ASSERT_FALSE (detector.isVoxelOccupiedAtPoint (noise.points[0]));
+  ASSERT_EQ (detector.getOccupiedVoxelCount (), (std::size_t)0);
+  ASSERT_EQ (detector.getTrackedVoxelCount (), (std::size_t)0);
+}
+
 TEST (PCL, Octree_Pointcloud_Voxel_Centroid_Test)
 {
 
@@ -1327,6 +1696,83 @@ TEST (PCL, Octree_Pointcloud_Nearest_K_Neighbour_Search)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Batch_Nearest_K_Neighbour_Search)
+{
+  const unsigned int test_runs = 10;
+  unsigned int test_id;
+
+  // instantiate point clouds
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  PointCloud<PointXYZ> queries;
+
+  size_t i, j;
+
+  srand (time (NULL));
+
+  for (test_id = 0; test_id < test_runs; test_id++)
+  {
+    // generate point cloud
+    cloudIn->width = 2000;
+    cloudIn->height = 1;
+    cloudIn->points.resize (cloudIn->width * cloudIn->height);
+    for (i = 0; i < cloudIn->points.size (); i++)
+    {
+      cloudIn->points[i] = PointXYZ (5.0 * ((double)rand () / (double)RAND_MAX),
+                                     10.0 * ((double)rand () / (double)RAND_MAX),
+                                     10.0 * ((double)rand () / (double)RAND_MAX));
+    }
+
+    // query points partially outside of the octree bounding box
+    queries.points.resize (500);
+    for (i = 0; i < queries.points.size (); i++)
+    {
+      queries.points[i] = PointXYZ (12.0 * ((double)rand () / (double)RAND_MAX) - 1.0,
+                                    12.0 * ((double)rand () / (double)RAND_MAX) - 1.0,
+                                    12.0 * ((double)rand () / (double)RAND_MAX) - 1.0);
+    }
+    queries.width = queries.points.size ();
+    queries.height = 1;
+
+    OctreePointCloudSearch<PointXYZ> octree (0.1 + 0.5 * ((double)rand () / (double)RAND_MAX));
+    octree.setInputCloud (cloudIn);
+    octree.setNumberOfThreads (1 + test_id % 4);
+    octree.addPointsFromInputCloud ();
+
+    int K = 1 + rand () % 30;
+
+    std::vector<int> queryIndices;
+    if (test_id % 2)
+    {
+      for (i = 0; i < queries.points.size (); i += 3)
+        queryIndices.push_back ((int)i);
+    }
+
+    std::vector<std::vector<int> > k_indices;
+    std::vector<std::vector<float> > k_sqr_distances;
+    octree.nearestKSearch (queries, queryIndices, K, k_indices, k_sqr_distances);
+
+    const size_t queryCount = queryIndices.empty () ? queries.points.size () : queryIndices.size ();
+    ASSERT_EQ (queryCount, k_indices.size ());
+    ASSERT_EQ (queryCount, k_sqr_distances.size ());
+
+    // batched search finds the same neighbors as single queries
+    std::vector<int> k_indices_single;
+    std::vector<float> k_sqr_distances_single;
+    for (i = 0; i < queryCount; i++)
+    {
+      const PointXYZ& searchPoint = queries.points[queryIndices.empty () ? i : queryIndices[i]];
+      octree.nearestKSearch (searchPoint, K, k_indices_single, k_sqr_distances_single);
+
+      ASSERT_EQ (k_indices_single.size (), k_indices[i].size ());
+      for (j = 0; j < k_indices_single.size (); j++)
+      {
+        EXPECT_EQ (k_indices_single[j], k_indices[i][j]);
+        EXPECT_EQ (k_sqr_distances_single[j], k_sqr_distances[i][j]);
+      }
+    }
+  }
+}
+
 TEST (PCL, Octree_Pointcloud_Box_Search)
 {
 
@@ -1632,6 +2078,282 @@ TEST (PCL, Octree_Pointcloud_Ray_Traversal)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Batch_Ray_Traversal)
+{
+  const unsigned int rayCount = 1000;
+  size_t i, j;
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+
+  octree::OctreePointCloudSearch<PointXYZ> octree_search (0.25f);
+  octree_search.setNumberOfThreads (2);
+
+  srand (time (NULL));
+
+  for (i = 0; i < 2000; i++)
+    cloudIn->points.push_back (PointXYZ (10.0 * ((double)rand () / (double)RAND_MAX),
+                                         10.0 * ((double)rand () / (double)RAND_MAX),
+                                         10.0 * ((double)rand () / (double)RAND_MAX)));
+
+  octree_search.setInputCloud (cloudIn);
+  octree_search.addPointsFromInputCloud ();
+
+  std::vector<Eigen::Vector3f> origins (rayCount);
+  std::vector<Eigen::Vector3f> directions (rayCount);
+  for (i = 0; i < rayCount; i++)
+  {
+    origins[i] = Eigen::Vector3f (14.0 * ((double)rand () / (double)RAND_MAX) - 2.0,
+                                  14.0 * ((double)rand () / (double)RAND_MAX) - 2.0,
+                                  14.0 * ((double)rand () / (double)RAND_MAX) - 2.0);
+    directions[i] = Eigen::Vector3f ((double)rand () / (double)RAND_MAX - 0.5,
+                                     (double)rand () / (double)RAND_MAX - 0.5,
+                                     (double)rand () / (double)RAND_MAX - 0.5);
+  }
+
+  std::vector<pcl::PointXYZ, Eigen::aligned_allocator<pcl::PointXYZ> > voxelCenters, firstVoxelCenters;
+  std::vector<int> indices, firstIndices;
+  std::vector<int> voxelOffsets, firstVoxelOffsets, indexOffsets, firstIndexOffsets;
+
+  octree_search.getIntersectedVoxelCenters (origins, directions, voxelCenters, voxelOffsets);
+  octree_search.getIntersectedVoxelCenters (origins, directions, firstVoxelCenters, firstVoxelOffsets, true);
+  octree_search.getIntersectedVoxelIndices (origins, directions, indices, indexOffsets);
+  octree_search.getIntersectedVoxelIndices (origins, directions, firstIndices, firstIndexOffsets, true);
+
+  ASSERT_EQ(voxelOffsets.size (), rayCount + 1);
+  ASSERT_EQ(firstVoxelOffsets.size (), rayCount + 1);
+  ASSERT_EQ(indexOffsets.size (), rayCount + 1);
+  ASSERT_EQ(firstIndexOffsets.size (), rayCount + 1);
+
+  // batch results match single rays
+  std::vector<pcl::PointXYZ, Eigen::aligned_allocator<pcl::PointXYZ> > voxelsInRay;
+  std::vector<int> indicesInRay;
+  for (i = 0; i < rayCount; i++)
+  {
+    octree_search.getIntersectedVoxelCenters (origins[i], directions[i], voxelsInRay);
+    octree_search.getIntersectedVoxelIndices (origins[i], directions[i], indicesInRay);
+
+    ASSERT_EQ(voxelOffsets[i + 1] - voxelOffsets[i], static_cast<int> (voxelsInRay.size ()));
+    for (j = 0; j < voxelsInRay.size (); j++)
+    {
+      ASSERT_EQ(voxelCenters[voxelOffsets[i] + j].x, voxelsInRay[j].x);
+      ASSERT_EQ(voxelCenters[voxelOffsets[i] + j].y, voxelsInRay[j].y);
+      ASSERT_EQ(voxelCenters[voxelOffsets[i] + j].z, voxelsInRay[j].z);
+    }
+
+    ASSERT_EQ(indexOffsets[i + 1] - indexOffsets[i], static_cast<int> (indicesInRay.size ()));
+    for (j = 0; j < indicesInRay.size (); j++)
+      ASSERT_EQ(indices[indexOffsets[i] + j], indicesInRay[j]);
+
+    // first hit is the first voxel along the ray
+    ASSERT_EQ(firstVoxelOffsets[i + 1] - firstVoxelOffsets[i], voxelsInRay.empty () ? 0 : 1);
+    if (!voxelsInRay.empty ())
+    {
+      ASSERT_EQ(firstVoxelCenters[firstVoxelOffsets[i]].x, voxelsInRay[0].x);
+      ASSERT_EQ(firstVoxelCenters[firstVoxelOffsets[i]].y, voxelsInRay[0].y);
+      ASSERT_EQ(firstVoxelCenters[firstVoxelOffsets[i]].z, voxelsInRay[0].z);
+
+      std::vector<int> firstVoxelIndices;
+      octree_search.voxelSearch (voxelsInRay[0], firstVoxelIndices);
+      ASSERT_EQ(firstIndexOffsets[i + 1] - firstIndexOffsets[i], static_cast<int> (firstVoxelIndices.size ()));
+    }
+  }
+}
+
+TEST (PCL, Octree_Pointcloud_Linear_Search)
+{
+  const unsigned int test_runs = 20;
+  unsigned int test_id;
+
+  // instantiate point cloud
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+
+  size_t i;
+
+  srand (time (NULL));
+
+  for (test_id = 0; test_id < test_runs; test_id++)
+  {
+    // generate point cloud
+    cloudIn->width = 1000;
+    cloudIn->height = 1;
+    cloudIn->points.resize (cloudIn->width * cloudIn->height);
+    for (i = 0; i < cloudIn->points.size (); i++)
+    {
+      cloudIn->points[i] = PointXYZ (10.0 * ((double)rand () / (double)RAND_MAX),
+                                     10.0 * ((double)rand () / (double)RAND_MAX),
+                                     5.0 * ((double)rand () / (double)RAND_MAX));
+    }
+
+    OctreePointCloudSearch<PointXYZ> octree (0.3 + (double)rand () / (double)RAND_MAX);
+    octree.setInputCloud (cloudIn);
+    octree.addPointsFromInputCloud ();
+
+    OctreePointCloudLinear<PointXYZ> linearOctree;
+    linearOctree.freeze (octree);
+
+    ASSERT_EQ (linearOctree.getLeafCount (), octree.getLeafCount ());
+    ASSERT_EQ (linearOctree.getBranchCount (), octree.getBranchCount ());
+    ASSERT_EQ (linearOctree.getPointCount (), cloudIn->points.size ());
+
+    for (unsigned int query = 0; query < 10; query++)
+    {
+      PointXYZ searchPoint (10.0 * ((double)rand () / (double)RAND_MAX),
+                            10.0 * ((double)rand () / (double)RAND_MAX),
+                            5.0 * ((double)rand () / (double)RAND_MAX));
+
+      std::vector<int> k_indices, k_indices_linear;
+      std::vector<float> k_sqr_distances, k_sqr_distances_linear;
+
+      // radius search returns identical results in identical order
+      double radius = 2.0 * ((double)rand () / (double)RAND_MAX);
+      octree.radiusSearch (searchPoint, radius, k_indices, k_sqr_distances);
+      linearOctree.radiusSearch (searchPoint, radius, k_indices_linear, k_sqr_distances_linear);
+      ASSERT_EQ (k_indices_linear.size (), k_indices.size ());
+      for (i = 0; i < k_indices.size (); i++)
+      {
+        ASSERT_EQ (k_indices_linear[i], k_indices[i]);
+        EXPECT_NEAR (k_sqr_distances_linear[i], k_sqr_distances[i], 1e-4);
+      }
+
+      // nearest neighbor search returns the same neighbor distances
+      int K = 1 + rand () % 20;
+      octree.nearestKSearch (searchPoint, K, k_indices, k_sqr_distances);
+      linearOctree.nearestKSearch (searchPoint, K, k_indices_linear, k_sqr_distances_linear);
+      ASSERT_EQ (k_indices_linear.size (), k_indices.size ());
+      for (i = 0; i < k_indices.size (); i++)
+        EXPECT_NEAR (k_sqr_distances_linear[i], k_sqr_distances[i], 1e-4);
+
+      // voxel search
+      const PointXYZ& voxelPoint = cloudIn->points[rand () % cloudIn->points.size ()];
+      k_indices.clear ();
+      ASSERT_TRUE (octree.voxelSearch (voxelPoint, k_indices));
+      ASSERT_TRUE (linearOctree.voxelSearch (voxelPoint, k_indices_linear));
+      ASSERT_EQ (k_indices_linear, k_indices);
+
+      // ray traversal
+      Eigen::Vector3f origin (-1.0f, -1.0f, -1.0f);
+      Eigen::Vector3f direction (searchPoint.x + 1.0f, searchPoint.y + 1.0f, searchPoint.z + 1.0f);
+      int voxelCount = octree.getIntersectedVoxelIndices (origin, direction, k_indices);
+      int voxelCountLinear = linearOctree.getIntersectedVoxelIndices (origin, direction, k_indices_linear);
+      ASSERT_EQ (voxelCountLinear, voxelCount);
+      ASSERT_EQ (k_indices_linear, k_indices);
+    }
+  }
+}
+
+TEST (PCL, Octree_Pointcloud_Linear_Image)
+{
+  const char* fileName = "test_octree_linear_image.bin";
+
+  // instantiate point cloud
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+
+  size_t i;
+
+  srand (time (NULL));
+
+  cloudIn->width = 1000;
+  cloudIn->height = 1;
+  cloudIn->points.resize (cloudIn->width * cloudIn->height);
+  for (i = 0; i < cloudIn->points.size (); i++)
+  {
+    cloudIn->points[i] = PointXYZ (10.0 * ((double)rand () / (double)RAND_MAX),
+                                   10.0 * ((double)rand () / (double)RAND_MAX),
+                                   5.0 * ((double)rand () / (double)RAND_MAX));
+  }
+
+  OctreePointCloudSearch<PointXYZ> octree (0.5);
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+
+  OctreePointCloudLinear<PointXYZ> linearOctree;
+  ASSERT_FALSE (linearOctree.saveImage (fileName));
+  linearOctree.freeze (octree);
+  ASSERT_TRUE (linearOctree.saveImage (fileName));
+
+  OctreePointCloudLinear<PointXYZ> mappedOctree, loadedOctree;
+  ASSERT_TRUE (mappedOctree.mapImage (fileName));
+  ASSERT_TRUE (loadedOctree.loadImage (fileName));
+  ASSERT_TRUE (mappedOctree.isMapped ());
+  ASSERT_FALSE (loadedOctree.isMapped ());
+
+  const OctreePointCloudLinear<PointXYZ>* images[2] = {&mappedOctree, &loadedOctree};
+  for (int image = 0; image < 2; image++)
+  {
+    const OctreePointCloudLinear<PointXYZ>& imageOctree = *images[image];
+
+    ASSERT_EQ (imageOctree.getLeafCount (), linearOctree.getLeafCount ());
+    ASSERT_EQ (imageOctree.getBranchCount (), linearOctree.getBranchCount ());
+    ASSERT_EQ (imageOctree.getPointCount (), linearOctree.getPointCount ());
+    ASSERT_EQ (imageOctree.getTreeDepth (), linearOctree.getTreeDepth ());
+    ASSERT_EQ (imageOctree.getResolution (), linearOctree.getResolution ());
+
+    for (unsigned int query = 0; query < 10; query++)
+    {
+      PointXYZ searchPoint (10.0 * ((double)rand () / (double)RAND_MAX),
+                            10.0 * ((double)rand () / (double)RAND_MAX),
+                            5.0 * ((double)rand () / (double)RAND_MAX));
+
+      std::vector<int> k_indices, k_indices_image;
+      std::vector<float> k_sqr_distances, k_sqr_distances_image;
+
+      linearOctree.radiusSearch (searchPoint, 1.5, k_indices, k_sqr_distances);
+      imageOctree.radiusSearch (searchPoint, 1.5, k_indices_image, k_sqr_distances_image);
+      ASSERT_EQ (k_indices_image, k_indices);
+      ASSERT_EQ (k_sqr_distances_image, k_sqr_distances);
+
+      linearOctree.nearestKSearch (searchPoint, 8, k_indices, k_sqr_distances);
+      imageOctree.nearestKSearch (searchPoint, 8, k_indices_image, k_sqr_distances_image);
+      ASSERT_EQ (k_indices_image, k_indices);
+      ASSERT_EQ (k_sqr_distances_image, k_sqr_distances);
+
+      const PointXYZ& voxelPoint = cloudIn->points[rand () % cloudIn->points.size ()];
+      ASSERT_TRUE (linearOctree.voxelSearch (voxelPoint, k_indices));
+      ASSERT_TRUE (imageOctree.voxelSearch (voxelPoint, k_indices_image));
+      ASSERT_EQ (k_indices_image, k_indices);
+    }
+  }
+
+  // index based queries resolve their query point through an input cloud provided by the user
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  mappedOctree.setInputCloud (cloudIn);
+  ASSERT_GT (mappedOctree.nearestKSearch (0, 1, k_indices, k_sqr_distances), 0);
+  ASSERT_EQ (k_sqr_distances[0], 0.0f);
+
+  // copies share the mapping
+  OctreePointCloudLinear<PointXYZ> mappedCopy (mappedOctree);
+  mappedOctree.freeze (octree);
+  ASSERT_TRUE (mappedCopy.isMapped ());
+  ASSERT_TRUE (mappedCopy.voxelSearch (cloudIn->points[0], k_indices));
+
+  // images of another point type, truncated files and foreign files are rejected
+  OctreePointCloudLinear<PointXYZRGB> otherTypeOctree;
+  ASSERT_FALSE (otherTypeOctree.mapImage (fileName));
+
+  FILE* file = fopen (fileName, "rb");
+  ASSERT_TRUE (file != NULL);
+  std::vector<char> image;
+  int c;
+  while ((c = fgetc (file)) != EOF)
+    image.push_back (static_cast<char> (c));
+  fclose (file);
+
+  file = fopen (fileName, "wb");
+  fwrite (&image[0], 1, image.size () - 1, file);
+  fclose (file);
+  ASSERT_FALSE (loadedOctree.mapImage (fileName));
+
+  file = fopen (fileName, "wb");
+  fputs ("not an octree image, just some text that is longer than an image header is. not an octree image, "
+         "just some text that is longer than an image header is.", file);
+  fclose (file);
+  ASSERT_FALSE (loadedOctree.mapImage (fileName));
+  ASSERT_FALSE (loadedOctree.mapImage ("non_existing_octree_image.bin"));
+
+  remove (fileName);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -0,0 +1,392 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Boost
+#include <boost/bind.hpp>
+
+// PCL (Urban Robotics)
+#include "pcl/outofcore/octree_async_query.h"
+
+template<typename Container, typename PointType>
+octree_async_query<Container, PointType>::octree_async_query (tree_type& tree, const unsigned int nr_threads) :
+  tree (tree), jobs (), queries (), failed_queries (), next_query (0), next_seq (0), stopping (false)
+{
+  const unsigned int n = (nr_threads == 0) ? 1 : nr_threads;
+  for (unsigned int i = 0; i < n; i++)
+  {
+    workers.create_thread (boost::bind (&octree_async_query<Container, PointType>::run, this));
+  }
+}
+
+template<typename Container, typename PointType>
+octree_async_query<Container, PointType>::~octree_async_query ()
+{
+  {
+    boost::mutex::scoped_lock lock (queue_mutex);
+    stopping = true;
+    for (typename std::map<boost::uint64_t, boost::shared_ptr<query_state> >::iterator it = queries.begin ();
+         it != queries.end (); ++it)
+    {
+      it->second->cancelled = true;
+    }
+  }
+  queue_cond.notify_all ();
+  done_cond.notify_all ();
+  workers.join_all ();
+}
+
+template<typename Container, typename PointType> boost::uint64_t
+octree_async_query<Container, PointType>::queryBBIncludes (const double min[3], const double max[3],
+                                                           const double eye[3], const double error_budget,
+                                                           const callback_type& callback)
+{
+  //the box as six planes: x - min >= 0 and max - x >= 0 per axis
+  double planes[6][4];
+  for (int i = 0; i < 3; i++)
+  {
+    double* lower = planes[2 * i];
+    double* upper = planes[2 * i + 1];
+    lower[0] = lower[1] = lower[2] = 0;
+    upper[0] = upper[1] = upper[2] = 0;
+    lower[i] = 1;
+    lower[3] = -min[i];
+    upper[i] = -1;
+    upper[3] = max[i];
+  }
+  return (start (planes, eye, error_budget, callback));
+}
+
+template<typename Container, typename PointType> boost::uint64_t
+octree_async_query<Container, PointType>::queryFrustum (const double planes[6][4], const double eye[3],
+                                                        const double error_budget, const callback_type& callback)
+{
+  return (start (planes, eye, error_budget, callback));
+}
+
+template<typename Container, typename PointType> boost::uint64_t
+octree_async_query<Container, PointType>::start (const double planes[6][4], const double eye[3],
+                                                 const double error_budget, const callback_type& callback)
+{
+  boost::shared_ptr<query_state> query (new query_state);
+  memcpy (query->planes, planes, 6 * 4 * sizeof(double));
+  memcpy (query->eye, eye, 3 * sizeof(double));
+  query->error_budget = error_budget;
+  query->callback = callback;
+  query->outstanding = 0;
+  query->cancelled = false;
+  query->failed = false;
+
+  boost::mutex::scoped_lock lock (queue_mutex);
+  query->id = next_query++;
+  if ((tree.root != NULL) && !stopping && push (tree.root, query))
+  {
+    queries[query->id] = query;
+    queue_cond.notify_one ();
+  }
+  return (query->id);
+}
+
+template<typename Container, typename PointType> void
+octree_async_query<Container, PointType>::cancel (const boost::uint64_t query_id)
+{
+  boost::mutex::scoped_lock lock (queue_mutex);
+  typename std::map<boost::uint64_t, boost::shared_ptr<query_state> >::iterator it = queries.find (query_id);
+  if (it != queries.end ())
+  {
+    it->second->cancelled = true;
+  }
+}
+
+template<typename Container, typename PointType> bool
+octree_async_query<Container, PointType>::wait (const boost::uint64_t query_id)
+{
+  boost::mutex::scoped_lock lock (queue_mutex);
+  while (!stopping && (queries.find (query_id) != queries.end ()))
+  {
+    done_cond.wait (lock);
+  }
+  return (failed_queries.erase (query_id) == 0);
+}
+
+template<typename Container, typename PointType> size_t
+octree_async_query<Container, PointType>::getNumRunning () const
+{
+  boost::mutex::scoped_lock lock (queue_mutex);
+  return (queries.size ());
+}
+
+template<typename Container, typename PointType> bool
+octree_async_query<Container, PointType>::push (node_type* node, const boost::shared_ptr<query_state>& query)
+{
+  double min[3];
+  double max[3];
+  node->getBB (min, max);
+
+  const int c = classify (query->planes, min, max);
+  if (c < 0)
+  {
+    return (false);
+  }
+
+  job j;
+  j.node = node;
+  j.query = query;
+  j.depth = node->depth;
+  j.error = projectedError (query->eye, min, max);
+  j.inside = (c > 0);
+  j.seq = next_seq++;
+  jobs.push (j);
+
+  query->outstanding++;
+  return (true);
+}
+
+template<typename Container, typename PointType> void
+octree_async_query<Container, PointType>::finish (const boost::shared_ptr<query_state>& query)
+{
+  if (--query->outstanding == 0)
+  {
+    if (query->failed)
+    {
+      failed_queries.insert (query->id);
+    }
+    queries.erase (query->id);
+    done_cond.notify_all ();
+  }
+}
+
+template<typename Container, typename PointType> void
+octree_async_query<Container, PointType>::run ()
+{
+  for (;;)
+  {
+    job j;
+    {
+      boost::mutex::scoped_lock lock (queue_mutex);
+      while (jobs.empty () && !stopping)
+      {
+        queue_cond.wait (lock);
+      }
+      if (stopping)
+      {
+        return;
+      }
+
+      j = jobs.top ();
+      jobs.pop ();
+
+      if (j.query->cancelled)
+      {
+        finish (j.query);
+        continue;
+      }
+    }
+
+    process (j);
+  }
+}
+
+template<typename Container, typename PointType> void
+octree_async_query<Container, PointType>::process (job& j)
+{
+  query_state& query = *(j.query);
+  node_type* node = j.node;
+
+  result_type result;
+  result.query_id = query.id;
+  result.depth = node->depth;
+  node->getBB (result.min, result.max);
+  result.refined = false;
+
+  std::vector<node_type*> children;
+  bool ok = true;
+  try
+  {
+    {
+      boost::shared_lock < boost::shared_mutex > lock (tree.read_write_mutex);
+
+      if ((node->depth < tree.maxDepth) && (j.error > query.error_budget))
+      {
+        boost::mutex::scoped_lock load_lock (load_mutex);
+        if ((node->numchild == 0) && node->hasUnloadedChildren ())
+        {
+          node->loadChildren (false);
+        }
+
+        for (int i = 0; i < 8; i++)
+        {
+          node_type* child = node->children[i];
+          if (child == NULL)
+          {
+            continue;
+          }
+
+          double min[3];
+          double max[3];
+          child->getBB (min, max);
+          if (classify (query.planes, min, max) >= 0)
+          {
+            children.push_back (child);
+          }
+        }
+      }
+      result.refined = !children.empty ();
+
+      const boost::uint64_t size = node->payload->size ();
+      if (size > 0)
+      {
+        node->payload->readRange (0, size, result.points);
+        if (!j.inside)
+        {
+          size_t kept = 0;
+          for (size_t i = 0; i < result.points.size (); i++)
+          {
+            if (pointInside (query.planes, result.points[i]))
+            {
+              result.points[kept++] = result.points[i];
+            }
+          }
+          result.points.resize (kept);
+        }
+      }
+    }
+
+    bool cancelled;
+    {
+      boost::mutex::scoped_lock lock (queue_mutex);
+      cancelled = query.cancelled;
+    }
+
+    //deliver outside the tree lock, and before queueing the children so
+    //that coarse points arrive first
+    if (!result.points.empty () && !cancelled)
+    {
+      query.callback (result);
+    }
+  }
+  catch (...)
+  {
+    ok = false;
+  }
+
+  boost::mutex::scoped_lock lock (queue_mutex);
+  if (!ok)
+  {
+    query.failed = true;
+  }
+  else if (!query.cancelled && !stopping)
+  {
+    for (size_t i = 0; i < children.size (); i++)
+    {
+      push (children[i], j.query);
+    }
+    queue_cond.notify_all ();
+  }
+  finish (j.query);
+}
+
+template<typename Container, typename PointType> bool
+octree_async_query<Container, PointType>::pointInside (const double planes[6][4], const PointType& p)
+{
+  for (int i = 0; i < 6; i++)
+  {
+    const double* pl = planes[i];
+    if ((pl[0] * p.x + pl[1] * p.y + pl[2] * p.z + pl[3]) < 0)
+    {
+      return (false);
+    }
+  }
+  return (true);
+}
+
+template<typename Container, typename PointType> int
+octree_async_query<Container, PointType>::classify (const double planes[6][4], const double min[3],
+                                                    const double max[3])
+{
+  bool inside = true;
+  for (int i = 0; i < 6; i++)
+  {
+    const double* pl = planes[i];
+
+    //corners farthest along and against the plane normal
+    double far_side = pl[3];
+    double near_side = pl[3];
+    for (int k = 0; k < 3; k++)
+    {
+      far_side += pl[k] * ((pl[k] >= 0) ? max[k] : min[k]);
+      near_side += pl[k] * ((pl[k] >= 0) ? min[k] : max[k]);
+    }
+
+    if (far_side < 0)
+    {
+      return (-1);
+    }
+    if (near_side < 0)
+    {
+      inside = false;
+    }
+  }
+  return (inside ? 1 : 0);
+}
+
+template<typename Container, typename PointType> double
+octree_async_query<Container, PointType>::projectedError (const double eye[3], const double min[3],
+                                                          const double max[3])
+{
+  double edge = 0;
+  double dist2 = 0;
+  for (int k = 0; k < 3; k++)
+  {
+    edge = std::max (edge, max[k] - min[k]);
+
+    const double d = std::max (std::max (min[k] - eye[k], eye[k] - max[k]), 0.0);
+    dist2 += d * d;
+  }
+
+  if (dist2 == 0)
+  {
+    return (std::numeric_limits<double>::max ());
+  }
+  return (edge / std::sqrt (dist2));
+}
@@ -0,0 +1,366 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+// PCL (Urban Robotics)
+#include "pcl/outofcore/octree_bulk_ingester.h"
+#include "pcl/outofcore/octree_exceptions.h"
+
+template<typename Container, typename PointType>
+octree_bulk_ingester<Container, PointType>::octree_bulk_ingester (tree_type& tree, const size_t memory_budget) :
+  tree (tree), buffers (), checked (), buffered (0), budget (memory_budget), threads (1)
+{
+}
+
+template<typename Container, typename PointType>
+octree_bulk_ingester<Container, PointType>::~octree_bulk_ingester ()
+{
+  try
+  {
+    flush ();
+  }
+  catch (const OctreeException& e)
+  {
+    std::cerr << "octree_bulk_ingester: could not flush buffered points: " << e.what () << std::endl;
+  }
+}
+
+template<typename Container, typename PointType> inline int
+octree_bulk_ingester<Container, PointType>::childIndex (const node_type* node, const PointType& pt)
+{
+  //same split as octree_base_node::addDataToLeaf: idx = 4*z + 2*y + x
+  return (((pt.z >= node->midz) ? 4 : 0) + ((pt.y >= node->midy) ? 2 : 0) + ((pt.x >= node->midx) ? 1 : 0));
+}
+
+template<typename Container, typename PointType> void
+octree_bulk_ingester<Container, PointType>::makeChild (node_type* node, const int idx)
+{
+  //pick up children stored on disk once per node
+  if (checked.insert (node).second)
+  {
+    if ((node->numchild < 8) && node->hasUnloadedChildren ())
+    {
+      node->loadChildren (false);
+    }
+  }
+
+  if (node->children[idx] == NULL)
+  {
+    node->createChild (idx);
+    //a fresh node has nothing on disk below it
+    checked.insert (node->children[idx]);
+  }
+}
+
+template<typename Container, typename PointType> boost::uint64_t
+octree_bulk_ingester<Container, PointType>::addData (const std::vector<PointType>& p)
+{
+  if (p.empty () || (tree.root == NULL))
+  {
+    return 0;
+  }
+
+  boost::unique_lock < boost::shared_mutex > lock (tree.read_write_mutex);
+
+  node_type* const root = tree.root;
+  const boost::uint64_t max_depth = tree.maxDepth;
+  const long len = static_cast<long> (p.size ());
+
+  //node reached by each point, NULL if it is outside the tree
+  std::vector<node_type*> leaf (p.size ());
+#pragma omp parallel for schedule (static) num_threads (threads)
+  for (long i = 0; i < len; i++)
+  {
+    leaf[i] = root->pointWithinBB (p[i]) ? root : NULL;
+  }
+
+  std::vector<size_t> pending;
+  pending.reserve (p.size ());
+  for (size_t i = 0; i < p.size (); i++)
+  {
+    if (leaf[i] != NULL)
+    {
+      pending.push_back (i);
+    }
+  }
+  const boost::uint64_t accepted = pending.size ();
+
+  //descend in parallel as far as the existing nodes reach, then create the
+  //missing children serially and continue with the points that stopped
+  std::vector<size_t> stopped;
+  while (!pending.empty ())
+  {
+    const long num_pending = static_cast<long> (pending.size ());
+#pragma omp parallel for schedule (static) num_threads (threads)
+    for (long k = 0; k < num_pending; k++)
+    {
+      const PointType& pt = p[pending[k]];
+      node_type* node = leaf[pending[k]];
+      while (node->depth < max_depth)
+      {
+        node_type* child = node->children[childIndex (node, pt)];
+        if (child == NULL)
+        {
+          break;
+        }
+        node = child;
+      }
+      leaf[pending[k]] = node;
+    }
+
+    stopped.clear ();
+    for (size_t k = 0; k < pending.size (); k++)
+    {
+      node_type* node = leaf[pending[k]];
+      if (node->depth < max_depth)
+      {
+        makeChild (node, childIndex (node, p[pending[k]]));
+        stopped.push_back (pending[k]);
+      }
+    }
+    pending.swap (stopped);
+  }
+
+  //append to the write-back buffers; neighbouring points mostly share a leaf
+  node_type* last = NULL;
+  std::vector<PointType>* buff = NULL;
+  for (size_t i = 0; i < p.size (); i++)
+  {
+    if (leaf[i] == NULL)
+    {
+      continue;
+    }
+    if (leaf[i] != last)
+    {
+      last = leaf[i];
+      buff = &buffers[last];
+    }
+    buff->push_back (p[i]);
+  }
+  buffered += accepted;
+  tree.count_point (max_depth, accepted);
+
+  if (getBufferedBytes () > budget)
+  {
+    flushBuffers (budget / sizeof(PointType) / 2);
+  }
+
+  return (accepted);
+}
+
+template<typename Container, typename PointType> void
+octree_bulk_ingester<Container, PointType>::flushBuffers (const size_t target)
+{
+  if (buffered <= target)
+  {
+    return;
+  }
+
+  //largest buffers first
+  std::vector<std::pair<size_t, node_type*> > sizes;
+  sizes.reserve (buffers.size ());
+  for (typename boost::unordered_map<node_type*, std::vector<PointType> >::const_iterator it = buffers.begin ();
+       it != buffers.end (); ++it)
+  {
+    sizes.push_back (std::make_pair (it->second.size (), it->first));
+  }
+  std::sort (sizes.begin (), sizes.end (), std::greater<std::pair<size_t, node_type*> > ());
+
+  std::vector<std::pair<node_type*, std::vector<PointType>*> > victims;
+  size_t remaining = buffered;
+  for (size_t i = 0; (i < sizes.size ()) && (remaining > target); i++)
+  {
+    victims.push_back (std::make_pair (sizes[i].second, &buffers[sizes[i].second]));
+    remaining -= sizes[i].first;
+  }
+
+  //each leaf has its own file, so the writes are independent
+  std::vector<char> written (victims.size (), 0);
+  const long num_victims = static_cast<long> (victims.size ());
+#pragma omp parallel for schedule (dynamic) num_threads (threads)
+  for (long k = 0; k < num_victims; k++)
+  {
+    std::vector<PointType>& b = *(victims[k].second);
+    try
+    {
+      victims[k].first->payload->insertRange (&(b.front ()), b.size ());
+      written[k] = 1;
+    }
+    catch (...)
+    {
+    }
+  }
+
+  //keep what could not be written, so a later flush can retry it
+  bool failed = false;
+  for (size_t k = 0; k < victims.size (); k++)
+  {
+    if (written[k])
+    {
+      buffers.erase (victims[k].first);
+    }
+    else
+    {
+      remaining += victims[k].second->size ();
+      failed = true;
+    }
+  }
+  buffered = remaining;
+
+  if (failed)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+}
+
+template<typename Container, typename PointType> void
+octree_bulk_ingester<Container, PointType>::flush ()
+{
+  boost::unique_lock < boost::shared_mutex > lock (tree.read_write_mutex);
+  flushBuffers (0);
+}
+
+//loads chunks of up to 2e7 pts at a time
+template<typename Container, typename PointType> void
+octree_bulk_ingester<Container, PointType>::buildLOD ()
+{
+  if (tree.root == NULL)
+  {
+    std::cerr << "root is null, aborting buildLOD" << std::endl;
+    return;
+  }
+
+  boost::unique_lock < boost::shared_mutex > lock (tree.read_write_mutex);
+  flushBuffers (0);
+
+  const boost::uint64_t max_depth = tree.maxDepth;
+
+  //gather the nodes of every level, loading the parts of the tree not in memory
+  std::vector<std::vector<node_type*> > levels (max_depth + 1);
+  levels[0].push_back (tree.root);
+  for (boost::uint64_t d = 0; d < max_depth; d++)
+  {
+    for (size_t k = 0; k < levels[d].size (); k++)
+    {
+      node_type* node = levels[d][k];
+      if (checked.insert (node).second && (node->numchild < 8) && node->hasUnloadedChildren ())
+      {
+        node->loadChildren (false);
+      }
+      for (int i = 0; i < 8; i++)
+      {
+        if (node->children[i] != NULL)
+        {
+          levels[d + 1].push_back (node->children[i]);
+        }
+      }
+    }
+  }
+
+  //clear the LOD, in case we are updating it
+  for (boost::uint64_t d = 0; d < max_depth; d++)
+  {
+    for (size_t k = 0; k < levels[d].size (); k++)
+    {
+      levels[d][k]->payload->clear ();
+    }
+    tree.lodPoints[d] = 0;
+  }
+
+  //each level is a sample of the level below it, so the levels are built
+  //bottom-up and the nodes of one level are independent
+  static const boost::uint64_t loadcount = boost::uint64_t (2e7);
+  const double percent = node_type::sample_precent;
+  for (boost::uint64_t d = max_depth; d-- > 0;)
+  {
+    const std::vector<node_type*>& nodes = levels[d];
+    std::vector<boost::uint64_t> added (nodes.size (), 0);
+
+    bool failed = false;
+    const long num_nodes = static_cast<long> (nodes.size ());
+#pragma omp parallel for schedule (dynamic) num_threads (threads)
+    for (long k = 0; k < num_nodes; k++)
+    {
+      node_type* node = nodes[k];
+      try
+      {
+        std::vector<PointType> v;
+        for (int i = 0; i < 8; i++)
+        {
+          node_type* child = node->children[i];
+          if (child == NULL)
+          {
+            continue;
+          }
+
+          const boost::uint64_t child_size = child->payload->size ();
+          for (boost::uint64_t startp = 0; startp < child_size; startp += loadcount)
+          {
+            v.clear ();
+            child->payload->readRangeSubSample (startp, std::min (loadcount, child_size - startp), percent, v);
+            if (!v.empty ())
+            {
+              node->payload->insertRange (&(v.front ()), v.size ());
+              added[k] += v.size ();
+            }
+          }
+        }
+      }
+      catch (...)
+      {
+#pragma omp critical
+        failed = true;
+      }
+    }
+
+    if (failed)
+    {
+      throw OctreeException (OctreeException::OCT_BAD_PATH);
+    }
+
+    for (size_t k = 0; k < added.size (); k++)
+    {
+      tree.count_point (d, added[k]);
+    }
+  }
+}
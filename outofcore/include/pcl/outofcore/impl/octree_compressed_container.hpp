@@ -0,0 +1,679 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+
+// Boost
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/bernoulli_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+// PCL
+#include <pcl/io/lzf.h>
+
+// PCL (Urban Robotics)
+#include "pcl/outofcore/octree_compressed_container.h"
+#include "pcl/outofcore/octree_disk_container.h"
+#include "pcl/outofcore/octree_disk_file_cache.h"
+#include "pcl/outofcore/octree_exceptions.h"
+
+//allows operation on POSIX
+#ifndef WIN32
+#define _fseeki64 fseeko
+#endif
+
+template<typename PointType>
+const boost::uint32_t octree_compressed_container<PointType>::block_points;
+
+template<typename PointType>
+boost::mutex octree_compressed_container<PointType>::rng_mutex;
+
+#pragma warning(push)
+#pragma warning(disable : 4244)
+template<typename PointType>
+boost::mt19937 octree_compressed_container<PointType>::rand_gen (std::time (NULL));
+#pragma warning(pop)
+
+template<typename PointType>
+octree_compressed_container<PointType>::octree_compressed_container () :
+  fileback_name (), writebuff (), blocks (), filelen (0), filebytes (0), quantization_step (0)
+{
+  quantization_origin[0] = quantization_origin[1] = quantization_origin[2] = 0;
+  octree_disk_container<PointType>::getRandomUUIDString (fileback_name);
+}
+
+template<typename PointType>
+octree_compressed_container<PointType>::octree_compressed_container (const boost::filesystem::path& path) :
+  fileback_name (), writebuff (), blocks (), filelen (0), filebytes (0), quantization_step (0)
+{
+  quantization_origin[0] = quantization_origin[1] = quantization_origin[2] = 0;
+  if (boost::filesystem::exists (path) && boost::filesystem::is_directory (path))
+  {
+    std::string uuid;
+    octree_disk_container<PointType>::getRandomUUIDString (uuid);
+    fileback_name = (path / boost::filesystem::path (uuid)).string ();
+  }
+  else
+  {
+    fileback_name = path.string ();
+    scanBlocks ();
+  }
+}
+
+template<typename PointType>
+octree_compressed_container<PointType>::~octree_compressed_container ()
+{
+  flush_writebuff (true);
+  octree_disk_file_cache::instance ().close (fileback_name);
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::setQuantization (const double step, const double origin[3])
+{
+  quantization_step = (step > 0) ? step : 0;
+  memcpy (quantization_origin, origin, 3 * sizeof(double));
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::scanBlocks ()
+{
+  if (!boost::filesystem::exists (fileback_name))
+  {
+    return;
+  }
+
+  const boost::uint64_t len = boost::filesystem::file_size (fileback_name);
+  FILE* f = fopen (fileback_name.c_str (), "rb");
+  if (f == NULL)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  block_header h;
+  while ((filebytes + sizeof(block_header)) <= len)
+  {
+    int seekret = _fseeki64 (f, filebytes, SEEK_SET);
+    assert (seekret == 0);
+    if (fread (&h, sizeof(block_header), 1, f) != 1)
+    {
+      break;
+    }
+
+    const boost::uint64_t end = filebytes + sizeof(block_header) + h.bytes;
+    if ((h.count == 0) || (h.count > block_points) || (end > len))
+    {
+      //a block cut short by a crash; ignore it
+      std::cerr << "octree_compressed_container: ignoring damaged block in " << fileback_name << std::endl;
+      break;
+    }
+
+    block_entry e;
+    e.offset = filebytes;
+    e.first = filelen;
+    e.count = h.count;
+    blocks.push_back (e);
+
+    //appended blocks keep the quantization of the file
+    quantization_step = (h.flags & BLOCK_QUANTIZED) ? h.step : 0;
+    if (h.flags & BLOCK_QUANTIZED)
+    {
+      memcpy (quantization_origin, h.origin, 3 * sizeof(double));
+    }
+
+    filelen += h.count;
+    filebytes = end;
+  }
+
+  fclose (f);
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::writeBlock (const PointType* start, const boost::uint32_t count)
+{
+  block_header h;
+  memset (&h, 0, sizeof(block_header));
+  h.count = count;
+
+  std::vector<PointType> pts (start, start + count);
+
+  //quantize the coordinates relative to the origin
+  std::vector<boost::uint32_t> q;
+  const double step = quantization_step;
+  if (step > 0)
+  {
+    bool fits = true;
+    boost::uint32_t qmax = 0;
+    q.resize (3 * count);
+    for (boost::uint32_t i = 0; (i < count) && fits; i++)
+    {
+      const double c[3] = {pts[i].x, pts[i].y, pts[i].z};
+      for (int k = 0; k < 3; k++)
+      {
+        const double v = std::floor ((c[k] - quantization_origin[k]) / step + 0.5);
+        if (!((v >= 0) && (v <= 4294967295.0)))
+        {
+          fits = false;
+          break;
+        }
+        q[3 * i + k] = static_cast<boost::uint32_t> (v);
+        qmax = std::max (qmax, q[3 * i + k]);
+      }
+    }
+
+    if (fits)
+    {
+      h.flags |= BLOCK_QUANTIZED;
+      memcpy (h.origin, quantization_origin, 3 * sizeof(double));
+      h.step = step;
+      while ((h.bits < 32) && ((qmax >> h.bits) != 0))
+      {
+        h.bits++;
+      }
+      for (boost::uint32_t i = 0; i < count; i++)
+      {
+        pts[i].x = pts[i].y = pts[i].z = 0;
+      }
+    }
+    else
+    {
+      q.clear ();
+    }
+  }
+
+  //shuffle: byte b of point i goes to b*count + i
+  const size_t pointbytes = count * sizeof(PointType);
+  const size_t rawlen = pointbytes + (q.size () * h.bits + 7) / 8;
+  std::vector<char> shuffled (rawlen);
+  const char* in = reinterpret_cast<const char*> (&pts.front ());
+  for (size_t b = 0; b < sizeof(PointType); b++)
+  {
+    char* out = &shuffled[b * count];
+    for (boost::uint32_t i = 0; i < count; i++)
+    {
+      out[i] = in[i * sizeof(PointType) + b];
+    }
+  }
+
+  //the quantized coordinates follow, h.bits bits each
+  boost::uint64_t acc = 0;
+  unsigned int accbits = 0;
+  char* packed = &shuffled[0] + pointbytes;
+  for (size_t i = 0; i < q.size (); i++)
+  {
+    acc |= boost::uint64_t (q[i]) << accbits;
+    accbits += h.bits;
+    while (accbits >= 8)
+    {
+      *packed++ = static_cast<char> (acc & 0xff);
+      acc >>= 8;
+      accbits -= 8;
+    }
+  }
+  if (accbits > 0)
+  {
+    *packed = static_cast<char> (acc & 0xff);
+  }
+
+  //header and data are appended together
+  std::vector<char> buff (sizeof(block_header) + rawlen);
+  unsigned int clen = pcl::lzfCompress (&shuffled.front (), static_cast<unsigned int> (rawlen),
+                                        &buff[sizeof(block_header)], static_cast<unsigned int> (rawlen - 1));
+  if (clen > 0)
+  {
+    h.flags |= BLOCK_LZF;
+    h.bytes = clen;
+  }
+  else
+  {
+    memcpy (&buff[sizeof(block_header)], &shuffled.front (), rawlen);
+    h.bytes = static_cast<boost::uint32_t> (rawlen);
+  }
+  memcpy (&buff.front (), &h, sizeof(block_header));
+
+  const size_t len = sizeof(block_header) + h.bytes;
+  octree_disk_file_cache::instance ().append (fileback_name, &buff.front (), len);
+
+  block_entry e;
+  e.offset = filebytes;
+  e.first = filelen;
+  e.count = count;
+  blocks.push_back (e);
+
+  filebytes += len;
+  filelen += count;
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::readBlock (FILE* f, const size_t b, std::vector<PointType>& points) const
+{
+  const block_entry& e = blocks[b];
+
+  block_header h;
+  int seekret = _fseeki64 (f, e.offset, SEEK_SET);
+  assert (seekret == 0);
+  if ((fread (&h, sizeof(block_header), 1, f) != 1) || (h.count != e.count))
+  {
+    throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+  }
+
+  std::vector<char> data (h.bytes);
+  if (fread (&data.front (), 1, h.bytes, f) != h.bytes)
+  {
+    throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+  }
+
+  const boost::uint32_t count = h.count;
+  const bool quantized = (h.flags & BLOCK_QUANTIZED) != 0;
+  const size_t pointbytes = count * sizeof(PointType);
+  if (quantized && (h.bits > 32))
+  {
+    throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+  }
+  const size_t rawlen = pointbytes + (quantized ? (3 * size_t (count) * h.bits + 7) / 8 : 0);
+
+  std::vector<char> decompressed;
+  const char* shuffled = &data.front ();
+  if (h.flags & BLOCK_LZF)
+  {
+    decompressed.resize (rawlen);
+    if (pcl::lzfDecompress (&data.front (), h.bytes, &decompressed.front (),
+                            static_cast<unsigned int> (rawlen)) != rawlen)
+    {
+      throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+    }
+    shuffled = &decompressed.front ();
+  }
+  else if (h.bytes != rawlen)
+  {
+    throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+  }
+
+  points.resize (count);
+  char* out = reinterpret_cast<char*> (&points.front ());
+  for (size_t b = 0; b < sizeof(PointType); b++)
+  {
+    const char* in = shuffled + b * count;
+    for (boost::uint32_t i = 0; i < count; i++)
+    {
+      out[i * sizeof(PointType) + b] = in[i];
+    }
+  }
+
+  if (quantized)
+  {
+    const boost::uint64_t mask = (boost::uint64_t (1) << h.bits) - 1;
+    const unsigned char* packed = reinterpret_cast<const unsigned char*> (shuffled + pointbytes);
+    boost::uint64_t acc = 0;
+    unsigned int accbits = 0;
+    for (boost::uint32_t i = 0; i < count; i++)
+    {
+      double c[3];
+      for (int k = 0; k < 3; k++)
+      {
+        while (accbits < h.bits)
+        {
+          acc |= boost::uint64_t (*packed++) << accbits;
+          accbits += 8;
+        }
+        c[k] = h.origin[k] + double (acc & mask) * h.step;
+        acc >>= h.bits;
+        accbits -= h.bits;
+      }
+      points[i].x = static_cast<float> (c[0]);
+      points[i].y = static_cast<float> (c[1]);
+      points[i].z = static_cast<float> (c[2]);
+    }
+  }
+}
+
+template<typename PointType> size_t
+octree_compressed_container<PointType>::findBlock (const boost::uint64_t idx) const
+{
+  size_t lo = 0;
+  size_t hi = blocks.size ();
+  while ((hi - lo) > 1)
+  {
+    const size_t mid = (lo + hi) / 2;
+    if (blocks[mid].first <= idx)
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return (lo);
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::flush_writebuff (const bool forceCacheDeAlloc)
+{
+  for (size_t pos = 0; pos < writebuff.size (); pos += block_points)
+  {
+    writeBlock (&writebuff[pos], static_cast<boost::uint32_t> (std::min<size_t> (block_points, writebuff.size () - pos)));
+  }
+  writebuff.clear ();
+
+  if (forceCacheDeAlloc)
+  {
+    std::vector<PointType> ().swap (writebuff);
+  }
+}
+
+template<typename PointType> PointType
+octree_compressed_container<PointType>::operator[] (boost::uint64_t idx)
+{
+  if (idx < filelen)
+  {
+    FILE* f = fopen (fileback_name.c_str (), "rb");
+    assert (f != NULL);
+    std::vector<PointType> points;
+    const size_t b = findBlock (idx);
+    readBlock (f, b, points);
+    fclose (f);
+    return points[static_cast<size_t> (idx - blocks[b].first)];
+  }
+
+  if (idx < (filelen + writebuff.size ()))
+  {
+    return writebuff[static_cast<size_t> (idx - filelen)];
+  }
+  throw("out of range");
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::push_back (const PointType& p)
+{
+  writebuff.push_back (p);
+  if (writebuff.size () >= block_points)
+  {
+    flush_writebuff (false);
+  }
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::insertRange (const PointType* const * start, const boost::uint64_t count)
+{
+  //copy the handles to a continous block
+  std::vector<PointType> arr (static_cast<size_t> (count));
+  for (size_t i = 0; i < count; i++)
+  {
+    arr[i] = *(start[i]);
+  }
+  if (!arr.empty ())
+  {
+    insertRange (&arr.front (), count);
+  }
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::insertRange (const PointType* start, const boost::uint64_t count)
+{
+  //keep the points in insertion order
+  flush_writebuff (false);
+
+  for (boost::uint64_t pos = 0; pos < count; pos += block_points)
+  {
+    writeBlock (start + pos, static_cast<boost::uint32_t> (std::min<boost::uint64_t> (block_points, count - pos)));
+  }
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::readRange (const boost::uint64_t start, const boost::uint64_t count,
+                                                   std::vector<PointType>& v)
+{
+  if ((start + count) > size ())
+  {
+    throw("out of range");
+  }
+
+  v.clear ();
+  if (count == 0)
+  {
+    return;
+  }
+  v.reserve (static_cast<size_t> (count));
+
+  const boost::uint64_t end = start + count;
+  if (start < filelen)
+  {
+    FILE* f = fopen (fileback_name.c_str (), "rb");
+    assert (f != NULL);
+
+    std::vector<PointType> points;
+    for (size_t b = findBlock (start); (b < blocks.size ()) && (blocks[b].first < end); b++)
+    {
+      readBlock (f, b, points);
+
+      const boost::uint64_t first = blocks[b].first;
+      const size_t from = static_cast<size_t> (std::max (start, first) - first);
+      const size_t to = static_cast<size_t> (std::min (end, first + blocks[b].count) - first);
+      v.insert (v.end (), points.begin () + from, points.begin () + to);
+    }
+
+    fclose (f);
+  }
+
+  if (end > filelen)
+  {
+    const size_t from = static_cast<size_t> (std::max (start, filelen) - filelen);
+    v.insert (v.end (), writebuff.begin () + from, writebuff.begin () + static_cast<size_t> (end - filelen));
+  }
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::readSortedOffsets (const std::vector<boost::uint64_t>& offsets,
+                                                           std::vector<PointType>& v)
+{
+  if (offsets.empty ())
+  {
+    return;
+  }
+
+  FILE* f = fopen (fileback_name.c_str (), "rb");
+  assert (f != NULL);
+
+  //decompress each touched block once
+  std::vector<PointType> points;
+  size_t b = blocks.size ();
+  for (size_t i = 0; i < offsets.size (); i++)
+  {
+    if ((b == blocks.size ()) || (offsets[i] >= (blocks[b].first + blocks[b].count)))
+    {
+      b = findBlock (offsets[i]);
+      readBlock (f, b, points);
+    }
+    v.push_back (points[static_cast<size_t> (offsets[i] - blocks[b].first)]);
+  }
+
+  fclose (f);
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::readRangeSubSample (const boost::uint64_t start, const boost::uint64_t count,
+                                                            const double percent, std::vector<PointType>& v)
+{
+  if (count == 0)
+  {
+    return;
+  }
+
+  v.clear ();
+
+  const boost::uint64_t end = start + count;
+  const boost::uint64_t filecount = (start < filelen) ? (std::min (end, filelen) - start) : 0;
+  const boost::uint64_t buffstart = std::max (start, filelen) - filelen;
+  const boost::uint64_t buffcount = count - filecount;
+
+  const boost::uint64_t filesamp = boost::uint64_t (percent * filecount);
+  const boost::uint64_t buffsamp = boost::uint64_t (percent * buffcount);
+
+  if ((filesamp == 0) && (buffsamp == 0) && (size () > 0))
+  {
+    readRangeSubSample_bernoulli (start, count, percent, v);
+    return;
+  }
+
+  std::vector<boost::uint64_t> offsets (static_cast<size_t> (filesamp));
+  std::vector<boost::uint64_t> buffoffsets (static_cast<size_t> (buffsamp));
+  {
+    boost::mutex::scoped_lock lock (rng_mutex);
+
+    if (filesamp > 0)
+    {
+      boost::uniform_int<boost::uint64_t> filedist (start, start + filecount - 1);
+      boost::variate_generator<boost::mt19937&, boost::uniform_int<boost::uint64_t> > filedie (rand_gen, filedist);
+      for (size_t i = 0; i < offsets.size (); i++)
+      {
+        offsets[i] = filedie ();
+      }
+    }
+
+    if (buffsamp > 0)
+    {
+      boost::uniform_int<boost::uint64_t> buffdist (buffstart, buffstart + buffcount - 1);
+      boost::variate_generator<boost::mt19937&, boost::uniform_int<boost::uint64_t> > buffdie (rand_gen, buffdist);
+      for (size_t i = 0; i < buffoffsets.size (); i++)
+      {
+        buffoffsets[i] = buffdie ();
+      }
+    }
+  }
+
+  for (size_t i = 0; i < buffoffsets.size (); i++)
+  {
+    v.push_back (writebuff[static_cast<size_t> (buffoffsets[i])]);
+  }
+
+  std::sort (offsets.begin (), offsets.end ());
+  readSortedOffsets (offsets, v);
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::readRangeSubSample_bernoulli (const boost::uint64_t start,
+                                                                      const boost::uint64_t count,
+                                                                      const double percent,
+                                                                      std::vector<PointType>& v)
+{
+  if (count == 0)
+  {
+    return;
+  }
+
+  v.clear ();
+
+  const boost::uint64_t end = start + count;
+  std::vector<boost::uint64_t> offsets;
+  std::vector<boost::uint64_t> buffoffsets;
+  {
+    boost::mutex::scoped_lock lock (rng_mutex);
+    boost::bernoulli_distribution<double> dist (percent);
+    boost::variate_generator<boost::mt19937&, boost::bernoulli_distribution<double> > coin (rand_gen, dist);
+
+    for (boost::uint64_t i = start; i < end; i++)
+    {
+      if (coin ())
+      {
+        if (i < filelen)
+        {
+          offsets.push_back (i);
+        }
+        else
+        {
+          buffoffsets.push_back (i - filelen);
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < buffoffsets.size (); i++)
+  {
+    v.push_back (writebuff[static_cast<size_t> (buffoffsets[i])]);
+  }
+
+  readSortedOffsets (offsets, v);
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::clear ()
+{
+  writebuff.clear ();
+  octree_disk_file_cache::instance ().close (fileback_name);
+  boost::filesystem::remove (boost::filesystem::path (fileback_name));
+  blocks.clear ();
+  filelen = 0;
+  filebytes = 0;
+}
+
+template<typename PointType> void
+octree_compressed_container<PointType>::convertToXYZ (const boost::filesystem::path& path)
+{
+  if (empty ())
+  {
+    return;
+  }
+
+  FILE* fxyz = fopen (path.string ().c_str (), "w");
+  if (fxyz == NULL)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  std::vector<PointType> points;
+  for (boost::uint64_t pos = 0; pos < size (); pos += block_points)
+  {
+    readRange (pos, std::min<boost::uint64_t> (block_points, size () - pos), points);
+    for (size_t i = 0; i < points.size (); i++)
+    {
+      std::stringstream ss;
+      ss << std::fixed;
+      ss.precision (16);
+      ss << points[i].x << "\t" << points[i].y << "\t" << points[i].z << "\n";
+
+      fwrite (ss.str ().c_str (), 1, ss.str ().size (), fxyz);
+    }
+  }
+
+  fclose (fxyz);
+}
@@ -40,6 +40,7 @@
 #include <sstream>
 #include <cassert>
 #include <ctime>
+#include <algorithm>
 
 // Boost
 #include <boost/filesystem.hpp>
@@ -60,6 +61,7 @@
 //allows operation on POSIX
 #ifndef WIN32
 #define _fseeki64 fseeko
+#include <fcntl.h>
 #endif
 
 template<typename PointType>
@@ -137,6 +139,7 @@ template<typename PointType>
 octree_disk_container<PointType>::~octree_disk_container ()
 {
   flush_writebuff (true);
+  octree_disk_file_cache::instance ().close (*fileback_name);
   //fileback.flush();
   //fileback.close();
   //std::remove(persistant->c_str());
@@ -151,15 +154,8 @@ octree_disk_container<PointType>::flush_writebuff (const bool forceCacheDeAlloc)
 {
   if (writebuff.size () > 0)
   {
-    FILE* f = fopen (fileback_name->c_str (), "a+b");
-
-    size_t len = writebuff.size () * sizeof(PointType);
-    char* loc = (char*)&(writebuff.front ());
-    size_t w = fwrite (loc, 1, len, f);
-    assert (w == len);
-
-    //		int closeret = fclose(f);
-    fclose (f);
+    octree_disk_file_cache::instance ().append (*fileback_name, &(writebuff.front ()),
+                                                writebuff.size () * sizeof(PointType));
 
     filelen += writebuff.size ();
     writebuff.clear ();
@@ -294,6 +290,68 @@ octree_disk_container<PointType>::readRange (const boost::uint64_t start, const
 
 }
 
+template<typename PointType> void
+octree_disk_container<PointType>::readSortedOffsets (const std::vector<boost::uint64_t>& offsets,
+                                                     std::vector<PointType>& v)
+{
+  if (offsets.empty ())
+  {
+    return;
+  }
+
+  //reading across a gap of up to 64KB is cheaper than a seek and another
+  //read call; a single block read is at most 4MB
+  const static boost::uint64_t maxgap = std::max<boost::uint64_t> (1, (1 << 16) / sizeof(PointType));
+  const static boost::uint64_t maxblock = std::max<boost::uint64_t> (1, (1 << 22) / sizeof(PointType));
+
+  FILE* f = fopen (fileback_name->c_str (), "rb");
+  assert (f != NULL);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+  //the offsets are sorted, so the file is read front to back
+  const off_t first = static_cast<off_t> (offsets.front () * sizeof(PointType));
+  const off_t span = static_cast<off_t> ((offsets.back () - offsets.front () + 1) * sizeof(PointType));
+  posix_fadvise (fileno (f), first, span, POSIX_FADV_SEQUENTIAL);
+  posix_fadvise (fileno (f), first, span, POSIX_FADV_WILLNEED);
+#endif
+
+  v.reserve (v.size () + offsets.size ());
+
+  std::vector<PointType> block;
+  boost::uint64_t filepos = boost::uint64_t (-1);
+  size_t i = 0;
+  while (i < offsets.size ())
+  {
+    //coalesce nearby offsets into one sequential read
+    size_t j = i + 1;
+    while ((j < offsets.size ()) && ((offsets[j] - offsets[j - 1]) <= maxgap) && ((offsets[j] - offsets[i]) < maxblock))
+    {
+      j++;
+    }
+
+    const boost::uint64_t blockstart = offsets[i];
+    const boost::uint64_t blocklen = offsets[j - 1] - blockstart + 1;
+    block.resize (static_cast<size_t> (blocklen));
+
+    if (filepos != blockstart)
+    {
+      int seekret = _fseeki64 (f, blockstart * static_cast<boost::uint64_t> (sizeof(PointType)), SEEK_SET);
+      assert (seekret == 0);
+    }
+    size_t readlen = fread (&(block.front ()), sizeof(PointType), static_cast<size_t> (blocklen), f);
+    assert (readlen == blocklen);
+    filepos = blockstart + blocklen;
+
+    for (size_t k = i; k < j; k++)
+    {
+      v.push_back (block[static_cast<size_t> (offsets[k] - blockstart)]);
+    }
+    i = j;
+  }
+
+  fclose (f);
+}
+
 template<typename PointType> void
 octree_disk_container<PointType>::readRangeSubSample_bernoulli (const boost::uint64_t start,
                                                                 const boost::uint64_t count, 
@@ -366,21 +424,7 @@ octree_disk_container<PointType>::readRangeSubSample_bernoulli (const boost::uin
     }
     std::sort (offsets.begin (), offsets.end ());
 
-    FILE* f = fopen (fileback_name->c_str (), "rb");
-    assert (f != NULL);
-    PointType p;
-    char* loc = (char*)&p;
-    boost::uint64_t filesamp = offsets.size ();
-    for (boost::uint64_t i = 0; i < filesamp; i++)
-    {
-      int seekret = _fseeki64 (f, offsets[i] * static_cast<boost::uint64_t>(sizeof(PointType)), SEEK_SET);
-      assert (seekret == 0);
-      size_t readlen = fread (loc, sizeof(PointType), 1, f);
-      assert (readlen == 1);
-
-      v.push_back (p);
-    }
-    int closeret = fclose (f);
+    readSortedOffsets (offsets, v);
   }
 }
 
@@ -463,20 +507,7 @@ octree_disk_container<PointType>::readRangeSubSample (const boost::uint64_t star
     }
     std::sort (offsets.begin (), offsets.end ());
 
-    FILE* f = fopen (fileback_name->c_str (), "rb");
-    assert (f != NULL);
-    PointType p;
-    char* loc = (char*)&p;
-    for (boost::uint64_t i = 0; i < filesamp; i++)
-    {
-      int seekret = _fseeki64 (f, offsets[i] * static_cast<boost::uint64_t> (sizeof(PointType)), SEEK_SET);
-      assert (seekret == 0);
-      size_t readlen = fread (loc, sizeof(PointType), 1, f);
-      assert (readlen == 1);
-
-      v.push_back (p);
-    }
-    int closeret = fclose (f);
+    readSortedOffsets (offsets, v);
   }
 }
 
@@ -493,28 +524,8 @@ octree_disk_container<PointType>::push_back (const PointType& p)
 template<typename PointType> inline void
 octree_disk_container<PointType>::insertRange (const PointType* start, const boost::uint64_t count)
 {
-  FILE* f = fopen (fileback_name->c_str (), "a+b");
-
-  //write at most 2 million elements at a ime
-  const static size_t blocksize = (size_t)2e6;
-
-  for (boost::uint64_t pos = 0; pos < count; pos += blocksize)
-  {
-    const PointType* loc = start + pos;
-    if ((pos + blocksize) < count)
-    {
-      size_t w = fwrite (loc, sizeof(PointType), blocksize, f);
-      assert (w == blocksize);
-    }
-    else
-    {
-      size_t w = fwrite (loc, sizeof(PointType), (size_t) (count - pos), f);
-      assert (w == count - pos);
-    }
-  }
-
-  //	int closeret = fclose(f);
-  fclose (f);
+  //appends go through the shared handle cache instead of reopening the file
+  octree_disk_file_cache::instance ().append (*fileback_name, start, static_cast<size_t> (count) * sizeof(PointType));
 
   filelen += count;
 }
@@ -0,0 +1,528 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <cstring>
+#include <iostream>
+
+// PCL (Urban Robotics)
+#include "pcl/outofcore/octree_packed.h"
+#include "pcl/outofcore/octree_exceptions.h"
+
+//allows operation on POSIX
+#ifndef WIN32
+#define _fseeki64 fseeko
+#endif
+
+template<typename PointType>
+const char octree_packed<PointType>::magic[8] = "PCLOPAK";
+
+template<typename PointType>
+const boost::uint32_t octree_packed<PointType>::version;
+
+template<typename PointType>
+const boost::uint32_t octree_packed<PointType>::byte_order;
+
+template<typename PointType> boost::filesystem::path
+octree_packed<PointType>::dataPath (const boost::filesystem::path& file)
+{
+  return boost::filesystem::path (file.string () + "_dat");
+}
+
+template<typename PointType>
+octree_packed<PointType>::octree_packed (const boost::filesystem::path& file) :
+  table (new pcl::octree::OctreeMappedFile), header (NULL), lod_points (NULL), level_nodes (NULL), nodes (NULL),
+  data_file (dataPath (file).string ())
+{
+  if (!table->open (file.string ()) || !boost::filesystem::exists (data_file))
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  const char* data = table->getData ();
+  const size_t size = table->getSize ();
+  if (size < sizeof(packed_header))
+  {
+    throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+  }
+
+  header = reinterpret_cast<const packed_header*> (data);
+  if ((memcmp (header->magic, magic, sizeof(magic)) != 0) || (header->version != version)
+      || (header->byte_order != byte_order) || (header->point_size != sizeof(PointType))
+      || (header->node_size != sizeof(octree_packed_node)) || (header->max_depth > 32) || (header->node_count == 0))
+  {
+    std::cerr << "packed octree " << file << " has the wrong format for this point type" << std::endl;
+    throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+  }
+
+  //the table: header, points per LOD, first node per LOD, nodes
+  const boost::uint64_t depths = header->max_depth + 1;
+  const boost::uint64_t expected = sizeof(packed_header) + (2 * depths + 1) * sizeof(boost::uint64_t)
+    + header->node_count * sizeof(octree_packed_node);
+  if (size != expected)
+  {
+    throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+  }
+
+  lod_points = reinterpret_cast<const boost::uint64_t*> (data + sizeof(packed_header));
+  level_nodes = lod_points + depths;
+  nodes = reinterpret_cast<const octree_packed_node*> (level_nodes + depths + 1);
+
+  if (!validTable () || (boost::filesystem::file_size (data_file) / sizeof(PointType) < header->point_count))
+  {
+    std::cerr << "packed octree " << file << " is corrupt" << std::endl;
+    throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+  }
+}
+
+template<typename PointType> bool
+octree_packed<PointType>::validTable () const
+{
+  const boost::uint64_t node_count = header->node_count;
+  const boost::uint64_t depths = header->max_depth + 1;
+
+  if (memchr (header->coord_system, 0, sizeof(header->coord_system)) == NULL)
+  {
+    return false;
+  }
+
+  //the LODs are contiguous ranges covering all nodes, starting at the root
+  if ((level_nodes[0] != 0) || (level_nodes[depths] != node_count))
+  {
+    return false;
+  }
+  for (boost::uint64_t d = 0; d < depths; d++)
+  {
+    if (level_nodes[d] > level_nodes[d + 1])
+    {
+      return false;
+    }
+  }
+
+  //queries walk the children and read the point ranges without further checks
+  for (boost::uint64_t k = 0; k < node_count; k++)
+  {
+    const octree_packed_node& n = nodes[k];
+    if ((n.depth >= depths) || (k < level_nodes[n.depth]) || (k >= level_nodes[n.depth + 1]))
+    {
+      return false;
+    }
+    if ((n.count > header->point_count) || (n.first > header->point_count - n.count))
+    {
+      return false;
+    }
+    for (int i = 0; i < 8; i++)
+    {
+      //children are stored after their parent, which also rules out cycles
+      const boost::uint32_t c = n.children[i];
+      if ((c != 0) && ((c <= k) || (c >= node_count) || (nodes[c].depth != n.depth + 1)))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+template<typename PointType> template<typename Container> void
+octree_packed<PointType>::pack (octree_base<Container, PointType>& tree, const boost::filesystem::path& file)
+{
+  typedef octree_base_node<Container, PointType> node_type;
+
+  if (tree.root == NULL)
+  {
+    throw OctreeException (OctreeException::OCT_MISSING_DIR);
+  }
+
+  boost::unique_lock < boost::shared_mutex > lock (tree.read_write_mutex);
+
+  //breadth first, so that every LOD is a contiguous range of nodes
+  std::vector<node_type*> order (1, tree.root);
+  std::vector<octree_packed_node> records (1);
+  memset (&records[0], 0, sizeof(octree_packed_node));
+  for (size_t k = 0; k < order.size (); k++)
+  {
+    node_type* node = order[k];
+    if ((node->numchild == 0) && node->hasUnloadedChildren ())
+    {
+      node->loadChildren (false);
+    }
+
+    memcpy (records[k].min, node->min, 3 * sizeof(double));
+    memcpy (records[k].max, node->max, 3 * sizeof(double));
+    records[k].depth = static_cast<boost::uint32_t> (node->depth);
+
+    for (int i = 0; i < 8; i++)
+    {
+      if (node->children[i] != NULL)
+      {
+        octree_packed_node child;
+        memset (&child, 0, sizeof(octree_packed_node));
+        child.parent = static_cast<boost::uint32_t> (k);
+
+        records[k].children[i] = static_cast<boost::uint32_t> (order.size ());
+        order.push_back (node->children[i]);
+        records.push_back (child);
+      }
+    }
+  }
+
+  if (order.size () > 0xffffffffu)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  //copy the payloads, 2 million points at a time
+  const boost::filesystem::path data_path = dataPath (file);
+  FILE* f = fopen (data_path.string ().c_str (), "wb");
+  if (f == NULL)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  const static boost::uint64_t blocksize = boost::uint64_t (2e6);
+  const boost::uint64_t max_depth = tree.maxDepth;
+  std::vector<boost::uint64_t> lod (max_depth + 1, 0);
+  boost::uint64_t total = 0;
+  std::vector<PointType> v;
+  for (size_t k = 0; k < order.size (); k++)
+  {
+    const boost::uint64_t count = order[k]->payload->size ();
+    records[k].first = total;
+    records[k].count = count;
+    for (boost::uint64_t pos = 0; pos < count; pos += blocksize)
+    {
+      const boost::uint64_t len = std::min (blocksize, count - pos);
+      order[k]->payload->readRange (pos, len, v);
+      if (fwrite (&(v.front ()), sizeof(PointType), static_cast<size_t> (len), f) != len)
+      {
+        fclose (f);
+        throw OctreeException (OctreeException::OCT_BAD_PATH);
+      }
+    }
+    total += count;
+    lod[records[k].depth] += count;
+  }
+  fclose (f);
+
+  std::vector<boost::uint64_t> levels (max_depth + 2, order.size ());
+  for (size_t k = order.size (); k-- > 0;)
+  {
+    levels[records[k].depth] = k;
+  }
+  for (size_t d = max_depth; d-- > 0;)
+  {
+    //empty levels start where the next one does
+    levels[d] = std::min (levels[d], levels[d + 1]);
+  }
+
+  packed_header h;
+  memset (&h, 0, sizeof(packed_header));
+  memcpy (h.magic, magic, sizeof(magic));
+  h.version = version;
+  h.byte_order = byte_order;
+  h.point_size = sizeof(PointType);
+  h.node_size = sizeof(octree_packed_node);
+  h.max_depth = max_depth;
+  h.node_count = order.size ();
+  h.point_count = total;
+  tree.root->getBB (h.min, h.max);
+  strncpy (h.coord_system, tree.coord_system.c_str (), sizeof(h.coord_system) - 1);
+
+  f = fopen (file.string ().c_str (), "wb");
+  if (f == NULL)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+  bool ok = (fwrite (&h, sizeof(packed_header), 1, f) == 1);
+  ok = ok && (fwrite (&lod.front (), sizeof(boost::uint64_t), lod.size (), f) == lod.size ());
+  ok = ok && (fwrite (&levels.front (), sizeof(boost::uint64_t), levels.size (), f) == levels.size ());
+  ok = ok && (fwrite (&records.front (), sizeof(octree_packed_node), records.size (), f) == records.size ());
+  ok = (fclose (f) == 0) && ok;
+  if (!ok)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+}
+
+template<typename PointType> template<typename Container> void
+octree_packed<PointType>::unpack (const boost::filesystem::path& rootname) const
+{
+  octree_base<Container, PointType> tree (static_cast<int> (header->max_depth), header->min, header->max,
+                                          rootname, get_coord_system ());
+
+  FILE* f = fopen (data_file.c_str (), "rb");
+  if (f == NULL)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  try
+  {
+    unpackNode (tree.root, 0, f);
+  }
+  catch (...)
+  {
+    fclose (f);
+    throw;
+  }
+  fclose (f);
+
+  tree.lodPoints.assign (lod_points, lod_points + header->max_depth + 1);
+}
+
+template<typename PointType> template<typename Container> void
+octree_packed<PointType>::unpackNode (octree_base_node<Container, PointType>* node, const size_t idx, FILE* f) const
+{
+  const octree_packed_node& n = nodes[idx];
+
+  //keep the stored boxes; recomputing them in createChild may round differently
+  memcpy (node->min, n.min, 3 * sizeof(double));
+  memcpy (node->max, n.max, 3 * sizeof(double));
+  node->midx = (node->max[0] + node->min[0]) / double (2);
+  node->midy = (node->max[1] + node->min[1]) / double (2);
+  node->midz = (node->max[2] + node->min[2]) / double (2);
+  node->saveIdx (false);
+
+  const static boost::uint64_t blocksize = boost::uint64_t (2e6);
+  std::vector<PointType> v;
+  for (boost::uint64_t pos = 0; pos < n.count; pos += blocksize)
+  {
+    readPoints (f, n.first + pos, std::min (blocksize, n.count - pos), v);
+    node->payload->insertRange (&(v.front ()), v.size ());
+  }
+
+  for (int i = 0; i < 8; i++)
+  {
+    if (n.children[i] != 0)
+    {
+      node->createChild (i);
+      unpackNode (node->children[i], n.children[i], f);
+    }
+  }
+}
+
+template<typename PointType> void
+octree_packed<PointType>::getBB (double min[3], double max[3]) const
+{
+  memcpy (min, header->min, 3 * sizeof(double));
+  memcpy (max, header->max, 3 * sizeof(double));
+}
+
+template<typename PointType> void
+octree_packed<PointType>::readPoints (FILE* f, const boost::uint64_t first, const boost::uint64_t count,
+                                      std::vector<PointType>& v)
+{
+  v.resize (static_cast<size_t> (count));
+  if (count == 0)
+  {
+    return;
+  }
+
+  int seekret = _fseeki64 (f, first * static_cast<boost::uint64_t> (sizeof(PointType)), SEEK_SET);
+  if ((seekret != 0) || (fread (&(v.front ()), sizeof(PointType), static_cast<size_t> (count), f) != count))
+  {
+    throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+  }
+}
+
+template<typename PointType> void
+octree_packed<PointType>::readNode (const size_t idx, std::vector<PointType>& v) const
+{
+  FILE* f = fopen (data_file.c_str (), "rb");
+  if (f == NULL)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  try
+  {
+    readPoints (f, nodes[idx].first, nodes[idx].count, v);
+  }
+  catch (...)
+  {
+    fclose (f);
+    throw;
+  }
+  fclose (f);
+}
+
+template<typename PointType> void
+octree_packed<PointType>::queryBBIncludes (const double min[3], const double max[3], const size_t query_depth,
+                                           std::vector<PointType>& v) const
+{
+  FILE* f = fopen (data_file.c_str (), "rb");
+  if (f == NULL)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  try
+  {
+    queryBBIncludes (f, 0, min, max, query_depth, v);
+  }
+  catch (...)
+  {
+    fclose (f);
+    throw;
+  }
+  fclose (f);
+}
+
+template<typename PointType> void
+octree_packed<PointType>::queryBBIncludes (const double min[3], const double max[3], const size_t query_depth,
+                                           std::list<PointType>& v) const
+{
+  std::vector<PointType> points;
+  queryBBIncludes (min, max, query_depth, points);
+  v.insert (v.end (), points.begin (), points.end ());
+}
+
+template<typename PointType> void
+octree_packed<PointType>::queryBBIncludes (FILE* f, const size_t idx, const double min[3], const double max[3],
+                                           const size_t query_depth, std::vector<PointType>& v) const
+{
+  const octree_packed_node& n = nodes[idx];
+  if (!intersectsWithBB (n, min, max))
+  {
+    return;
+  }
+
+  if (n.depth < query_depth)
+  {
+    for (int i = 0; i < 8; i++)
+    {
+      if (n.children[i] != 0)
+      {
+        queryBBIncludes (f, n.children[i], min, max, query_depth, v);
+      }
+    }
+    return;
+  }
+
+  if (withinBB (n, min, max))
+  {
+    const size_t start = v.size ();
+    v.resize (start + static_cast<size_t> (n.count));
+    if (n.count > 0)
+    {
+      int seekret = _fseeki64 (f, n.first * static_cast<boost::uint64_t> (sizeof(PointType)), SEEK_SET);
+      if ((seekret != 0) || (fread (&v[start], sizeof(PointType), static_cast<size_t> (n.count), f) != n.count))
+      {
+        throw OctreeException (OctreeException::OCT_PARSE_FAILURE);
+      }
+    }
+    return;
+  }
+
+  std::vector<PointType> points;
+  readPoints (f, n.first, n.count, points);
+  for (size_t i = 0; i < points.size (); i++)
+  {
+    const PointType& p = points[i];
+    if ((min[0] <= p.x) && (p.x <= max[0]) && (min[1] <= p.y) && (p.y <= max[1]) && (min[2] <= p.z)
+        && (p.z <= max[2]))
+    {
+      v.push_back (p);
+    }
+  }
+}
+
+template<typename PointType> void
+octree_packed<PointType>::queryBBIntersects (const double min[3], const double max[3],
+                                             const boost::uint32_t query_depth,
+                                             std::vector<size_t>& node_ids) const
+{
+  queryBBIntersects (0, min, max, query_depth, node_ids);
+}
+
+template<typename PointType> void
+octree_packed<PointType>::queryBBIntersects (const size_t idx, const double min[3], const double max[3],
+                                             const boost::uint32_t query_depth,
+                                             std::vector<size_t>& node_ids) const
+{
+  const octree_packed_node& n = nodes[idx];
+  if (!intersectsWithBB (n, min, max))
+  {
+    return;
+  }
+
+  if (n.depth < query_depth)
+  {
+    for (int i = 0; i < 8; i++)
+    {
+      if (n.children[i] != 0)
+      {
+        queryBBIntersects (n.children[i], min, max, query_depth, node_ids);
+      }
+    }
+    return;
+  }
+
+  if (n.count > 0)
+  {
+    node_ids.push_back (idx);
+  }
+}
+
+template<typename PointType> inline bool
+octree_packed<PointType>::intersectsWithBB (const octree_packed_node& n, const double minbb[3], const double maxbb[3])
+{
+  for (int i = 0; i < 3; i++)
+  {
+    if (!(((n.min[i] <= minbb[i]) && (minbb[i] <= n.max[i])) || ((minbb[i] <= n.min[i]) && (n.min[i] <= maxbb[i]))))
+    {
+      return (false);
+    }
+  }
+  return (true);
+}
+
+template<typename PointType> inline bool
+octree_packed<PointType>::withinBB (const octree_packed_node& n, const double minbb[3], const double maxbb[3])
+{
+  for (int i = 0; i < 3; i++)
+  {
+    if (!((minbb[i] <= n.min[i]) && (n.max[i] <= maxbb[i])))
+    {
+      return (false);
+    }
+  }
+  return (true);
+}
@@ -0,0 +1,333 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <iostream>
+#include <limits>
+#include <list>
+
+// PCL
+#include <pcl/search/search.h>
+
+// PCL (Urban Robotics)
+#include "pcl/outofcore/octree_tile_processor.h"
+#include "pcl/outofcore/octree_exceptions.h"
+#include "pcl/outofcore/impl/octree_bulk_ingester.hpp"
+
+template<typename Container, typename PointType> template<typename Function>
+struct octree_tile_processor<Container, PointType>::user_function
+{
+  Function fn;
+
+  user_function (Function f) :
+    fn (f)
+  {
+  }
+
+  template<typename PointOutT> void
+  operator() (const tile&, const PointCloudConstPtr& cloud, const IndicesPtr& core,
+              pcl::PointCloud<PointOutT>& result)
+  {
+    fn (cloud, core, result);
+  }
+};
+
+template<typename Container, typename PointType> template<typename FilterT>
+struct octree_tile_processor<Container, PointType>::filter_function
+{
+  const FilterT& prototype;
+  const octree_tile_processor& processor;
+
+  filter_function (const FilterT& f, const octree_tile_processor& p) :
+    prototype (f), processor (p)
+  {
+  }
+
+  typedef typename pcl::search::Search<PointType>::Ptr SearchPtr;
+
+  /** \brief Only matches filters with a setSearchMethod of their own */
+  template<typename T, void (T::*) (const SearchPtr&)>
+  struct search_method_setter
+  {
+  };
+
+  //the copy would share the prototype's search object with the other threads
+  template<typename T> static void
+  resetSearchMethod (T& f, search_method_setter<T, &T::setSearchMethod>*)
+  {
+    f.setSearchMethod (SearchPtr ());
+  }
+
+  //filters such as VoxelGrid have no search object
+  template<typename T> static void
+  resetSearchMethod (T&, ...)
+  {
+  }
+
+  void
+  operator() (const tile& t, const PointCloudConstPtr& cloud, const IndicesPtr& core, PointCloud& result) const
+  {
+    FilterT f (prototype);
+    resetSearchMethod<FilterT> (f, 0);
+    f.setInputCloud (cloud);
+    f.setIndices (core);
+    f.filter (result);
+
+    //drop what lies in the halo, e.g. voxels of VoxelGrid centered there
+    size_t kept = 0;
+    for (size_t i = 0; i < result.points.size (); i++)
+    {
+      if (processor.inCore (t, result.points[i]))
+      {
+        result.points[kept++] = result.points[i];
+      }
+    }
+    result.points.resize (kept);
+    result.width = static_cast<uint32_t> (kept);
+    result.height = 1;
+  }
+};
+
+template<typename Container, typename PointType> template<typename FeatureT>
+struct octree_tile_processor<Container, PointType>::feature_function
+{
+  const FeatureT& prototype;
+
+  feature_function (const FeatureT& f) :
+    prototype (f)
+  {
+  }
+
+  template<typename PointOutT> void
+  operator() (const tile&, const PointCloudConstPtr& cloud, const IndicesPtr& core,
+              pcl::PointCloud<PointOutT>& result) const
+  {
+    FeatureT f (prototype);
+    //the copy would share the prototype's search object with the other threads
+    f.setSearchMethod (typename FeatureT::KdTreePtr ());
+    f.setInputCloud (cloud);
+    f.setIndices (core);
+    f.compute (result);
+
+    if (result.points.size () != core->size ())
+    {
+      result.points.clear ();
+      return;
+    }
+    for (size_t i = 0; i < result.points.size (); i++)
+    {
+      const PointType& p = cloud->points[(*core)[i]];
+      result.points[i].x = p.x;
+      result.points[i].y = p.y;
+      result.points[i].z = p.z;
+    }
+  }
+};
+
+template<typename Container, typename PointType>
+octree_tile_processor<Container, PointType>::octree_tile_processor (tree_type& tree, const double halo) :
+  tree (tree), halo (halo), tile_depth (std::numeric_limits<boost::uint64_t>::max ()), threads (1),
+  budget (size_t (256) << 20)
+{
+  tree.getBB (tree_min, tree_max);
+}
+
+template<typename Container, typename PointType> template<typename PointOutT, typename OutContainer, typename Function> size_t
+octree_tile_processor<Container, PointType>::process (Function fn, octree_base<OutContainer, PointOutT>& output)
+{
+  return run (user_function<Function> (fn), output);
+}
+
+template<typename Container, typename PointType> template<typename FilterT, typename OutContainer> size_t
+octree_tile_processor<Container, PointType>::filter (const FilterT& filter, octree_base<OutContainer, PointType>& output)
+{
+  return run (filter_function<FilterT> (filter, *this), output);
+}
+
+template<typename Container, typename PointType> template<typename FeatureT, typename OutContainer, typename PointOutT> size_t
+octree_tile_processor<Container, PointType>::compute (const FeatureT& feature,
+                                                      octree_base<OutContainer, PointOutT>& output)
+{
+  return run (feature_function<FeatureT> (feature), output);
+}
+
+template<typename Container, typename PointType> template<typename PointOutT, typename OutContainer, typename TileFunction> size_t
+octree_tile_processor<Container, PointType>::run (TileFunction fn, octree_base<OutContainer, PointOutT>& output)
+{
+  if (static_cast<void*> (&output) == static_cast<void*> (&tree))
+  {
+    std::cerr << "the output of octree_tile_processor can not be its input" << std::endl;
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  std::vector<tile> tiles;
+  getTiles (tiles);
+
+  octree_bulk_ingester<OutContainer, PointOutT> ingester (output, budget);
+  ingester.setNumberOfThreads (threads);
+
+  bool failed = false;
+  long processed = 0;
+  const long num_tiles = static_cast<long> (tiles.size ());
+#pragma omp parallel for schedule (dynamic) num_threads (threads) reduction (+:processed)
+  for (long k = 0; k < num_tiles; k++)
+  {
+    try
+    {
+      PointCloudPtr cloud (new PointCloud);
+      IndicesPtr core (new std::vector<int>);
+      readTile (tiles[k], *cloud, *core);
+      if (core->empty ())
+      {
+        continue;
+      }
+
+      pcl::PointCloud<PointOutT> result;
+      fn (tiles[k], PointCloudConstPtr (cloud), core, result);
+      processed++;
+
+      if (!result.points.empty ())
+      {
+        const std::vector<PointOutT> points (result.points.begin (), result.points.end ());
+#pragma omp critical (octree_tile_output)
+        ingester.addData (points);
+      }
+    }
+    catch (...)
+    {
+#pragma omp critical (octree_tile_output)
+      failed = true;
+    }
+  }
+
+  if (failed)
+  {
+    std::cerr << "processing a tile failed" << std::endl;
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+
+  ingester.buildLOD ();
+  return static_cast<size_t> (processed);
+}
+
+template<typename Container, typename PointType> void
+octree_tile_processor<Container, PointType>::getTiles (std::vector<tile>& tiles)
+{
+  tiles.clear ();
+  if (tree.root == NULL)
+  {
+    return;
+  }
+
+  boost::unique_lock < boost::shared_mutex > lock (tree.read_write_mutex);
+
+  //load the whole tree, so that reading tiles concurrently only reads payloads
+  const boost::uint64_t depth = std::min (tile_depth, tree.maxDepth);
+  std::vector<node_type*> level (1, tree.root);
+  for (boost::uint64_t d = 0; !level.empty (); d++)
+  {
+    std::vector<node_type*> next;
+    for (size_t k = 0; k < level.size (); k++)
+    {
+      node_type* node = level[k];
+      if (d == depth)
+      {
+        tile t;
+        node->getBB (t.min, t.max);
+        tiles.push_back (t);
+      }
+
+      if ((node->numchild == 0) && node->hasUnloadedChildren ())
+      {
+        node->loadChildren (false);
+      }
+      for (int i = 0; i < 8; i++)
+      {
+        if (node->children[i] != NULL)
+        {
+          next.push_back (node->children[i]);
+        }
+      }
+    }
+    level.swap (next);
+  }
+}
+
+template<typename Container, typename PointType> void
+octree_tile_processor<Container, PointType>::readTile (const tile& t, PointCloud& cloud, std::vector<int>& core)
+{
+  double min[3];
+  double max[3];
+  for (int i = 0; i < 3; i++)
+  {
+    min[i] = t.min[i] - halo;
+    max[i] = t.max[i] + halo;
+  }
+
+  std::list<PointType> v;
+  tree.queryBBIncludes (min, max, tree.maxDepth, v);
+
+  cloud.points.assign (v.begin (), v.end ());
+  cloud.width = static_cast<uint32_t> (cloud.points.size ());
+  cloud.height = 1;
+  cloud.is_dense = true;
+
+  core.clear ();
+  for (size_t i = 0; i < cloud.points.size (); i++)
+  {
+    if (inCore (t, cloud.points[i]))
+    {
+      core.push_back (static_cast<int> (i));
+    }
+  }
+}
+
+template<typename Container, typename PointType> template<typename PointT> inline bool
+octree_tile_processor<Container, PointType>::inCore (const tile& t, const PointT& p) const
+{
+  const double c[3] = {p.x, p.y, p.z};
+  for (int i = 0; i < 3; i++)
+  {
+    //the upper side belongs to the next tile, unless it is the tree's
+    if ((c[i] < t.min[i]) || (c[i] > t.max[i]) || ((c[i] == t.max[i]) && (t.max[i] < tree_max[i])))
+    {
+      return (false);
+    }
+  }
+  return (true);
+}
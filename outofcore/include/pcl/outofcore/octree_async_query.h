@@ -0,0 +1,253 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <map>
+#include <queue>
+#include <set>
+#include <vector>
+
+// Boost
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#pragma warning(push)
+#pragma warning(disable: 4311 4312)
+#include <boost/thread.hpp>
+#pragma warning(pop)
+
+// PCL (Urban Robotics)
+#include "pcl/outofcore/octree_base.h"
+#include "pcl/outofcore/octree_base_node.h"
+
+/** \brief Points of one node, delivered by octree_async_query */
+template<typename PointType>
+struct octree_query_result
+{
+  /** \brief Id returned when the query was started */
+  boost::uint64_t query_id;
+
+  /** \brief Depth of the node, root is 0 */
+  boost::uint64_t depth;
+
+  /** \brief Bounding box of the node */
+  double min[3];
+  double max[3];
+
+  /** \brief True if the children of this node follow, i.e. finer points for this region are on their way */
+  bool refined;
+
+  /** \brief The node's points inside the query region. The callback may swap them out. */
+  std::vector<PointType> points;
+};
+
+/** \class octree_async_query
+ *
+ * \brief Asynchronous, coarse-to-fine point queries on an out-of-core octree
+ *
+ * A query is a bounding box or a frustum, a viewpoint and a screen-space
+ * error budget. The projected error of a node is its largest edge divided
+ * by its distance from the viewpoint. A node's children are visited while
+ * this error exceeds the budget, so a budget of 0 goes down to the leaves.
+ *
+ * Nodes are loaded by a pool of I/O threads, coarsest first and, within a
+ * level, largest projected error first. The points of each node are passed
+ * to the callback as soon as they are read, from one of the I/O threads.
+ * Internal nodes hold a subsample of their children (see
+ * octree_base::buildLOD), so a client replaces the points of a refined node
+ * by those of its children as they arrive.
+ *
+ * The tree must outlive the query object. Queries hold a shared lock on the
+ * tree only while a node is read.
+ */
+template<typename Container, typename PointType>
+class octree_async_query
+{
+  public:
+    typedef octree_base<Container, PointType> tree_type;
+    typedef octree_base_node<Container, PointType> node_type;
+    typedef octree_query_result<PointType> result_type;
+    typedef boost::function<void (result_type&)> callback_type;
+
+    /** \brief Start the I/O threads
+     *
+     * \param tree the tree to query
+     * \param nr_threads number of I/O threads (0 means 1)
+     */
+    octree_async_query (tree_type& tree, const unsigned int nr_threads = 2);
+
+    /** \brief Cancel all queries and stop the I/O threads */
+    ~octree_async_query ();
+
+    /** \brief Start a query for the points inside a bounding box
+     *
+     * \param min bounding box min
+     * \param max bounding box max
+     * \param eye viewpoint used for the projected error
+     * \param error_budget largest accepted projected error
+     * \param callback called once per node with points in the box
+     * \return id of the query
+     */
+    boost::uint64_t
+    queryBBIncludes (const double min[3], const double max[3], const double eye[3], const double error_budget,
+                     const callback_type& callback);
+
+    /** \brief Start a query for the points inside a frustum
+     *
+     * \param planes six planes (a, b, c, d); a point is inside if
+     * a*x + b*y + c*z + d >= 0 for all of them
+     * \param eye viewpoint used for the projected error
+     * \param error_budget largest accepted projected error
+     * \param callback called once per node with points in the frustum
+     * \return id of the query
+     */
+    boost::uint64_t
+    queryFrustum (const double planes[6][4], const double eye[3], const double error_budget,
+                  const callback_type& callback);
+
+    /** \brief Stop a query; nodes already being read may still be delivered */
+    void
+    cancel (const boost::uint64_t query_id);
+
+    /** \brief Block until a query has delivered all its nodes or was cancelled
+     *
+     * \return false if reading a node failed
+     */
+    bool
+    wait (const boost::uint64_t query_id);
+
+    /** \brief Number of queries still running */
+    size_t
+    getNumRunning () const;
+
+  private:
+    //no copy construction
+    octree_async_query (const octree_async_query& rval);
+
+    octree_async_query&
+    operator= (const octree_async_query& rval);
+
+    struct query_state
+    {
+      boost::uint64_t id;
+      double planes[6][4];
+      double eye[3];
+      double error_budget;
+      callback_type callback;
+      /** \brief Number of nodes queued or being read */
+      size_t outstanding;
+      bool cancelled;
+      bool failed;
+    };
+
+    /** \brief A node waiting to be read */
+    struct job
+    {
+      node_type* node;
+      boost::shared_ptr<query_state> query;
+      boost::uint64_t depth;
+      double error;
+      /** \brief Node is entirely inside the query region */
+      bool inside;
+      boost::uint64_t seq;
+
+      /** \brief Order for the priority queue: lower depth, then larger error, then older first */
+      bool
+      operator< (const job& rhs) const
+      {
+        if (depth != rhs.depth)
+          return (depth > rhs.depth);
+        if (error != rhs.error)
+          return (error < rhs.error);
+        return (seq > rhs.seq);
+      }
+    };
+
+    boost::uint64_t
+    start (const double planes[6][4], const double eye[3], const double error_budget, const callback_type& callback);
+
+    /** \brief Queue node for query unless it lies outside the region; queue_mutex must be held */
+    bool
+    push (node_type* node, const boost::shared_ptr<query_state>& query);
+
+    /** \brief Mark one node of query as done; queue_mutex must be held */
+    void
+    finish (const boost::shared_ptr<query_state>& query);
+
+    /** \brief Read one node and queue its children */
+    void
+    process (job& j);
+
+    /** \brief I/O thread main loop */
+    void
+    run ();
+
+    /** \brief Whether p is on the inner side of all planes */
+    static bool
+    pointInside (const double planes[6][4], const PointType& p);
+
+    /** \brief -1 if the box is outside a plane, 1 if inside all planes, 0 otherwise */
+    static int
+    classify (const double planes[6][4], const double min[3], const double max[3]);
+
+    static double
+    projectedError (const double eye[3], const double min[3], const double max[3]);
+
+    tree_type& tree;
+
+    std::priority_queue<job> jobs;
+
+    /** \brief Running queries by id */
+    std::map<boost::uint64_t, boost::shared_ptr<query_state> > queries;
+
+    /** \brief Finished queries that failed and were not waited for yet */
+    std::set<boost::uint64_t> failed_queries;
+
+    boost::uint64_t next_query;
+    boost::uint64_t next_seq;
+    bool stopping;
+
+    /** \brief Guards the job queue and the query states */
+    mutable boost::mutex queue_mutex;
+    boost::condition_variable queue_cond;
+    boost::condition_variable done_cond;
+
+    /** \brief Serializes loading child nodes from disk */
+    boost::mutex load_mutex;
+
+    boost::thread_group workers;
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <vector>
+
+// Boost
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+// PCL (Urban Robotics)
+#include "pcl/outofcore/octree_base.h"
+#include "pcl/outofcore/octree_base_node.h"
+
+/** \class octree_bulk_ingester
+ *
+ * \brief Parallel bulk loader for out-of-core octrees
+ *
+ * octree_base::addDataToLeaf walks the tree once per chunk and writes every
+ * leaf it touches straight to disk. This makes many small appends per chunk.
+ * The ingester sends each chunk down the tree in parallel and keeps the
+ * points in per leaf write-back buffers. When the buffers grow past the
+ * memory budget, the largest ones are written in parallel. buildLOD then
+ * fills the LOD levels bottom-up, one level at a time, with the nodes of a
+ * level processed in parallel.
+ *
+ * The tree is locked for writing during addData, flush and buildLOD.
+ * Buffered points are not visible to queries until flush () is called. The
+ * ingester must be destroyed (or flushed) before the tree it loads.
+ */
+template<typename Container, typename PointType>
+class octree_bulk_ingester
+{
+  public:
+    typedef octree_base<Container, PointType> tree_type;
+    typedef octree_base_node<Container, PointType> node_type;
+
+    /** \brief Create an ingester for tree
+     *
+     * \param tree the tree to load points into
+     * \param memory_budget maximum number of bytes held in write-back buffers
+     */
+    octree_bulk_ingester (tree_type& tree, const size_t memory_budget = size_t (256) << 20);
+
+    /** \brief Flushes all buffers */
+    ~octree_bulk_ingester ();
+
+    /** \brief Set the number of threads used for binning, flushing and LOD generation (0 means 1) */
+    inline void
+    setNumberOfThreads (const unsigned int nr_threads)
+    {
+      threads = (nr_threads == 0) ? 1 : nr_threads;
+    }
+
+    /** \brief Set the maximum number of bytes held in write-back buffers */
+    inline void
+    setMemoryBudget (const size_t memory_budget)
+    {
+      budget = memory_budget;
+    }
+
+    /** \brief Get the maximum number of bytes held in write-back buffers */
+    inline size_t
+    getMemoryBudget () const
+    {
+      return budget;
+    }
+
+    /** \brief Number of bytes currently held in write-back buffers */
+    inline size_t
+    getBufferedBytes () const
+    {
+      return buffered * sizeof(PointType);
+    }
+
+    /** \brief Bin a chunk of points into the leaves of the tree
+     *
+     * Points outside the bounding box of the tree are dropped, like
+     * octree_base::addDataToLeaf does.
+     *
+     * \param p the points
+     * \return number of points accepted
+     */
+    boost::uint64_t
+    addData (const std::vector<PointType>& p);
+
+    /** \brief Write all buffered points to the leaves' payloads */
+    void
+    flush ();
+
+    /** \brief Flush, then regenerate every LOD level from the leaves
+     *
+     * Each internal node gets sample_precent of the points of its children,
+     * so level d holds about sample_precent^(maxDepth-d) of the leaf points,
+     * as with octree_base::buildLOD.
+     */
+    void
+    buildLOD ();
+
+  private:
+    //no copy construction
+    octree_bulk_ingester (const octree_bulk_ingester& rval);
+
+    octree_bulk_ingester&
+    operator= (const octree_bulk_ingester& rval);
+
+    /** \brief Index of the child of node that pt falls into */
+    static inline int
+    childIndex (const node_type* node, const PointType& pt);
+
+    /** \brief Make sure children[idx] of node exists, loading it from disk or creating it */
+    void
+    makeChild (node_type* node, const int idx);
+
+    /** \brief Write the largest buffers until at most target points are buffered */
+    void
+    flushBuffers (const size_t target);
+
+    tree_type& tree;
+
+    /** \brief Per leaf write-back buffers */
+    boost::unordered_map<node_type*, std::vector<PointType> > buffers;
+
+    /** \brief Nodes whose children on disk have already been loaded */
+    boost::unordered_set<node_type*> checked;
+
+    /** \brief Number of buffered points */
+    size_t buffered;
+
+    size_t budget;
+
+    unsigned int threads;
+};
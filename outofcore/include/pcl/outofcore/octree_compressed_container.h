@@ -0,0 +1,249 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+#pragma warning(push)
+#pragma warning(disable: 4311 4312)
+#include <boost/thread.hpp>
+#pragma warning(pop)
+#include <boost/random/mersenne_twister.hpp>
+
+/** \class octree_compressed_container
+ *
+ * \brief Disk container that stores points in compressed blocks
+ *
+ * A drop-in replacement for octree_disk_container as the Container of
+ * octree_base. Points are written in blocks of up to block_points points.
+ * The bytes of each block are shuffled so that byte k of every point lies
+ * next to byte k of every other point, then compressed with LZF. Padding,
+ * exponents and the high bytes of colors then form long runs.
+ *
+ * Optionally (see setQuantization) the coordinates of each block are
+ * stored as multiples of a step relative to an origin, packed with as many
+ * bits as the largest multiple in the block needs. octree_base passes the
+ * minimum of the node's bounding box as the origin. This is lossy, off by
+ * at most half a step per coordinate, and is off by default. A container
+ * opened from an existing file continues with the step and origin of its
+ * last block.
+ *
+ * An index of the blocks is kept in memory, built by scanning the block
+ * headers when an existing file is opened. Range and subsampled reads only
+ * decompress the blocks they touch.
+ */
+template<typename PointType>
+class octree_compressed_container
+{
+  public:
+    /** \brief Maximum number of points per block */
+    static const boost::uint32_t block_points = 4096;
+
+    octree_compressed_container ();
+
+    /** \brief Creates uuid named file or loads existing file
+     *
+     * If dir is a directory, constructor will create new
+     * uuid named file; if dir is an existing file, it will load the
+     * file
+     */
+    octree_compressed_container (const boost::filesystem::path& dir);
+
+    ~octree_compressed_container ();
+
+    /** \brief Set the quantization of coordinates of blocks written from now on
+     * \param[in] step the quantization step, 0 is lossless
+     * \param[in] origin the point the coordinates are stored relative to,
+     * usually the minimum of the node's bounding box; blocks with a point
+     * below it are stored lossless
+     */
+    void
+    setQuantization (const double step, const double origin[3]);
+
+    /** \brief Get the quantization step for coordinates */
+    double
+    getQuantizationStep () const
+    {
+      return quantization_step;
+    }
+
+    PointType
+    operator[] (boost::uint64_t idx);
+
+    void
+    push_back (const PointType& p);
+
+    void
+    insertRange (const PointType* const * start, const boost::uint64_t count);
+
+    void
+    insertRange (const PointType* start, const boost::uint64_t count);
+
+    void
+    readRange (const boost::uint64_t start, const boost::uint64_t count, std::vector<PointType>& v);
+
+    /** \brief grab percent*count random points. points are _not_ guaranteed to be
+     * unique (could have multiple identical points!)
+     */
+    void
+    readRangeSubSample (const boost::uint64_t start, const boost::uint64_t count, const double percent,
+                        std::vector<PointType>& v);
+
+    /** \brief use bernoulli trials to select points. points are unique */
+    void
+    readRangeSubSample_bernoulli (const boost::uint64_t start, const boost::uint64_t count,
+                                  const double percent, std::vector<PointType>& v);
+
+    boost::uint64_t
+    size () const
+    {
+      return filelen + writebuff.size ();
+    }
+
+    bool
+    empty ()
+    {
+      return ((filelen == 0) && writebuff.empty ());
+    }
+
+    void
+    flush (const bool forceCacheDeAlloc)
+    {
+      flush_writebuff (forceCacheDeAlloc);
+    }
+
+    inline std::string&
+    path ()
+    {
+      return fileback_name;
+    }
+
+    void
+    clear ();
+
+    void
+    convertToXYZ (const boost::filesystem::path& path);
+
+    /** \brief Number of bytes the points take on disk */
+    boost::uint64_t
+    getFileSize () const
+    {
+      return filebytes;
+    }
+
+  private:
+    //no copy construction
+    octree_compressed_container (const octree_compressed_container& rval);
+
+    octree_compressed_container&
+    operator= (const octree_compressed_container& rval);
+
+    enum
+    {
+      BLOCK_LZF = 1,       // data is LZF compressed, otherwise it is only shuffled
+      BLOCK_QUANTIZED = 2  // coordinates are stored as multiples of step from origin
+    };
+
+    /** \brief On disk header in front of every block */
+    struct block_header
+    {
+      boost::uint32_t count;
+      boost::uint32_t bytes;
+      boost::uint32_t flags;
+      boost::uint32_t bits;
+      double origin[3];
+      double step;
+    };
+
+    /** \brief Position of a block in the file */
+    struct block_entry
+    {
+      boost::uint64_t offset;
+      boost::uint64_t first;
+      boost::uint32_t count;
+    };
+
+    void
+    flush_writebuff (const bool forceCacheDeAlloc);
+
+    /** \brief Build the block index from the headers in the file */
+    void
+    scanBlocks ();
+
+    /** \brief Compress and append one block */
+    void
+    writeBlock (const PointType* start, const boost::uint32_t count);
+
+    /** \brief Decompress block b of an open file into points */
+    void
+    readBlock (FILE* f, const size_t b, std::vector<PointType>& points) const;
+
+    /** \brief Index of the block containing point idx, which must be < filelen */
+    size_t
+    findBlock (const boost::uint64_t idx) const;
+
+    /** \brief Append the points at the given sorted indices (all < filelen) to v */
+    void
+    readSortedOffsets (const std::vector<boost::uint64_t>& offsets, std::vector<PointType>& v);
+
+    std::string fileback_name;
+
+    /** \brief Points not yet written by push_back */
+    std::vector<PointType> writebuff;
+
+    std::vector<block_entry> blocks;
+
+    /** \brief Number of points in the file */
+    boost::uint64_t filelen;
+
+    /** \brief Size of the file in bytes */
+    boost::uint64_t filebytes;
+
+    /** \brief Quantization step for coordinates, 0 is lossless */
+    double quantization_step;
+
+    /** \brief Origin of the quantized coordinates */
+    double quantization_origin[3];
+
+    static boost::mutex rng_mutex;
+    static boost::mt19937 rand_gen;
+};
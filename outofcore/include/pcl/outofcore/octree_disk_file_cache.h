@@ -0,0 +1,129 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <cstdio>
+#include <list>
+#include <string>
+
+// Boost
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#pragma warning(push)
+#pragma warning(disable: 4311 4312)
+#include <boost/thread.hpp>
+#pragma warning(pop)
+
+#include <pcl/pcl_macros.h>
+
+/** \class octree_disk_file_cache
+ *
+ * \brief Process wide LRU cache of open append handles to node storage files
+ *
+ * Appending to a node used to open and close its storage file on every
+ * flush. This cache keeps up to getMaxOpenFiles () handles open and closes the
+ * least recently used one when a new file is opened. Handles are unbuffered,
+ * so data appended through the cache is visible to readers of the file
+ * immediately. Appends to different files may run concurrently.
+ */
+class PCL_EXPORTS octree_disk_file_cache
+{
+  public:
+    /** \brief The cache shared by all disk containers */
+    static octree_disk_file_cache&
+    instance ();
+
+    /** \brief Set the maximum number of simultaneously open files */
+    void
+    setMaxOpenFiles (const size_t max_open_files);
+
+    /** \brief Get the maximum number of simultaneously open files */
+    size_t
+    getMaxOpenFiles () const;
+
+    /** \brief Number of currently open files */
+    size_t
+    getNumOpenFiles () const;
+
+    /** \brief Append a block of bytes to a file, creating it if needed
+     *
+     * Throws OctreeException::OCT_BAD_PATH if the file can not be opened or
+     * written.
+     *
+     * \param path file to append to
+     * \param data start of the block
+     * \param bytes size of the block in bytes
+     */
+    void
+    append (const std::string& path, const void* data, const size_t bytes);
+
+    /** \brief Close the handle of a file, e.g. before it is removed */
+    void
+    close (const std::string& path);
+
+    /** \brief Close all handles */
+    void
+    closeAll ();
+
+  private:
+    octree_disk_file_cache ();
+
+    //no copy construction
+    octree_disk_file_cache (const octree_disk_file_cache& rval);
+
+    octree_disk_file_cache&
+    operator= (const octree_disk_file_cache& rval);
+
+    typedef boost::shared_ptr<FILE> file_handle;
+    typedef std::list<std::pair<std::string, file_handle> > lru_list;
+
+    /** \brief Get an open handle for path, evicting the least recently used one if necessary */
+    file_handle
+    acquire (const std::string& path);
+
+    /** \brief Open handles, most recently used first */
+    lru_list lru;
+
+    /** \brief Maps a path to its position in the LRU list */
+    boost::unordered_map<std::string, lru_list::iterator> handles;
+
+    size_t max_open_files;
+
+    /** \brief Guards the LRU list and the handle map. Writes happen outside the lock. */
+    mutable boost::mutex cache_mutex;
+};
@@ -0,0 +1,242 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <list>
+#include <string>
+#include <vector>
+
+// Boost
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+
+// PCL
+#include <pcl/octree/octree_mapped_file.h>
+
+// PCL (Urban Robotics)
+#include "pcl/outofcore/octree_base.h"
+#include "pcl/outofcore/octree_base_node.h"
+
+/** \brief Node record of a packed octree */
+struct octree_packed_node
+{
+  /** \brief Bounding box */
+  double min[3];
+  double max[3];
+  /** \brief First point of the node in the data file, in points */
+  boost::uint64_t first;
+  /** \brief Number of points of the node */
+  boost::uint64_t count;
+  /** \brief Index of each child in the node table, 0 if there is none */
+  boost::uint32_t children[8];
+  /** \brief Index of the parent, 0 for the root */
+  boost::uint32_t parent;
+  /** \brief Depth in the tree, root is 0 */
+  boost::uint32_t depth;
+};
+
+/** \class octree_packed
+ *
+ * \brief Read-only out-of-core octree stored in two files
+ *
+ * The directory layout of octree_base keeps a JSON index and a data file
+ * per node. Opening a deep tree therefore means thousands of small file
+ * opens and parses. The packed format has one binary node table, which is
+ * mapped into memory with a single mmap on open, and one data file with
+ * the points of all nodes.
+ *
+ * Nodes are stored breadth first. The nodes of one depth are contiguous in
+ * the table and their points are contiguous in the data file, so each LOD
+ * is one range of both. The data file is the table file name followed by
+ * "_dat".
+ *
+ * Use pack to convert a tree to this format and unpack to convert back.
+ */
+template<typename PointType>
+class octree_packed
+{
+  public:
+    /** \brief Map the node table of a packed tree
+     *
+     * Throws OctreeException::OCT_BAD_PATH if the files can not be opened
+     * and OctreeException::OCT_PARSE_FAILURE if the table is not valid for
+     * PointType, or if its node table or the data file is corrupt.
+     */
+    octree_packed (const boost::filesystem::path& file);
+
+    /** \brief Write tree in packed form to file and its data file
+     *
+     * \param tree the tree to convert, loaded completely while packing
+     * \param file name of the node table
+     */
+    template<typename Container> static void
+    pack (octree_base<Container, PointType>& tree, const boost::filesystem::path& file);
+
+    /** \brief Write this tree in the directory layout of octree_base
+     *
+     * \param rootname root node of the new tree, must end in ".oct_idx"
+     */
+    template<typename Container> void
+    unpack (const boost::filesystem::path& rootname) const;
+
+    /** \brief Copy the overall BB to min max */
+    void
+    getBB (double min[3], double max[3]) const;
+
+    /** \brief Get number of LODs */
+    inline boost::uint64_t
+    getDepth () const
+    {
+      return header->max_depth;
+    }
+
+    /** \brief Get number of points at specified LOD */
+    inline boost::uint64_t
+    getNumPoints (const boost::uint64_t depth) const
+    {
+      return lod_points[depth];
+    }
+
+    /** \brief Get coord system tag */
+    inline std::string
+    get_coord_system () const
+    {
+      return std::string (header->coord_system);
+    }
+
+    /** \brief Number of nodes in the table */
+    inline size_t
+    getNumNodes () const
+    {
+      return static_cast<size_t> (header->node_count);
+    }
+
+    /** \brief Node record, 0 is the root */
+    inline const octree_packed_node&
+    getNode (const size_t idx) const
+    {
+      return nodes[idx];
+    }
+
+    /** \brief Range [first, last) of the nodes at the specified LOD */
+    inline void
+    getLevelNodes (const boost::uint64_t depth, size_t& first, size_t& last) const
+    {
+      first = static_cast<size_t> (level_nodes[depth]);
+      last = static_cast<size_t> (level_nodes[depth + 1]);
+    }
+
+    /** \brief Read all points of a node */
+    void
+    readNode (const size_t idx, std::vector<PointType>& v) const;
+
+    /** \brief Get the points in a BB at query_depth, like octree_base::queryBBIncludes */
+    void
+    queryBBIncludes (const double min[3], const double max[3], const size_t query_depth,
+                     std::vector<PointType>& v) const;
+
+    void
+    queryBBIncludes (const double min[3], const double max[3], const size_t query_depth,
+                     std::list<PointType>& v) const;
+
+    /** \brief Get the nodes at query_depth that intersect with a BB */
+    void
+    queryBBIntersects (const double min[3], const double max[3], const boost::uint32_t query_depth,
+                       std::vector<size_t>& node_ids) const;
+
+  private:
+    /** \brief Start of the node table file */
+    struct packed_header
+    {
+      char magic[8];
+      boost::uint32_t version;
+      boost::uint32_t byte_order;
+      boost::uint32_t point_size;
+      boost::uint32_t node_size;
+      boost::uint64_t max_depth;
+      boost::uint64_t node_count;
+      boost::uint64_t point_count;
+      double min[3];
+      double max[3];
+      char coord_system[64];
+    };
+
+    static const char magic[8];
+    static const boost::uint32_t version = 1;
+    static const boost::uint32_t byte_order = 0x01020304;
+
+    static boost::filesystem::path
+    dataPath (const boost::filesystem::path& file);
+
+    /** \brief Check that the LOD ranges, child indices and point ranges of the mapped table are consistent */
+    bool
+    validTable () const;
+
+    /** \brief Read count points starting at first from an open data file */
+    static void
+    readPoints (FILE* f, const boost::uint64_t first, const boost::uint64_t count, std::vector<PointType>& v);
+
+    static inline bool
+    intersectsWithBB (const octree_packed_node& n, const double minbb[3], const double maxbb[3]);
+
+    static inline bool
+    withinBB (const octree_packed_node& n, const double minbb[3], const double maxbb[3]);
+
+    void
+    queryBBIncludes (FILE* f, const size_t idx, const double min[3], const double max[3],
+                     const size_t query_depth, std::vector<PointType>& v) const;
+
+    void
+    queryBBIntersects (const size_t idx, const double min[3], const double max[3],
+                       const boost::uint32_t query_depth, std::vector<size_t>& node_ids) const;
+
+    /** \brief Create the children of node to match the packed node idx, and fill them */
+    template<typename Container> void
+    unpackNode (octree_base_node<Container, PointType>* node, const size_t idx, FILE* f) const;
+
+    /** \brief Mapped node table */
+    boost::shared_ptr<pcl::octree::OctreeMappedFile> table;
+
+    const packed_header* header;
+    const boost::uint64_t* lod_points;
+    const boost::uint64_t* level_nodes;
+    const octree_packed_node* nodes;
+
+    std::string data_file;
+};
@@ -0,0 +1,222 @@
+#pragma once
+
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// C++
+#include <vector>
+
+// Boost
+#include <boost/shared_ptr.hpp>
+
+// PCL
+#include <pcl/point_cloud.h>
+
+// PCL (Urban Robotics)
+#include "pcl/outofcore/octree_base.h"
+#include "pcl/outofcore/octree_base_node.h"
+
+/** \class octree_tile_processor
+ *
+ * \brief Runs PCL filters and features over an out-of-core octree, tile by tile
+ *
+ * A tile is the region of one node at the tile depth, the leaves by
+ * default. Each tile is read from the leaves together with the points in a
+ * halo around it, so that neighborhood based algorithms see the points
+ * across the tile's border. Only the points of the tile itself (its core)
+ * are processed and written to the output tree. Cores are half-open boxes,
+ * like the children of a node, so every point belongs to exactly one tile.
+ *
+ * Tiles are processed in parallel. Each thread holds one tile at a time and
+ * the results go through an octree_bulk_ingester, so memory use depends on
+ * the tile size, the halo and the ingester's budget, not on the size of the
+ * tree. The output tree gets its LOD built at the end.
+ *
+ * The input tree is locked for writing while the tiles are enumerated and
+ * for reading afterwards. It must not be the output tree.
+ */
+template<typename Container, typename PointType>
+class octree_tile_processor
+{
+  public:
+    typedef octree_base<Container, PointType> tree_type;
+    typedef octree_base_node<Container, PointType> node_type;
+
+    typedef pcl::PointCloud<PointType> PointCloud;
+    typedef typename PointCloud::Ptr PointCloudPtr;
+    typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+
+    typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
+
+    /** \brief Create a processor for the tiles of tree
+     *
+     * \param tree the input tree
+     * \param halo margin added to each side of a tile
+     */
+    octree_tile_processor (tree_type& tree, const double halo = 0);
+
+    /** \brief Set the margin added to each side of a tile */
+    inline void
+    setHalo (const double halo)
+    {
+      this->halo = halo;
+    }
+
+    /** \brief Get the margin added to each side of a tile */
+    inline double
+    getHalo () const
+    {
+      return halo;
+    }
+
+    /** \brief Set the depth of the nodes used as tiles; larger than the tree depth means the leaves */
+    inline void
+    setTileDepth (const boost::uint64_t depth)
+    {
+      tile_depth = depth;
+    }
+
+    /** \brief Set the number of tiles processed at once (0 means 1) */
+    inline void
+    setNumberOfThreads (const unsigned int nr_threads)
+    {
+      threads = (nr_threads == 0) ? 1 : nr_threads;
+    }
+
+    /** \brief Set the maximum number of bytes of results buffered before they are written */
+    inline void
+    setMemoryBudget (const size_t memory_budget)
+    {
+      budget = memory_budget;
+    }
+
+    /** \brief Run a function on every tile
+     *
+     * The function is called as fn (tile, core, result) where tile is a
+     * PointCloudConstPtr with the points of the tile and its halo, core is
+     * an IndicesPtr into tile with the points of the tile itself, and result
+     * is an empty pcl::PointCloud<PointOutT> to fill. It is called from
+     * several threads at once.
+     *
+     * \param fn the function
+     * \param output the tree the results are written to
+     * \return number of tiles processed
+     */
+    template<typename PointOutT, typename OutContainer, typename Function> size_t
+    process (Function fn, octree_base<OutContainer, PointOutT>& output);
+
+    /** \brief Run a filter on every tile
+     *
+     * Each tile works on a copy of filter, with the tile as input cloud and
+     * the core as indices. Results outside the core are dropped, for filters
+     * that do not use the indices. A VoxelGrid gives the same voxels as on
+     * the whole cloud when the halo is at least as wide as its leaves.
+     *
+     * \param filter a filter that has not been used yet; copies drop a search
+     * object set with setSearchMethod and make their own
+     * \param output the tree the filtered points are written to
+     * \return number of tiles processed
+     */
+    template<typename FilterT, typename OutContainer> size_t
+    filter (const FilterT& filter, octree_base<OutContainer, PointType>& output);
+
+    /** \brief Compute a feature on every tile
+     *
+     * Each tile works on a copy of feature with its own search object, with
+     * the tile as input cloud and the core as indices. The coordinates of the
+     * input points are copied to the results, so PointOutT needs x, y and z
+     * (e.g. pcl::PointNormal for pcl::NormalEstimation).
+     *
+     * \param feature the feature estimator
+     * \param output the tree the results are written to
+     * \return number of tiles processed
+     */
+    template<typename FeatureT, typename OutContainer, typename PointOutT> size_t
+    compute (const FeatureT& feature, octree_base<OutContainer, PointOutT>& output);
+
+  private:
+    //no copy construction
+    octree_tile_processor (const octree_tile_processor& rval);
+
+    octree_tile_processor&
+    operator= (const octree_tile_processor& rval);
+
+    /** \brief Region of a tile */
+    struct tile
+    {
+      double min[3];
+      double max[3];
+    };
+
+    /** \brief Collect the tiles, loading the parts of the tree not in memory */
+    void
+    getTiles (std::vector<tile>& tiles);
+
+    /** \brief Read a tile and its halo; core gets the indices of the points inside the tile */
+    void
+    readTile (const tile& t, PointCloud& cloud, std::vector<int>& core);
+
+    /** \brief Is p in the half-open box of t (closed on the sides of the tree's box) */
+    template<typename PointT> inline bool
+    inCore (const tile& t, const PointT& p) const;
+
+    /** \brief Process all tiles with fn (tile, cloud, core, result) */
+    template<typename PointOutT, typename OutContainer, typename TileFunction> size_t
+    run (TileFunction fn, octree_base<OutContainer, PointOutT>& output);
+
+    /** \brief Calls a user function, which does not get the tile */
+    template<typename Function>
+    struct user_function;
+
+    /** \brief Calls filter on a copy of a prototype */
+    template<typename FilterT>
+    struct filter_function;
+
+    /** \brief Calls compute on a copy of a prototype */
+    template<typename FeatureT>
+    struct feature_function;
+
+    tree_type& tree;
+
+    double halo;
+    boost::uint64_t tile_depth;
+    unsigned int threads;
+    size_t budget;
+
+    /** \brief BB of the tree */
+    double tree_min[3];
+    double tree_max[3];
+};
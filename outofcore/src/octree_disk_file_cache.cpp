@@ -0,0 +1,156 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "pcl/outofcore/octree_disk_file_cache.h"
+#include "pcl/outofcore/octree_exceptions.h"
+
+octree_disk_file_cache&
+octree_disk_file_cache::instance ()
+{
+  static octree_disk_file_cache cache;
+  return cache;
+}
+
+octree_disk_file_cache::octree_disk_file_cache () :
+  lru (), handles (), max_open_files (256), cache_mutex ()
+{
+}
+
+void
+octree_disk_file_cache::setMaxOpenFiles (const size_t max_open_files)
+{
+  boost::mutex::scoped_lock lock (cache_mutex);
+  this->max_open_files = (max_open_files > 0) ? max_open_files : 1;
+
+  while (lru.size () > this->max_open_files)
+  {
+    handles.erase (lru.back ().first);
+    lru.pop_back ();
+  }
+}
+
+size_t
+octree_disk_file_cache::getMaxOpenFiles () const
+{
+  boost::mutex::scoped_lock lock (cache_mutex);
+  return max_open_files;
+}
+
+size_t
+octree_disk_file_cache::getNumOpenFiles () const
+{
+  boost::mutex::scoped_lock lock (cache_mutex);
+  return lru.size ();
+}
+
+octree_disk_file_cache::file_handle
+octree_disk_file_cache::acquire (const std::string& path)
+{
+  boost::mutex::scoped_lock lock (cache_mutex);
+
+  boost::unordered_map<std::string, lru_list::iterator>::iterator it = handles.find (path);
+  if (it != handles.end ())
+  {
+    // move to the front of the LRU list
+    lru.splice (lru.begin (), lru, it->second);
+    return it->second->second;
+  }
+
+  FILE* f = fopen (path.c_str (), "ab");
+  if (f == NULL)
+  {
+    throw OctreeException (OctreeException::OCT_BAD_PATH);
+  }
+  // callers write large blocks; bypass the stdio buffer so readers always see complete data
+  setvbuf (f, NULL, _IONBF, 0);
+
+  // an evicted handle is closed by the last writer still holding it
+  if (lru.size () >= max_open_files)
+  {
+    handles.erase (lru.back ().first);
+    lru.pop_back ();
+  }
+
+  lru.push_front (std::make_pair (path, file_handle (f, fclose)));
+  handles[path] = lru.begin ();
+  return lru.front ().second;
+}
+
+void
+octree_disk_file_cache::append (const std::string& path, const void* data, const size_t bytes)
+{
+  if (bytes == 0)
+  {
+    return;
+  }
+
+  file_handle f = acquire (path);
+
+  //write at most 64MB at a time
+  const static size_t blocksize = size_t (1) << 26;
+
+  const char* loc = static_cast<const char*> (data);
+  for (size_t pos = 0; pos < bytes; pos += blocksize)
+  {
+    const size_t len = std::min (blocksize, bytes - pos);
+    if (fwrite (loc + pos, 1, len, f.get ()) != len)
+    {
+      close (path);
+      throw OctreeException (OctreeException::OCT_BAD_PATH);
+    }
+  }
+}
+
+void
+octree_disk_file_cache::close (const std::string& path)
+{
+  boost::mutex::scoped_lock lock (cache_mutex);
+
+  boost::unordered_map<std::string, lru_list::iterator>::iterator it = handles.find (path);
+  if (it != handles.end ())
+  {
+    lru.erase (it->second);
+    handles.erase (it);
+  }
+}
+
+void
+octree_disk_file_cache::closeAll ()
+{
+  boost::mutex::scoped_lock lock (cache_mutex);
+  handles.clear ();
+  lru.clear ();
+}
@@ -41,6 +41,8 @@
 
 #include <gtest/gtest.h>
 
+#include <fstream>
+#include <iterator>
 #include <vector>
 
 #include <stdio.h>
@@ -59,6 +61,9 @@ using namespace pcl;
 #include "pcl/outofcore/pointCloudTools.h"
 #include "pcl/outofcore/impl/octree_disk_container.hpp"
 #include "pcl/outofcore/impl/octree_ram_container.hpp"
+#include "pcl/outofcore/impl/octree_bulk_ingester.hpp"
+#include "pcl/outofcore/impl/octree_async_query.hpp"
+#include "pcl/outofcore/impl/octree_packed.hpp"
 
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_real.hpp>
@@ -77,6 +82,12 @@ const static boost::filesystem::path filename_otreeB = "treeB/tree_test.oct_idx"
 const static boost::filesystem::path filename_otreeA_LOD = "treeA_LOD/tree_test.oct_idx";
 const static boost::filesystem::path filename_otreeB_LOD = "treeB_LOD/tree_test.oct_idx";
 
+const static boost::filesystem::path filename_otree_bulk = "tree_bulk/tree_test.oct_idx";
+const static boost::filesystem::path filename_otree_compressed = "tree_compressed/tree_test.oct_idx";
+const static boost::filesystem::path filename_otree_quantized = "tree_quantized/tree_test.oct_idx";
+const static boost::filesystem::path filename_otree_packed = "tree_packed/tree_test.oct_pack";
+const static boost::filesystem::path filename_otree_unpacked = "tree_unpacked/tree_test.oct_idx";
+
 std::vector<PointCloudTools::point> points;
 
 TEST (PCL, Octree_Build)
@@ -203,7 +214,8 @@ TEST(PCL, Bounding_Box)
   ASSERT_EQ (max_otreeB[2], 1);
 }
 
-void point_test(octree_disk& t)
+template<typename tree_type>
+void point_test(tree_type& t)
 {
   boost::mt19937 rng(rngseed);
   boost::uniform_real<double> dist(0,1);
@@ -355,6 +367,515 @@ TEST (PCL, Ram_Tree)
   }
 }
 
+TEST (PCL, Bulk_Ingest)
+{
+  boost::filesystem::remove_all (filename_otree_bulk.parent_path ());
+
+  double min[3] = {0, 0, 0};
+  double max[3] = {1, 1, 1};
+
+  boost::mt19937 rng (rngseed);
+  boost::normal_distribution<double> dist (0.5, .1);
+
+  PointCloudTools::point p;
+  p.r = p.g = p.b = 0;
+  p.nx = p.ny = p.nz = 1;
+  p.cameraCount = 0;
+  p.error = 0;
+  p.triadID = 0;
+
+  points.resize (numPts);
+  boost::uint64_t inside = 0;
+  for (int i = 0; i < numPts; i++)
+  {
+    p.x = dist (rng);
+    p.y = dist (rng);
+    p.z = dist (rng);
+
+    points[i] = p;
+    if (octree_base_node<octree_disk_container<PointCloudTools::point>, PointCloudTools::point>::pointWithinBB (min, max, p))
+    {
+      inside++;
+    }
+  }
+
+  // Force evictions from the handle cache and from the write-back buffers
+  const size_t max_open_files = octree_disk_file_cache::instance ().getMaxOpenFiles ();
+  octree_disk_file_cache::instance ().setMaxOpenFiles (4);
+
+  {
+    octree_disk tree (3, min, max, filename_otree_bulk, "ECEF");
+    {
+      octree_bulk_ingester<octree_disk_container<PointCloudTools::point>, PointCloudTools::point>
+        ingester (tree, 200 * sizeof (PointCloudTools::point));
+      ingester.setNumberOfThreads (2);
+
+      boost::uint64_t accepted = 0;
+      const size_t chunk = 1000;
+      for (size_t start = 0; start < points.size (); start += chunk)
+      {
+        std::vector<PointCloudTools::point> c (points.begin () + start,
+                                               points.begin () + std::min (start + chunk, points.size ()));
+        accepted += ingester.addData (c);
+        EXPECT_LE (ingester.getBufferedBytes (), ingester.getMemoryBudget ());
+      }
+      EXPECT_EQ (accepted, inside);
+      EXPECT_LE (octree_disk_file_cache::instance ().getNumOpenFiles (), 4u);
+
+      ingester.buildLOD ();
+      EXPECT_EQ (ingester.getBufferedBytes (), 0u);
+    }
+
+    point_test (tree);
+
+    // Every level is a subsample of the one below it
+    EXPECT_EQ (tree.getNumPoints (tree.getDepth ()), inside);
+    for (boost::uint64_t d = 0; d < tree.getDepth (); d++)
+    {
+      EXPECT_GT (tree.getNumPoints (d), 0u);
+      EXPECT_LT (tree.getNumPoints (d), tree.getNumPoints (d + 1));
+
+      std::list<PointCloudTools::point> v;
+      tree.queryBBIncludes (min, max, d, v);
+      EXPECT_EQ (v.size (), tree.getNumPoints (d));
+    }
+  }
+
+  octree_disk_file_cache::instance ().setMaxOpenFiles (max_open_files);
+
+  // The ingested tree loads like any other
+  octree_disk tree (filename_otree_bulk, false);
+  point_test (tree);
+}
+
+TEST (PCL, Disk_Container_SubSample)
+{
+  const boost::filesystem::path dir ("container_test");
+  boost::filesystem::remove_all (dir);
+  boost::filesystem::create_directory (dir);
+
+  // Tag every point with its position in the file
+  const size_t num = 200000;
+  std::vector<PointCloudTools::point> data (num);
+  for (size_t i = 0; i < num; i++)
+  {
+    data[i].x = float (i);
+    data[i].y = data[i].z = 0;
+  }
+
+  octree_disk_container<PointCloudTools::point> c (dir);
+  c.insertRange (&(data.front ()), data.size ());
+  ASSERT_EQ (c.size (), num);
+
+  // Sparse samples are read with seeks, dense ones as coalesced blocks
+  const double percents[] = {0.0005, 0.5};
+  for (int t = 0; t < 2; t++)
+  {
+    std::vector<PointCloudTools::point> v;
+    c.readRangeSubSample (1000, num - 2000, percents[t], v);
+    ASSERT_EQ (v.size (), size_t (percents[t] * (num - 2000)));
+    for (size_t i = 0; i < v.size (); i++)
+    {
+      const size_t idx = size_t (v[i].x);
+      ASSERT_GE (idx, 1000u);
+      ASSERT_LT (idx, num - 1000);
+      ASSERT_EQ (v[i].x, data[idx].x);
+      if (i > 0)
+      {
+        ASSERT_LE (v[i - 1].x, v[i].x);
+      }
+    }
+
+    c.readRangeSubSample_bernoulli (0, num, percents[t], v);
+    ASSERT_FALSE (v.empty ());
+    for (size_t i = 1; i < v.size (); i++)
+    {
+      ASSERT_LT (v[i - 1].x, v[i].x);
+    }
+  }
+}
+
+typedef octree_async_query<octree_disk_container<PointCloudTools::point>, PointCloudTools::point> async_query;
+
+struct query_collector
+{
+  query_collector () : leaf_points (), depths (), refined (), per_depth (8, 0), max_depth (0) { }
+
+  void
+  operator() (octree_query_result<PointCloudTools::point>& r)
+  {
+    boost::mutex::scoped_lock lock (mutex);
+    depths.push_back (r.depth);
+    refined.push_back (r.refined);
+    per_depth[r.depth] += r.points.size ();
+    if (r.depth == max_depth)
+    {
+      leaf_points.insert (leaf_points.end (), r.points.begin (), r.points.end ());
+    }
+  }
+
+  boost::mutex mutex;
+  std::vector<PointCloudTools::point> leaf_points;
+  std::vector<boost::uint64_t> depths;
+  std::vector<bool> refined;
+  std::vector<size_t> per_depth;
+  boost::uint64_t max_depth;
+};
+
+TEST (PCL, Async_Query)
+{
+  // Uses the tree written by Bulk_Ingest
+  octree_disk tree (filename_otree_bulk, false);
+  const boost::uint64_t depth = tree.getDepth ();
+
+  double min[3];
+  double max[3];
+  tree.getBB (min, max);
+  const double eye[3] = {0.5, 0.5, -10};
+
+  // Everything down to the leaves, coarsest first
+  query_collector all;
+  all.max_depth = depth;
+  {
+    async_query q (tree, 1);
+    const boost::uint64_t id = q.queryBBIncludes (min, max, eye, 0, boost::ref (all));
+    ASSERT_TRUE (q.wait (id));
+    EXPECT_EQ (q.getNumRunning (), 0u);
+  }
+  ASSERT_FALSE (all.depths.empty ());
+  EXPECT_EQ (all.depths.front (), 0u);
+  for (size_t i = 1; i < all.depths.size (); i++)
+  {
+    EXPECT_LE (all.depths[i - 1], all.depths[i]);
+  }
+  for (boost::uint64_t d = 0; d <= depth; d++)
+  {
+    EXPECT_EQ (all.per_depth[d], tree.getNumPoints (d));
+  }
+
+  async_query q (tree, 3);
+
+  // A partial box matches the synchronous query
+  const double qmin[3] = {0.3, 0.4, 0.35};
+  const double qmax[3] = {0.6, 0.55, 0.7};
+  query_collector box;
+  box.max_depth = depth;
+  ASSERT_TRUE (q.wait (q.queryBBIncludes (qmin, qmax, eye, 0, boost::ref (box))));
+
+  std::list<PointCloudTools::point> expected;
+  tree.queryBBIncludes (qmin, qmax, depth, expected);
+  EXPECT_EQ (box.leaf_points.size (), expected.size ());
+
+  // A frustum cutting the tree diagonally
+  const double planes[6][4] = {{1, 1, 0, -1.1}, {0, 0, 1, -0.2}, {0, 0, -1, 0.8},
+                               {1, 0, 0, 10}, {0, 1, 0, 10}, {-1, -1, -1, 10}};
+  query_collector frustum;
+  frustum.max_depth = depth;
+  ASSERT_TRUE (q.wait (q.queryFrustum (planes, eye, 0, boost::ref (frustum))));
+
+  size_t inside = 0;
+  BOOST_FOREACH (const PointCloudTools::point& p, all.leaf_points)
+  {
+    if ((p.x + p.y - 1.1 >= 0) && (p.z >= 0.2) && (p.z <= 0.8))
+    {
+      inside++;
+    }
+  }
+  EXPECT_EQ (frustum.leaf_points.size (), inside);
+  EXPECT_GT (inside, 0u);
+
+  // Seen from far away the root is good enough
+  const double far_eye[3] = {100, 100, 100};
+  query_collector coarse;
+  coarse.max_depth = depth;
+  ASSERT_TRUE (q.wait (q.queryBBIncludes (min, max, far_eye, 1, boost::ref (coarse))));
+  ASSERT_EQ (coarse.depths.size (), 1u);
+  EXPECT_EQ (coarse.depths[0], 0u);
+  EXPECT_FALSE (coarse.refined[0]);
+
+  // Cancelled queries finish early
+  query_collector cancelled;
+  const boost::uint64_t id = q.queryBBIncludes (min, max, eye, 0, boost::ref (cancelled));
+  q.cancel (id);
+  EXPECT_TRUE (q.wait (id));
+  EXPECT_LE (cancelled.depths.size (), all.depths.size ());
+}
+
+TEST (PCL, Compressed_Container)
+{
+  const boost::filesystem::path dir ("compressed_test");
+  boost::filesystem::remove_all (dir);
+  boost::filesystem::create_directory (dir);
+
+  // Scanner-like data: float precision coordinates, 8 bit colors
+  boost::mt19937 rng (rngseed);
+  boost::uniform_real<double> dist (0, 1);
+  const size_t num = 10000;
+  std::vector<PointCloudTools::point> data (num);
+  for (size_t i = 0; i < num; i++)
+  {
+    PointCloudTools::point& p = data[i];
+    p.x = float (dist (rng));
+    p.y = float (dist (rng));
+    p.z = float (dist (rng));
+    p.nx = p.ny = 0;
+    p.nz = 1;
+    p.r = double (int (255 * dist (rng)));
+    p.g = p.b = p.r;
+    p.error = 0;
+    p.cameraCount = 1;
+    p.triadID = 0;
+  }
+
+  std::string file;
+  {
+    octree_compressed_container<PointCloudTools::point> c (dir);
+    c.insertRange (&(data.front ()), 1000);
+    c.insertRange (&(data.front ()) + 1000, num - 1000);
+    for (size_t i = 0; i < 10; i++)
+    {
+      c.push_back (data[i]);
+    }
+    ASSERT_EQ (c.size (), num + 10);
+    file = c.path ();
+
+    std::vector<PointCloudTools::point> v;
+    c.readRange (0, c.size (), v);
+    ASSERT_EQ (v.size (), num + 10);
+    for (size_t i = 0; i < num; i++)
+    {
+      ASSERT_TRUE (v[i] == data[i]);
+    }
+    ASSERT_TRUE (v[num + 3] == data[3]);
+    ASSERT_TRUE (c[4500] == data[4500]);
+
+    c.readRange (4090, 20, v);
+    ASSERT_EQ (v.size (), 20u);
+    ASSERT_TRUE (v[0] == data[4090]);
+    ASSERT_TRUE (v[19] == data[4109]);
+
+    c.readRangeSubSample (0, num, 0.1, v);
+    ASSERT_EQ (v.size (), num / 10);
+    BOOST_FOREACH (const PointCloudTools::point& p, v)
+    {
+      ASSERT_TRUE (std::find (data.begin (), data.end (), p) != data.end ());
+    }
+
+    c.readRangeSubSample_bernoulli (0, num, 0.1, v);
+    ASSERT_FALSE (v.empty ());
+  }
+
+  // Reopening rebuilds the block index
+  octree_compressed_container<PointCloudTools::point> c (file);
+  ASSERT_EQ (c.size (), num + 10);
+  EXPECT_LT (c.getFileSize () * 2, (num + 10) * sizeof (PointCloudTools::point));
+  std::vector<PointCloudTools::point> v;
+  c.readRange (num - 5, 15, v);
+  ASSERT_TRUE (v[0] == data[num - 5]);
+  ASSERT_TRUE (v[14] == data[9]);
+
+  // Quantized coordinates are within half a step
+  const double step = 1e-4;
+  const double origin[3] = {0, 0, 0};
+  octree_compressed_container<PointCloudTools::point> q (dir);
+  q.setQuantization (step, origin);
+  q.insertRange (&(data.front ()), num);
+  EXPECT_EQ (c.getQuantizationStep (), 0.0);
+
+  q.readRange (0, num, v);
+  ASSERT_EQ (v.size (), num);
+  for (size_t i = 0; i < num; i++)
+  {
+    ASSERT_NEAR (v[i].x, data[i].x, step * 0.51);
+    ASSERT_NEAR (v[i].y, data[i].y, step * 0.51);
+    ASSERT_NEAR (v[i].z, data[i].z, step * 0.51);
+    ASSERT_EQ (v[i].r, data[i].r);
+  }
+  EXPECT_LT (q.getFileSize (), c.getFileSize ());
+
+  // The step is kept when the file is opened again
+  q.flush (true);
+  octree_compressed_container<PointCloudTools::point> reopened ((boost::filesystem::path (q.path ())));
+  EXPECT_EQ (reopened.getQuantizationStep (), step);
+
+  // A block with a point below the origin is stored lossless
+  const double above[3] = {0.5, 0.5, 0.5};
+  octree_compressed_container<PointCloudTools::point> lossless (dir);
+  lossless.setQuantization (step, above);
+  lossless.insertRange (&(data.front ()), 100);
+  lossless.readRange (0, 100, v);
+  for (size_t i = 0; i < 100; i++)
+  {
+    ASSERT_TRUE (v[i] == data[i]);
+  }
+}
+
+TEST (PCL, Compressed_Tree)
+{
+  boost::filesystem::remove_all (filename_otree_compressed.parent_path ());
+
+  double min[3] = {0, 0, 0};
+  double max[3] = {1, 1, 1};
+
+  {
+    octree_compressed tree (4, min, max, filename_otree_compressed, "ECEF");
+    tree.addDataToLeaf_and_genLOD (points);
+    point_test (tree);
+  }
+
+  octree_compressed tree (filename_otree_compressed, false);
+  point_test (tree);
+
+  // A quantized tree keeps its step when reopened
+  boost::filesystem::remove_all (filename_otree_quantized.parent_path ());
+  const double step = 1e-4;
+  {
+    octree_compressed quantized (4, min, max, filename_otree_quantized, "ECEF");
+    EXPECT_EQ (quantized.getQuantizationStep (), 0.0);
+    quantized.setQuantizationStep (step);
+    quantized.addDataToLeaf_and_genLOD (points);
+  }
+
+  octree_compressed quantized (filename_otree_quantized, true);
+  EXPECT_EQ (quantized.getQuantizationStep (), step);
+
+  std::list<PointCloudTools::point> lossless_points;
+  std::list<PointCloudTools::point> quantized_points;
+  tree.queryBBIncludes (min, max, tree.getDepth (), lossless_points);
+  quantized.queryBBIncludes (min, max, quantized.getDepth (), quantized_points);
+  ASSERT_EQ (quantized_points.size (), lossless_points.size ());
+
+  // Leaves are written in the same order, so the points match one by one
+  std::list<PointCloudTools::point>::const_iterator l = lossless_points.begin ();
+  std::list<PointCloudTools::point>::const_iterator q = quantized_points.begin ();
+  for (; l != lossless_points.end (); ++l, ++q)
+  {
+    ASSERT_NEAR (q->x, l->x, step * 0.51);
+    ASSERT_NEAR (q->y, l->y, step * 0.51);
+    ASSERT_NEAR (q->z, l->z, step * 0.51);
+    ASSERT_EQ (q->r, l->r);
+  }
+}
+
+TEST (PCL, Packed_Tree)
+{
+  // Uses the tree written by Bulk_Ingest
+  boost::filesystem::remove_all (filename_otree_packed.parent_path ());
+  boost::filesystem::remove_all (filename_otree_unpacked.parent_path ());
+  boost::filesystem::create_directory (filename_otree_packed.parent_path ());
+
+  octree_disk tree (filename_otree_bulk, false);
+  octree_packed<PointCloudTools::point>::pack (tree, filename_otree_packed);
+
+  octree_packed<PointCloudTools::point> packed (filename_otree_packed);
+  ASSERT_EQ (packed.getDepth (), tree.getDepth ());
+  EXPECT_EQ (packed.get_coord_system (), tree.get_coord_system ());
+
+  double min[3], max[3], pmin[3], pmax[3];
+  tree.getBB (min, max);
+  packed.getBB (pmin, pmax);
+  for (int i = 0; i < 3; i++)
+  {
+    EXPECT_EQ (pmin[i], min[i]);
+    EXPECT_EQ (pmax[i], max[i]);
+  }
+
+  // Every LOD is one contiguous range of nodes
+  ASSERT_EQ (packed.getNode (0).depth, 0u);
+  for (boost::uint64_t d = 0; d <= packed.getDepth (); d++)
+  {
+    EXPECT_EQ (packed.getNumPoints (d), tree.getNumPoints (d));
+
+    size_t first, last;
+    packed.getLevelNodes (d, first, last);
+    boost::uint64_t count = 0;
+    for (size_t n = first; n < last; n++)
+    {
+      EXPECT_EQ (packed.getNode (n).depth, d);
+      count += packed.getNode (n).count;
+    }
+    EXPECT_EQ (count, packed.getNumPoints (d));
+  }
+
+  const double qmin[3] = {0.3, 0.4, 0.35};
+  const double qmax[3] = {0.6, 0.55, 0.7};
+  for (size_t d = 0; d <= packed.getDepth (); d++)
+  {
+    std::list<PointCloudTools::point> expected;
+    tree.queryBBIncludes (qmin, qmax, d, expected);
+
+    std::vector<PointCloudTools::point> v;
+    packed.queryBBIncludes (qmin, qmax, d, v);
+    EXPECT_EQ (v.size (), expected.size ());
+
+    std::list<std::string> nodes;
+    tree.queryBBIntersects (qmin, qmax, boost::uint32_t (d), nodes);
+    std::vector<size_t> ids;
+    packed.queryBBIntersects (qmin, qmax, boost::uint32_t (d), ids);
+    EXPECT_EQ (ids.size (), nodes.size ());
+  }
+
+  // And back to the directory layout
+  packed.unpack<octree_disk_container<PointCloudTools::point> > (filename_otree_unpacked);
+  octree_disk unpacked (filename_otree_unpacked, false);
+  for (boost::uint64_t d = 0; d <= tree.getDepth (); d++)
+  {
+    EXPECT_EQ (unpacked.getNumPoints (d), tree.getNumPoints (d));
+  }
+  point_test (unpacked);
+
+  // A table for another point type is rejected
+  EXPECT_THROW (octree_packed<pcl::PointXYZ> bad (filename_otree_packed), OctreeException);
+
+  // Corrupt node tables and truncated data files are rejected when opening
+  std::string table;
+  {
+    std::ifstream in (filename_otree_packed.string ().c_str (), std::ios::binary);
+    table.assign (std::istreambuf_iterator<char> (in), std::istreambuf_iterator<char> ());
+  }
+  const size_t node_offset = table.size () - packed.getNumNodes () * sizeof(octree_packed_node);
+  const boost::filesystem::path filename_corrupt = filename_otree_packed.parent_path () / "corrupt.oct_pack";
+  boost::filesystem::copy_file (filename_otree_packed.string () + "_dat", filename_corrupt.string () + "_dat");
+
+  ASSERT_GT (packed.getNumNodes (), 1u);
+  for (int c = 0; c < 4; c++)
+  {
+    std::string corrupt (table);
+    octree_packed_node* records = reinterpret_cast<octree_packed_node*> (&corrupt[node_offset]);
+    switch (c)
+    {
+      case 0:
+        // child beyond the table
+        records[0].children[0] = static_cast<boost::uint32_t> (packed.getNumNodes ());
+        break;
+      case 1:
+        // child referring to its own node
+        records[1].children[0] = 1;
+        break;
+      case 2:
+        // point range beyond the data file
+        records[0].first = 1;
+        records[0].count = ~boost::uint64_t (0);
+        break;
+      case 3:
+        // truncated table
+        corrupt.resize (node_offset + sizeof(octree_packed_node));
+        break;
+    }
+    std::ofstream out (filename_corrupt.string ().c_str (), std::ios::binary);
+    out.write (corrupt.data (), corrupt.size ());
+    out.close ();
+    EXPECT_THROW (octree_packed<PointCloudTools::point> bad (filename_corrupt), OctreeException);
+  }
+
+  boost::filesystem::resize_file (filename_corrupt.string () + "_dat", 10);
+  {
+    std::ofstream out (filename_corrupt.string ().c_str (), std::ios::binary);
+    out.write (table.data (), table.size ());
+  }
+  EXPECT_THROW (octree_packed<PointCloudTools::point> bad (filename_corrupt), OctreeException);
+}
+
 //TEST (PCL, Octree_Teardown)
 //{
 //  boost::filesystem::remove_all (filename_otreeA.parent_path ());
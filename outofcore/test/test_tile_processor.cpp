@@ -0,0 +1,388 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2010, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <list>
+#include <vector>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/filters/radius_outlier_removal.h>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/search/kdtree.h>
+
+using namespace pcl;
+
+#include "pcl/outofcore/impl/octree_base.hpp"
+#include "pcl/outofcore/impl/octree_base_node.hpp"
+
+#include "pcl/outofcore/pointCloudTools.h"
+#include "pcl/outofcore/impl/octree_disk_container.hpp"
+#include "pcl/outofcore/impl/octree_tile_processor.hpp"
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/foreach.hpp>
+
+typedef octree_base<octree_disk_container<pcl::PointXYZ>, pcl::PointXYZ> octree_xyz;
+typedef octree_base<octree_disk_container<pcl::PointNormal>, pcl::PointNormal> octree_normal;
+
+const static int numPts = 1e4;
+
+const static boost::uint32_t rngseed = 0xAAFF33DD;
+
+const static boost::filesystem::path filename_otree_points = "tree_tiles_points/tree_test.oct_idx";
+const static boost::filesystem::path filename_otree_tiles = "tree_tiles/tree_test.oct_idx";
+const static boost::filesystem::path filename_otree_plane = "tree_tiles_plane/tree_test.oct_idx";
+const static boost::filesystem::path filename_otree_filtered = "tree_tiles_filtered/tree_test.oct_idx";
+const static boost::filesystem::path filename_otree_normals = "tree_tiles_normals/tree_test.oct_idx";
+
+const static double tree_min[3] = {0, 0, 0};
+const static double tree_max[3] = {1, 1, 1};
+
+// Stores the number of neighbors within radius of each core point in cameraCount
+struct neighbor_count
+{
+  neighbor_count (double r) : radius (r) { }
+
+  void
+  operator() (const pcl::PointCloud<PointCloudTools::point>::ConstPtr& cloud,
+              const boost::shared_ptr<std::vector<int> >& core,
+              pcl::PointCloud<PointCloudTools::point>& result) const
+  {
+    BOOST_FOREACH (int i, *core)
+    {
+      PointCloudTools::point p = cloud->points[i];
+      p.cameraCount = 0;
+      BOOST_FOREACH (const PointCloudTools::point& q, cloud->points)
+      {
+        const double dx = q.x - p.x, dy = q.y - p.y, dz = q.z - p.z;
+        if (dx * dx + dy * dy + dz * dz <= radius * radius)
+        {
+          p.cameraCount++;
+        }
+      }
+      result.points.push_back (p);
+    }
+  }
+
+  double radius;
+};
+
+// Orders points by their coordinates, to pair up the results of two runs
+struct xyz_less
+{
+  bool
+  operator() (const pcl::PointNormal& a, const pcl::PointNormal& b) const
+  {
+    if (a.x != b.x)
+      return (a.x < b.x);
+    if (a.y != b.y)
+      return (a.y < b.y);
+    return (a.z < b.z);
+  }
+};
+
+// Samples a slightly noisy plane at z = 0.4 across the tree
+void
+samplePlane (pcl::PointCloud<pcl::PointXYZ>& cloud)
+{
+  boost::mt19937 rng (rngseed);
+  boost::uniform_real<float> dist (0, 1);
+
+  cloud.points.resize (numPts);
+  for (int i = 0; i < numPts; i++)
+  {
+    cloud.points[i].x = dist (rng);
+    cloud.points[i].y = dist (rng);
+    cloud.points[i].z = 0.4f + 0.001f * dist (rng);
+  }
+  cloud.width = static_cast<uint32_t> (cloud.points.size ());
+  cloud.height = 1;
+  cloud.is_dense = true;
+}
+
+TEST (PCL, Tile_Process)
+{
+  boost::filesystem::remove_all (filename_otree_points.parent_path ());
+
+  boost::mt19937 rng (rngseed);
+  boost::normal_distribution<double> dist (0.5, .1);
+
+  PointCloudTools::point p;
+  p.r = p.g = p.b = 0;
+  p.nx = p.ny = p.nz = 1;
+  p.cameraCount = 0;
+  p.error = 0;
+  p.triadID = 0;
+
+  std::vector<PointCloudTools::point> points (numPts);
+  for (int i = 0; i < numPts; i++)
+  {
+    p.x = dist (rng);
+    p.y = dist (rng);
+    p.z = dist (rng);
+    points[i] = p;
+  }
+
+  const boost::uint64_t depth = 3;
+  const double radius = 0.05;
+
+  octree_disk tree (depth, tree_min, tree_max, filename_otree_points, "ECEF");
+  tree.addDataToLeaf_and_genLOD (points);
+
+  std::list<PointCloudTools::point> leaves;
+  tree.queryBBIncludes (tree_min, tree_max, depth, leaves);
+  const std::vector<PointCloudTools::point> all (leaves.begin (), leaves.end ());
+  ASSERT_GT (all.size (), 0u);
+
+  // Leaf tiles, and tiles of one level below the root
+  const boost::uint64_t tile_depths[2] = {depth, 1};
+  BOOST_FOREACH (boost::uint64_t tile_depth, tile_depths)
+  {
+    boost::filesystem::remove_all (filename_otree_tiles.parent_path ());
+
+    size_t tiles;
+    {
+      octree_disk output (depth, tree_min, tree_max, filename_otree_tiles, "ECEF");
+
+      octree_tile_processor<octree_disk_container<PointCloudTools::point>, PointCloudTools::point> processor (tree, radius);
+      processor.setTileDepth (tile_depth);
+      processor.setNumberOfThreads (3);
+      tiles = processor.process (neighbor_count (radius), output);
+    }
+    EXPECT_GT (tiles, 0u);
+
+    // Every point is processed once, with all its neighbors in its tile
+    octree_disk output (filename_otree_tiles, false);
+    EXPECT_EQ (output.getNumPoints (depth), all.size ());
+    EXPECT_GT (output.getNumPoints (0), 0u);
+
+    std::list<PointCloudTools::point> result;
+    output.queryBBIncludes (tree_min, tree_max, depth, result);
+    ASSERT_EQ (result.size (), all.size ());
+
+    size_t checked = 0;
+    BOOST_FOREACH (const PointCloudTools::point& p, result)
+    {
+      if ((checked++ % 97) != 0)
+      {
+        continue;
+      }
+      unsigned int expected = 0;
+      BOOST_FOREACH (const PointCloudTools::point& q, all)
+      {
+        const double dx = q.x - p.x, dy = q.y - p.y, dz = q.z - p.z;
+        if (dx * dx + dy * dy + dz * dz <= radius * radius)
+        {
+          expected++;
+        }
+      }
+      EXPECT_EQ (p.cameraCount, expected);
+    }
+  }
+}
+
+TEST (PCL, Tile_Filter)
+{
+  boost::filesystem::remove_all (filename_otree_plane.parent_path ());
+  boost::filesystem::remove_all (filename_otree_filtered.parent_path ());
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
+  samplePlane (*cloud);
+
+  const boost::uint64_t depth = 2;
+  octree_xyz tree (depth, tree_min, tree_max, filename_otree_plane, "ECEF");
+  tree.addDataToLeaf_and_genLOD (std::vector<pcl::PointXYZ> (cloud->points.begin (), cloud->points.end ()));
+
+  // The halo is as wide as a voxel, so the voxels across tile borders are complete
+  const float leaf = 0.06f;
+  pcl::VoxelGrid<pcl::PointXYZ> grid;
+  grid.setLeafSize (leaf, leaf, leaf);
+
+  {
+    octree_xyz output (depth, tree_min, tree_max, filename_otree_filtered, "ECEF");
+
+    octree_tile_processor<octree_disk_container<pcl::PointXYZ>, pcl::PointXYZ> processor (tree, leaf);
+    processor.setNumberOfThreads (3);
+    EXPECT_GT (processor.filter (grid, output), 0u);
+  }
+
+  // Same voxels as when filtering the whole cloud at once
+  pcl::PointCloud<pcl::PointXYZ> expected;
+  grid.setInputCloud (cloud);
+  grid.filter (expected);
+  ASSERT_GT (expected.points.size (), 0u);
+
+  octree_xyz output (filename_otree_filtered, false);
+  std::list<pcl::PointXYZ> result;
+  output.queryBBIncludes (tree_min, tree_max, depth, result);
+  ASSERT_EQ (result.size (), expected.points.size ());
+
+  BOOST_FOREACH (const pcl::PointXYZ& p, result)
+  {
+    float nearest = FLT_MAX;
+    BOOST_FOREACH (const pcl::PointXYZ& q, expected.points)
+    {
+      nearest = std::min (nearest, pcl::squaredEuclideanDistance (p, q));
+    }
+    EXPECT_LT (nearest, 1e-10f);
+  }
+}
+
+TEST (PCL, Tile_Filter_Search_Method)
+{
+  boost::filesystem::remove_all (filename_otree_plane.parent_path ());
+  boost::filesystem::remove_all (filename_otree_filtered.parent_path ());
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
+  samplePlane (*cloud);
+
+  const boost::uint64_t depth = 2;
+  octree_xyz tree (depth, tree_min, tree_max, filename_otree_plane, "ECEF");
+  tree.addDataToLeaf_and_genLOD (std::vector<pcl::PointXYZ> (cloud->points.begin (), cloud->points.end ()));
+
+  // The prototype's search object is not shared by the copies of the threads
+  const double radius = 0.01;
+  pcl::RadiusOutlierRemoval<pcl::PointXYZ> ror;
+  ror.setRadiusSearch (radius);
+  ror.setMinNeighborsInRadius (4);
+  ror.setSearchMethod (pcl::search::KdTree<pcl::PointXYZ>::Ptr (new pcl::search::KdTree<pcl::PointXYZ>));
+
+  {
+    octree_xyz output (depth, tree_min, tree_max, filename_otree_filtered, "ECEF");
+
+    octree_tile_processor<octree_disk_container<pcl::PointXYZ>, pcl::PointXYZ> processor (tree, radius);
+    processor.setNumberOfThreads (3);
+    EXPECT_GT (processor.filter (ror, output), 0u);
+  }
+
+  // Same inliers as when filtering the whole cloud at once
+  pcl::PointCloud<pcl::PointXYZ> expected;
+  ror.setInputCloud (cloud);
+  ror.filter (expected);
+  ASSERT_GT (expected.points.size (), 0u);
+  ASSERT_LT (expected.points.size (), cloud->points.size ());
+
+  octree_xyz output (filename_otree_filtered, false);
+  std::list<pcl::PointXYZ> result;
+  output.queryBBIncludes (tree_min, tree_max, depth, result);
+  ASSERT_EQ (result.size (), expected.points.size ());
+
+  BOOST_FOREACH (const pcl::PointXYZ& p, result)
+  {
+    float nearest = FLT_MAX;
+    BOOST_FOREACH (const pcl::PointXYZ& q, expected.points)
+    {
+      nearest = std::min (nearest, pcl::squaredEuclideanDistance (p, q));
+    }
+    EXPECT_EQ (nearest, 0.0f);
+  }
+}
+
+TEST (PCL, Tile_Compute)
+{
+  boost::filesystem::remove_all (filename_otree_plane.parent_path ());
+  boost::filesystem::remove_all (filename_otree_normals.parent_path ());
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
+  samplePlane (*cloud);
+
+  const boost::uint64_t depth = 2;
+  const double radius = 0.05;
+  octree_xyz tree (depth, tree_min, tree_max, filename_otree_plane, "ECEF");
+  tree.addDataToLeaf_and_genLOD (std::vector<pcl::PointXYZ> (cloud->points.begin (), cloud->points.end ()));
+
+  // A halo as wide as the search radius gives every point its full neighborhood
+  pcl::NormalEstimation<pcl::PointXYZ, pcl::PointNormal> ne;
+  ne.setRadiusSearch (radius);
+
+  {
+    octree_normal output (depth, tree_min, tree_max, filename_otree_normals, "ECEF");
+
+    octree_tile_processor<octree_disk_container<pcl::PointXYZ>, pcl::PointXYZ> processor (tree, radius);
+    processor.setNumberOfThreads (3);
+    EXPECT_GT (processor.compute (ne, output), 0u);
+  }
+
+  // Same normals as when computing them on the whole cloud at once
+  pcl::PointCloud<pcl::PointNormal> normals;
+  ne.setInputCloud (cloud);
+  ne.compute (normals);
+  ASSERT_EQ (normals.points.size (), cloud->points.size ());
+
+  std::vector<pcl::PointNormal> expected (normals.points.begin (), normals.points.end ());
+  for (size_t i = 0; i < expected.size (); i++)
+  {
+    expected[i].x = cloud->points[i].x;
+    expected[i].y = cloud->points[i].y;
+    expected[i].z = cloud->points[i].z;
+  }
+  std::sort (expected.begin (), expected.end (), xyz_less ());
+
+  octree_normal output (filename_otree_normals, false);
+  std::list<pcl::PointNormal> leaves;
+  output.queryBBIncludes (tree_min, tree_max, depth, leaves);
+  std::vector<pcl::PointNormal> result (leaves.begin (), leaves.end ());
+  std::sort (result.begin (), result.end (), xyz_less ());
+  ASSERT_EQ (result.size (), expected.size ());
+
+  for (size_t i = 0; i < result.size (); i++)
+  {
+    ASSERT_EQ (result[i].x, expected[i].x);
+    ASSERT_EQ (result[i].y, expected[i].y);
+    ASSERT_EQ (result[i].z, expected[i].z);
+
+    EXPECT_NEAR (result[i].normal_x, expected[i].normal_x, 1e-4);
+    EXPECT_NEAR (result[i].normal_y, expected[i].normal_y, 1e-4);
+    EXPECT_NEAR (result[i].normal_z, expected[i].normal_z, 1e-4);
+    EXPECT_GT (fabs (result[i].normal_z), 0.99);
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
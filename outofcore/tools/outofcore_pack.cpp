@@ -0,0 +1,110 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string>
+
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+
+#include "pcl/outofcore/impl/octree_base.hpp"
+#include "pcl/outofcore/impl/octree_base_node.hpp"
+#include "pcl/outofcore/impl/octree_packed.hpp"
+
+using namespace pcl::console;
+
+typedef PointCloudTools::point PointT;
+typedef octree_disk_container<PointT> Container;
+
+void
+printHelp (int argc, char **argv)
+{
+  print_error ("Syntax is: %s input.oct_idx output.oct_pack\n", argv[0]);
+  print_error ("       or: %s input.oct_pack output.oct_idx\n", argv[0]);
+  print_info ("  The first form packs a tree into a node table and a data file (output.oct_pack_dat),\n");
+  print_info ("  the second unpacks it into the directory layout again. The output directory must not exist.\n");
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Convert an outofcore octree to and from the packed format. For more information, use: %s -h\n", argv[0]);
+
+  if (argc < 3)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  std::vector<int> idx_file_indices = parse_file_extension_argument (argc, argv, ".oct_idx");
+  std::vector<int> pack_file_indices = parse_file_extension_argument (argc, argv, ".oct_pack");
+  if (idx_file_indices.size () != 1 || pack_file_indices.size () != 1)
+  {
+    print_error ("Need one .oct_idx and one .oct_pack file.\n");
+    return (-1);
+  }
+
+  const boost::filesystem::path idx_file = argv[idx_file_indices[0]];
+  const boost::filesystem::path pack_file = argv[pack_file_indices[0]];
+
+  TicToc tt;
+  tt.tic ();
+  try
+  {
+    if (idx_file_indices[0] < pack_file_indices[0])
+    {
+      print_highlight ("Packing "); print_value ("%s ", idx_file.string ().c_str ());
+      octree_base<Container, PointT> tree (idx_file, false);
+      octree_packed<PointT>::pack (tree, pack_file);
+    }
+    else
+    {
+      print_highlight ("Unpacking "); print_value ("%s ", pack_file.string ().c_str ());
+      octree_packed<PointT> packed (pack_file);
+      packed.unpack<Container> (idx_file);
+    }
+  }
+  catch (OctreeException& e)
+  {
+    print_error ("\nFailed: %s\n", e.what ());
+    return (-1);
+  }
+
+  print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms]\n");
+  return (0);
+}
+/* ]--- */
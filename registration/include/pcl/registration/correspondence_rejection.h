@@ -54,10 +54,15 @@ namespace pcl
     class CorrespondenceRejector /*: public PCLBase<PointSource> */
     {
       public:
+        typedef boost::shared_ptr<CorrespondenceRejector> Ptr;
+        typedef boost::shared_ptr<const CorrespondenceRejector> ConstPtr;
 
         /** \brief Empty constructor. */
         CorrespondenceRejector () : input_correspondences_() {};
 
+        /** \brief Empty destructor. */
+        virtual ~CorrespondenceRejector () {}
+
         /** \brief Provide a pointer to the vector of the input correspondences.
           * \param[in] correspondences the const boost shared pointer to a correspondence vector
           */
@@ -117,6 +122,45 @@ namespace pcl
           pcl::getRejectedQueryIndices(*input_correspondences_, correspondences, indices);
         }
 
+        /** \brief Check whether this rejector decides on every correspondence independently of all the
+          * others (e.g., by thresholding its distance). Such rejectors implement \a isCorrespondenceValid and
+          * can be fused into a single pass by \a CorrespondenceRejectorPipeline.
+          */
+        virtual inline bool
+        isPointwise () const { return (false); }
+
+        /** \brief Test a single correspondence. Only used for pointwise rejectors (see \a isPointwise), and
+          * must be safe to call concurrently from several threads.
+          * \param[in] correspondences the set of correspondences being filtered
+          * \param[in] index the index of the correspondence to test in \a correspondences
+          * \return true if the correspondence is kept, false if it is rejected
+          */
+        virtual inline bool
+        isCorrespondenceValid (const pcl::Correspondences &, size_t) const { return (true); }
+
+        /** \brief Run correspondence rejection in place, i.e., without copying the set of correspondences.
+          * Pointwise rejectors compact \a correspondences directly; all the others default to
+          * \a getRemainingCorrespondences, using \a scratch as output buffer (so that its capacity can be
+          * reused across calls).
+          * \param[in,out] correspondences the set of correspondences to filter
+          * \param[in,out] scratch a temporary buffer whose contents are undefined on return
+          */
+        virtual inline void
+        applyRejectionInPlace (pcl::Correspondences &correspondences, pcl::Correspondences &scratch)
+        {
+          if (isPointwise ())
+          {
+            size_t nr_valid = 0;
+            for (size_t i = 0; i < correspondences.size (); ++i)
+              if (isCorrespondenceValid (correspondences, i))
+                correspondences[nr_valid++] = correspondences[i];
+            correspondences.resize (nr_valid);
+            return;
+          }
+          getRemainingCorrespondences (correspondences, scratch);
+          correspondences.swap (scratch);
+        }
+
       protected:
 
         /** \brief The name of the rejection method. */
@@ -65,6 +65,8 @@ namespace pcl
       using CorrespondenceRejector::getClassName;
 
       public:
+        typedef boost::shared_ptr<CorrespondenceRejectorDistance> Ptr;
+        typedef boost::shared_ptr<const CorrespondenceRejectorDistance> ConstPtr;
 
         /** \brief Empty constructor. */
         CorrespondenceRejectorDistance () : max_distance_(std::numeric_limits<float>::max ()),
@@ -93,6 +95,22 @@ namespace pcl
         inline float 
         getMaximumDistance () { return std::sqrt (max_distance_); };
 
+        /** \brief Distance thresholding decides on each correspondence independently. */
+        inline bool
+        isPointwise () const { return (true); }
+
+        /** \brief Test whether the distance of a single correspondence is below the maximum distance.
+          * \param[in] correspondences the set of correspondences being filtered
+          * \param[in] index the index of the correspondence to test in \a correspondences
+          */
+        inline bool
+        isCorrespondenceValid (const pcl::Correspondences &correspondences, size_t index) const
+        {
+          if (data_container_)
+            return (data_container_->getCorrespondenceScore (correspondences[index]) < max_distance_);
+          return (correspondences[index].distance < max_distance_);
+        }
+
         /** \brief Provide a source point cloud dataset (must contain XYZ
           * data!), used to compute the correspondence distance.  
           * \param[in] cloud a cloud containing XYZ data
@@ -136,6 +154,7 @@ namespace pcl
         class DataContainerInterface
         {
           public:
+            virtual ~DataContainerInterface () {}
             virtual double getCorrespondenceScore (int index) = 0;
             virtual double getCorrespondenceScore (const pcl::Correspondence &) = 0;
         };
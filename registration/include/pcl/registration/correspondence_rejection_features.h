@@ -64,6 +64,9 @@ namespace pcl
       using CorrespondenceRejector::getClassName;
 
       public:
+        typedef boost::shared_ptr<CorrespondenceRejectorFeatures> Ptr;
+        typedef boost::shared_ptr<const CorrespondenceRejectorFeatures> ConstPtr;
+
         /** \brief Empty constructor. */
         CorrespondenceRejectorFeatures () : max_distance_ (std::numeric_limits<float>::max ())
         {
@@ -129,6 +132,19 @@ namespace pcl
         setFeatureRepresentation (const typename pcl::PointRepresentation<FeatureT>::ConstPtr &fr,
                                   const std::string &key);
 
+        /** \brief Feature thresholding decides on each correspondence independently. */
+        inline bool
+        isPointwise () const { return (true); }
+
+        /** \brief Test whether the correspondence at \a index is valid in every feature space. The feature
+          * clouds are assumed to be ordered like the correspondences, i.e., \a index also addresses the source
+          * and target features.
+          * \param[in] correspondences the set of correspondences being filtered
+          * \param[in] index the index of the correspondence to test in \a correspondences
+          */
+        inline bool
+        isCorrespondenceValid (const pcl::Correspondences &correspondences, size_t index) const;
+
       protected:
 
         /** \brief Apply the rejection algorithm.
@@ -148,6 +164,7 @@ namespace pcl
         class FeatureContainerInterface
         {
           public:
+            virtual ~FeatureContainerInterface () {}
             virtual bool isValid () = 0;
             virtual double getCorrespondenceScore (int index) = 0;
             virtual bool isCorrespondenceValid (int index) = 0;
@@ -174,7 +191,8 @@ namespace pcl
             
             typedef typename pcl::PointRepresentation<FeatureT>::ConstPtr PointRepresentationConstPtr;
 
-            FeatureContainer () : thresh_(std::numeric_limits<double>::max ()), feature_representation_()
+            FeatureContainer () : thresh_(std::numeric_limits<double>::max ()), 
+                                  feature_representation_(new DefaultFeatureRepresentation<FeatureT>)
             {
             }
 
@@ -224,7 +242,12 @@ namespace pcl
             inline void
             setFeatureRepresentation (const PointRepresentationConstPtr &fr)
             {
-              feature_representation_ = fr;
+              // Fall back to the default implementation for FeatureT, so that scoring never has to
+              // (lazily, and thus not thread safe) create it
+              if (fr)
+                feature_representation_ = fr;
+              else
+                feature_representation_.reset (new DefaultFeatureRepresentation<FeatureT>);
             }
 
             /** \brief Obtain a score between a pair of correspondences.
@@ -234,10 +257,6 @@ namespace pcl
             virtual inline double
             getCorrespondenceScore (int index)
             {
-              // If no feature representation was given, reset to the default implementation for FeatureT
-              if (!feature_representation_)
-                feature_representation_.reset (new DefaultFeatureRepresentation<FeatureT>);
-
               // Get the source and the target feature from the list
               const FeatureT &feat_src = source_features_->points[index];
               const FeatureT &feat_tgt = target_features_->points[index];
@@ -0,0 +1,124 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ */
+#ifndef PCL_REGISTRATION_CORRESPONDENCE_REJECTION_MEDIAN_DISTANCE_H_
+#define PCL_REGISTRATION_CORRESPONDENCE_REJECTION_MEDIAN_DISTANCE_H_
+
+#include <pcl/registration/correspondence_rejection.h>
+
+namespace pcl
+{
+  namespace registration
+  {
+    /** \brief CorrespondenceRejectorMedianDistance implements a simple correspondence rejection method based on
+      * thresholding the distances between the correspondences with an adaptive threshold: correspondences whose
+      * distance is larger than \a factor times the median distance of all correspondences are rejected.
+      *
+      * \note The median is computed over the distances stored in the correspondences (usually squared
+      * Euclidean distances, see \a CorrespondenceEstimation).
+      * \ingroup registration
+      */
+    class CorrespondenceRejectorMedianDistance: public CorrespondenceRejector
+    {
+      using CorrespondenceRejector::input_correspondences_;
+      using CorrespondenceRejector::rejection_name_;
+      using CorrespondenceRejector::getClassName;
+
+      public:
+        typedef boost::shared_ptr<CorrespondenceRejectorMedianDistance> Ptr;
+        typedef boost::shared_ptr<const CorrespondenceRejectorMedianDistance> ConstPtr;
+
+        /** \brief Empty constructor. */
+        CorrespondenceRejectorMedianDistance () : median_distance_ (0), factor_ (1.0)
+        {
+          rejection_name_ = "CorrespondenceRejectorMedianDistance";
+        }
+
+        /** \brief Get a list of valid correspondences after rejection from the original set of correspondences.
+          * \param[in] original_correspondences the set of initial correspondences given
+          * \param[out] remaining_correspondences the resultant filtered set of remaining correspondences
+          */
+        inline void 
+        getRemainingCorrespondences (const pcl::Correspondences& original_correspondences, 
+                                     pcl::Correspondences& remaining_correspondences);
+
+        /** \brief Run correspondence rejection in place, without copying the set of correspondences.
+          * \param[in,out] correspondences the set of correspondences to filter
+          * \param[in,out] scratch a temporary buffer used for the median selection
+          */
+        inline void
+        applyRejectionInPlace (pcl::Correspondences &correspondences, pcl::Correspondences &scratch);
+
+        /** \brief Get the median distance computed during the last call to the rejection method. */
+        inline double
+        getMedianDistance () const { return (median_distance_); };
+
+        /** \brief Set the factor for correspondence rejection. Points with distances greater than
+          * \a factor times the median distance are rejected.
+          * \param[in] factor multiplier used to compute the rejection threshold from the median distance
+          */
+        inline void
+        setMedianFactor (double factor) { factor_ = factor; };
+
+        /** \brief Get the factor used for thresholding in correspondence rejection. */
+        inline double
+        getMedianFactor () const { return (factor_); };
+
+      protected:
+
+        /** \brief Apply the rejection algorithm.
+          * \param[out] correspondences the set of resultant correspondences.
+          */
+        inline void 
+        applyRejection (pcl::Correspondences &correspondences)
+        {
+          getRemainingCorrespondences (*input_correspondences_, correspondences);
+        }
+
+        /** \brief The median distance of the last set of correspondences given. */
+        double median_distance_;
+
+        /** \brief The factor applied to the median distance to obtain the rejection threshold. */
+        double factor_;
+    };
+
+  }
+}
+
+#include "pcl/registration/impl/correspondence_rejection_median_distance.hpp"
+
+#endif /* PCL_REGISTRATION_CORRESPONDENCE_REJECTION_MEDIAN_DISTANCE_H_ */
@@ -60,6 +60,8 @@ namespace pcl
       using CorrespondenceRejector::getClassName;
 
       public:
+        typedef boost::shared_ptr<CorrespondenceRejectorOneToOne> Ptr;
+        typedef boost::shared_ptr<const CorrespondenceRejectorOneToOne> ConstPtr;
 
         /** \brief Empty constructor. */
         CorrespondenceRejectorOneToOne ()
@@ -75,6 +77,13 @@ namespace pcl
         getRemainingCorrespondences (const pcl::Correspondences& original_correspondences, 
                                      pcl::Correspondences& remaining_correspondences);
 
+        /** \brief Run correspondence rejection in place, without copying the set of correspondences.
+          * \param[in,out] correspondences the set of correspondences to filter
+          * \param[in,out] scratch a temporary buffer (unused)
+          */
+        inline void
+        applyRejectionInPlace (pcl::Correspondences &correspondences, pcl::Correspondences &scratch);
+
       protected:
         /** \brief Apply the rejection algorithm.
           * \param[out] correspondences the set of resultant correspondences.
@@ -0,0 +1,158 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ */
+#ifndef PCL_REGISTRATION_CORRESPONDENCE_REJECTION_PIPELINE_H_
+#define PCL_REGISTRATION_CORRESPONDENCE_REJECTION_PIPELINE_H_
+
+#include <pcl/registration/correspondence_rejection.h>
+
+namespace pcl
+{
+  namespace registration
+  {
+    /** \brief CorrespondenceRejectorPipeline chains several correspondence rejectors, applying them in the
+      * order in which they were added.
+      *
+      * Consecutive pointwise rejectors (see \a CorrespondenceRejector::isPointwise, e.g.,
+      * \a CorrespondenceRejectorDistance and \a CorrespondenceRejectorFeatures) are fused into a single
+      * parallel pass over the correspondences followed by an in-place compaction, instead of one copy per
+      * stage. All other rejectors (e.g., \a CorrespondenceRejectorOneToOne, \a CorrespondenceRejectorTrimmed,
+      * \a CorrespondenceRejectorMedianDistance) run in place, sharing a single scratch buffer that is kept
+      * between calls. The result is the same as applying the rejectors one after the other.
+      *
+      * \code
+      * pcl::registration::CorrespondenceRejectorDistance::Ptr rej_dist (new pcl::registration::CorrespondenceRejectorDistance);
+      * rej_dist->setMaximumDistance (0.1);
+      * pcl::registration::CorrespondenceRejectorPipeline pipeline;
+      * pipeline.addRejector (rej_dist);
+      * pipeline.addRejector (pcl::registration::CorrespondenceRejector::Ptr (new pcl::registration::CorrespondenceRejectorOneToOne));
+      * pipeline.setInputCorrespondences (correspondences);
+      * pipeline.getCorrespondences (remaining);
+      * \endcode
+      * \ingroup registration
+      */
+    class CorrespondenceRejectorPipeline: public CorrespondenceRejector
+    {
+      using CorrespondenceRejector::input_correspondences_;
+      using CorrespondenceRejector::rejection_name_;
+      using CorrespondenceRejector::getClassName;
+
+      public:
+        typedef boost::shared_ptr<CorrespondenceRejectorPipeline> Ptr;
+        typedef boost::shared_ptr<const CorrespondenceRejectorPipeline> ConstPtr;
+
+        /** \brief Empty constructor. */
+        CorrespondenceRejectorPipeline () : rejectors_ (), scratch_ (), valid_ (), threads_ (1)
+        {
+          rejection_name_ = "CorrespondenceRejectorPipeline";
+        }
+
+        /** \brief Append a rejector to the end of the pipeline.
+          * \param[in] rejector the rejector to add
+          */
+        inline void
+        addRejector (const CorrespondenceRejector::Ptr &rejector) { rejectors_.push_back (rejector); }
+
+        /** \brief Get the list of rejectors, in the order in which they are applied. */
+        inline const std::vector<CorrespondenceRejector::Ptr>&
+        getRejectors () const { return (rejectors_); }
+
+        /** \brief Remove all rejectors from the pipeline. */
+        inline void
+        clearRejectors () { rejectors_.clear (); }
+
+        /** \brief Set the number of threads used to evaluate fused pointwise rejectors.
+          * \param[in] nr_threads the number of threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+        /** \brief Get a list of valid correspondences after rejection from the original set of correspondences.
+          * \a original_correspondences and \a remaining_correspondences may be the same vector.
+          * \param[in] original_correspondences the set of initial correspondences given
+          * \param[out] remaining_correspondences the resultant filtered set of remaining correspondences
+          */
+        inline void 
+        getRemainingCorrespondences (const pcl::Correspondences& original_correspondences, 
+                                     pcl::Correspondences& remaining_correspondences);
+
+        /** \brief Run all rejectors in place on the given set of correspondences.
+          * \param[in,out] correspondences the set of correspondences to filter
+          * \param[in,out] scratch a temporary buffer (unused, the pipeline keeps its own)
+          */
+        inline void
+        applyRejectionInPlace (pcl::Correspondences &correspondences, pcl::Correspondences &scratch);
+
+      protected:
+
+        /** \brief Apply the rejection algorithm.
+          * \param[out] correspondences the set of resultant correspondences.
+          */
+        inline void 
+        applyRejection (pcl::Correspondences &correspondences)
+        {
+          getRemainingCorrespondences (*input_correspondences_, correspondences);
+        }
+
+        /** \brief Apply the pointwise rejectors in [first, last) in a single pass, then compact the
+          * surviving correspondences in place.
+          * \param[in,out] correspondences the set of correspondences to filter
+          * \param[in] first index of the first rejector of the group in \a rejectors_
+          * \param[in] last index one past the last rejector of the group in \a rejectors_
+          */
+        inline void
+        applyPointwiseRejectors (pcl::Correspondences &correspondences, size_t first, size_t last);
+
+        /** \brief The rejectors, in the order in which they are applied. */
+        std::vector<CorrespondenceRejector::Ptr> rejectors_;
+
+        /** \brief Scratch buffer shared by all non-pointwise rejectors. */
+        pcl::Correspondences scratch_;
+
+        /** \brief Per correspondence verdict of the current fused pointwise pass. */
+        std::vector<unsigned char> valid_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+    };
+
+  }
+}
+
+#include "pcl/registration/impl/correspondence_rejection_pipeline.hpp"
+
+#endif /* PCL_REGISTRATION_CORRESPONDENCE_REJECTION_PIPELINE_H_ */
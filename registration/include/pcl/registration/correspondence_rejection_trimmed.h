@@ -65,6 +65,8 @@ namespace pcl
       using CorrespondenceRejector::getClassName;
 
       public:
+        typedef boost::shared_ptr<CorrespondenceRejectorTrimmed> Ptr;
+        typedef boost::shared_ptr<const CorrespondenceRejectorTrimmed> ConstPtr;
 
         /** \brief Empty constructor. */
         CorrespondenceRejectorTrimmed () : overlap_ratio_(1.0f)
@@ -108,6 +110,13 @@ namespace pcl
         getRemainingCorrespondences (const pcl::Correspondences& original_correspondences,
                                      pcl::Correspondences& remaining_correspondences);
 
+        /** \brief Run correspondence rejection in place, without copying the set of correspondences.
+          * \param[in,out] correspondences the set of correspondences to filter
+          * \param[in,out] scratch a temporary buffer (unused)
+          */
+        inline void
+        applyRejectionInPlace (pcl::Correspondences &correspondences, pcl::Correspondences &scratch);
+
 
       protected:
 
@@ -48,7 +48,7 @@ namespace pcl
       */
     struct sortCorrespondencesByQueryIndex : public std::binary_function<pcl::Correspondence, pcl::Correspondence, bool>
     {
-      bool operator()( pcl::Correspondence a, pcl::Correspondence b)
+      bool operator()( const pcl::Correspondence &a, const pcl::Correspondence &b) const
       {
         return (a.index_query < b.index_query);
       }
@@ -60,7 +60,7 @@ namespace pcl
       */
     struct sortCorrespondencesByMatchIndex : public std::binary_function<pcl::Correspondence, pcl::Correspondence, bool>
     {
-      bool operator()( pcl::Correspondence a, pcl::Correspondence b)
+      bool operator()( const pcl::Correspondence &a, const pcl::Correspondence &b) const
       {
         return (a.index_match < b.index_match);
       }
@@ -72,7 +72,7 @@ namespace pcl
       */
     struct sortCorrespondencesByDistance : public std::binary_function<pcl::Correspondence, pcl::Correspondence, bool>
     {
-      bool operator()( pcl::Correspondence a, pcl::Correspondence b)
+      bool operator()( const pcl::Correspondence &a, const pcl::Correspondence &b) const
       {
         return (a.distance < b.distance);
       }
@@ -84,7 +84,7 @@ namespace pcl
       */
     struct sortCorrespondencesByQueryIndexAndDistance : public std::binary_function<pcl::Correspondence, pcl::Correspondence, bool>
     {
-      bool operator()( pcl::Correspondence a, pcl::Correspondence b)
+      bool operator()( const pcl::Correspondence &a, const pcl::Correspondence &b) const
       {
         if (a.index_query < b.index_query)
           return true;
@@ -100,7 +100,7 @@ namespace pcl
       */
     struct sortCorrespondencesByMatchIndexAndDistance : public std::binary_function<pcl::Correspondence, pcl::Correspondence, bool>
     {
-      bool operator()( pcl::Correspondence a, pcl::Correspondence b)
+      bool operator()( const pcl::Correspondence &a, const pcl::Correspondence &b) const
       {
         if (a.index_match < b.index_match)
           return true;
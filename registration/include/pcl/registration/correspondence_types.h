@@ -67,6 +67,38 @@ namespace pcl
     inline void 
     getMatchIndices (const pcl::Correspondences& correspondences, std::vector<int>& indices);
 
+    /** \brief Index view that maps i to i, used to walk over a whole cloud like over an index vector. */
+    struct IdentityIndices
+    {
+      inline int
+      operator[] (size_t i) const { return ((int)i); }
+    };
+
+    /** \brief Index view on the query indices of a list of correspondences, an alternative to
+      * getQueryIndices () that does not copy the indices.
+      */
+    struct CorrespondenceQueryIndices
+    {
+      CorrespondenceQueryIndices (const pcl::Correspondences &correspondences) : correspondences_ (correspondences) {}
+
+      inline int
+      operator[] (size_t i) const { return (correspondences_[i].index_query); }
+
+      const pcl::Correspondences &correspondences_;
+    };
+
+    /** \brief Index view on the match indices of a list of correspondences, an alternative to
+      * getMatchIndices () that does not copy the indices.
+      */
+    struct CorrespondenceMatchIndices
+    {
+      CorrespondenceMatchIndices (const pcl::Correspondences &correspondences) : correspondences_ (correspondences) {}
+
+      inline int
+      operator[] (size_t i) const { return (correspondences_[i].index_match); }
+
+      const pcl::Correspondences &correspondences_;
+    };
   }
 }
 
@@ -51,6 +51,7 @@
 #include <pcl/point_cloud.h>
 #include <pcl/registration/registration.h>
 #include <pcl/registration/icp.h>
+#include <pcl/filters/voxel_grid.h>
 
 namespace pcl
 {
@@ -90,7 +91,8 @@ namespace pcl
         typedef typename Registration::ConstPtr RegistrationConstPtr;
 
         /** \brief Empty constructor. */
-        ELCH () : loop_graph_ (new LoopGraph), loop_start_ (0), loop_end_ (0), reg_ (new pcl::IterativeClosestPoint<PointT, PointT>), compute_loop_ (true)
+        ELCH () : loop_graph_ (new LoopGraph), loop_start_ (0), loop_end_ (0), reg_ (new pcl::IterativeClosestPoint<PointT, PointT>), compute_loop_ (true),
+                  leaf_size_ (0), downsampled_clouds_ (), threads_ (1)
         {};
 
         /** \brief Add a new point cloud to the internal graph.
@@ -120,6 +122,7 @@ namespace pcl
         setLoopGraph (LoopGraphPtr loop_graph)
         {
           loop_graph_ = loop_graph;
+          downsampled_clouds_.clear ();
         }
 
         /** \brief Getter for the first scan of a loop. */
@@ -187,9 +190,44 @@ namespace pcl
           compute_loop_ = false;
         }
 
+        /** \brief Set the leaf size of the voxel grid used to downsample the clouds around the loop start and end
+          * before they are registered. The downsampled clouds are cached per scan and transformed together with
+          * their scans by compute (), so closing further loops in an online setting does not rebuild them.
+          * \note The cache assumes that the clouds in the graph are only modified through compute ().
+          * \param[in] leaf_size the voxel grid leaf size (0 disables downsampling)
+          */
+        inline void
+        setLeafSize (float leaf_size)
+        {
+          leaf_size_ = leaf_size;
+          downsampled_clouds_.clear ();
+        }
+
+        /** \brief Get the voxel grid leaf size used to downsample the loop clouds. */
+        inline float
+        getLeafSize ()
+        {
+          return (leaf_size_);
+        }
+
+        /** \brief Set the number of threads used to apply the new poses to the point clouds.
+          * \param[in] nr_threads the number of hardware threads to use
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads)
+        {
+          if (nr_threads == 0)
+            nr_threads = 1;
+          threads_ = nr_threads;
+        }
+
         /** \brief Computes now poses for all point clouds by closing the loop
          * between start and end point cloud. This will transform all given point
          * clouds for now!
+         * \note Only the part of the graph that lies on paths between the loop start and end is optimized.
+         * Earlier loops and scans hanging off this part, e.g. the map built before the loop start, keep the
+         * pose of the vertex they are attached to, so closing a new loop in an online setting leaves them
+         * unchanged and doesn't run the weight propagation over them.
          */
         void
         compute ();
@@ -219,6 +257,23 @@ namespace pcl
         void
         loopOptimizerAlgorithm (LOAGraph &g, double *weights);
 
+        /** \brief Remove everything from the graph that doesn't lie on a path between the loop start and end,
+          * i.e. all biconnected components that are not passed when going from the loop start to the loop end.
+          * The removed vertices don't take part in the weight computation, they inherit the weight of the vertex
+          * they are attached to.
+          * \param[in,out] g the graph
+          * \param[out] pruned the removed vertices and the vertex each of them is attached to, ordered such
+          * that every attachment vertex either stays in the graph or precedes the vertices attached to it
+          */
+        void
+        pruneBranches (LOAGraph &g, std::vector<std::pair<int, int> > &pruned);
+
+        /** \brief Get the (cached) downsampled cloud of a scan, see setLeafSize ().
+          * \param[in] vertex the scan in the loop graph
+          */
+        PointCloudPtr
+        getDownsampledCloud (typename boost::graph_traits<LoopGraph>::vertex_descriptor vertex);
+
         /** \brief The internal loop graph. */
         LoopGraphPtr loop_graph_;
 
@@ -235,6 +290,15 @@ namespace pcl
         Eigen::Matrix4f loop_transform_;
         bool compute_loop_;
 
+        /** \brief The voxel grid leaf size used to downsample the loop clouds. */
+        float leaf_size_;
+
+        /** \brief The cached downsampled clouds, indexed by the vertices of the loop graph. */
+        std::vector<PointCloudPtr> downsampled_clouds_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+
         /** \brief previously added node in the loop_graph_. */
         typename boost::graph_traits<LoopGraph>::vertex_descriptor vd_;
 
@@ -40,6 +40,7 @@
 
 #include "pcl/registration/icp.h"
 #include "pcl/registration/bfgs.h"
+#include "pcl/registration/prepared_target.h"
 
 namespace pcl
 {
@@ -60,6 +61,7 @@ namespace pcl
     using IterativeClosestPoint<PointSource, PointTarget>::getClassName;
     using IterativeClosestPoint<PointSource, PointTarget>::indices_;
     using IterativeClosestPoint<PointSource, PointTarget>::target_;
+    using IterativeClosestPoint<PointSource, PointTarget>::prepared_target_;
     using IterativeClosestPoint<PointSource, PointTarget>::input_;
     using IterativeClosestPoint<PointSource, PointTarget>::tree_;
     using IterativeClosestPoint<PointSource, PointTarget>::nr_iterations_;
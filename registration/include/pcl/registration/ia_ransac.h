@@ -46,6 +46,11 @@ namespace pcl
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief @b SampleConsensusInitialAlignment is an implementation of the initial alignment algorithm described in
     *  section IV of "Fast Point Feature Histograms (FPFH) for 3D Registration," Rusu et al.
+    *
+    * The random samples of all iterations are drawn up front, the feature space nearest neighbors of the sampled
+    * source features are looked up once and cached until the features change, and the hypotheses are then
+    * evaluated in parallel (see setNumberOfThreads ()). The result does not depend on the number of threads.
+    * \note When using more than one thread, the transformation estimation object has to be thread safe.
     * \author Radu Bogdan Rusu, Michael Dixon
     * \ingroup registration
     */
@@ -122,7 +127,8 @@ namespace pcl
 
       typedef typename KdTreeFLANN<FeatureT>::Ptr FeatureKdTreePtr; 
       /** \brief Constructor. */
-      SampleConsensusInitialAlignment () : nr_samples_(3), min_sample_distance_ (0), k_correspondences_ (10)
+      SampleConsensusInitialAlignment () : nr_samples_(3), min_sample_distance_ (0), k_correspondences_ (10),
+                                           similar_features_ (), threads_ (1)
       {
         reg_name_ = "SampleConsensusInitialAlignment";
         feature_tree_.reset (new pcl::KdTreeFLANN<FeatureT>);
@@ -175,7 +181,11 @@ namespace pcl
         * \param k the number of neighbors to use when selecting a random feature correspondence.
         */
       void
-      setCorrespondenceRandomness (int k) { k_correspondences_ = k; }
+      setCorrespondenceRandomness (int k) 
+      { 
+        k_correspondences_ = k; 
+        similar_features_.clear ();
+      }
 
       /** \brief Get the number of neighbors used when selecting a random feature correspondence, as set by the user */
       int
@@ -194,6 +204,17 @@ namespace pcl
       boost::shared_ptr<ErrorFunctor>
       getErrorFunction () { return (error_functor_); }
 
+      /** \brief Set the number of threads used to evaluate the alignment hypotheses.
+        * \param[in] nr_threads the number of hardware threads to use
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        if (nr_threads == 0)
+          nr_threads = 1;
+        threads_ = nr_threads;
+      }
+
     protected:
       /** \brief Choose a random index between 0 and n-1
         * \param n the number of possible indices to choose from
@@ -230,6 +251,23 @@ namespace pcl
       float 
       computeErrorMetric (const PointCloudSource &cloud, float threshold);
 
+      /** \brief Compute the error metric of the input cloud transformed by the given transformation, without
+        * creating the transformed cloud. The computation stops as soon as the error exceeds \a max_error.
+        * \param cloud the input cloud
+        * \param transformation the transformation to apply to the input cloud
+        * \param max_error the error at which the computation is aborted (the hypothesis can't win anymore)
+        * \return the error, or a partial error larger than \a max_error
+        */
+      float 
+      computeErrorMetric (const PointCloudSource &cloud, const Eigen::Matrix4f &transformation, float max_error);
+
+      /** \brief Make sure the \a k_correspondences_ nearest target features of the given source features are cached.
+        * \param input_features the source feature descriptors
+        * \param sample_indices the indices of the source features
+        */
+      void 
+      cacheSimilarFeatures (const FeatureCloud &input_features, const std::vector<int> &sample_indices);
+
       /** \brief Rigid transformation computation method.
         * \param output the transformed input point cloud dataset using the rigid transformation found
         */
@@ -256,6 +294,12 @@ namespace pcl
 
       /** */
       boost::shared_ptr<ErrorFunctor> error_functor_;
+
+      /** \brief The cached nearest target features of each source feature (empty if not looked up yet). */
+      std::vector<std::vector<int> > similar_features_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
     public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
   };
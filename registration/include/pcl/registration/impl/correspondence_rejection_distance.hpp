@@ -44,25 +44,16 @@ pcl::registration::CorrespondenceRejectorDistance::getRemainingCorrespondences (
     const pcl::Correspondences& original_correspondences, 
     pcl::Correspondences& remaining_correspondences)
 {
+  // Compacting front to back never overwrites an entry that still has to be read, so this also
+  // works when both arguments refer to the same vector
   unsigned int number_valid_correspondences = 0;
   remaining_correspondences.resize (original_correspondences.size ());
   for (size_t i = 0; i < original_correspondences.size (); ++i)
   {
-    if (data_container_)
+    if (isCorrespondenceValid (original_correspondences, i))
     {
-      if (data_container_->getCorrespondenceScore (original_correspondences[i]) < max_distance_)
-      {
-        remaining_correspondences[number_valid_correspondences] = original_correspondences[i];
-        ++number_valid_correspondences;
-      }
-    }
-    else
-    {
-      if (original_correspondences[i].distance < max_distance_)
-      {
-        remaining_correspondences[number_valid_correspondences] = original_correspondences[i];
-        ++number_valid_correspondences;
-      }
+      remaining_correspondences[number_valid_correspondences] = original_correspondences[i];
+      ++number_valid_correspondences;
     }
   }
   remaining_correspondences.resize (number_valid_correspondences);
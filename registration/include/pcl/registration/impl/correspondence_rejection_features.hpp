@@ -46,17 +46,10 @@ pcl::registration::CorrespondenceRejectorFeatures::getRemainingCorrespondences (
 {
   unsigned int number_valid_correspondences = 0;
   remaining_correspondences.resize (original_correspondences.size ());
-  // For each set of features, go over each correspondence from input_correspondences_
-  for (size_t i = 0; i < input_correspondences_->size (); ++i)
+  for (size_t i = 0; i < original_correspondences.size (); ++i)
   {
-    // Go over the map of features
-    for (FeaturesMap::const_iterator it = features_map_.begin (); it != features_map_.end (); ++it)
+    if (isCorrespondenceValid (original_correspondences, i))
     {
-      // Check if the score in feature space is above the given threshold
-      // (assume that the number of feature correspondenecs is the same as the number of point correspondences)
-      if (!it->second->isCorrespondenceValid (i))
-        break;
-
       remaining_correspondences[number_valid_correspondences] = original_correspondences[i];
       ++number_valid_correspondences;
     }
@@ -64,6 +57,19 @@ pcl::registration::CorrespondenceRejectorFeatures::getRemainingCorrespondences (
   remaining_correspondences.resize (number_valid_correspondences);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline bool
+pcl::registration::CorrespondenceRejectorFeatures::isCorrespondenceValid (
+    const pcl::Correspondences &, size_t index) const
+{
+  // Check if the score in feature space is below the given threshold for every feature
+  // (assume that the number of feature correspondences is the same as the number of point correspondences)
+  for (FeaturesMap::const_iterator it = features_map_.begin (); it != features_map_.end (); ++it)
+    if (!it->second->isCorrespondenceValid (static_cast<int> (index)))
+      return (false);
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename FeatureT> inline void 
 pcl::registration::CorrespondenceRejectorFeatures::setSourceFeature (
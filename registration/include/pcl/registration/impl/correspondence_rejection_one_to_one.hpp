@@ -44,26 +44,34 @@ pcl::registration::CorrespondenceRejectorOneToOne::getRemainingCorrespondences (
     const pcl::Correspondences& original_correspondences, 
     pcl::Correspondences& remaining_correspondences)
 {
-  /* not really an efficient implementation */
-  pcl::Correspondences input = original_correspondences;
+  if (&remaining_correspondences != &original_correspondences)
+    remaining_correspondences = original_correspondences;
+  pcl::Correspondences unused;
+  applyRejectionInPlace (remaining_correspondences, unused);
+}
 
-  std::sort (input.begin (), input.end (), pcl::registration::sortCorrespondencesByMatchIndexAndDistance ());
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorOneToOne::applyRejectionInPlace (
+    pcl::Correspondences &correspondences, pcl::Correspondences &)
+{
+  std::sort (correspondences.begin (), correspondences.end (), pcl::registration::sortCorrespondencesByMatchIndexAndDistance ());
 
-  remaining_correspondences.resize (input.size ());
+  // Keep the closest correspondence per match index, compacting front to back
   int index_last = -1;
   unsigned int number_valid_correspondences = 0;
-  for (size_t i = 0; i < input.size (); ++i)
+  for (size_t i = 0; i < correspondences.size (); ++i)
   {
-    if (input[i].index_match < 0)
+    if (correspondences[i].index_match < 0)
       continue;
-    else if (input[i].index_match != index_last)
+    else if (correspondences[i].index_match != index_last)
     {
-      remaining_correspondences[number_valid_correspondences] = input[i];
-      index_last = input[i].index_match;
+      index_last = correspondences[i].index_match;
+      correspondences[number_valid_correspondences] = correspondences[i];
       ++number_valid_correspondences;
     }
   }
-  remaining_correspondences.resize (number_valid_correspondences);
+  correspondences.resize (number_valid_correspondences);
 }
 
 #endif /* PCL_REGISTRATION_IMPL_CORRESPONDENCE_REJECTION_ONE_TO_ONE_HPP_ */
@@ -0,0 +1,108 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ */
+#ifndef PCL_REGISTRATION_IMPL_CORRESPONDENCE_REJECTION_PIPELINE_HPP_
+#define PCL_REGISTRATION_IMPL_CORRESPONDENCE_REJECTION_PIPELINE_HPP_
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorPipeline::getRemainingCorrespondences (
+    const pcl::Correspondences& original_correspondences, 
+    pcl::Correspondences& remaining_correspondences)
+{
+  if (&remaining_correspondences != &original_correspondences)
+    remaining_correspondences = original_correspondences;
+  applyRejectionInPlace (remaining_correspondences, scratch_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorPipeline::applyRejectionInPlace (
+    pcl::Correspondences &correspondences, pcl::Correspondences &)
+{
+  size_t stage = 0;
+  while (stage < rejectors_.size () && !correspondences.empty ())
+  {
+    if (!rejectors_[stage])
+    {
+      ++stage;
+      continue;
+    }
+
+    if (!rejectors_[stage]->isPointwise ())
+    {
+      rejectors_[stage]->applyRejectionInPlace (correspondences, scratch_);
+      ++stage;
+      continue;
+    }
+
+    // Group all consecutive pointwise rejectors into a single pass
+    size_t last = stage + 1;
+    while (last < rejectors_.size () && rejectors_[last] && rejectors_[last]->isPointwise ())
+      ++last;
+    applyPointwiseRejectors (correspondences, stage, last);
+    stage = last;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorPipeline::applyPointwiseRejectors (
+    pcl::Correspondences &correspondences, size_t first, size_t last)
+{
+  const int nr_correspondences = static_cast<int> (correspondences.size ());
+  valid_.resize (nr_correspondences);
+
+  // A correspondence rejected by one stage would not have been seen by the later ones, so testing
+  // all stages on the same set and keeping the conjunction yields the sequential result
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int i = 0; i < nr_correspondences; ++i)
+  {
+    unsigned char valid = 1;
+    for (size_t r = first; r < last && valid; ++r)
+      valid = rejectors_[r]->isCorrespondenceValid (correspondences, i);
+    valid_[i] = valid;
+  }
+
+  size_t nr_valid = 0;
+  for (int i = 0; i < nr_correspondences; ++i)
+    if (valid_[i])
+      correspondences[nr_valid++] = correspondences[i];
+  correspondences.resize (nr_valid);
+}
+
+#endif /* PCL_REGISTRATION_IMPL_CORRESPONDENCE_REJECTION_PIPELINE_HPP_ */
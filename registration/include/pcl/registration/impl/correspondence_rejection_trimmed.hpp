@@ -44,18 +44,27 @@ pcl::registration::CorrespondenceRejectorTrimmed::getRemainingCorrespondences (
     const pcl::Correspondences& original_correspondences, 
     pcl::Correspondences& remaining_correspondences)
 {
-  /* not really an efficient implementation */
-  remaining_correspondences = original_correspondences;
-  unsigned int number_valid_correspondences = (int (std::floor (overlap_ratio_ * (float) (remaining_correspondences.size ()))));
+  if (&remaining_correspondences != &original_correspondences)
+    remaining_correspondences = original_correspondences;
+  pcl::Correspondences unused;
+  applyRejectionInPlace (remaining_correspondences, unused);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorTrimmed::applyRejectionInPlace (
+    pcl::Correspondences &correspondences, pcl::Correspondences &)
+{
+  unsigned int number_valid_correspondences = (int (std::floor (overlap_ratio_ * (float) (correspondences.size ()))));
   number_valid_correspondences = std::max (number_valid_correspondences, nr_min_correspondences_);
 
-  if (number_valid_correspondences < remaining_correspondences.size ())
+  if (number_valid_correspondences < correspondences.size ())
   {
-    std::sort (remaining_correspondences.begin (), remaining_correspondences.end (), 
-               pcl::registration::sortCorrespondencesByDistance ());
-    remaining_correspondences.resize (number_valid_correspondences);
+    // Only the best 'k' correspondences are kept, so only those need to be sorted
+    std::partial_sort (correspondences.begin (), correspondences.begin () + number_valid_correspondences, 
+                       correspondences.end (), pcl::registration::sortCorrespondencesByDistance ());
+    correspondences.resize (number_valid_correspondences);
   }
 }
 
-
 #endif /* PCL_REGISTRATION_IMPL_CORRESPONDENCE_REJECTION_TRIMMED_HPP_ */
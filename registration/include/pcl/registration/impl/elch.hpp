@@ -41,11 +41,14 @@
 #define PCL_REGISTRATION_IMPL_ELCH_H_
 
 #include <list>
+#include <map>
 #include <algorithm>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <boost/graph/biconnected_components.hpp>
+#include <boost/property_map/property_map.hpp>
 
 #include <Eigen/Geometry>
 
@@ -153,6 +156,92 @@ pcl::registration::ELCH<PointT>::loopOptimizerAlgorithm (LOAGraph &g, double *we
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::registration::ELCH<PointT>::pruneBranches (LOAGraph &g, std::vector<std::pair<int, int> > &pruned)
+{
+  typedef typename boost::graph_traits<LOAGraph>::edge_descriptor Edge;
+
+  pruned.clear ();
+
+  // a vertex lies on a path between the loop start and end if it shares a biconnected component with the edge
+  // closing the loop
+  Edge loop_edge;
+  bool loop_edge_exists;
+  boost::tuples::tie (loop_edge, loop_edge_exists) = edge (loop_start_, loop_end_, g);
+  if (!loop_edge_exists)
+    loop_edge = add_edge (loop_start_, loop_end_, 0, g).first;
+
+  std::map<Edge, std::size_t> components;
+  boost::associative_property_map<std::map<Edge, std::size_t> > component_map (components);
+  biconnected_components (g, component_map);
+
+  const std::size_t loop_component = components[loop_edge];
+  if (!loop_edge_exists)
+    remove_edge (loop_edge, g);
+
+  std::vector<bool> on_loop (num_vertices (g), false);
+  on_loop[loop_start_] = on_loop[loop_end_] = true;
+
+  std::vector<Edge> off_loop_edges;
+  typename boost::graph_traits<LOAGraph>::edge_iterator edge_it, edge_it_end;
+  for (boost::tuples::tie (edge_it, edge_it_end) = edges (g); edge_it != edge_it_end; ++edge_it)
+  {
+    if (components[*edge_it] == loop_component)
+      on_loop[source (*edge_it, g)] = on_loop[target (*edge_it, g)] = true;
+    else
+      off_loop_edges.push_back (*edge_it);
+  }
+
+  // everything else hangs off a single vertex of the loop part, walk outwards from there
+  std::vector<bool> visited (on_loop);
+  std::list<int> queue;
+  for (int i = 0; i < (int)on_loop.size (); i++)
+    if (on_loop[i])
+      queue.push_back (i);
+
+  boost::graph_traits<LOAGraph>::adjacency_iterator adjacent_it, adjacent_it_end;
+  while (!queue.empty ())
+  {
+    int v = queue.front ();
+    queue.pop_front ();
+
+    for (boost::tuples::tie (adjacent_it, adjacent_it_end) = adjacent_vertices (v, g); adjacent_it != adjacent_it_end; ++adjacent_it)
+    {
+      if (visited[*adjacent_it])
+        continue;
+      visited[*adjacent_it] = true;
+      pruned.push_back (std::make_pair ((int)*adjacent_it, v));
+      queue.push_back (*adjacent_it);
+    }
+  }
+
+  for (size_t i = 0; i < off_loop_edges.size (); i++)
+    remove_edge (off_loop_edges[i], g);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> typename pcl::registration::ELCH<PointT>::PointCloudPtr
+pcl::registration::ELCH<PointT>::getDownsampledCloud (typename boost::graph_traits<LoopGraph>::vertex_descriptor vertex)
+{
+  if (leaf_size_ <= 0)
+    return ((*loop_graph_)[vertex].cloud);
+
+  if (downsampled_clouds_.size () < num_vertices (*loop_graph_))
+    downsampled_clouds_.resize (num_vertices (*loop_graph_));
+
+  if (!downsampled_clouds_[vertex])
+  {
+    downsampled_clouds_[vertex].reset (new PointCloud);
+    pcl::VoxelGrid<PointT> grid;
+    grid.setLeafSize (leaf_size_, leaf_size_, leaf_size_);
+    grid.setInputCloud ((*loop_graph_)[vertex].cloud);
+    grid.filter (*downsampled_clouds_[vertex]);
+  }
+
+  return (downsampled_clouds_[vertex]);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::registration::ELCH<PointT>::initCompute ()
@@ -182,15 +271,15 @@ pcl::registration::ELCH<PointT>::initCompute ()
   {
     PointCloudPtr meta_start (new PointCloud);
     PointCloudPtr meta_end (new PointCloud);
-    *meta_start = *(*loop_graph_)[loop_start_].cloud;
-    *meta_end = *(*loop_graph_)[loop_end_].cloud;
+    *meta_start = *getDownsampledCloud (loop_start_);
+    *meta_end = *getDownsampledCloud (loop_end_);
 
     typename boost::graph_traits<LoopGraph>::adjacency_iterator si, si_end;
     for (boost::tuples::tie (si, si_end) = adjacent_vertices (loop_start_, *loop_graph_); si != si_end; si++)
-      *meta_start += *(*loop_graph_)[*si].cloud;
+      *meta_start += *getDownsampledCloud (*si);
 
     for (boost::tuples::tie (si, si_end) = adjacent_vertices (loop_end_, *loop_graph_); si != si_end; si++)
-      *meta_end += *(*loop_graph_)[*si].cloud;
+      *meta_end += *getDownsampledCloud (*si);
 
     //TODO use real pose instead of centroid
     //Eigen::Vector4f pose_start;
@@ -229,21 +318,30 @@ pcl::registration::ELCH<PointT>::compute ()
     return;
   }
 
-  LOAGraph grb[4];
+  LOAGraph grb (num_vertices (*loop_graph_));
 
   typename boost::graph_traits<LoopGraph>::edge_iterator edge_it, edge_it_end;
   for (boost::tuples::tie (edge_it, edge_it_end) = edges (*loop_graph_); edge_it != edge_it_end; edge_it++)
   {
-    for (int j = 0; j < 4; j++)
-      add_edge (source (*edge_it, *loop_graph_), target (*edge_it, *loop_graph_), 1, grb[j]);  //TODO add variance
+    // parallel edges (e.g. a loop closed twice) don't change the weights, but would break the block decomposition
+    int s = (int)source (*edge_it, *loop_graph_);
+    int t = (int)target (*edge_it, *loop_graph_);
+    if (s != t && !edge (s, t, grb).second)
+      add_edge (s, t, 1, grb);  //TODO add variance
   }
 
-  double *weights[4];
-  for (int i = 0; i < 4; i++)
-  {
-    weights[i] = new double[num_vertices (*loop_graph_)];
-    loopOptimizerAlgorithm (grb[i], weights[i]);
-  }
+  // everything hanging off the part of the graph between the loop start and end only inherits a weight
+  std::vector<std::pair<int, int> > pruned;
+  pruneBranches (grb, pruned);
+
+  // all edges have the same weight so far, thus all four channels (x, y, z, rotation) get the same weights
+  //TODO compute a channel per dimension once the edges carry variances
+  int nr_vertices = (int)num_vertices (*loop_graph_);
+  std::vector<double> weights (nr_vertices, 0.0);
+  loopOptimizerAlgorithm (grb, &weights[0]);
+
+  for (std::vector<std::pair<int, int> >::const_iterator it = pruned.begin (); it != pruned.end (); ++it)
+    weights[it->first] = weights[it->second];
 
   //TODO use pose
   //Eigen::Vector4f cend;
@@ -252,20 +350,26 @@ pcl::registration::ELCH<PointT>::compute ()
   //Eigen::Affine3f aend (tend);
   //Eigen::Affine3f aendI = aend.inverse ();
 
+  Eigen::Affine3f bl (loop_transform_);
+  Eigen::Quaternionf q (bl.rotation ());
+
   //TODO iterate ovr loop_graph_
   //typename boost::graph_traits<LoopGraph>::vertex_iterator vertex_it, vertex_it_end;
   //for (boost::tuples::tie (vertex_it, vertex_it_end) = vertices (*loop_graph_); vertex_it != vertex_it_end; vertex_it++)
-  for (size_t i = 0; i < num_vertices (*loop_graph_); i++)
+#pragma omp parallel for schedule (dynamic) num_threads (threads_)
+  for (int i = 0; i < nr_vertices; i++)
   {
+    // scans outside of the loop keep their pose
+    if (weights[i] == 0)
+      continue;
+
     Eigen::Vector3f t2;
-    t2[0] = loop_transform_ (0, 3) * weights[0][i];
-    t2[1] = loop_transform_ (1, 3) * weights[1][i];
-    t2[2] = loop_transform_ (2, 3) * weights[2][i];
+    t2[0] = loop_transform_ (0, 3) * weights[i];
+    t2[1] = loop_transform_ (1, 3) * weights[i];
+    t2[2] = loop_transform_ (2, 3) * weights[i];
 
-    Eigen::Affine3f bl (loop_transform_);
-    Eigen::Quaternionf q (bl.rotation ());
     Eigen::Quaternionf q2;
-    q2 = Eigen::Quaternionf::Identity ().slerp (weights[3][i], q);
+    q2 = Eigen::Quaternionf::Identity ().slerp (weights[i], q);
 
     //TODO use rotation from branch start
     Eigen::Translation3f t3 (t2);
@@ -273,6 +377,10 @@ pcl::registration::ELCH<PointT>::compute ()
     //a = aend * a * aendI;
 
     pcl::transformPointCloud (*(*loop_graph_)[i].cloud, *(*loop_graph_)[i].cloud, a);
+
+    // keep the cached downsampled clouds in sync with their scans
+    if (i < (int)downsampled_clouds_.size () && downsampled_clouds_[i])
+      pcl::transformPointCloud (*downsampled_clouds_[i], *downsampled_clouds_[i], a);
   }
 
   add_edge (loop_start_, loop_end_, *loop_graph_);
@@ -345,8 +345,12 @@ pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransfor
   const size_t N = indices_->size ();
   // Set the mahalanobis matrices to identity
   mahalanobis_.resize (N, Eigen::Matrix3d::Identity ());
-  // Compute target cloud covariance matrices
-  computeCovariances<PointTarget> (target_, tree_, target_covariances_);
+  // Compute target cloud covariance matrices, unless a prepared target already holds them
+  const std::vector<Eigen::Matrix3d> *target_covariances = &target_covariances_;
+  if (prepared_target_ && prepared_target_->hasCovariances (k_correspondences_, gicp_epsilon_))
+    target_covariances = &prepared_target_->getCovariances ();
+  else
+    computeCovariances<PointTarget> (target_, tree_, target_covariances_);
   // Compute input cloud covariance matrices
   computeCovariances<PointSource> (input_, input_tree_, input_covariances_);
 
@@ -388,7 +392,7 @@ pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransfor
       if (nn_dists[0] < dist_threshold)
       {
         Eigen::Matrix3d &C1 = input_covariances_[i];
-        Eigen::Matrix3d &C2 = target_covariances_[nn_indices[0]];
+        const Eigen::Matrix3d &C2 = (*target_covariances)[nn_indices[0]];
         Eigen::Matrix3d &M = mahalanobis_[i];
         // M = R*C1
         M = R * C1;
@@ -45,6 +45,7 @@ pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::setSou
     return;
   }
   input_features_ = features;
+  similar_features_.clear ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -58,6 +59,7 @@ pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::setTar
   }
   target_features_ = features;
   feature_tree_->setInputCloud (target_features_);
+  similar_features_.clear ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -143,6 +145,63 @@ pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::findSi
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename FeatureT> void 
+pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::cacheSimilarFeatures (
+    const FeatureCloud &input_features, const std::vector<int> &sample_indices)
+{
+  similar_features_.resize (input_features.points.size ());
+
+  std::vector<int> missing;
+  for (size_t i = 0; i < sample_indices.size (); ++i)
+    if (similar_features_[sample_indices[i]].empty ())
+      missing.push_back (sample_indices[i]);
+  std::sort (missing.begin (), missing.end ());
+  missing.erase (std::unique (missing.begin (), missing.end ()), missing.end ());
+
+#pragma omp parallel for schedule (dynamic, 16) num_threads (threads_)
+  for (int i = 0; i < (int)missing.size (); ++i)
+  {
+    std::vector<int> nn_indices (k_correspondences_);
+    std::vector<float> nn_distances (k_correspondences_);
+    // Find the k features nearest to input_features.points[missing[i]]
+    feature_tree_->nearestKSearch (input_features, missing[i], k_correspondences_, nn_indices, nn_distances);
+    similar_features_[missing[i]].swap (nn_indices);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename FeatureT> float 
+pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::computeErrorMetric (
+    const PointCloudSource &cloud, const Eigen::Matrix4f &transformation, float max_error)
+{
+  std::vector<int> nn_index (1);
+  std::vector<float> nn_distance (1);
+
+  const ErrorFunctor & compute_error = *error_functor_;
+  float error = 0;
+
+  const Eigen::Matrix3f rotation = transformation.topLeftCorner<3, 3> ();
+  const Eigen::Vector3f translation = transformation.block<3, 1> (0, 3);
+
+  PointSource point;
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    // Transform cloud.points[i] on the fly
+    point = cloud.points[i];
+    point.getVector3fMap () = rotation * cloud.points[i].getVector3fMap () + translation;
+
+    // Find the distance between the transformed point and its nearest neighbor in the target point cloud
+    tree_->nearestKSearchT (point, 1, nn_index, nn_distance);
+
+    // Compute the error, and give up as soon as this hypothesis can't beat the best one anymore
+    error += compute_error (nn_distance[0]);
+    if (error > max_error)
+      break;
+  }
+  return (error);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget, typename FeatureT> float 
 pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::computeErrorMetric (
@@ -188,41 +247,78 @@ pcl::SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::comput
   }
 
   std::vector<int> sample_indices (nr_samples_);
-  std::vector<int> corresponding_indices (nr_samples_);
-  PointCloudSource input_transformed;
-  float error, lowest_error (0);
+  float lowest_error (std::numeric_limits<float>::max ());
+  int best_iter = -1;
 
   final_transformation_ = guess;
   int i_iter = 0;
   if (!guess.isApprox(Eigen::Matrix4f::Identity(), 0.01f)) { //If guess is not the Identity matrix we check it.
-	  transformPointCloud (*input_, input_transformed, final_transformation_);
-	  lowest_error = computeErrorMetric (input_transformed, (float) corr_dist_threshold_);
+	  lowest_error = computeErrorMetric (*input_, final_transformation_, std::numeric_limits<float>::max ());
 	  i_iter = 1;
   }
 
-  for (; i_iter < max_iterations_; ++i_iter)
+  // Draw the random samples and the random feature correspondences of all iterations up front, in the
+  // same order as a sequential run would, so the hypotheses can be evaluated in any order
+  int nr_hypotheses = std::max (max_iterations_ - i_iter, 0);
+  std::vector<int> hypotheses_samples (nr_hypotheses * nr_samples_);
+  std::vector<int> hypotheses_picks (nr_hypotheses * nr_samples_);
+  for (int h = 0; h < nr_hypotheses; ++h)
   {
     // Draw nr_samples_ random samples
     selectSamples (*input_, nr_samples_, min_sample_distance_, sample_indices);
 
-    // Find corresponding features in the target cloud
-    findSimilarFeatures (*input_features_, sample_indices, corresponding_indices);
+    for (int j = 0; j < nr_samples_; ++j)
+    {
+      hypotheses_samples[h * nr_samples_ + j] = sample_indices[j];
+      hypotheses_picks[h * nr_samples_ + j] = getRandomIndex (k_correspondences_);
+    }
+  }
 
-    // Estimate the transform from the samples to their corresponding points
-    transformation_estimation_->estimateRigidTransformation (*input_, sample_indices, *target_, corresponding_indices, transformation_);
+  // Look up the similar features of all drawn samples at once
+  cacheSimilarFeatures (*input_features_, hypotheses_samples);
 
-    // Tranform the data and compute the error
-    transformPointCloud (*input_, input_transformed, transformation_);
-    error = computeErrorMetric (input_transformed, (float) corr_dist_threshold_);
+#pragma omp parallel num_threads (threads_)
+  {
+    std::vector<int> samples (nr_samples_);
+    std::vector<int> corresponding_indices (nr_samples_);
+    Eigen::Matrix4f transformation;
+    float error, max_error;
 
-    // If the new error is lower, update the final transformation
-    if (i_iter == 0 || error < lowest_error)
+#pragma omp for schedule (dynamic)
+    for (int h = 0; h < nr_hypotheses; ++h)
     {
-      lowest_error = error;
-      final_transformation_ = transformation_;
+      // Find corresponding features in the target cloud
+      for (int j = 0; j < nr_samples_; ++j)
+      {
+        samples[j] = hypotheses_samples[h * nr_samples_ + j];
+        corresponding_indices[j] = similar_features_[samples[j]][hypotheses_picks[h * nr_samples_ + j]];
+      }
+
+      // Estimate the transform from the samples to their corresponding points
+      transformation_estimation_->estimateRigidTransformation (*input_, samples, *target_, corresponding_indices, transformation);
+
+#pragma omp critical (sample_consensus_initial_alignment_best)
+      max_error = lowest_error;
+
+      // Compute the error of the transformed data
+      error = computeErrorMetric (*input_, transformation, max_error);
+
+      // If the new error is lower, update the final transformation (ties go to the earliest hypothesis)
+#pragma omp critical (sample_consensus_initial_alignment_best)
+      {
+        if (error < lowest_error || (error == lowest_error && best_iter >= 0 && h < best_iter))
+        {
+          lowest_error = error;
+          best_iter = h;
+          final_transformation_ = transformation;
+        }
+      }
     }
   }
 
+  if (best_iter >= 0)
+    transformation_ = final_transformation_;
+
   // Apply the final transformation
   transformPointCloud (*input_, output, final_transformation_);
 }
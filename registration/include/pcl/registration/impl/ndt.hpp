@@ -37,6 +37,7 @@
 #ifndef PCL_NDT_IMPL_H_
 #define PCL_NDT_IMPL_H_
 #include <cmath>
+#include <iostream>
 
 #include <boost/noncopyable.hpp>
 #include <boost/make_shared.hpp>
@@ -198,6 +199,32 @@ namespace pcl
           return r;
         }
 
+        /** \brief Write the estimated distribution parameters in binary form.
+          * \param[out] os the output stream
+          */
+        void
+        write (std::ostream &os) const
+        {
+          uint64_t n = n_;
+          os.write (reinterpret_cast<const char*> (&n), sizeof (n));
+          os.write (reinterpret_cast<const char*> (mean_.data ()), sizeof (double) * 2);
+          os.write (reinterpret_cast<const char*> (covar_inv_.data ()), sizeof (double) * 4);
+        }
+
+        /** \brief Read distribution parameters previously stored with write (...).
+          * \param[in] is the input stream
+          */
+        void
+        read (std::istream &is)
+        {
+          uint64_t n = 0;
+          is.read (reinterpret_cast<char*> (&n), sizeof (n));
+          is.read (reinterpret_cast<char*> (mean_.data ()), sizeof (double) * 2);
+          is.read (reinterpret_cast<char*> (covar_inv_.data ()), sizeof (double) * 4);
+          n_ = static_cast<size_t> (n);
+          pt_indices_.clear ();
+        }
+
     protected:
         const size_t min_n_;
 
@@ -247,6 +274,42 @@ namespace pcl
               normal_distributions_.coeffRef (x,y).estimateParams (*cloud);
         }
         
+        /** \brief Read a grid previously stored with write (...).
+          * \param[in] is the input stream
+          */
+        explicit NDTSingleGrid (std::istream &is)
+            : min_ (), max_ (), step_ (), cells_ (0, 0), normal_distributions_ ()
+        {
+          is.read (reinterpret_cast<char*> (min_.data ()), sizeof (float) * 2);
+          is.read (reinterpret_cast<char*> (max_.data ()), sizeof (float) * 2);
+          is.read (reinterpret_cast<char*> (step_.data ()), sizeof (float) * 2);
+          is.read (reinterpret_cast<char*> (cells_.data ()), sizeof (int) * 2);
+          if (!is || cells_[0] < 0 || cells_[1] < 0)
+          {
+            cells_.setZero ();
+            return;
+          }
+          normal_distributions_.resize (cells_[0], cells_[1]);
+          for (int x = 0; x < cells_[0]; x++)
+            for (int y = 0; y < cells_[1]; y++)
+              normal_distributions_.coeffRef (x,y).read (is);
+        }
+
+        /** \brief Write the grid geometry and all its distributions in binary form.
+          * \param[out] os the output stream
+          */
+        void
+        write (std::ostream &os) const
+        {
+          os.write (reinterpret_cast<const char*> (min_.data ()), sizeof (float) * 2);
+          os.write (reinterpret_cast<const char*> (max_.data ()), sizeof (float) * 2);
+          os.write (reinterpret_cast<const char*> (step_.data ()), sizeof (float) * 2);
+          os.write (reinterpret_cast<const char*> (cells_.data ()), sizeof (int) * 2);
+          for (int x = 0; x < cells_[0]; x++)
+            for (int y = 0; y < cells_[1]; y++)
+              normal_distributions_.coeff (x,y).write (os);
+        }
+
         /** \brief Return the 'score' (denormalised likelihood) and derivatives of score of the point p given this distribution.
           * \param[in] transformed_pt   Location to evaluate at.
           * \param[in] cos_theta        sin(theta) of the current rotation angle of rigid transformation: to avoid repeated evaluation
@@ -339,6 +402,26 @@ namespace pcl
           return r;
         }
 
+        /** \brief Read a model previously stored with write (...).
+          * \param[in] is the input stream
+          */
+        explicit NDT (std::istream &is)
+        {
+          for (size_t i = 0; i < 4; i++)
+            single_grids_[i].reset (new SingleGrid (is));
+        }
+
+        /** \brief Write the four grids of the model in binary form, so that the model can be restored
+          * without the original point cloud.
+          * \param[out] os the output stream
+          */
+        void
+        write (std::ostream &os) const
+        {
+          for (size_t i = 0; i < 4; i++)
+            single_grids_[i]->write (os);
+        }
+
       protected:
         boost::shared_ptr<SingleGrid> single_grids_[4];
     };
@@ -380,8 +463,12 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeTransformati
     transformPointCloud (output, intm_cloud, transformation_);
   } 
 
-  // build Normal Distribution Transform of target cloud:
-  ndt::NDT<PointTarget> target_ndt (target_, grid_centre_, grid_extent_, grid_step_);
+  // build Normal Distribution Transform of target cloud, unless a prepared target already holds it:
+  boost::shared_ptr<const ndt::NDT<PointTarget> > target_ndt;
+  if (prepared_target_ && prepared_target_->hasNDTGrid (grid_centre_, grid_extent_, grid_step_))
+    target_ndt = prepared_target_->getNDTGrid ();
+  else
+    target_ndt.reset (new ndt::NDT<PointTarget> (target_, grid_centre_, grid_extent_, grid_step_));
   
   // can't seem to use .block<> () member function on transformation_
   // directly... gcc bug? 
@@ -408,7 +495,7 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeTransformati
 
     ndt::ValueAndDerivatives<3, double> score = ndt::ValueAndDerivatives<3, double>::Zero ();
     for (size_t i = 0; i < intm_cloud.size (); i++)
-      score += target_ndt.test (intm_cloud[i], cos_theta, sin_theta);
+      score += target_ndt->test (intm_cloud[i], cos_theta, sin_theta);
     
     PCL_DEBUG ("NDT score %f (x=%f,y=%f,r=%f)\n",
       float (score.value), xytheta_transformation[0], xytheta_transformation[1], xytheta_transformation[2]
@@ -0,0 +1,400 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ */
+#ifndef PCL_REGISTRATION_IMPL_PREPARED_TARGET_HPP_
+#define PCL_REGISTRATION_IMPL_PREPARED_TARGET_HPP_
+
+#include <fstream>
+#include <cstring>
+#include <pcl/common/io.h>
+#include <pcl/features/normal_3d.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::registration::PreparedTarget<PointT>::setInputCloud (const PointCloudConstPtr &cloud)
+{
+  if (!cloud || cloud->points.empty ())
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::setInputCloud] Invalid or empty point cloud dataset given!\n");
+    return (false);
+  }
+
+  // Set all the point.data[3] values to 1 to aid the rigid transformation, like Registration::setInputTarget
+  PointCloudPtr target (new PointCloud (*cloud));
+  for (size_t i = 0; i < target->points.size (); ++i)
+    target->points[i].data[3] = 1.0;
+
+  target_ = target;
+  tree_.reset (new pcl::KdTreeFLANN<PointT>);
+  tree_->setInputCloud (target_);
+
+  covariances_.clear ();
+  normals_.reset ();
+  k_correspondences_ = 0;
+  gicp_epsilon_ = 0;
+  ndt_grid_.reset ();
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::registration::PreparedTarget<PointT>::computeCovariances (int k_correspondences, double gicp_epsilon)
+{
+  if (!target_)
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::computeCovariances] No target point cloud given!\n");
+    return (false);
+  }
+  if (k_correspondences <= 0 || (size_t)k_correspondences > target_->size ())
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::computeCovariances] Number or points in cloud (%lu) is less than k_correspondences (%d)!\n", (unsigned long)target_->size (), k_correspondences);
+    return (false);
+  }
+
+  const PointCloud &cloud = *target_;
+  const int nr_points = static_cast<int> (cloud.size ());
+  const Eigen::Vector4f &viewpoint = cloud.sensor_origin_;
+
+  std::vector<Eigen::Matrix3d> covariances (nr_points);
+  NormalsPtr normals (new Normals);
+  normals->points.resize (nr_points);
+  normals->width = cloud.width;
+  normals->height = cloud.height;
+  normals->is_dense = cloud.is_dense;
+  normals->header = cloud.header;
+
+  // Same estimation as GeneralizedIterativeClosestPoint::computeCovariances, so that a prepared target gives
+  // the same registration results as an unprepared one
+#pragma omp parallel num_threads (threads_)
+  {
+    std::vector<int> nn_indices (k_correspondences);
+    std::vector<float> nn_dists (k_correspondences);
+
+#pragma omp for schedule (dynamic, 256)
+    for (int i = 0; i < nr_points; ++i)
+    {
+      Eigen::Matrix3d &cov = covariances[i];
+      cov.setZero ();
+      Eigen::Vector3d mean = Eigen::Vector3d::Zero ();
+
+      tree_->nearestKSearch (cloud.points[i], k_correspondences, nn_indices, nn_dists);
+
+      for (int j = 0; j < k_correspondences; j++)
+      {
+        const PointT &pt = cloud.points[nn_indices[j]];
+
+        mean[0] += pt.x;
+        mean[1] += pt.y;
+        mean[2] += pt.z;
+
+        cov (0,0) += pt.x*pt.x;
+
+        cov (1,0) += pt.y*pt.x;
+        cov (1,1) += pt.y*pt.y;
+
+        cov (2,0) += pt.z*pt.x;
+        cov (2,1) += pt.z*pt.y;
+        cov (2,2) += pt.z*pt.z;
+      }
+
+      mean /= (double)k_correspondences;
+      for (int k = 0; k < 3; k++)
+        for (int l = 0; l <= k; l++)
+        {
+          cov (k,l) /= (double)k_correspondences;
+          cov (k,l) -= mean[k]*mean[l];
+          cov (l,k) = cov (k,l);
+        }
+
+      Eigen::JacobiSVD<Eigen::Matrix3d> svd (cov, Eigen::ComputeFullU);
+      const Eigen::Matrix3d U = svd.matrixU ();
+      const Eigen::Vector3d &sv = svd.singularValues ();
+
+      // The eigenvector of the smallest eigenvalue is the surface normal
+      pcl::Normal &normal = normals->points[i];
+      normal.normal_x = static_cast<float> (U (0, 2));
+      normal.normal_y = static_cast<float> (U (1, 2));
+      normal.normal_z = static_cast<float> (U (2, 2));
+      const double sum = sv.sum ();
+      normal.curvature = sum != 0 ? static_cast<float> (sv[2] / sum) : 0;
+      pcl::flipNormalTowardsViewpoint (cloud.points[i], viewpoint[0], viewpoint[1], viewpoint[2],
+                                       normal.normal_x, normal.normal_y, normal.normal_z);
+
+      // Reconstitute the covariance matrix with the two largest singular values replaced by 1 and the
+      // smallest one by gicp_epsilon
+      cov.setZero ();
+      for (int k = 0; k < 3; k++)
+      {
+        Eigen::Vector3d col = U.col (k);
+        double v = 1.;
+        if (k == 2)
+          v = gicp_epsilon;
+        cov += v * col * col.transpose ();
+      }
+    }
+  }
+
+  covariances_.swap (covariances);
+  normals_ = normals;
+  k_correspondences_ = k_correspondences;
+  gicp_epsilon_ = gicp_epsilon;
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::registration::PreparedTarget<PointT>::computeNDTGrid (
+    const Eigen::Vector2f &centre, const Eigen::Vector2f &extent, const Eigen::Vector2f &step)
+{
+  if (!target_)
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::computeNDTGrid] No target point cloud given!\n");
+    return (false);
+  }
+  ndt_grid_.reset (new NDTGrid (target_, centre, extent, step));
+  grid_centre_ = centre;
+  grid_extent_ = extent;
+  grid_step_ = step;
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+namespace pcl
+{
+  namespace registration
+  {
+    /** \brief Magic number and version of the binary files written by PreparedTarget::save. */
+    static const char prepared_target_magic[8] = { 'P', 'C', 'L', 'P', 'T', 'G', 'T', '\0' };
+    static const uint32_t prepared_target_version = 1;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::registration::PreparedTarget<PointT>::save (const std::string &file_name) const
+{
+  if (!target_)
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::save] No target point cloud given!\n");
+    return (false);
+  }
+
+  std::ofstream fs (file_name.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::save] Could not open %s for writing!\n", file_name.c_str ());
+    return (false);
+  }
+
+  // Header: enough to refuse files written for another point type
+  const std::string fields = pcl::getFieldsList (*target_);
+  const uint32_t point_size = sizeof (PointT);
+  const uint32_t fields_size = static_cast<uint32_t> (fields.size ());
+  fs.write (prepared_target_magic, sizeof (prepared_target_magic));
+  fs.write (reinterpret_cast<const char*> (&prepared_target_version), sizeof (uint32_t));
+  fs.write (reinterpret_cast<const char*> (&point_size), sizeof (uint32_t));
+  fs.write (reinterpret_cast<const char*> (&fields_size), sizeof (uint32_t));
+  fs.write (fields.c_str (), fields_size);
+
+  // Target cloud
+  const uint32_t width = target_->width, height = target_->height;
+  const uint8_t is_dense = target_->is_dense;
+  const uint64_t nr_points = target_->points.size ();
+  fs.write (reinterpret_cast<const char*> (&width), sizeof (uint32_t));
+  fs.write (reinterpret_cast<const char*> (&height), sizeof (uint32_t));
+  fs.write (reinterpret_cast<const char*> (&is_dense), sizeof (uint8_t));
+  fs.write (reinterpret_cast<const char*> (target_->sensor_origin_.data ()), sizeof (float) * 4);
+  fs.write (reinterpret_cast<const char*> (target_->sensor_orientation_.coeffs ().data ()), sizeof (float) * 4);
+  fs.write (reinterpret_cast<const char*> (&nr_points), sizeof (uint64_t));
+  fs.write (reinterpret_cast<const char*> (&target_->points[0]), nr_points * sizeof (PointT));
+
+  // Covariances and normals
+  const uint8_t has_covariances = !covariances_.empty ();
+  fs.write (reinterpret_cast<const char*> (&has_covariances), sizeof (uint8_t));
+  if (has_covariances)
+  {
+    const int32_t k = k_correspondences_;
+    fs.write (reinterpret_cast<const char*> (&k), sizeof (int32_t));
+    fs.write (reinterpret_cast<const char*> (&gicp_epsilon_), sizeof (double));
+    for (size_t i = 0; i < covariances_.size (); ++i)
+      fs.write (reinterpret_cast<const char*> (covariances_[i].data ()), sizeof (double) * 9);
+    for (size_t i = 0; i < normals_->points.size (); ++i)
+    {
+      const pcl::Normal &n = normals_->points[i];
+      const float data[4] = { n.normal_x, n.normal_y, n.normal_z, n.curvature };
+      fs.write (reinterpret_cast<const char*> (data), sizeof (data));
+    }
+  }
+
+  // NDT model
+  const uint8_t has_ndt_grid = ndt_grid_ ? 1 : 0;
+  fs.write (reinterpret_cast<const char*> (&has_ndt_grid), sizeof (uint8_t));
+  if (has_ndt_grid)
+  {
+    fs.write (reinterpret_cast<const char*> (grid_centre_.data ()), sizeof (float) * 2);
+    fs.write (reinterpret_cast<const char*> (grid_extent_.data ()), sizeof (float) * 2);
+    fs.write (reinterpret_cast<const char*> (grid_step_.data ()), sizeof (float) * 2);
+    ndt_grid_->write (fs);
+  }
+
+  if (!fs)
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::save] Error writing to %s!\n", file_name.c_str ());
+    return (false);
+  }
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::registration::PreparedTarget<PointT>::load (const std::string &file_name)
+{
+  std::ifstream fs (file_name.c_str (), std::ios::in | std::ios::binary);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::load] Could not open %s for reading!\n", file_name.c_str ());
+    return (false);
+  }
+
+  char magic[sizeof (prepared_target_magic)];
+  uint32_t version = 0, point_size = 0, fields_size = 0;
+  fs.read (magic, sizeof (magic));
+  fs.read (reinterpret_cast<char*> (&version), sizeof (uint32_t));
+  fs.read (reinterpret_cast<char*> (&point_size), sizeof (uint32_t));
+  fs.read (reinterpret_cast<char*> (&fields_size), sizeof (uint32_t));
+  if (!fs || memcmp (magic, prepared_target_magic, sizeof (magic)) != 0 || version != prepared_target_version)
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::load] %s is not a prepared target file (or has an unsupported version)!\n", file_name.c_str ());
+    return (false);
+  }
+
+  PointCloudPtr target (new PointCloud);
+  std::string fields (fields_size, ' ');
+  if (fields_size > 0)
+    fs.read (&fields[0], fields_size);
+  if (!fs || point_size != sizeof (PointT) || fields != pcl::getFieldsList (*target))
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::load] %s was written for a different point type (%s)!\n", file_name.c_str (), fields.c_str ());
+    return (false);
+  }
+
+  // Target cloud
+  uint32_t width = 0, height = 0;
+  uint8_t is_dense = 0;
+  uint64_t nr_points = 0;
+  fs.read (reinterpret_cast<char*> (&width), sizeof (uint32_t));
+  fs.read (reinterpret_cast<char*> (&height), sizeof (uint32_t));
+  fs.read (reinterpret_cast<char*> (&is_dense), sizeof (uint8_t));
+  fs.read (reinterpret_cast<char*> (target->sensor_origin_.data ()), sizeof (float) * 4);
+  fs.read (reinterpret_cast<char*> (target->sensor_orientation_.coeffs ().data ()), sizeof (float) * 4);
+  fs.read (reinterpret_cast<char*> (&nr_points), sizeof (uint64_t));
+  if (!fs || nr_points == 0 || (uint64_t)width * height != nr_points)
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::load] Invalid point cloud header in %s!\n", file_name.c_str ());
+    return (false);
+  }
+  target->width = width;
+  target->height = height;
+  target->is_dense = is_dense != 0;
+  target->points.resize (nr_points);
+  fs.read (reinterpret_cast<char*> (&target->points[0]), nr_points * sizeof (PointT));
+
+  // Covariances and normals
+  std::vector<Eigen::Matrix3d> covariances;
+  NormalsPtr normals;
+  int32_t k = 0;
+  double gicp_epsilon = 0;
+  uint8_t has_covariances = 0;
+  fs.read (reinterpret_cast<char*> (&has_covariances), sizeof (uint8_t));
+  if (fs && has_covariances)
+  {
+    fs.read (reinterpret_cast<char*> (&k), sizeof (int32_t));
+    fs.read (reinterpret_cast<char*> (&gicp_epsilon), sizeof (double));
+    covariances.resize (nr_points);
+    for (size_t i = 0; i < covariances.size () && fs; ++i)
+      fs.read (reinterpret_cast<char*> (covariances[i].data ()), sizeof (double) * 9);
+    normals.reset (new Normals);
+    normals->points.resize (nr_points);
+    normals->width = width;
+    normals->height = height;
+    normals->is_dense = target->is_dense;
+    for (size_t i = 0; i < normals->points.size () && fs; ++i)
+    {
+      float data[4];
+      fs.read (reinterpret_cast<char*> (data), sizeof (data));
+      normals->points[i].normal_x = data[0];
+      normals->points[i].normal_y = data[1];
+      normals->points[i].normal_z = data[2];
+      normals->points[i].curvature = data[3];
+    }
+  }
+
+  // NDT model
+  NDTGridPtr ndt_grid;
+  Eigen::Vector2f centre (0, 0), extent (0, 0), step (0, 0);
+  uint8_t has_ndt_grid = 0;
+  fs.read (reinterpret_cast<char*> (&has_ndt_grid), sizeof (uint8_t));
+  if (fs && has_ndt_grid)
+  {
+    fs.read (reinterpret_cast<char*> (centre.data ()), sizeof (float) * 2);
+    fs.read (reinterpret_cast<char*> (extent.data ()), sizeof (float) * 2);
+    fs.read (reinterpret_cast<char*> (step.data ()), sizeof (float) * 2);
+    ndt_grid.reset (new NDTGrid (fs));
+  }
+
+  if (!fs)
+  {
+    PCL_ERROR ("[pcl::registration::PreparedTarget::load] Unexpected end of file in %s!\n", file_name.c_str ());
+    return (false);
+  }
+
+  // Only the search tree has to be recomputed
+  target_ = target;
+  tree_.reset (new pcl::KdTreeFLANN<PointT>);
+  tree_->setInputCloud (target_);
+  covariances_.swap (covariances);
+  normals_ = normals;
+  k_correspondences_ = k;
+  gicp_epsilon_ = gicp_epsilon;
+  ndt_grid_ = ndt_grid;
+  grid_centre_ = centre;
+  grid_extent_ = extent;
+  grid_step_ = step;
+  return (true);
+}
+
+#endif  // PCL_REGISTRATION_IMPL_PREPARED_TARGET_HPP_
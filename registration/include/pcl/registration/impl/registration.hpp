@@ -51,11 +51,32 @@ pcl::Registration<PointSource, PointTarget>::setInputTarget (const PointCloudTar
   for (size_t i = 0; i < target.points.size (); ++i)
     target.points[i].data[3] = 1.0;
 
+  // Never rebuild a search tree that is shared through a prepared target
+  if (prepared_target_)
+  {
+    prepared_target_.reset ();
+    tree_.reset (new pcl::KdTreeFLANN<PointTarget>);
+  }
+
   //target_ = cloud;
   target_ = target.makeShared ();
   tree_->setInputCloud (target_);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> inline void
+pcl::Registration<PointSource, PointTarget>::setPreparedTarget (const PreparedTargetConstPtr &target)
+{
+  if (!target || !target->getInputCloud () || !target->getSearchMethod ())
+  {
+    PCL_ERROR ("[pcl::%s::setPreparedTarget] Invalid prepared target given!\n", getClassName ().c_str ());
+    return;
+  }
+  prepared_target_ = target;
+  target_ = target->getInputCloud ();
+  tree_ = target->getSearchMethod ();
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget> inline double
 pcl::Registration<PointSource, PointTarget>::getFitnessScore (const std::vector<float> &distances_a, 
@@ -149,8 +170,8 @@ pcl::Registration<PointSource, PointTarget>::align (PointCloudSource &output, co
   for (size_t i = 0; i < indices_->size (); ++i)
     output.points[i] = input_->points[(*indices_)[i]];
 
-  // Set the internal point representation of choice
-  if (point_representation_)
+  // Set the internal point representation of choice (a shared search tree is left untouched)
+  if (point_representation_ && !prepared_target_)
     tree_->setPointRepresentation (point_representation_);
 
   // Perform the actual transformation computation
@@ -52,35 +52,8 @@ estimateRigidTransformation (const pcl::PointCloud<PointSource> &cloud_src,
     return;
   }
 
-  // Approximate as a linear least squares problem
-  Eigen::MatrixXf A (nr_points, 6);
-  Eigen::MatrixXf b (nr_points, 1);
-  for (size_t i = 0; i < nr_points; ++i)
-  {
-    const float & sx = cloud_src.points[i].x;
-    const float & sy = cloud_src.points[i].y;
-    const float & sz = cloud_src.points[i].z;
-    const float & dx = cloud_tgt.points[i].x;
-    const float & dy = cloud_tgt.points[i].y;
-    const float & dz = cloud_tgt.points[i].z;
-    const float & nx = cloud_tgt.points[i].normal[0];
-    const float & ny = cloud_tgt.points[i].normal[1];
-    const float & nz = cloud_tgt.points[i].normal[2];
-    A (i, 0) = nz*sy - ny*sz;
-    A (i, 1) = nx*sz - nz*sx; 
-    A (i, 2) = ny*sx - nx*sy;
-    A (i, 3) = nx;
-    A (i, 4) = ny;
-    A (i, 5) = nz;
-    b (i, 0) = nx*dx + ny*dy + nz*dz - nx*sx - ny*sy - nz*sz;
-  }
-
-  // Solve A*x = b
-  Eigen::VectorXf x = A.colPivHouseholderQr ().solve (b);
-  
-  // Construct the transformation matrix from x
-  constructTransformationMatrix (x (0), x (1), x (2), x (3), x (4), x (5), transformation_matrix);
- 
+  estimateRigidTransformationStreaming (cloud_src, IdentityIndices (), cloud_tgt, IdentityIndices (),
+                                        nr_points, transformation_matrix);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -98,34 +71,8 @@ estimateRigidTransformation (const pcl::PointCloud<PointSource> &cloud_src,
     return;
   }
 
-  // Approximate as a linear least squares problem
-  Eigen::MatrixXf A (nr_points, 6);
-  Eigen::MatrixXf b (nr_points, 1);
-  for (size_t i = 0; i < nr_points; ++i)
-  {
-    const float & sx = cloud_src.points[indices_src[i]].x;
-    const float & sy = cloud_src.points[indices_src[i]].y;
-    const float & sz = cloud_src.points[indices_src[i]].z;
-    const float & dx = cloud_tgt.points[i].x;
-    const float & dy = cloud_tgt.points[i].y;
-    const float & dz = cloud_tgt.points[i].z;
-    const float & nx = cloud_tgt.points[i].normal[0];
-    const float & ny = cloud_tgt.points[i].normal[1];
-    const float & nz = cloud_tgt.points[i].normal[2];
-    A (i, 0) = nz*sy - ny*sz;
-    A (i, 1) = nx*sz - nz*sx; 
-    A (i, 2) = ny*sx - nx*sy;
-    A (i, 3) = nx;
-    A (i, 4) = ny;
-    A (i, 5) = nz;
-    b (i, 0) = nx*dx + ny*dy + nz*dz - nx*sx - ny*sy - nz*sz;
-  }
-
-  // Solve A*x = b
-  Eigen::VectorXf x = A.colPivHouseholderQr ().solve (b);
-  
-  // Construct the transformation matrix from x
-  constructTransformationMatrix (x (0), x (1), x (2), x (3), x (4), x (5), transformation_matrix);
+  estimateRigidTransformationStreaming (cloud_src, indices_src, cloud_tgt, IdentityIndices (),
+                                        nr_points, transformation_matrix);
 }
 
 
@@ -145,34 +92,8 @@ estimateRigidTransformation (const pcl::PointCloud<PointSource> &cloud_src,
     return;
   }
 
-  // Approximate as a linear least squares problem
-  Eigen::MatrixXf A (nr_points, 6);
-  Eigen::MatrixXf b (nr_points, 1);
-  for (size_t i = 0; i < nr_points; ++i)
-  {
-    const float & sx = cloud_src.points[indices_src[i]].x;
-    const float & sy = cloud_src.points[indices_src[i]].y;
-    const float & sz = cloud_src.points[indices_src[i]].z;
-    const float & dx = cloud_tgt.points[indices_tgt[i]].x;
-    const float & dy = cloud_tgt.points[indices_tgt[i]].y;
-    const float & dz = cloud_tgt.points[indices_tgt[i]].z;
-    const float & nx = cloud_tgt.points[indices_tgt[i]].normal[0];
-    const float & ny = cloud_tgt.points[indices_tgt[i]].normal[1];
-    const float & nz = cloud_tgt.points[indices_tgt[i]].normal[2];
-    A (i, 0) = nz*sy - ny*sz;
-    A (i, 1) = nx*sz - nz*sx; 
-    A (i, 2) = ny*sx - nx*sy;
-    A (i, 3) = nx;
-    A (i, 4) = ny;
-    A (i, 5) = nz;
-    b (i, 0) = nx*dx + ny*dy + nz*dz - nx*sx - ny*sy - nz*sz;
-  }
-
-  // Solve A*x = b
-  Eigen::VectorXf x = A.colPivHouseholderQr ().solve (b);
-  
-  // Construct the transformation matrix from x
-  constructTransformationMatrix (x (0), x (1), x (2), x (3), x (4), x (5), transformation_matrix);
+  estimateRigidTransformationStreaming (cloud_src, indices_src, cloud_tgt, indices_tgt,
+                                        nr_points, transformation_matrix);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -183,38 +104,83 @@ estimateRigidTransformation (const pcl::PointCloud<PointSource> &cloud_src,
                              const pcl::Correspondences &correspondences,
                              Eigen::Matrix4f &transformation_matrix)
 {
-  size_t nr_points = correspondences.size ();
+  estimateRigidTransformationStreaming (cloud_src, CorrespondenceQueryIndices (correspondences),
+                                        cloud_tgt, CorrespondenceMatchIndices (correspondences),
+                                        correspondences.size (), transformation_matrix);
+}
 
-  // Approximate as a linear least squares problem
-  Eigen::MatrixXf A (nr_points, 6);
-  Eigen::MatrixXf b (nr_points, 1);
-  for (size_t i = 0; i < nr_points; ++i)
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> template <typename IndicesSrc, typename IndicesTgt> void
+pcl::registration::TransformationEstimationPointToPlaneLLS<PointSource, PointTarget>::
+estimateRigidTransformationStreaming (const pcl::PointCloud<PointSource> &cloud_src,
+                                      const IndicesSrc &indices_src,
+                                      const pcl::PointCloud<PointTarget> &cloud_tgt,
+                                      const IndicesTgt &indices_tgt,
+                                      size_t nr_points,
+                                      Eigen::Matrix4f &transformation_matrix)
+{
+  typedef Eigen::Matrix<double, 6, 1> Vector6d;
+  typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+
+  // Approximate as a linear least squares problem A x = b and accumulate the normal equations A'A x = A'b
+  Matrix6d ATA = Matrix6d::Zero ();
+  Vector6d ATb = Vector6d::Zero ();
+
+#pragma omp parallel num_threads (threads_) if (threads_ > 1)
   {
-    const int & src_idx = correspondences[i].index_query;
-    const int & tgt_idx = correspondences[i].index_match;
-    const float & sx = cloud_src.points[src_idx].x;
-    const float & sy = cloud_src.points[src_idx].y;
-    const float & sz = cloud_src.points[src_idx].z;
-    const float & dx = cloud_tgt.points[tgt_idx].x;
-    const float & dy = cloud_tgt.points[tgt_idx].y;
-    const float & dz = cloud_tgt.points[tgt_idx].z;
-    const float & nx = cloud_tgt.points[tgt_idx].normal[0];
-    const float & ny = cloud_tgt.points[tgt_idx].normal[1];
-    const float & nz = cloud_tgt.points[tgt_idx].normal[2];
-    A (i, 0) = nz*sy - ny*sz;
-    A (i, 1) = nx*sz - nz*sx; 
-    A (i, 2) = ny*sx - nx*sy;
-    A (i, 3) = nx;
-    A (i, 4) = ny;
-    A (i, 5) = nz;
-    b (i, 0) = nx*dx + ny*dy + nz*dz - nx*sx - ny*sy - nz*sz;
+    Matrix6d local_ATA = Matrix6d::Zero ();
+    Vector6d local_ATb = Vector6d::Zero ();
+    Vector6d a;
+
+#pragma omp for nowait
+    for (int i = 0; i < (int)nr_points; ++i)
+    {
+      const PointSource &src = cloud_src.points[indices_src[i]];
+      const PointTarget &tgt = cloud_tgt.points[indices_tgt[i]];
+      const double sx = src.x, sy = src.y, sz = src.z;
+      const double dx = tgt.x, dy = tgt.y, dz = tgt.z;
+      const double nx = tgt.normal[0], ny = tgt.normal[1], nz = tgt.normal[2];
+
+      a << nz*sy - ny*sz,
+           nx*sz - nz*sx,
+           ny*sx - nx*sy,
+           nx,
+           ny,
+           nz;
+      const double b = nx*dx + ny*dy + nz*dz - nx*sx - ny*sy - nz*sz;
+
+      local_ATA.noalias () += a * a.transpose ();
+      local_ATb.noalias () += a * b;
+    }
+
+#pragma omp critical
+    {
+      ATA += local_ATA;
+      ATb += local_ATb;
+    }
   }
 
-  // Solve A*x = b
-  Eigen::VectorXf x = A.colPivHouseholderQr ().solve (b);
-  
+  // Far from the origin the rotation columns of A dwarf the translation columns. Scaling all columns to unit
+  // length keeps the normal equations well conditioned and doesn't change their solution.
+  Vector6d scale;
+  for (int i = 0; i < 6; ++i)
+    scale (i) = ATA (i, i) > 0 ? 1.0 / sqrt (ATA (i, i)) : 1.0;
+  ATA = scale.asDiagonal () * ATA * scale.asDiagonal ();
+  ATb = scale.asDiagonal () * ATb;
+
+  // Solve A'A x = A'b with LDLT, fall back to an SVD if the system is (close to) singular, e.g. if all
+  // correspondences lie on a single plane
+  Vector6d x;
+  Eigen::LDLT<Matrix6d> ldlt (ATA);
+  const Vector6d d = ldlt.vectorD ().cwiseAbs ();
+  if (ldlt.info () == Eigen::Success && ldlt.isPositive () && d.minCoeff () > 1e-10 * d.maxCoeff ())
+    x = ldlt.solve (ATb);
+  else
+    x = ATA.jacobiSvd (Eigen::ComputeFullU | Eigen::ComputeFullV).solve (ATb);
+  x = scale.asDiagonal () * x;
+
   // Construct the transformation matrix from x
-  constructTransformationMatrix (x (0), x (1), x (2), x (3), x (4), x (5), transformation_matrix);
+  constructTransformationMatrix ((float)x (0), (float)x (1), (float)x (2), (float)x (3), (float)x (4), (float)x (5), transformation_matrix);
 }
 
 template <typename PointSource, typename PointTarget> inline void
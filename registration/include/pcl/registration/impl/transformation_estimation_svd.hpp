@@ -45,22 +45,14 @@ pcl::registration::TransformationEstimationSVD<PointSource, PointTarget>::estima
     const pcl::PointCloud<PointTarget> &cloud_tgt,
     Eigen::Matrix4f &transformation_matrix)
 {
-  // <cloud_src,cloud_src> is the source dataset
-  transformation_matrix.setIdentity ();
-
-  Eigen::Vector4f centroid_src, centroid_tgt;
-  // Estimate the centroids of source, target
-  compute3DCentroid (cloud_src, centroid_src);
-  compute3DCentroid (cloud_tgt, centroid_tgt);
-
-  // Subtract the centroids from source, target
-  Eigen::MatrixXf cloud_src_demean;
-  demeanPointCloud (cloud_src, centroid_src, cloud_src_demean);
-
-  Eigen::MatrixXf cloud_tgt_demean;
-  demeanPointCloud (cloud_tgt, centroid_tgt, cloud_tgt_demean);
+  if (cloud_src.points.size () != cloud_tgt.points.size ())
+  {
+    PCL_ERROR ("[pcl::TransformationEstimationSVD::estimateRigidTransformation] Number or points in source (%lu) differs than target (%lu)!\n", (unsigned long)cloud_src.points.size (), (unsigned long)cloud_tgt.points.size ());
+    return;
+  }
 
-  getTransformationFromCorrelation (cloud_src_demean, centroid_src, cloud_tgt_demean, centroid_tgt, transformation_matrix);
+  estimateRigidTransformationStreaming (cloud_src, IdentityIndices (), cloud_tgt, IdentityIndices (),
+                                        cloud_src.points.size (), transformation_matrix);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -77,22 +69,8 @@ pcl::registration::TransformationEstimationSVD<PointSource, PointTarget>::estima
     return;
   }
 
-  // <cloud_src,cloud_src> is the source dataset
-  transformation_matrix.setIdentity ();
-
-  Eigen::Vector4f centroid_src, centroid_tgt;
-  // Estimate the centroids of source, target
-  compute3DCentroid (cloud_src, indices_src, centroid_src);
-  compute3DCentroid (cloud_tgt, centroid_tgt);
-
-  // Subtract the centroids from source, target
-  Eigen::MatrixXf cloud_src_demean;
-  demeanPointCloud (cloud_src, indices_src, centroid_src, cloud_src_demean);
-
-  Eigen::MatrixXf cloud_tgt_demean;
-  demeanPointCloud (cloud_tgt, centroid_tgt, cloud_tgt_demean);
-
-  getTransformationFromCorrelation (cloud_src_demean, centroid_src, cloud_tgt_demean, centroid_tgt, transformation_matrix);
+  estimateRigidTransformationStreaming (cloud_src, indices_src, cloud_tgt, IdentityIndices (),
+                                        indices_src.size (), transformation_matrix);
 }
 
 
@@ -111,22 +89,8 @@ pcl::registration::TransformationEstimationSVD<PointSource, PointTarget>::estima
     return;
   }
 
-  // <cloud_src,cloud_src> is the source dataset
-  transformation_matrix.setIdentity ();
-
-  Eigen::Vector4f centroid_src, centroid_tgt;
-  // Estimate the centroids of source, target
-  compute3DCentroid (cloud_src, indices_src, centroid_src);
-  compute3DCentroid (cloud_tgt, indices_tgt, centroid_tgt);
-
-  // Subtract the centroids from source, target
-  Eigen::MatrixXf cloud_src_demean;
-  demeanPointCloud (cloud_src, indices_src, centroid_src, cloud_src_demean);
-
-  Eigen::MatrixXf cloud_tgt_demean;
-  demeanPointCloud (cloud_tgt, indices_tgt, centroid_tgt, cloud_tgt_demean);
-
-  getTransformationFromCorrelation (cloud_src_demean, centroid_src, cloud_tgt_demean, centroid_tgt, transformation_matrix);
+  estimateRigidTransformationStreaming (cloud_src, indices_src, cloud_tgt, indices_tgt,
+                                        indices_src.size (), transformation_matrix);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -137,24 +101,66 @@ pcl::registration::TransformationEstimationSVD<PointSource, PointTarget>::estima
     const pcl::Correspondences &correspondences,
     Eigen::Matrix4f &transformation_matrix)
 {
-  std::vector<int> indices_src, indices_tgt;
-  pcl::registration::getQueryIndices (correspondences, indices_src);
-  pcl::registration::getMatchIndices (correspondences, indices_tgt);
+  estimateRigidTransformationStreaming (cloud_src, CorrespondenceQueryIndices (correspondences),
+                                        cloud_tgt, CorrespondenceMatchIndices (correspondences),
+                                        correspondences.size (), transformation_matrix);
+}
 
-  // <cloud_src,cloud_src> is the source dataset
-  Eigen::Vector4f centroid_src, centroid_tgt;
-  // Estimate the centroids of source, target
-  compute3DCentroid (cloud_src, indices_src, centroid_src);
-  compute3DCentroid (cloud_tgt, indices_tgt, centroid_tgt);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> template <typename IndicesSrc, typename IndicesTgt> void
+pcl::registration::TransformationEstimationSVD<PointSource, PointTarget>::estimateRigidTransformationStreaming (
+    const pcl::PointCloud<PointSource> &cloud_src,
+    const IndicesSrc &indices_src,
+    const pcl::PointCloud<PointTarget> &cloud_tgt,
+    const IndicesTgt &indices_tgt,
+    size_t nr_points,
+    Eigen::Matrix4f &transformation_matrix)
+{
+  transformation_matrix.setIdentity ();
+  if (nr_points == 0)
+    return;
+
+  // Accumulate relative to the first pair, which keeps the single pass sums well conditioned
+  // for clouds that are far away from the origin
+  const Eigen::Vector3d ref_src = cloud_src.points[indices_src[0]].getVector3fMap ().template cast<double> ();
+  const Eigen::Vector3d ref_tgt = cloud_tgt.points[indices_tgt[0]].getVector3fMap ().template cast<double> ();
 
-  // Subtract the centroids from source, target
-  Eigen::MatrixXf cloud_src_demean;
-  demeanPointCloud (cloud_src, indices_src, centroid_src, cloud_src_demean);
+  Eigen::Vector3d sum_src = Eigen::Vector3d::Zero (), sum_tgt = Eigen::Vector3d::Zero ();
+  Eigen::Matrix3d sum_src_tgt = Eigen::Matrix3d::Zero ();
 
-  Eigen::MatrixXf cloud_tgt_demean;
-  demeanPointCloud (cloud_tgt, indices_tgt, centroid_tgt, cloud_tgt_demean);
+#pragma omp parallel num_threads (threads_) if (threads_ > 1)
+  {
+    Eigen::Vector3d local_sum_src = Eigen::Vector3d::Zero (), local_sum_tgt = Eigen::Vector3d::Zero ();
+    Eigen::Matrix3d local_sum_src_tgt = Eigen::Matrix3d::Zero ();
+
+#pragma omp for nowait
+    for (int i = 0; i < (int)nr_points; ++i)
+    {
+      const Eigen::Vector3d s = cloud_src.points[indices_src[i]].getVector3fMap ().template cast<double> () - ref_src;
+      const Eigen::Vector3d t = cloud_tgt.points[indices_tgt[i]].getVector3fMap ().template cast<double> () - ref_tgt;
+      local_sum_src += s;
+      local_sum_tgt += t;
+      local_sum_src_tgt.noalias () += s * t.transpose ();
+    }
+
+#pragma omp critical
+    {
+      sum_src += local_sum_src;
+      sum_tgt += local_sum_tgt;
+      sum_src_tgt += local_sum_src_tgt;
+    }
+  }
+
+  // H = sum (s - c_s) (t - c_t)' = sum (s t') - N c_s c_t'
+  const double inv_n = 1.0 / (double)nr_points;
+  Eigen::Matrix3d H = sum_src_tgt - sum_src * sum_tgt.transpose () * inv_n;
 
-  getTransformationFromCorrelation (cloud_src_demean, centroid_src, cloud_tgt_demean, centroid_tgt, transformation_matrix);
+  Eigen::Vector4f centroid_src, centroid_tgt;
+  centroid_src.head<3> () = (ref_src + sum_src * inv_n).cast<float> ();
+  centroid_tgt.head<3> () = (ref_tgt + sum_tgt * inv_n).cast<float> ();
+  centroid_src[3] = centroid_tgt[3] = 0;
+
+  getTransformationFromCorrelation (H.cast<float> (), centroid_src, centroid_tgt, transformation_matrix);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -166,11 +172,22 @@ pcl::registration::TransformationEstimationSVD<PointSource, PointTarget>::getTra
     const Eigen::Vector4f &centroid_tgt,
     Eigen::Matrix4f &transformation_matrix)
 {
-  transformation_matrix.setIdentity ();
-
   // Assemble the correlation matrix H = source * target'
   Eigen::Matrix3f H = (cloud_src_demean * cloud_tgt_demean.transpose ()).topLeftCorner<3, 3>();
 
+  getTransformationFromCorrelation (H, centroid_src, centroid_tgt, transformation_matrix);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> void
+pcl::registration::TransformationEstimationSVD<PointSource, PointTarget>::getTransformationFromCorrelation (
+    const Eigen::Matrix3f &H,
+    const Eigen::Vector4f &centroid_src,
+    const Eigen::Vector4f &centroid_tgt,
+    Eigen::Matrix4f &transformation_matrix)
+{
+  transformation_matrix.setIdentity ();
+
   // Compute the Singular Value Decomposition
   Eigen::JacobiSVD<Eigen::Matrix3f> svd (H, Eigen::ComputeFullU | Eigen::ComputeFullV);
   Eigen::Matrix3f u = svd.matrixU ();
@@ -121,6 +121,7 @@ namespace pcl
 
       using Registration<PointSource, PointTarget>::reg_name_;
       using Registration<PointSource, PointTarget>::target_;
+      using Registration<PointSource, PointTarget>::prepared_target_;
       using Registration<PointSource, PointTarget>::converged_;
       using Registration<PointSource, PointTarget>::nr_iterations_;
       using Registration<PointSource, PointTarget>::max_iterations_;
@@ -142,6 +143,7 @@ namespace pcl
 } // namespace pcl
 
 #include "pcl/registration/impl/ndt.hpp"
+#include "pcl/registration/prepared_target.h"
 
 #endif // ndef PCL_NDT_H_
 
@@ -0,0 +1,230 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ */
+#ifndef PCL_REGISTRATION_PREPARED_TARGET_H_
+#define PCL_REGISTRATION_PREPARED_TARGET_H_
+
+#include <string>
+#include <vector>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/kdtree/kdtree_flann.h>
+#include <pcl/registration/ndt.h>
+
+namespace pcl
+{
+  namespace registration
+  {
+    /** \brief PreparedTarget holds all the data that registration methods derive from a target point cloud: the
+      * search tree, the per point covariance matrices and normals used by
+      * \a GeneralizedIterativeClosestPoint, and the normal distribution grids used by
+      * \a NormalDistributionsTransform.
+      *
+      * This is meant for scan-to-map alignment, where many scans are registered against the same static map.
+      * The target is prepared once and then handed to any number of registration objects via
+      * \a Registration::setPreparedTarget, which skips rebuilding the search tree and, when the parameters
+      * match, the covariances or NDT grids. A prepared target is read-only once computed, so it can be shared
+      * between registration objects running in different threads.
+      *
+      * A prepared target can be saved to and loaded from a binary file. The file stores the target cloud,
+      * covariances, normals and NDT grids; only the search tree is rebuilt on load, which is cheap compared to
+      * the k-nearest-neighbor queries needed for the covariances. The file stores raw point data, so it can
+      * only be read back for the same point type on a machine with the same byte order.
+      *
+      * \code
+      * pcl::registration::PreparedTarget<pcl::PointXYZ>::Ptr map (new pcl::registration::PreparedTarget<pcl::PointXYZ>);
+      * map->setInputCloud (map_cloud);
+      * map->computeCovariances (20, 0.001);
+      * map->save ("map.pt");
+      * ...
+      * pcl::GeneralizedIterativeClosestPoint<pcl::PointXYZ, pcl::PointXYZ> gicp;
+      * gicp.setPreparedTarget (map);
+      * gicp.setInputCloud (scan);
+      * gicp.align (aligned_scan);
+      * \endcode
+      * \ingroup registration
+      */
+    template <typename PointT>
+    class PreparedTarget
+    {
+      public:
+        typedef boost::shared_ptr<PreparedTarget<PointT> > Ptr;
+        typedef boost::shared_ptr<const PreparedTarget<PointT> > ConstPtr;
+
+        typedef pcl::PointCloud<PointT> PointCloud;
+        typedef typename PointCloud::Ptr PointCloudPtr;
+        typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+
+        typedef typename pcl::KdTree<PointT>::Ptr KdTreePtr;
+
+        typedef pcl::PointCloud<pcl::Normal> Normals;
+        typedef Normals::Ptr NormalsPtr;
+        typedef Normals::ConstPtr NormalsConstPtr;
+
+        typedef pcl::ndt::NDT<PointT> NDTGrid;
+        typedef boost::shared_ptr<NDTGrid> NDTGridPtr;
+        typedef boost::shared_ptr<const NDTGrid> NDTGridConstPtr;
+
+        /** \brief Empty constructor. */
+        PreparedTarget () 
+          : target_ (), tree_ (), covariances_ (), normals_ (), k_correspondences_ (0), gicp_epsilon_ (0), 
+            ndt_grid_ (), grid_centre_ (0, 0), grid_extent_ (0, 0), grid_step_ (0, 0), threads_ (1)
+        {}
+
+        /** \brief Set the target point cloud and build its search tree. All previously computed data is dropped.
+          * \param[in] cloud the target point cloud
+          * \return false if the cloud is empty
+          */
+        bool
+        setInputCloud (const PointCloudConstPtr &cloud);
+
+        /** \brief Get the target point cloud (a copy of the given cloud, with all point.data[3] values set to 1
+          * as expected by the registration methods).
+          */
+        inline PointCloudConstPtr
+        getInputCloud () const { return (target_); }
+
+        /** \brief Get the search tree built on the target point cloud. The tree is shared by every registration
+          * object using this target and must not be modified.
+          */
+        inline KdTreePtr
+        getSearchMethod () const { return (tree_); }
+
+        /** \brief Set the number of threads used for computing the covariances.
+          * \param[in] nr_threads the number of threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+        /** \brief Compute the per point covariance matrices of the target, as done by
+          * \a GeneralizedIterativeClosestPoint, together with the point normals and curvatures that follow from
+          * the same neighborhoods. Normals are oriented towards the sensor origin of the target cloud.
+          * \param[in] k_correspondences the number of neighbors used to estimate each covariance matrix
+          * \param[in] gicp_epsilon the value replacing the smallest eigenvalue of each covariance matrix
+          * \return false if no target is set or if it has less than \a k_correspondences points
+          */
+        bool
+        computeCovariances (int k_correspondences = 20, double gicp_epsilon = 0.001);
+
+        /** \brief Check whether covariances were computed with the given parameters. */
+        inline bool
+        hasCovariances (int k_correspondences, double gicp_epsilon) const
+        {
+          return (!covariances_.empty () && k_correspondences_ == k_correspondences && gicp_epsilon_ == gicp_epsilon);
+        }
+
+        /** \brief Get the per point covariance matrices computed by \a computeCovariances. */
+        inline const std::vector<Eigen::Matrix3d>&
+        getCovariances () const { return (covariances_); }
+
+        /** \brief Get the point normals computed by \a computeCovariances. */
+        inline NormalsConstPtr
+        getNormals () const { return (normals_); }
+
+        /** \brief Build the normal distributions transform model of the target, as done by
+          * \a NormalDistributionsTransform.
+          * \param[in] centre the centre of the grid
+          * \param[in] extent the extent of the grid (in either direction from the centre)
+          * \param[in] step the size of the region modeled by each normal distribution
+          * \return false if no target is set
+          */
+        bool
+        computeNDTGrid (const Eigen::Vector2f &centre, const Eigen::Vector2f &extent, const Eigen::Vector2f &step);
+
+        /** \brief Check whether an NDT model was built with the given grid parameters. */
+        inline bool
+        hasNDTGrid (const Eigen::Vector2f &centre, const Eigen::Vector2f &extent, const Eigen::Vector2f &step) const
+        {
+          return (ndt_grid_ && grid_centre_ == centre && grid_extent_ == extent && grid_step_ == step);
+        }
+
+        /** \brief Get the NDT model built by \a computeNDTGrid. */
+        inline NDTGridConstPtr
+        getNDTGrid () const { return (ndt_grid_); }
+
+        /** \brief Save the prepared target to a binary file.
+          * \param[in] file_name the name of the file to write
+          * \return true on success
+          */
+        bool
+        save (const std::string &file_name) const;
+
+        /** \brief Load a prepared target from a binary file written by \a save, and rebuild its search tree.
+          * \param[in] file_name the name of the file to read
+          * \return true on success; on failure the object is left unchanged
+          */
+        bool
+        load (const std::string &file_name);
+
+      protected:
+        /** \brief The target point cloud. */
+        PointCloudConstPtr target_;
+
+        /** \brief The search tree built on \a target_. */
+        KdTreePtr tree_;
+
+        /** \brief Per point covariance matrices of \a target_. */
+        std::vector<Eigen::Matrix3d> covariances_;
+
+        /** \brief Per point normals of \a target_. */
+        NormalsPtr normals_;
+
+        /** \brief The number of neighbors \a covariances_ were computed with. */
+        int k_correspondences_;
+
+        /** \brief The smallest eigenvalue \a covariances_ were computed with. */
+        double gicp_epsilon_;
+
+        /** \brief The NDT model of \a target_. */
+        NDTGridPtr ndt_grid_;
+
+        /** \brief The grid parameters \a ndt_grid_ was built with. */
+        Eigen::Vector2f grid_centre_, grid_extent_, grid_step_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+
+      public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+  }
+}
+
+#include "pcl/registration/impl/prepared_target.hpp"
+
+#endif  // PCL_REGISTRATION_PREPARED_TARGET_H_
@@ -52,6 +52,11 @@
 
 namespace pcl
 {
+  namespace registration
+  {
+    template <typename PointT> class PreparedTarget;
+  }
+
   /** \brief @b Registration represents the base registration class. 
     * All 3D registration methods should inherit from this class.
     * \author Radu Bogdan Rusu, Michael Dixon
@@ -86,10 +91,14 @@ namespace pcl
       typedef typename TransformationEstimation::Ptr TransformationEstimationPtr;
       typedef typename TransformationEstimation::ConstPtr TransformationEstimationConstPtr;
 
+      typedef typename pcl::registration::PreparedTarget<PointTarget> PreparedTarget;
+      typedef boost::shared_ptr<const PreparedTarget> PreparedTargetConstPtr;
+
       /** \brief Empty constructor. */
       Registration () : nr_iterations_(0),
                         max_iterations_(10),
                         target_ (),
+                        prepared_target_ (),
                         final_transformation_ (Eigen::Matrix4f::Identity ()),
                         transformation_ (Eigen::Matrix4f::Identity ()),
                         previous_transformation_ (Eigen::Matrix4f::Identity ()),
@@ -124,6 +133,21 @@ namespace pcl
       inline PointCloudTargetConstPtr const 
       getInputTarget () { return (target_ ); }
 
+      /** \brief Provide a target whose search tree (and, depending on the registration method, covariances or
+        * NDT grids) has already been computed. The prepared target is only read, so it can be shared with other
+        * registration objects, including ones running in other threads. This replaces any target given via
+        * \a setInputTarget.
+        * \note The point representation set via \a setPointRepresentation is not applied to the shared search
+        * tree.
+        * \param[in] target the prepared target (see pcl::registration::PreparedTarget)
+        */
+      inline void
+      setPreparedTarget (const PreparedTargetConstPtr &target);
+
+      /** \brief Get the prepared target given via \a setPreparedTarget, if any. */
+      inline PreparedTargetConstPtr
+      getPreparedTarget () const { return (prepared_target_); }
+
       /** \brief Get the final transformation matrix estimated by the registration method. */
       inline Eigen::Matrix4f 
       getFinalTransformation () { return (final_transformation_); }
@@ -294,6 +318,9 @@ namespace pcl
       /** \brief The input point cloud dataset target. */
       PointCloudTargetConstPtr target_;
 
+      /** \brief The prepared target, if given. Its cloud and search tree are shared via \a target_ and \a tree_. */
+      PreparedTargetConstPtr prepared_target_;
+
       /** \brief The final transformation matrix estimated by the registration method after N iterations. */
       Eigen::Matrix4f final_transformation_;
 
@@ -39,6 +39,9 @@
 #ifndef PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_POINT_TO_PLANE_LLS_H_ 
 #define PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_POINT_TO_PLANE_LLS_H_
 
+#include <Eigen/Cholesky>
+#include <Eigen/SVD>
+
 #include <pcl/registration/transformation_estimation.h>
 #include <pcl/registration/warp_point_rigid.h>
 
@@ -52,6 +55,11 @@ namespace pcl
       * For additional details, see 
       *   "Linear Least-Squares Optimization for Point-to-Plane ICP Surface Registration", Kok-Lim Low, 2004
       *
+      * The 6x6 normal equations are accumulated in double precision in a single pass over the point clouds, through
+      * the indices or correspondences without copying them, and solved with LDLT (or an SVD if they are close to
+      * singular). For large sets of correspondences the accumulation can be split over several threads, see
+      * setNumberOfThreads ().
+      *
       * \author Michael Dixon
       * \ingroup registration
       */
@@ -59,9 +67,20 @@ namespace pcl
     class TransformationEstimationPointToPlaneLLS : public TransformationEstimation<PointSource, PointTarget>
     {
       public:
-        TransformationEstimationPointToPlaneLLS () {};
+        TransformationEstimationPointToPlaneLLS () : threads_ (1) {};
         virtual ~TransformationEstimationPointToPlaneLLS () {};
 
+        /** \brief Set the number of threads used to accumulate the normal equations.
+          * \param[in] nr_threads the number of hardware threads to use
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads)
+        {
+          if (nr_threads == 0)
+            nr_threads = 1;
+          threads_ = nr_threads;
+        }
+
         /** \brief Estimate a rigid rotation transformation between a source and a target point cloud using SVD.
           * \param[in] cloud_src the source point cloud dataset
           * \param[in] cloud_tgt the target point cloud dataset
@@ -115,6 +134,24 @@ namespace pcl
             Eigen::Matrix4f &transformation_matrix);
 
       protected:
+        /** \brief Estimate the transformation between the point pairs (indices_src[i], indices_tgt[i]), i < nr_points,
+          * accumulating the normal equations in double precision in a single pass.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] indices_src the source indices (any type providing operator[] (size_t))
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[in] indices_tgt the target indices (any type providing operator[] (size_t))
+          * \param[in] nr_points the number of point pairs
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        template <typename IndicesSrc, typename IndicesTgt> void
+        estimateRigidTransformationStreaming (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const IndicesSrc &indices_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            const IndicesTgt &indices_tgt,
+            size_t nr_points,
+            Eigen::Matrix4f &transformation_matrix);
+
         /** \brief Construct a 4 by 4 tranformation matrix from the provided rotation and translation.
           * \param[in] alpha the rotation about the x-axis
           * \param[in] beta the rotation about the y-axis
@@ -129,6 +166,8 @@ namespace pcl
                                        const float & tx, const float & ty, const float & tz,
                                        Eigen::Matrix4f &transformation_matrix);
 
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
     };
   }
 }
@@ -48,6 +48,10 @@ namespace pcl
     /** @b TransformationEstimationSVD implements SVD-based estimation of
       * the transformation aligning the given correspondences.
       *
+      * The centroids and the 3x3 correlation matrix are accumulated in a single pass directly from
+      * the point clouds, without copying the points into intermediate matrices. For large sets of
+      * correspondences the accumulation can be split over several threads, see setNumberOfThreads ().
+      *
       * \author Dirk Holz, Radu B. Rusu
       * \ingroup registration
       */
@@ -55,9 +59,20 @@ namespace pcl
     class TransformationEstimationSVD : public TransformationEstimation<PointSource, PointTarget>
     {
       public:
-        TransformationEstimationSVD () {};
+        TransformationEstimationSVD () : threads_ (1) {};
         virtual ~TransformationEstimationSVD () {};
 
+        /** \brief Set the number of threads used to accumulate the correlation matrix.
+          * \param[in] nr_threads the number of hardware threads to use
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads)
+        {
+          if (nr_threads == 0)
+            nr_threads = 1;
+          threads_ = nr_threads;
+        }
+
         /** \brief Estimate a rigid rotation transformation between a source and a target point cloud using SVD.
           * \param[in] cloud_src the source point cloud dataset
           * \param[in] cloud_tgt the target point cloud dataset
@@ -112,6 +127,36 @@ namespace pcl
 
       protected:
 
+        /** \brief Estimate the transformation between the point pairs (indices_src[i], indices_tgt[i]), i < nr_points,
+          * accumulating the centroids and the correlation matrix in a single pass.
+          * \param[in] cloud_src the source point cloud dataset
+          * \param[in] indices_src the source indices (any type providing operator[] (size_t))
+          * \param[in] cloud_tgt the target point cloud dataset
+          * \param[in] indices_tgt the target indices (any type providing operator[] (size_t))
+          * \param[in] nr_points the number of point pairs
+          * \param[out] transformation_matrix the resultant transformation matrix
+          */
+        template <typename IndicesSrc, typename IndicesTgt> void
+        estimateRigidTransformationStreaming (
+            const pcl::PointCloud<PointSource> &cloud_src,
+            const IndicesSrc &indices_src,
+            const pcl::PointCloud<PointTarget> &cloud_tgt,
+            const IndicesTgt &indices_tgt,
+            size_t nr_points,
+            Eigen::Matrix4f &transformation_matrix);
+
+        /** \brief Obtain a 4x4 rigid transformation matrix from a correlation matrix H = src * tgt'
+          * \param[in] H the 3x3 correlation matrix of the demeaned source and target points
+          * \param[in] centroid_src the input source centroid, in Eigen format
+          * \param[in] centroid_tgt the input target cloud, in Eigen format
+          * \param[out] transformation_matrix the resultant 4x4 rigid transformation matrix
+          */
+        void
+        getTransformationFromCorrelation (const Eigen::Matrix3f &H,
+                                          const Eigen::Vector4f &centroid_src,
+                                          const Eigen::Vector4f &centroid_tgt,
+                                          Eigen::Matrix4f &transformation_matrix);
+
         /** \brief Obtain a 4x4 rigid transformation matrix from a correlation matrix H = src * tgt'
           * \param[in] cloud_src_demean the input source cloud, demeaned, in Eigen format
           * \param[in] centroid_src the input source centroid, in Eigen format
@@ -125,6 +170,9 @@ namespace pcl
                                           const Eigen::MatrixXf &cloud_tgt_demean,
                                           const Eigen::Vector4f &centroid_tgt,
                                           Eigen::Matrix4f &transformation_matrix);
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
     };
 
   }
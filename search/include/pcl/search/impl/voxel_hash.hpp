@@ -0,0 +1,441 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef PCL_SEARCH_IMPL_VOXEL_HASH_H_
+#define PCL_SEARCH_IMPL_VOXEL_HASH_H_
+
+#include "pcl/search/voxel_hash.h"
+#include <algorithm>
+#include <cmath>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::VoxelHash<PointT>::setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr& indices)
+{
+  input_ = cloud;
+  indices_ = indices;
+
+  xyz_.clear ();
+  point_indices_.clear ();
+  cells_.clear ();
+  cell_map_.clear ();
+
+  if (!(resolution_ > 0))
+  {
+    PCL_ERROR ("[pcl::search::VoxelHash::setInputCloud] Invalid resolution %f!\n", resolution_);
+    return;
+  }
+
+  const int nr_points = (int)(indices_ ? indices_->size () : input_->points.size ());
+
+  // Count the points of every voxel, numbering the voxels in the order they are first seen
+  std::vector<int> point_cells (nr_points, -1);
+  for (int i = 0; i < nr_points; ++i)
+  {
+    const PointT &p = input_->points[indices_ ? (*indices_)[i] : i];
+    if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z))
+      continue;
+
+    const double max_coord = (double)MAX_CELL_COORD * resolution_;
+    if (!(std::abs (p.x) < max_coord && std::abs (p.y) < max_coord && std::abs (p.z) < max_coord))
+    {
+      PCL_ERROR ("[pcl::search::VoxelHash::setInputCloud] Resolution %f is too small for the extent of the input cloud!\n",
+                 resolution_);
+      cells_.clear ();
+      cell_map_.clear ();
+      return;
+    }
+
+    const CellKey key = getCellKey (p.x, p.y, p.z);
+    typename boost::unordered_map<CellKey, int>::iterator it = cell_map_.find (key);
+    if (it == cell_map_.end ())
+    {
+      Cell cell;
+      cell.key = key;
+      cell.begin = cell.end = 0;
+      it = cell_map_.insert (std::make_pair (key, (int)cells_.size ())).first;
+      cells_.push_back (cell);
+    }
+    point_cells[i] = it->second;
+    cells_[it->second].end++;
+  }
+
+  if (cells_.empty ())
+    return;
+
+  // Lay out the voxels one after the other and compute their bounds
+  min_cell_ = max_cell_ = cells_[0].key;
+  int nr_valid = 0;
+  for (size_t c = 0; c < cells_.size (); ++c)
+  {
+    const int size = cells_[c].end;
+    cells_[c].begin = cells_[c].end = nr_valid;
+    nr_valid += size;
+
+    const CellKey &key = cells_[c].key;
+    min_cell_.x = std::min (min_cell_.x, key.x); max_cell_.x = std::max (max_cell_.x, key.x);
+    min_cell_.y = std::min (min_cell_.y, key.y); max_cell_.y = std::max (max_cell_.y, key.y);
+    min_cell_.z = std::min (min_cell_.z, key.z); max_cell_.z = std::max (max_cell_.z, key.z);
+  }
+
+  // Copy the points voxel by voxel
+  xyz_.resize (nr_valid * 3);
+  point_indices_.resize (nr_valid);
+  for (int i = 0; i < nr_points; ++i)
+  {
+    if (point_cells[i] == -1)
+      continue;
+
+    const int index = indices_ ? (*indices_)[i] : i;
+    const PointT &p = input_->points[index];
+    const int pos = cells_[point_cells[i]].end++;
+    xyz_[pos * 3 + 0] = p.x;
+    xyz_[pos * 3 + 1] = p.y;
+    xyz_[pos * 3 + 2] = p.z;
+    point_indices_[pos] = index;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::VoxelHash<PointT>::getCellDistances (const PointT &point, const CellKey &key,
+                                                  double &min_sqr_dist, double &max_sqr_dist) const
+{
+  const double p[3] = {point.x, point.y, point.z};
+  const int k[3] = {key.x, key.y, key.z};
+  min_sqr_dist = max_sqr_dist = 0;
+  for (int d = 0; d < 3; ++d)
+  {
+    const double lower = k[d] * resolution_, upper = (k[d] + 1) * resolution_;
+    const double nearest = p[d] < lower ? lower - p[d] : (p[d] > upper ? p[d] - upper : 0);
+    const double farthest = std::max (std::abs (p[d] - lower), std::abs (p[d] - upper));
+    min_sqr_dist += nearest * nearest;
+    max_sqr_dist += farthest * farthest;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::VoxelHash<PointT>::getCellsInRadius (const PointT &point, double radius, std::vector<int> &cells) const
+{
+  cells.clear ();
+  if (cells_.empty ())
+    return;
+
+  // Widen the sphere a little so that rounding in the point distances never misses a voxel
+  radius *= 1.0 + 1e-5;
+
+  CellKey min_key = getCellKey (point.x - radius, point.y - radius, point.z - radius);
+  CellKey max_key = getCellKey (point.x + radius, point.y + radius, point.z + radius);
+  min_key.x = std::max (min_key.x, min_cell_.x); max_key.x = std::min (max_key.x, max_cell_.x);
+  min_key.y = std::max (min_key.y, min_cell_.y); max_key.y = std::min (max_key.y, max_cell_.y);
+  min_key.z = std::max (min_key.z, min_cell_.z); max_key.z = std::min (max_key.z, max_cell_.z);
+  if (min_key.x > max_key.x || min_key.y > max_key.y || min_key.z > max_key.z)
+    return;
+
+  const double sqr_radius = radius * radius;
+  double min_sqr_dist, max_sqr_dist;
+
+  // Look the voxels of the range up, unless there are fewer occupied voxels than that to go through
+  const double nr_keys = (max_key.x - min_key.x + 1.0) * (max_key.y - min_key.y + 1.0) * (max_key.z - min_key.z + 1.0);
+  if (nr_keys <= (double)cells_.size ())
+  {
+    CellKey key;
+    for (key.x = min_key.x; key.x <= max_key.x; ++key.x)
+      for (key.y = min_key.y; key.y <= max_key.y; ++key.y)
+        for (key.z = min_key.z; key.z <= max_key.z; ++key.z)
+        {
+          const int c = findCell (key);
+          if (c == -1)
+            continue;
+          getCellDistances (point, key, min_sqr_dist, max_sqr_dist);
+          if (min_sqr_dist <= sqr_radius)
+            cells.push_back (c);
+        }
+  }
+  else
+  {
+    for (int c = 0; c < (int)cells_.size (); ++c)
+    {
+      const CellKey &key = cells_[c].key;
+      if (key.x < min_key.x || key.x > max_key.x || key.y < min_key.y || key.y > max_key.y ||
+          key.z < min_key.z || key.z > max_key.z)
+        continue;
+      getCellDistances (point, key, min_sqr_dist, max_sqr_dist);
+      if (min_sqr_dist <= sqr_radius)
+        cells.push_back (c);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::VoxelHash<PointT>::nearestKSearch (const PointT &point, int k, 
+                                                std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (cells_.empty () || k <= 0 || !pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+    return (0);
+
+  // The k best candidates so far, as a max-heap on the distance
+  std::vector<std::pair<float, int> > result;
+  result.reserve (k + 1);
+
+  const CellKey center = getCellKey (point.x, point.y, point.z);
+  const int max_ring = std::max (std::max (std::max (center.x - min_cell_.x, max_cell_.x - center.x),
+                                           std::max (center.y - min_cell_.y, max_cell_.y - center.y)),
+                                 std::max (center.z - min_cell_.z, max_cell_.z - center.z));
+
+  std::vector<int> ring_cells;
+  for (int d = 0; d <= max_ring; ++d)
+  {
+    // Gather the occupied voxels at Chebyshev distance d from the center. Once a ring holds more keys than
+    // there are occupied voxels, all the voxels that are left are gathered at once.
+    ring_cells.clear ();
+    const bool last_ring = (2.0 * d + 1) * (2.0 * d + 1) * (2.0 * d + 1) > (double)cells_.size ();
+    if (last_ring)
+    {
+      for (int c = 0; c < (int)cells_.size (); ++c)
+      {
+        const CellKey &key = cells_[c].key;
+        const int ring = std::max (std::max (std::abs (key.x - center.x), std::abs (key.y - center.y)), 
+                                   std::abs (key.z - center.z));
+        if (ring >= d)
+          ring_cells.push_back (c);
+      }
+    }
+    else
+    {
+      CellKey key;
+      for (int dx = -d; dx <= d; ++dx)
+      {
+        key.x = center.x + dx;
+        if (key.x < min_cell_.x || key.x > max_cell_.x)
+          continue;
+        for (int dy = -d; dy <= d; ++dy)
+        {
+          key.y = center.y + dy;
+          if (key.y < min_cell_.y || key.y > max_cell_.y)
+            continue;
+          // Inside the ring only the two faces along z are left
+          const bool on_ring = (std::abs (dx) == d || std::abs (dy) == d);
+          const int step = (on_ring || d == 0) ? 1 : 2 * d;
+          for (int dz = -d; dz <= d; dz += step)
+          {
+            key.z = center.z + dz;
+            if (key.z < min_cell_.z || key.z > max_cell_.z)
+              continue;
+            const int c = findCell (key);
+            if (c != -1)
+              ring_cells.push_back (c);
+          }
+        }
+      }
+    }
+
+    for (size_t r = 0; r < ring_cells.size (); ++r)
+    {
+      const Cell &cell = cells_[ring_cells[r]];
+      for (int i = cell.begin; i < cell.end; ++i)
+      {
+        const float dx = xyz_[i * 3 + 0] - point.x, dy = xyz_[i * 3 + 1] - point.y, dz = xyz_[i * 3 + 2] - point.z;
+        const float sqr_dist = dx * dx + dy * dy + dz * dz;
+        if ((int)result.size () < k)
+        {
+          result.push_back (std::make_pair (sqr_dist, point_indices_[i]));
+          std::push_heap (result.begin (), result.end ());
+        }
+        else if (sqr_dist < result.front ().first)
+        {
+          std::pop_heap (result.begin (), result.end ());
+          result.back () = std::make_pair (sqr_dist, point_indices_[i]);
+          std::push_heap (result.begin (), result.end ());
+        }
+      }
+    }
+
+    // The voxels beyond ring d are at least d voxels away
+    if (last_ring || ((int)result.size () == k && result.front ().first <= (d * resolution_) * (d * resolution_)))
+      break;
+  }
+
+  std::sort_heap (result.begin (), result.end ());
+  k_indices.resize (result.size ());
+  k_sqr_distances.resize (result.size ());
+  for (size_t i = 0; i < result.size (); ++i)
+  {
+    k_sqr_distances[i] = result[i].first;
+    k_indices[i] = result[i].second;
+  }
+  return ((int)result.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::VoxelHash<PointT>::radiusSearch (const PointT& point, double radius,
+                                              std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                                              unsigned int max_nn) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+    return (0);
+
+  std::vector<int> cells;
+  getCellsInRadius (point, radius, cells);
+
+  const float sqr_radius = (float)(radius * radius);
+  std::vector<std::pair<float, int> > result;
+  if (max_nn == 0)
+  {
+    for (size_t c = 0; c < cells.size (); ++c)
+    {
+      const Cell &cell = cells_[cells[c]];
+      for (int i = cell.begin; i < cell.end; ++i)
+      {
+        const float dx = xyz_[i * 3 + 0] - point.x, dy = xyz_[i * 3 + 1] - point.y, dz = xyz_[i * 3 + 2] - point.z;
+        const float sqr_dist = dx * dx + dy * dy + dz * dz;
+        if (sqr_dist <= sqr_radius)
+          result.push_back (std::make_pair (sqr_dist, point_indices_[i]));
+      }
+    }
+    std::sort (result.begin (), result.end ());
+  }
+  else
+  {
+    // Visit the voxels from near to far and keep the max_nn nearest neighbors in a max-heap. Once the heap is
+    // full, the voxels farther away than its top cannot hold any of the nearest neighbors.
+    std::vector<std::pair<double, int> > cell_order (cells.size ());
+    double min_sqr_dist, max_sqr_dist;
+    for (size_t c = 0; c < cells.size (); ++c)
+    {
+      getCellDistances (point, cells_[cells[c]].key, min_sqr_dist, max_sqr_dist);
+      cell_order[c] = std::make_pair (min_sqr_dist, cells[c]);
+    }
+    std::sort (cell_order.begin (), cell_order.end ());
+
+    result.reserve (max_nn + 1);
+    for (size_t c = 0; c < cell_order.size (); ++c)
+    {
+      if (result.size () == max_nn && cell_order[c].first * (1.0 - 1e-5) > result.front ().first)
+        break;
+
+      const Cell &cell = cells_[cell_order[c].second];
+      for (int i = cell.begin; i < cell.end; ++i)
+      {
+        const float dx = xyz_[i * 3 + 0] - point.x, dy = xyz_[i * 3 + 1] - point.y, dz = xyz_[i * 3 + 2] - point.z;
+        const float sqr_dist = dx * dx + dy * dy + dz * dz;
+        if (sqr_dist > sqr_radius)
+          continue;
+        if (result.size () < max_nn)
+        {
+          result.push_back (std::make_pair (sqr_dist, point_indices_[i]));
+          std::push_heap (result.begin (), result.end ());
+        }
+        else if (sqr_dist < result.front ().first)
+        {
+          std::pop_heap (result.begin (), result.end ());
+          result.back () = std::make_pair (sqr_dist, point_indices_[i]);
+          std::push_heap (result.begin (), result.end ());
+        }
+      }
+    }
+    std::sort_heap (result.begin (), result.end ());
+  }
+
+  k_indices.resize (result.size ());
+  k_sqr_distances.resize (result.size ());
+  for (size_t i = 0; i < result.size (); ++i)
+  {
+    k_sqr_distances[i] = result[i].first;
+    k_indices[i] = result[i].second;
+  }
+  return ((int)result.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::VoxelHash<PointT>::radiusCount (const PointT &point, double radius, unsigned int max_count) const
+{
+  if (cells_.empty () || !pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+    return (0);
+
+  const float sqr_radius = (float)(radius * radius);
+  // Voxels are counted whole when they lie inside the sphere by a margin, which keeps rounding out of the decision
+  const double inner_sqr_radius = radius * radius * (1.0 - 1e-5);
+  unsigned int count = 0;
+  double min_sqr_dist, max_sqr_dist;
+
+  // The voxel of the query holds the closest points, so it is the most likely to reach max_count on its own
+  const CellKey center = getCellKey (point.x, point.y, point.z);
+  const int center_cell = findCell (center);
+
+  std::vector<int> cells;
+  if (center_cell != -1)
+    cells.push_back (center_cell);
+  std::vector<int> others;
+  getCellsInRadius (point, radius, others);
+  for (size_t c = 0; c < others.size (); ++c)
+    if (others[c] != center_cell)
+      cells.push_back (others[c]);
+
+  for (size_t c = 0; c < cells.size (); ++c)
+  {
+    const Cell &cell = cells_[cells[c]];
+    getCellDistances (point, cell.key, min_sqr_dist, max_sqr_dist);
+    if (max_sqr_dist <= inner_sqr_radius)
+      count += cell.end - cell.begin;
+    else
+    {
+      for (int i = cell.begin; i < cell.end; ++i)
+      {
+        const float dx = xyz_[i * 3 + 0] - point.x, dy = xyz_[i * 3 + 1] - point.y, dz = xyz_[i * 3 + 2] - point.z;
+        if (dx * dx + dy * dy + dz * dz <= sqr_radius)
+          ++count;
+      }
+    }
+    if (max_count != 0 && count >= max_count)
+      return ((int)max_count);
+  }
+  return ((int)count);
+}
+
+#define PCL_INSTANTIATE_VoxelHash(T) template class PCL_EXPORTS pcl::search::VoxelHash<T>;
+
+#endif  // PCL_SEARCH_IMPL_VOXEL_HASH_H_
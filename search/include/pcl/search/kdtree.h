@@ -160,6 +160,33 @@ namespace pcl
           return (tree_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
         }
 
+        /** \brief Count the nearest neighbors of the query point in a given radius, without returning them.
+          * With \a max_count set, FLANN narrows the search once it has found that many neighbors.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if non-zero, bounds the returned count to this value
+          * \return number of neighbors found in radius, at most \a max_count if it is non-zero
+          */
+        inline int
+        radiusCount (const PointT &point, double radius, unsigned int max_count = 0) const
+        {
+          return (tree_->radiusCount (point, radius, max_count));
+        }
+
+        /** \brief Count the nearest neighbors of the query point in a given radius (zero-copy).
+          * \param[in] index a \a valid index representing a \a valid query point in the dataset given 
+          * by \a setInputCloud. If indices were given in setInputCloud, index will be the position in 
+          * the indices vector.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if non-zero, bounds the returned count to this value
+          * \return number of neighbors found in radius, at most \a max_count if it is non-zero
+          */
+        inline int
+        radiusCount (int index, double radius, unsigned int max_count = 0) const
+        {
+          return (radiusCount (input_->points[indices_ ? (*indices_)[index] : index], radius, max_count));
+        }
+
       protected:
         /** \brief A pointer to the internal KdTreeFLANN object. */
         KdTreeFLANNPtr tree_;
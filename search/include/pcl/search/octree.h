@@ -171,6 +171,23 @@ namespace pcl
           return (tree_->nearestKSearch (index, k, k_indices, k_sqr_distances));
         }
 
+        /** \brief Search for the k-nearest neighbors for the given query points.
+          * \note Queries are processed in Morton order and spread over the octree's threads, see
+          * pcl::octree::OctreePointCloudSearch::nearestKSearch.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices a vector of point cloud indices to query for nearest neighbors
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i] corresponds to the neighbors of the query point i
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, k_sqr_distances[i] corresponds to the neighbors of the query point i
+          */
+        inline void
+        nearestKSearch (const PointCloud& cloud, const std::vector<int>& indices, int k,
+                        std::vector< std::vector<int> >& k_indices,
+                        std::vector< std::vector<float> >& k_sqr_distances) const
+        {
+          tree_->nearestKSearch (cloud, indices, k, k_indices, k_sqr_distances);
+        }
+
         /** \brief search for all neighbors of query point that are within a given radius.
          * \param cloud the point cloud data
          * \param index the index in \a cloud representing the query point
@@ -53,6 +53,9 @@ namespace pcl
       *   - \b nearestKSearch - search for K-nearest neighbors. 
       *   - \b radiusSearch - search for all nearest neighbors in a sphere of a given radius
       *
+      * In addition, \b radiusCount counts the neighbors in a sphere, up to a given number. It is implemented on
+      * top of radiusSearch, but may be overridden by search methods that can count faster.
+      *
       * The input to each search method can be given in 3 different ways:
       *   - as a query point
       *   - as a (cloud, index) pair
@@ -453,6 +456,55 @@ namespace pcl
           }
         }
 
+        /** \brief Count the nearest neighbors of the query point in a given radius, stopping as soon as
+          * \a max_count of them are found. Use this instead of radiusSearch () when only the number of neighbors
+          * matters, e.g. to test whether a point has enough of them.
+          * 
+          * The default implementations call radiusSearch () with \a max_count as \a max_nn; search methods that
+          * can count without gathering the neighbors should override them.
+          * 
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if non-zero, the search stops once this many neighbors are found
+          * \return number of neighbors found in radius, at most \a max_count if it is non-zero
+          */
+        virtual int
+        radiusCount (const PointT &point, double radius, unsigned int max_count = 0) const
+        {
+          std::vector<int> k_indices;
+          std::vector<float> k_sqr_distances;
+          int k = radiusSearch (point, radius, k_indices, k_sqr_distances, max_count);
+          if (max_count != 0 && k > (int)max_count)
+            k = (int)max_count;
+          return (k);
+        }
+
+        /** \brief Count the nearest neighbors of the query point in a given radius (zero-copy), stopping as soon
+          * as \a max_count of them are found.
+          * 
+          * \attention This method does not do any bounds checking for the input index
+          * (i.e., index >= cloud.points.size () || index < 0), and assumes valid (i.e., finite) data.
+          * 
+          * \param[in] index a \a valid index representing a \a valid query point in the dataset given 
+          * by \a setInputCloud. If indices were given in setInputCloud, index will be the position in 
+          * the indices vector.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if non-zero, the search stops once this many neighbors are found
+          * \return number of neighbors found in radius, at most \a max_count if it is non-zero
+          * 
+          * \exception asserts in debug mode if the index is not between 0 and the maximum number of points
+          */
+        virtual int 
+        radiusCount (int index, double radius, unsigned int max_count = 0) const
+        {
+          std::vector<int> k_indices;
+          std::vector<float> k_sqr_distances;
+          int k = radiusSearch (index, radius, k_indices, k_sqr_distances, max_count);
+          if (max_count != 0 && k > (int)max_count)
+            k = (int)max_count;
+          return (k);
+        }
+
       protected:
         PointCloudConstPtr input_;
         IndicesConstPtr indices_;
@@ -0,0 +1,267 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef PCL_SEARCH_VOXEL_HASH_H_
+#define PCL_SEARCH_VOXEL_HASH_H_
+
+#include <pcl/search/search.h>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief @b search::VoxelHash hashes the points of the input cloud into cubic voxels of a given resolution.
+      * Radius searches only visit the voxels that overlap the query sphere, and radiusCount () counts whole
+      * voxels that lie inside the sphere without looking at their points, stopping as soon as enough neighbors
+      * are found. This makes it a good fit for density tests such as \a pcl::RadiusOutlierRemoval.
+      *
+      * The resolution should be close to the search radius: much smaller voxels mean many lookups per query,
+      * much larger ones mean many distance checks. Voxel coordinates are limited to +/- 2^29, clouds whose
+      * extent exceeds that many voxels are rejected by setInputCloud ().
+      *
+      * \ingroup search
+      */
+    template<typename PointT>
+    class VoxelHash: public Search<PointT>
+    {
+      public:
+        typedef typename Search<PointT>::PointCloud PointCloud;
+        typedef typename Search<PointT>::PointCloudConstPtr PointCloudConstPtr;
+
+        typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
+        typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
+
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+
+        typedef boost::shared_ptr<VoxelHash<PointT> > Ptr;
+        typedef boost::shared_ptr<const VoxelHash<PointT> > ConstPtr;
+
+        /** \brief Constructor for VoxelHash.
+          * \param[in] resolution the side length of the voxels
+          */
+        VoxelHash (double resolution) : resolution_ (resolution), xyz_ (), point_indices_ (), cells_ (), cell_map_ (),
+                                        min_cell_ (), max_cell_ ()
+        {
+        }
+
+        /** \brief Destructor for VoxelHash. */
+        virtual
+        ~VoxelHash ()
+        {
+        }
+
+        /** \brief Set the side length of the voxels. Takes effect with the next call to setInputCloud ().
+          * \param[in] resolution the side length of the voxels
+          */
+        inline void
+        setResolution (double resolution)
+        {
+          resolution_ = resolution;
+        }
+
+        /** \brief Get the side length of the voxels. */
+        inline double
+        getResolution () const
+        {
+          return (resolution_);
+        }
+
+        /** \brief Provide a pointer to the input dataset and hash its points. Points with non-finite coordinates
+          * are left out. If a point lies too far from the origin for the resolution, an error is printed and the
+          * search finds no points.
+          * \param[in] cloud the const boost shared pointer to a PointCloud message
+          * \param[in] indices the point indices subset that is to be used from \a cloud 
+          */
+        void
+        setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr& indices = IndicesConstPtr ());
+
+        /** \brief Search for the k-nearest neighbors for the given query point.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned. Otherwise the \a max_nn nearest neighbors are returned.
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius,
+                      std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const;
+
+        /** \brief Count the nearest neighbors of the query point in a given radius, stopping as soon as
+          * \a max_count of them are found. The voxel of the query is counted first.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if non-zero, the search stops once this many neighbors are found
+          * \return number of neighbors found in radius, at most \a max_count if it is non-zero
+          */
+        int
+        radiusCount (const PointT &point, double radius, unsigned int max_count = 0) const;
+
+        /** \brief Count the nearest neighbors of the query point in a given radius (zero-copy), stopping as soon
+          * as \a max_count of them are found.
+          * \param[in] index a \a valid index representing a \a valid query point in the dataset given 
+          * by \a setInputCloud. If indices were given in setInputCloud, index will be the position in 
+          * the indices vector.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[in] max_count if non-zero, the search stops once this many neighbors are found
+          * \return number of neighbors found in radius, at most \a max_count if it is non-zero
+          */
+        inline int
+        radiusCount (int index, double radius, unsigned int max_count = 0) const
+        {
+          assert (index >= 0 && index < (int)(indices_ ? indices_->size () : input_->points.size ()) && 
+                  "Out-of-bounds error in radiusCount!");
+          return (radiusCount (input_->points[indices_ ? (*indices_)[index] : index], radius, max_count));
+        }
+
+      protected:
+        /** \brief Integer coordinates of a voxel. */
+        struct CellKey
+        {
+          int x, y, z;
+
+          inline bool
+          operator == (const CellKey &other) const
+          {
+            return (x == other.x && y == other.y && z == other.z);
+          }
+
+          friend inline std::size_t
+          hash_value (const CellKey &key)
+          {
+            std::size_t seed = 0;
+            boost::hash_combine (seed, key.x);
+            boost::hash_combine (seed, key.y);
+            boost::hash_combine (seed, key.z);
+            return (seed);
+          }
+        };
+
+        /** \brief An occupied voxel and the range of its points in \a xyz_ and \a point_indices_. */
+        struct Cell
+        {
+          CellKey key;
+          int begin, end;
+        };
+
+        /** \brief Largest magnitude of a voxel coordinate. It leaves room for differences of voxel coordinates
+          * and for the ring offsets of nearestKSearch () within an int.
+          */
+        static const int MAX_CELL_COORD = 1 << 29;
+
+        /** \brief Get the voxel coordinate of a point coordinate, clamped to +/- \a MAX_CELL_COORD. */
+        inline int
+        getCellCoord (double v) const
+        {
+          const double c = floor (v / resolution_);
+          return (c < -MAX_CELL_COORD ? -MAX_CELL_COORD : (c > MAX_CELL_COORD ? MAX_CELL_COORD : (int)c));
+        }
+
+        /** \brief Get the voxel containing the given coordinates. Coordinates beyond the voxel range are clamped,
+          * the voxels of the input cloud lie strictly within it.
+          */
+        inline CellKey
+        getCellKey (double x, double y, double z) const
+        {
+          CellKey key;
+          key.x = getCellCoord (x);
+          key.y = getCellCoord (y);
+          key.z = getCellCoord (z);
+          return (key);
+        }
+
+        /** \brief Get the occupied voxels that overlap the sphere of the given radius around \a point.
+          * \param[in] point the center of the sphere
+          * \param[in] radius the radius of the sphere
+          * \param[out] cells the positions in \a cells_ of the overlapping voxels
+          */
+        void
+        getCellsInRadius (const PointT &point, double radius, std::vector<int> &cells) const;
+
+        /** \brief Get the squared distances from \a point to the nearest and to the farthest point of a voxel. */
+        void
+        getCellDistances (const PointT &point, const CellKey &key, double &min_sqr_dist, double &max_sqr_dist) const;
+
+        /** \brief Find the occupied voxel with the given key, -1 if it is empty. */
+        inline int
+        findCell (const CellKey &key) const
+        {
+          typename boost::unordered_map<CellKey, int>::const_iterator it = cell_map_.find (key);
+          return (it == cell_map_.end () ? -1 : it->second);
+        }
+
+        /** \brief The side length of the voxels. */
+        double resolution_;
+
+        /** \brief The x, y, z coordinates of the finite points, voxel by voxel. */
+        std::vector<float> xyz_;
+
+        /** \brief The index in the input cloud of each point in \a xyz_. */
+        std::vector<int> point_indices_;
+
+        /** \brief The occupied voxels. */
+        std::vector<Cell> cells_;
+
+        /** \brief Maps a voxel to its position in \a cells_. */
+        boost::unordered_map<CellKey, int> cell_map_;
+
+        /** \brief The bounds of the occupied voxels. */
+        CellKey min_cell_, max_cell_;
+    };
+  }
+}
+
+#endif    // PCL_SEARCH_VOXEL_HASH_H_
@@ -0,0 +1,210 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <algorithm>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/pcl_search.h>
+#include <pcl/search/voxel_hash.h>
+
+using namespace std;
+using namespace pcl;
+
+PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+
+// Squared distances from the query to all the finite points, sorted
+void
+bruteForce (const PointXYZ &query, vector<pair<float, int> > &result)
+{
+  result.clear ();
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+  {
+    const PointXYZ &p = cloud->points[i];
+    if (!pcl_isfinite (p.x))
+      continue;
+    const float dx = p.x - query.x, dy = p.y - query.y, dz = p.z - query.z;
+    result.push_back (make_pair (dx * dx + dy * dy + dz * dz, (int)i));
+  }
+  sort (result.begin (), result.end ());
+}
+
+PointXYZ
+randomPoint (float range)
+{
+  return (PointXYZ (range * (float)rand () / RAND_MAX, range * (float)rand () / RAND_MAX, 
+                    range * (float)rand () / RAND_MAX));
+}
+
+TEST (PCL, VoxelHash_nearestKSearch)
+{
+  // Both a fine and a coarse grid, so that the rings and the full scan of the voxels are exercised
+  const double resolutions[] = {0.02, 0.5};
+  for (size_t r = 0; r < sizeof (resolutions) / sizeof (resolutions[0]); ++r)
+  {
+    search::VoxelHash<PointXYZ> voxel_hash (resolutions[r]);
+    voxel_hash.setInputCloud (cloud);
+
+    vector<int> k_indices;
+    vector<float> k_sqr_distances;
+    vector<pair<float, int> > expected;
+    for (int q = 0; q < 50; ++q)
+    {
+      const PointXYZ query = randomPoint (1.2f);
+      const int k = 1 + rand () % 20;
+      bruteForce (query, expected);
+
+      ASSERT_EQ (voxel_hash.nearestKSearch (query, k, k_indices, k_sqr_distances), k);
+      ASSERT_EQ ((int)k_sqr_distances.size (), k);
+      for (int i = 0; i < k; ++i)
+        EXPECT_EQ (k_sqr_distances[i], expected[i].first);
+    }
+  }
+}
+
+TEST (PCL, VoxelHash_radiusSearch)
+{
+  search::VoxelHash<PointXYZ> voxel_hash (0.05);
+  voxel_hash.setInputCloud (cloud);
+
+  vector<int> k_indices;
+  vector<float> k_sqr_distances;
+  vector<pair<float, int> > expected;
+  const double radii[] = {0.01, 0.05, 0.2};
+  for (size_t r = 0; r < sizeof (radii) / sizeof (radii[0]); ++r)
+  {
+    for (int q = 0; q < 50; ++q)
+    {
+      const PointXYZ query = randomPoint (1.0f);
+      bruteForce (query, expected);
+      const float sqr_radius = (float)(radii[r] * radii[r]);
+      size_t nr_expected = 0;
+      while (nr_expected < expected.size () && expected[nr_expected].first <= sqr_radius)
+        ++nr_expected;
+
+      ASSERT_EQ (voxel_hash.radiusSearch (query, radii[r], k_indices, k_sqr_distances), (int)nr_expected);
+      vector<int> sorted_indices (k_indices), expected_indices;
+      for (size_t i = 0; i < nr_expected; ++i)
+      {
+        EXPECT_EQ (k_sqr_distances[i], expected[i].first);
+        expected_indices.push_back (expected[i].second);
+      }
+      sort (sorted_indices.begin (), sorted_indices.end ());
+      sort (expected_indices.begin (), expected_indices.end ());
+      EXPECT_EQ (sorted_indices, expected_indices);
+
+      // A bounded search returns the nearest neighbors
+      const size_t max_nn = 7;
+      ASSERT_EQ (voxel_hash.radiusSearch (query, radii[r], k_indices, k_sqr_distances, max_nn),
+                 (int)min (nr_expected, max_nn));
+      for (size_t i = 0; i < k_sqr_distances.size (); ++i)
+        EXPECT_EQ (k_sqr_distances[i], expected[i].first);
+
+      // The counts agree with the search, and stop at the requested number
+      EXPECT_EQ (voxel_hash.radiusCount (query, radii[r]), (int)nr_expected);
+      EXPECT_EQ (voxel_hash.radiusCount (query, radii[r], 5), (int)min<size_t> (nr_expected, 5));
+    }
+  }
+}
+
+TEST (PCL, VoxelHash_radiusCount_default)
+{
+  // The generic counting query of Search gives the same counts
+  search::KdTree<PointXYZ> kdtree;
+  kdtree.setInputCloud (cloud);
+  search::VoxelHash<PointXYZ> voxel_hash (0.1);
+  voxel_hash.setInputCloud (cloud);
+
+  for (int q = 0; q < 50; ++q)
+  {
+    const int index = rand () % (int)cloud->points.size ();
+    if (!pcl_isfinite (cloud->points[index].x))
+      continue;
+    EXPECT_EQ (kdtree.radiusCount (index, 0.1), voxel_hash.radiusCount (index, 0.1));
+    EXPECT_EQ (kdtree.radiusCount (index, 0.1, 3), voxel_hash.radiusCount (index, 0.1, 3));
+  }
+}
+
+TEST (PCL, VoxelHash_coordinate_range)
+{
+  vector<int> k_indices;
+  vector<float> k_sqr_distances;
+
+  // Voxel coordinates of far away points would overflow, such clouds are rejected
+  PointCloud<PointXYZ>::Ptr far_cloud (new PointCloud<PointXYZ> (*cloud));
+  far_cloud->points.push_back (PointXYZ (1e8f, 0.0f, 0.0f));
+  search::VoxelHash<PointXYZ> voxel_hash (1e-3);
+  voxel_hash.setInputCloud (far_cloud);
+  EXPECT_EQ (voxel_hash.nearestKSearch (PointXYZ (0.5f, 0.5f, 0.5f), 1, k_indices, k_sqr_distances), 0);
+
+  // Far away queries are fine, their voxel coordinates are clamped
+  voxel_hash.setInputCloud (cloud);
+  vector<pair<float, int> > expected;
+  const PointXYZ far_query (1e8f, -1e8f, 0.5f);
+  bruteForce (far_query, expected);
+  ASSERT_EQ (voxel_hash.nearestKSearch (far_query, 3, k_indices, k_sqr_distances), 3);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ (k_sqr_distances[i], expected[i].first);
+  EXPECT_EQ (voxel_hash.radiusSearch (far_query, 1.0, k_indices, k_sqr_distances), 0);
+  EXPECT_EQ (voxel_hash.radiusCount (far_query, 1.0), 0);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  srand (1234);
+  // Uniform points with a dense cluster and a few invalid points
+  for (int i = 0; i < 2000; ++i)
+    cloud->points.push_back (randomPoint (1.0f));
+  for (int i = 0; i < 500; ++i)
+  {
+    PointXYZ p = randomPoint (0.05f);
+    p.x += 0.5f; p.y += 0.5f; p.z += 0.5f;
+    cloud->points.push_back (p);
+  }
+  for (int i = 0; i < 5; ++i)
+    cloud->points.push_back (PointXYZ (numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f));
+  cloud->width = (uint32_t)cloud->points.size ();
+  cloud->height = 1;
+  cloud->is_dense = false;
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -0,0 +1,189 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_SEGMENTATION_EUCLIDEAN_CLUSTER_GRID_H_
+#define PCL_SEGMENTATION_EUCLIDEAN_CLUSTER_GRID_H_
+
+#include <pcl/pcl_base.h>
+#include <boost/unordered_map.hpp>
+
+#include "pcl/segmentation/extract_clusters.h"
+
+namespace pcl
+{
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose a region of space into clusters based on the Euclidean distance between points, using a
+    * voxel grid (see \a EuclideanClusterGrid) instead of a spatial locator. The clusters are the same as the ones
+    * returned by \a extractEuclideanClusters.
+    * \param cloud the point cloud message
+    * \param indices a list of point indices to use from \a cloud
+    * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \ingroup segmentation
+    */
+  template <typename PointT> void 
+  extractEuclideanClustersGrid (
+      const PointCloud<PointT> &cloud, const std::vector<int> &indices, 
+      float tolerance, std::vector<PointIndices> &clusters, 
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose a region of space into clusters of equal label based on the Euclidean distance between
+    * points, using a voxel grid (see \a EuclideanClusterGrid) instead of a spatial locator. The clusters are the
+    * same as the ones returned by \a extractLabeledEuclideanClusters.
+    * \param[in] cloud the point cloud message
+    * \param[in] tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param[out] labeled_clusters the resultant clusters containing point indices, per label. Grown if a label
+    * does not fit.
+    * \param[in] min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
+    * \param[in] max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \ingroup segmentation
+    */
+  template <typename PointT> void 
+  extractLabeledEuclideanClustersGrid (
+      const PointCloud<PointT> &cloud, float tolerance, 
+      std::vector<std::vector<PointIndices> > &labeled_clusters, 
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief @b EuclideanClusterGrid finds the pairs of points that are closer than the cluster tolerance by hashing
+    * the points into a voxel grid with cells as large as the tolerance. The neighbors of a point can only lie in
+    * its own cell or in one of the 26 cells around it, so clustering needs no spatial locator queries at all.
+    * The points are copied in cell order, keeping the distance checks between two cells in contiguous memory.
+    *
+    * A grid is built once and can be linked several times, e.g. once per set of labels.
+    * \ingroup segmentation
+    */
+  template <typename PointT>
+  class EuclideanClusterGrid
+  {
+    public:
+      typedef pcl::PointCloud<PointT> PointCloud;
+
+      /** \brief Empty constructor. */
+      EuclideanClusterGrid () : tolerance_ (0), nr_points_ (0) {};
+
+      /** \brief Hash the points into cells as large as \a tolerance. Points with non-finite coordinates are left
+        * out and end up alone in their cluster.
+        * \param cloud the point cloud message
+        * \param indices a list of point indices to use from \a cloud
+        * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+        */
+      void 
+      build (const PointCloud &cloud, const std::vector<int> &indices, float tolerance);
+
+      /** \brief Link all the points that are within the tolerance of each other.
+        * \param roots for each position in the indices given to build (), the smallest position of its cluster.
+        * Can be passed to \a extractClustersFromRoots.
+        * \param labels an optional label per position in the indices; points are only linked to points with the
+        * same label
+        */
+      void 
+      link (std::vector<int> &roots, const std::vector<unsigned int> *labels = NULL) const;
+
+      /** \brief Get the number of occupied cells. */
+      inline size_t 
+      getNumberOfCells () const { return (cells_.size ()); }
+
+    protected:
+      /** \brief A finite point while the grid is built, ordered by cell. */
+      struct PointEntry
+      {
+        boost::uint64_t key;
+        boost::int64_t x, y, z;
+        int position;
+
+        inline bool
+        operator < (const PointEntry &other) const
+        {
+          if (key != other.key) return (key < other.key);
+          if (x != other.x) return (x < other.x);
+          if (y != other.y) return (y < other.y);
+          if (z != other.z) return (z < other.z);
+          return (position < other.position);
+        }
+      };
+
+      /** \brief An occupied cell: its key, its integer coordinates and the range of its points in \a xyz_ and
+        * \a positions_.
+        */
+      struct Cell
+      {
+        boost::uint64_t key;
+        boost::int64_t x, y, z;
+        int begin, end;
+      };
+
+      /** \brief Hash key of a cell. Keeps the low 21 bits of each coordinate, so very distant cells may share a
+        * key; the coordinates are always compared after a lookup.
+        */
+      static inline boost::uint64_t
+      getKey (boost::int64_t x, boost::int64_t y, boost::int64_t z)
+      {
+        const boost::uint64_t mask = (1 << 21) - 1;
+        return ((((boost::uint64_t)x & mask) << 42) | (((boost::uint64_t)y & mask) << 21) | ((boost::uint64_t)z & mask));
+      }
+
+      /** \brief Find the cell with the given coordinates, -1 if it is empty. */
+      int
+      findCell (boost::int64_t x, boost::int64_t y, boost::int64_t z) const;
+
+      /** \brief The spatial cluster tolerance, also the cell size. */
+      float tolerance_;
+
+      /** \brief The number of indices given to build (), including the non-finite points. */
+      int nr_points_;
+
+      /** \brief The x, y, z coordinates of the finite points, in cell order. */
+      std::vector<float> xyz_;
+
+      /** \brief The position in the indices of each point in \a xyz_. */
+      std::vector<int> positions_;
+
+      /** \brief The occupied cells, sorted by key. */
+      std::vector<Cell> cells_;
+
+      /** \brief Maps a key to the first cell in \a cells_ with that key. */
+      boost::unordered_map<boost::uint64_t, int> cell_map_;
+  };
+}
+
+#endif  //#ifndef PCL_SEGMENTATION_EUCLIDEAN_CLUSTER_GRID_H_
@@ -81,6 +81,69 @@ namespace pcl
       const boost::shared_ptr<search::Search<PointT> > &tree, float tolerance, std::vector<PointIndices> &clusters, 
       unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
 
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose a region of space into clusters based on the Euclidean distance between points, using
+    * several threads. The result is the same as the one of \a extractEuclideanClusters.
+    *
+    * The radius searches run in parallel, over blocks of points, and the neighbors found are merged into a
+    * union-find structure. Clusters are numbered by their first point in \a indices, as in the serial version.
+    * \param cloud the point cloud message
+    * \param indices a list of point indices to use from \a cloud
+    * \param tree the spatial locator (e.g., kd-tree) used for nearest neighbors searching
+    * \note the tree has to be created as a spatial locator on \a cloud and \a indices, and must support
+    * concurrent searches
+    * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain
+    * \param nr_threads the number of threads to use for the radius searches
+    * \ingroup segmentation
+    */
+  template <typename PointT> void 
+  extractEuclideanClustersParallel (
+      const PointCloud<PointT> &cloud, const std::vector<int> &indices, 
+      const boost::shared_ptr<search::Search<PointT> > &tree, float tolerance, std::vector<PointIndices> &clusters, 
+      unsigned int min_pts_per_cluster, unsigned int max_pts_per_cluster, unsigned int nr_threads);
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Find the root of a position in a union-find forest, halving the path on the way
+    * \param parent the parent of each position; roots are their own parent
+    * \param i the position to find the root of
+    * \ingroup segmentation
+    */
+  PCL_EXPORTS int
+  findClusterRoot (std::vector<int> &parent, int i);
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Join the clusters of two positions in a union-find forest. The smaller of the two roots becomes the
+    * root of the joined cluster, so every root stays the smallest position of its cluster.
+    * \param parent the parent of each position; roots are their own parent
+    * \param a the first position
+    * \param b the second position
+    * \ingroup segmentation
+    */
+  PCL_EXPORTS void
+  linkClusterRoots (std::vector<int> &parent, int a, int b);
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Turn a union-find forest over the positions in \a indices into clusters
+    * \param roots for each position in \a indices, a position in the same cluster that is not larger. The roots,
+    * i.e. the smallest position of each cluster, point to themselves. Paths are compressed in place.
+    * \param indices the list of point indices the positions refer to
+    * \param header the header given to the clusters
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain
+    * \param clusters the clusters of acceptable size are appended here, ordered by their smallest position, with
+    * sorted and unique point indices (as \a extractEuclideanClusters makes them)
+    * \param cluster_roots if given, the root of each appended cluster is appended here
+    * \ingroup segmentation
+    */
+  PCL_EXPORTS void
+  extractClustersFromRoots (
+      std::vector<int> &roots, const std::vector<int> &indices, const std_msgs::Header &header,
+      unsigned int min_pts_per_cluster, unsigned int max_pts_per_cluster, std::vector<PointIndices> &clusters,
+      std::vector<int> *cluster_roots = NULL);
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief Decompose a region of space into clusters based on the euclidean distance between points, and the normal
     * angular deviation
@@ -308,7 +371,8 @@ namespace pcl
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
       /** \brief Empty constructor. */
       EuclideanClusterExtraction () : tree_ (), min_pts_per_cluster_ (1), 
-                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ())
+                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ()), threads_ (1),
+                                      use_grid_ (false)
       {};
 
       /** \brief Provide a pointer to the search object.
@@ -345,6 +409,25 @@ namespace pcl
       /** \brief Get the maximum number of points that a cluster needs to contain in order to be considered valid. */
       inline int getMaxClusterSize () { return (max_pts_per_cluster_); }
 
+      /** \brief Set the number of threads used for the radius searches. With more than one thread the clusters
+        * are built with \a extractEuclideanClustersParallel; the result does not change.
+        * \param nr_threads the number of threads to use (0 means 1)
+        */
+      inline void setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads == 0 ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used for the radius searches. */
+      inline unsigned int getNumberOfThreads () { return (threads_); }
+
+      /** \brief Set whether to link the points through a voxel grid (see \a EuclideanClusterGrid) instead of
+        * radius searches in the search object. The grid avoids building and querying a kd-tree and gives the
+        * same clusters; the search method and the number of threads are then ignored.
+        * \param use_grid true to use the voxel grid
+        */
+      inline void setUseVoxelGrid (bool use_grid) { use_grid_ = use_grid; }
+
+      /** \brief Get whether the points are linked through a voxel grid. */
+      inline bool getUseVoxelGrid () { return (use_grid_); }
+
       /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
         * \param clusters the resultant point clusters
         */
@@ -369,6 +452,12 @@ namespace pcl
       /** \brief The maximum number of points that a cluster needs to contain in order to be considered valid (default = MAXINT). */
       int max_pts_per_cluster_;
 
+      /** \brief The number of threads used for the radius searches (default = 1). */
+      unsigned int threads_;
+
+      /** \brief Link the points through a voxel grid instead of the search object (default = false). */
+      bool use_grid_;
+
       /** \brief Class getName method. */
       virtual std::string getClassName () const { return ("EuclideanClusterExtraction"); }
 
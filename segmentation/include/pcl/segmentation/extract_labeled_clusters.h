@@ -87,7 +87,8 @@ namespace pcl
       /** \brief Empty constructor. */
       LabeledEuclideanClusterExtraction () : tree_ (), min_pts_per_cluster_ (1), 
                                       max_pts_per_cluster_ (std::numeric_limits<int>::max ()),
-                                      max_label_ (std::numeric_limits<int>::max ())
+                                      max_label_ (std::numeric_limits<int>::max ()),
+                                      use_grid_ (false)
       {};
 
       /** \brief Provide a pointer to the search object.
@@ -140,6 +141,17 @@ namespace pcl
       inline unsigned int 
       getMaxLabels () { return (max_label_); }
 
+      /** \brief Set whether to link the points through a voxel grid (see \a EuclideanClusterGrid) instead of
+        * radius searches in the search object. One grid is shared by all the labels.
+        * \param[in] use_grid true to use the voxel grid
+        */
+      inline void 
+      setUseVoxelGrid (bool use_grid) { use_grid_ = use_grid; }
+
+      /** \brief Get whether the points are linked through a voxel grid. */
+      inline bool 
+      getUseVoxelGrid () { return (use_grid_); }
+
       /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
         * \param[out] labeled_clusters the resultant point clusters
         */
@@ -168,6 +180,9 @@ namespace pcl
       /** \brief The maximum number of labels we can find in this pointcloud (default = MAXINT)*/
       unsigned int max_label_;
 
+      /** \brief Link the points through a voxel grid instead of the search object (default = false). */
+      bool use_grid_;
+
       /** \brief Class getName method. */
       virtual std::string getClassName () const { return ("LabeledEuclideanClusterExtraction"); }
 
@@ -0,0 +1,249 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_SEGMENTATION_IMPL_EUCLIDEAN_CLUSTER_GRID_H_
+#define PCL_SEGMENTATION_IMPL_EUCLIDEAN_CLUSTER_GRID_H_
+
+#include "pcl/segmentation/euclidean_cluster_grid.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClustersGrid (const PointCloud<PointT> &cloud, 
+                                   const std::vector<int> &indices,
+                                   float tolerance, std::vector<PointIndices> &clusters,
+                                   unsigned int min_pts_per_cluster, 
+                                   unsigned int max_pts_per_cluster)
+{
+  EuclideanClusterGrid<PointT> grid;
+  grid.build (cloud, indices, tolerance);
+
+  std::vector<int> roots;
+  grid.link (roots);
+  extractClustersFromRoots (roots, indices, cloud.header, min_pts_per_cluster, max_pts_per_cluster, clusters);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractLabeledEuclideanClustersGrid (const PointCloud<PointT> &cloud, 
+                                          float tolerance, 
+                                          std::vector<std::vector<PointIndices> > &labeled_clusters,
+                                          unsigned int min_pts_per_cluster, 
+                                          unsigned int max_pts_per_cluster)
+{
+  std::vector<int> indices (cloud.points.size ());
+  std::vector<unsigned int> labels (cloud.points.size ());
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    indices[i] = (int)i;
+    labels[i] = cloud.points[i].label;
+  }
+
+  // One grid serves all the labels
+  EuclideanClusterGrid<PointT> grid;
+  grid.build (cloud, indices, tolerance);
+
+  std::vector<int> roots;
+  grid.link (roots, &labels);
+
+  std::vector<PointIndices> clusters;
+  std::vector<int> cluster_roots;
+  extractClustersFromRoots (roots, indices, cloud.header, min_pts_per_cluster, max_pts_per_cluster, clusters, &cluster_roots);
+
+  for (size_t c = 0; c < clusters.size (); ++c)
+  {
+    const unsigned int label = labels[cluster_roots[c]];
+    if (label >= labeled_clusters.size ())
+      labeled_clusters.resize (label + 1);
+    labeled_clusters[label].push_back (clusters[c]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::EuclideanClusterGrid<PointT>::build (const PointCloud &cloud, const std::vector<int> &indices, float tolerance)
+{
+  tolerance_ = tolerance;
+  nr_points_ = (int)indices.size ();
+  xyz_.clear ();
+  positions_.clear ();
+  cells_.clear ();
+  cell_map_.clear ();
+
+  if (!(tolerance > 0))
+  {
+    PCL_ERROR ("[pcl::EuclideanClusterGrid::build] Invalid cluster tolerance %f!\n", tolerance);
+    return;
+  }
+
+  // Compute the cell of every finite point and sort the points by cell
+  const double inverse_size = 1.0 / tolerance;
+  std::vector<PointEntry> entries;
+  entries.reserve (indices.size ());
+  for (int i = 0; i < nr_points_; ++i)
+  {
+    const PointT &p = cloud.points[indices[i]];
+    if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z))
+      continue;
+
+    PointEntry e;
+    e.x = (boost::int64_t)floor (p.x * inverse_size);
+    e.y = (boost::int64_t)floor (p.y * inverse_size);
+    e.z = (boost::int64_t)floor (p.z * inverse_size);
+    e.key = getKey (e.x, e.y, e.z);
+    e.position = i;
+    entries.push_back (e);
+  }
+  std::sort (entries.begin (), entries.end ());
+
+  // Copy the points in cell order and delimit the cells
+  xyz_.resize (entries.size () * 3);
+  positions_.resize (entries.size ());
+  for (size_t i = 0; i < entries.size (); ++i)
+  {
+    const PointEntry &e = entries[i];
+    const PointT &p = cloud.points[indices[e.position]];
+    xyz_[i * 3 + 0] = p.x;
+    xyz_[i * 3 + 1] = p.y;
+    xyz_[i * 3 + 2] = p.z;
+    positions_[i] = e.position;
+
+    if (i == 0 || e.key != entries[i - 1].key || e.x != entries[i - 1].x || e.y != entries[i - 1].y || e.z != entries[i - 1].z)
+    {
+      Cell cell;
+      cell.key = e.key;
+      cell.x = e.x;
+      cell.y = e.y;
+      cell.z = e.z;
+      cell.begin = cell.end = (int)i;
+      if (i == 0 || e.key != entries[i - 1].key)
+        cell_map_[e.key] = (int)cells_.size ();
+      cells_.push_back (cell);
+    }
+    cells_.back ().end++;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::EuclideanClusterGrid<PointT>::findCell (boost::int64_t x, boost::int64_t y, boost::int64_t z) const
+{
+  const boost::uint64_t key = getKey (x, y, z);
+  boost::unordered_map<boost::uint64_t, int>::const_iterator it = cell_map_.find (key);
+  if (it == cell_map_.end ())
+    return (-1);
+
+  // Cells sharing a key are stored next to each other
+  for (int c = it->second; c < (int)cells_.size () && cells_[c].key == key; ++c)
+    if (cells_[c].x == x && cells_[c].y == y && cells_[c].z == z)
+      return (c);
+  return (-1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::EuclideanClusterGrid<PointT>::link (std::vector<int> &roots, const std::vector<unsigned int> *labels) const
+{
+  roots.resize (nr_points_);
+  for (int i = 0; i < nr_points_; ++i)
+    roots[i] = i;
+
+  // Union-find over the points in cell order
+  const int nr_entries = (int)positions_.size ();
+  std::vector<int> parent (nr_entries);
+  for (int i = 0; i < nr_entries; ++i)
+    parent[i] = i;
+
+  // Each pair of neighboring cells is visited once: a cell is compared with itself and with the 13 cells that
+  // come after it in (x, y, z) order
+  static const int offsets[13][3] = { { 0, 0, 1}, { 0, 1,-1}, { 0, 1, 0}, { 0, 1, 1},
+                                      { 1,-1,-1}, { 1,-1, 0}, { 1,-1, 1}, { 1, 0,-1}, { 1, 0, 0},
+                                      { 1, 0, 1}, { 1, 1,-1}, { 1, 1, 0}, { 1, 1, 1} };
+  const float sqr_tolerance = tolerance_ * tolerance_;
+  const float *xyz = xyz_.empty () ? NULL : &xyz_[0];
+
+  for (size_t c = 0; c < cells_.size (); ++c)
+  {
+    const Cell &cell = cells_[c];
+    for (int o = -1; o < 13; ++o)
+    {
+      int other = (int)c;
+      if (o >= 0)
+      {
+        other = findCell (cell.x + offsets[o][0], cell.y + offsets[o][1], cell.z + offsets[o][2]);
+        if (other == -1)
+          continue;
+      }
+
+      for (int a = cell.begin; a < cell.end; ++a)
+      {
+        const float *pa = xyz + a * 3;
+        // Within the same cell only the pairs after a are left
+        for (int b = (o == -1 ? a + 1 : cells_[other].begin); b < cells_[other].end; ++b)
+        {
+          if (labels && (*labels)[positions_[a]] != (*labels)[positions_[b]])
+            continue;
+
+          const float *pb = xyz + b * 3;
+          const float dx = pa[0] - pb[0], dy = pa[1] - pb[1], dz = pa[2] - pb[2];
+          if (dx * dx + dy * dy + dz * dz > sqr_tolerance)
+            continue;
+
+          linkClusterRoots (parent, a, b);
+        }
+      }
+    }
+  }
+
+  // Report every point with the smallest position of its cluster
+  std::vector<int> smallest (nr_entries, nr_points_);
+  for (int i = 0; i < nr_entries; ++i)
+  {
+    const int r = findClusterRoot (parent, i);
+    parent[i] = r;
+    smallest[r] = std::min (smallest[r], positions_[i]);
+  }
+  for (int i = 0; i < nr_entries; ++i)
+    roots[positions_[i]] = smallest[parent[i]];
+}
+
+#define PCL_INSTANTIATE_EuclideanClusterGrid(T) template class PCL_EXPORTS pcl::EuclideanClusterGrid<T>;
+#define PCL_INSTANTIATE_extractEuclideanClustersGrid(T) template void PCL_EXPORTS pcl::extractEuclideanClustersGrid<T>(const pcl::PointCloud<T> &, const std::vector<int> &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractLabeledEuclideanClustersGrid(T) template void PCL_EXPORTS pcl::extractLabeledEuclideanClustersGrid<T>(const pcl::PointCloud<T> &, float , std::vector<std::vector<pcl::PointIndices> > &, unsigned int, unsigned int);
+
+#endif        // PCL_SEGMENTATION_IMPL_EUCLIDEAN_CLUSTER_GRID_H_
@@ -39,6 +39,7 @@
 #define PCL_SEGMENTATION_IMPL_EXTRACT_CLUSTERS_H_
 
 #include "pcl/segmentation/extract_clusters.h"
+#include "pcl/segmentation/impl/euclidean_cluster_grid.hpp"
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -79,7 +80,8 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
         continue;
       }
 
-      for (size_t j = 1; j < nn_indices.size (); ++j)             // nn_indices[0] should be sq_idx
+      // nn_indices[0] is usually sq_idx, which is processed already, but not always: duplicate points tie
+      for (size_t j = 0; j < nn_indices.size (); ++j)
       {
         if (processed[nn_indices[j]])                             // Has this point been processed before ?
           continue;
@@ -164,7 +166,8 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
         continue;
       }
 
-      for (size_t j = 1; j < nn_indices.size (); ++j)             // nn_indices[0] should be sq_idx
+      // nn_indices[0] is usually sq_idx, which is processed already, but not always: duplicate points tie
+      for (size_t j = 0; j < nn_indices.size (); ++j)
       {
         if (processed[nn_indices[j]])                             // Has this point been processed before ?
           continue;
@@ -196,6 +199,82 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClustersParallel (const PointCloud<PointT> &cloud, 
+                                       const std::vector<int> &indices,
+                                       const boost::shared_ptr<search::Search<PointT> > &tree,
+                                       float tolerance, std::vector<PointIndices> &clusters,
+                                       unsigned int min_pts_per_cluster, 
+                                       unsigned int max_pts_per_cluster,
+                                       unsigned int nr_threads)
+{
+  if (tree->getInputCloud ()->points.size () != cloud.points.size ())
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersParallel] Tree built for a different point cloud dataset (%lu) than the input cloud (%lu)!\n", (unsigned long)tree->getInputCloud ()->points.size (), (unsigned long)cloud.points.size ());
+    return;
+  }
+  if (tree->getIndices ()->size () != indices.size ())
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersParallel] Tree built for a different set of indices (%lu) than the input set (%lu)!\n", (unsigned long)tree->getIndices ()->size (), (unsigned long)indices.size ());
+    return;
+  }
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  const int nr_points = (int)indices.size ();
+
+  // Union-find over positions in indices; every point starts as its own cluster
+  std::vector<int> parent (nr_points);
+  for (int i = 0; i < nr_points; ++i)
+    parent[i] = i;
+
+  // The neighbors of a block of points are searched in parallel, then merged. Blocks bound the memory used
+  // for the neighbor lists.
+  const int block_size = 16384;
+  std::vector<std::vector<int> > neighbors (std::min (block_size, nr_points));
+  bool failed = false;
+  for (int start = 0; start < nr_points; start += block_size)
+  {
+    const int end = std::min (nr_points, start + block_size);
+
+#pragma omp parallel num_threads (nr_threads)
+    {
+      std::vector<float> nn_distances;
+#pragma omp for schedule (dynamic, 256)
+      for (int i = start; i < end; ++i)
+      {
+        std::vector<int> &nn_indices = neighbors[i - start];
+        int ret = tree->radiusSearch (i, tolerance, nn_indices, nn_distances);
+        if (ret == -1)
+        {
+#pragma omp critical
+          failed = true;
+        }
+        if (ret <= 0)
+          nn_indices.clear ();
+        else if ((size_t)ret < nn_indices.size ())
+          nn_indices.resize (ret);
+      }
+    }
+
+    if (failed)
+    {
+      PCL_ERROR ("[pcl::extractEuclideanClustersParallel] Received error code -1 from radiusSearch\n");
+      return;
+    }
+
+    for (int i = start; i < end; ++i)
+    {
+      const std::vector<int> &nn_indices = neighbors[i - start];
+      for (size_t j = 0; j < nn_indices.size (); ++j)
+        linkClusterRoots (parent, i, nn_indices[j]);
+    }
+  }
+
+  extractClustersFromRoots (parent, indices, cloud.header, min_pts_per_cluster, max_pts_per_cluster, clusters);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -211,6 +290,14 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
     return;
   }
 
+  if (use_grid_)
+  {
+    extractEuclideanClustersGrid (*input_, *indices_, (float)cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+    std::sort (clusters.rbegin (), clusters.rend (), comparePointClusters);
+    deinitCompute ();
+    return;
+  }
+
   // Initialize the spatial locator
   if (!tree_)
   {
@@ -222,7 +309,10 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_, indices_);
-  extractEuclideanClusters (*input_, *indices_, tree_, cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+  if (threads_ > 1)
+    extractEuclideanClustersParallel (*input_, *indices_, tree_, (float)cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
+  else
+    extractEuclideanClusters (*input_, *indices_, tree_, cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
 
   //tree_->setInputCloud (input_);
   //extractEuclideanClusters (*input_, tree_, cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
@@ -236,5 +326,6 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 #define PCL_INSTANTIATE_EuclideanClusterExtraction(T) template class PCL_EXPORTS pcl::EuclideanClusterExtraction<T>;
 #define PCL_INSTANTIATE_extractEuclideanClusters(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
 #define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClustersParallel(T) template void PCL_EXPORTS pcl::extractEuclideanClustersParallel<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
 
 #endif        // PCL_EXTRACT_CLUSTERS_IMPL_H_
@@ -38,6 +38,7 @@
 #define PCL_SEGMENTATION_IMPL_EXTRACT_LABELED_CLUSTERS_H_
 
 #include "pcl/segmentation/extract_labeled_clusters.h"
+#include "pcl/segmentation/impl/euclidean_cluster_grid.hpp"
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -130,18 +131,23 @@ pcl::LabeledEuclideanClusterExtraction<PointT>::extract (std::vector<std::vector
     return;
   }
 
-  // Initialize the spatial locator
-  if (!tree_)
+  if (use_grid_)
+    extractLabeledEuclideanClustersGrid (*input_, (float)cluster_tolerance_, labeled_clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+  else
   {
-    if (input_->isOrganized ())
-      tree_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
-    else
-      tree_.reset (new pcl::search::KdTree<PointT> (false));
-  }
+    // Initialize the spatial locator
+    if (!tree_)
+    {
+      if (input_->isOrganized ())
+        tree_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
+      else
+        tree_.reset (new pcl::search::KdTree<PointT> (false));
+    }
 
-  // Send the input dataset to the spatial locator
-  tree_->setInputCloud (input_);
-  extractLabeledEuclideanClusters (*input_, tree_, cluster_tolerance_, labeled_clusters, min_pts_per_cluster_, max_pts_per_cluster_, max_label_);
+    // Send the input dataset to the spatial locator
+    tree_->setInputCloud (input_);
+    extractLabeledEuclideanClusters (*input_, tree_, cluster_tolerance_, labeled_clusters, min_pts_per_cluster_, max_pts_per_cluster_, max_label_);
+  }
 
   // Sort the clusters based on their size (largest one first)
   for(unsigned int i = 0; i < labeled_clusters.size(); i++)
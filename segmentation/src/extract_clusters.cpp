@@ -42,9 +42,94 @@
 #include "pcl/segmentation/extract_labeled_clusters.h"
 #include "pcl/segmentation/impl/extract_labeled_clusters.hpp"
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::findClusterRoot (std::vector<int> &parent, int i)
+{
+  while (parent[i] != i)
+    i = parent[i] = parent[parent[i]];
+  return (i);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::linkClusterRoots (std::vector<int> &parent, int a, int b)
+{
+  a = findClusterRoot (parent, a);
+  b = findClusterRoot (parent, b);
+  if (a < b)
+    parent[b] = a;
+  else if (b < a)
+    parent[a] = b;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::extractClustersFromRoots (std::vector<int> &roots, const std::vector<int> &indices,
+                               const std_msgs::Header &header,
+                               unsigned int min_pts_per_cluster, unsigned int max_pts_per_cluster,
+                               std::vector<PointIndices> &clusters, std::vector<int> *cluster_roots)
+{
+  const int nr_points = (int)roots.size ();
+
+  // Roots are the smallest position of their cluster, so numbering the roots in order numbers the clusters
+  // by their first point, like the region growing does
+  std::vector<int> label (nr_points);
+  std::vector<unsigned int> sizes;
+  for (int i = 0; i < nr_points; ++i)
+  {
+    const int r = findClusterRoot (roots, i);
+    roots[i] = r;
+
+    if (r == i)
+    {
+      label[i] = (int)sizes.size ();
+      sizes.push_back (0);
+    }
+    else
+      label[i] = label[r];
+    sizes[label[i]]++;
+  }
+
+  // Keep the clusters of acceptable size
+  const size_t first = clusters.size ();
+  std::vector<int> slot (sizes.size (), -1);
+  for (size_t c = 0; c < sizes.size (); ++c)
+  {
+    if (sizes[c] >= min_pts_per_cluster && sizes[c] <= max_pts_per_cluster)
+    {
+      slot[c] = (int)(clusters.size () - first);
+      clusters.push_back (pcl::PointIndices ());
+      clusters.back ().indices.reserve (sizes[c]);
+      clusters.back ().header = header;
+    }
+  }
+
+  for (int i = 0; i < nr_points; ++i)
+  {
+    const int c = slot[label[i]];
+    if (c == -1)
+      continue;
+    if (cluster_roots && clusters[first + c].indices.empty ())
+      cluster_roots->push_back (i);
+    clusters[first + c].indices.push_back (indices[i]);
+  }
+
+  for (size_t c = first; c < clusters.size (); ++c)
+  {
+    std::vector<int> &r = clusters[c].indices;
+    std::sort (r.begin (), r.end ());
+    r.erase (std::unique (r.begin (), r.end ()), r.end ());
+  }
+}
+
 // Instantiations of specific point types
 PCL_INSTANTIATE(EuclideanClusterExtraction, PCL_XYZ_POINT_TYPES)
 PCL_INSTANTIATE(extractEuclideanClusters, PCL_XYZ_POINT_TYPES);
 PCL_INSTANTIATE(extractEuclideanClusters_indices, PCL_XYZ_POINT_TYPES);
+PCL_INSTANTIATE(extractEuclideanClustersParallel, PCL_XYZ_POINT_TYPES);
+PCL_INSTANTIATE(EuclideanClusterGrid, PCL_XYZ_POINT_TYPES);
+PCL_INSTANTIATE(extractEuclideanClustersGrid, PCL_XYZ_POINT_TYPES);
 PCL_INSTANTIATE(LabeledEuclideanClusterExtraction, PCL_XYZL_POINT_TYPES);
 PCL_INSTANTIATE(extractLabeledEuclideanClusters, PCL_XYZL_POINT_TYPES);
+PCL_INSTANTIATE(extractLabeledEuclideanClustersGrid, PCL_XYZL_POINT_TYPES);
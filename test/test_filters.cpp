@@ -49,6 +49,7 @@
 #include <pcl/filters/conditional_removal.h>
 #include <pcl/filters/random_sample.h>
 #include <pcl/filters/crop_box.h>
+#include <pcl/search/voxel_hash.h>
 
 #include "pcl/common/transforms.h"
 #include "pcl/common/eigen.h"
@@ -873,6 +874,33 @@ TEST (RadiusOutlierRemoval, Filters)
   EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].x, -0.077893, 1e-4);
   EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].y, 0.16039, 1e-4);
   EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].z, -0.021299, 1e-4);
+
+  // The voxel hash counts and multiple threads give the same result
+  RadiusOutlierRemoval<PointXYZ> outrem_vh (true);
+  outrem_vh.setInputCloud (cloud);
+  outrem_vh.setRadiusSearch (0.02);
+  outrem_vh.setMinNeighborsInRadius (15);
+  outrem_vh.setSearchMethod (search::VoxelHash<PointXYZ>::Ptr (new search::VoxelHash<PointXYZ> (0.02)));
+  outrem_vh.setNumberOfThreads (4);
+  outrem_vh.filter (cloud_out);
+
+  EXPECT_EQ ((int)cloud_out.points.size (), 307);
+  EXPECT_EQ (*outrem_vh.getRemovedIndices (), *outrem_.getRemovedIndices ());
+  EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].x, -0.077893, 1e-4);
+  EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].y, 0.16039, 1e-4);
+  EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].z, -0.021299, 1e-4);
+
+  RadiusOutlierRemoval<PointCloud2> outrem2_vh (true);
+  outrem2_vh.setInputCloud (cloud_blob);
+  outrem2_vh.setRadiusSearch (0.02);
+  outrem2_vh.setMinNeighborsInRadius (15);
+  outrem2_vh.setSearchMethod (search::VoxelHash<PointXYZ>::Ptr (new search::VoxelHash<PointXYZ> (0.02)));
+  outrem2_vh.setNumberOfThreads (4);
+  outrem2_vh.filter (cloud_out2);
+
+  fromROSMsg (cloud_out2, cloud_out);
+  EXPECT_EQ ((int)cloud_out.points.size (), 307);
+  EXPECT_EQ (*outrem2_vh.getRemovedIndices (), *outrem2_.getRemovedIndices ());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1214,6 +1242,47 @@ TEST (StatisticalOutlierRemoval, Filters)
   EXPECT_NEAR (output.points[output.points.size () - 1].y, 0.17516, 1e-4);
   EXPECT_NEAR (output.points[output.points.size () - 1].z, -0.0444, 1e-4);
 
+  // Multiple threads and kept distances do not change the results while sweeping the threshold
+  PointCloud<PointXYZ> output_mt;
+  StatisticalOutlierRemoval<PointXYZ> outrem_mt;
+  outrem_mt.setInputCloud (cloud);
+  outrem_mt.setMeanK (50);
+  outrem_mt.setNumberOfThreads (4);
+  outrem_mt.setKeepDistances (true);
+
+  PointCloud2 output2_mt;
+  StatisticalOutlierRemoval<PointCloud2> outrem2_mt;
+  outrem2_mt.setInputCloud (cloud_blob);
+  outrem2_mt.setMeanK (50);
+  outrem2_mt.setNumberOfThreads (4);
+  outrem2_mt.setKeepDistances (true);
+
+  outrem.setNegative (false);
+  outrem2.setNegative (false);
+  const double std_muls[] = {0.5, 1.0, 2.0};
+  for (size_t t = 0; t < sizeof (std_muls) / sizeof (std_muls[0]); ++t)
+  {
+    outrem.setStddevMulThresh (std_muls[t]);
+    outrem.filter (output);
+    outrem_mt.setStddevMulThresh (std_muls[t]);
+    outrem_mt.filter (output_mt);
+
+    ASSERT_EQ (output_mt.points.size (), output.points.size ());
+    for (size_t i = 0; i < output.points.size (); ++i)
+    {
+      EXPECT_EQ (output_mt.points[i].x, output.points[i].x);
+      EXPECT_EQ (output_mt.points[i].y, output.points[i].y);
+      EXPECT_EQ (output_mt.points[i].z, output.points[i].z);
+    }
+
+    outrem2.setStddevMulThresh (std_muls[t]);
+    outrem2.filter (output2);
+    outrem2_mt.setStddevMulThresh (std_muls[t]);
+    outrem2_mt.filter (output2_mt);
+
+    EXPECT_EQ (output2_mt.width, output2.width);
+    EXPECT_TRUE (output2_mt.data == output2.data);
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
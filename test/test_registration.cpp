@@ -403,6 +403,24 @@ TEST (PCL, SampleConsensusInitialAlignment)
   reg.align (cloud_reg);
   EXPECT_EQ ((int)cloud_reg.points.size (), (int)cloud_source.points.size ());
   EXPECT_EQ (reg.getFitnessScore () < 0.0005, true);
+
+  // Evaluating the hypotheses with several threads gives the alignment of a single thread, for the same seed
+  PointCloud<PointXYZ> cloud_reg_parallel;
+  srand (12345);
+  reg.setNumberOfThreads (1);
+  reg.align (cloud_reg);
+  const Eigen::Matrix4f serial_transformation = reg.getFinalTransformation ();
+  const double serial_score = reg.getFitnessScore ();
+
+  srand (12345);
+  reg.setNumberOfThreads (4);
+  reg.align (cloud_reg_parallel);
+  EXPECT_EQ (reg.getFinalTransformation (), serial_transformation);
+  EXPECT_EQ (reg.getFitnessScore (), serial_score);
+  EXPECT_LT (reg.getFitnessScore (), 0.0005);
+  ASSERT_EQ (cloud_reg_parallel.points.size (), cloud_reg.points.size ());
+  for (size_t i = 0; i < cloud_reg.points.size (); ++i)
+    EXPECT_EQ (cloud_reg_parallel.points[i].getVector3fMap (), cloud_reg.points[i].getVector3fMap ());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -40,14 +40,21 @@
 #include <gtest/gtest.h>
 
 #include <pcl/point_types.h>
+#include <pcl/common/transforms.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/registration/correspondence_estimation.h>
 #include <pcl/registration/correspondence_rejection_distance.h>
 #include <pcl/registration/correspondence_rejection.h>
+#include <pcl/registration/correspondence_rejection_median_distance.h>
 #include <pcl/registration/correspondence_rejection_one_to_one.h>
+#include <pcl/registration/correspondence_rejection_pipeline.h>
 #include <pcl/registration/correspondence_rejection_sample_consensus.h>
 #include <pcl/registration/correspondence_rejection_trimmed.h>
+#include <pcl/registration/elch.h>
+#include <pcl/registration/gicp.h>
+#include <pcl/registration/prepared_target.h>
 #include <pcl/registration/transformation_estimation_lm.h>
+#include <pcl/registration/transformation_estimation_point_to_plane_lls.h>
 #include <pcl/registration/transformation_estimation_svd.h>
 
 #include "test_registration_api_data.h"
@@ -215,6 +222,63 @@ TEST (PCL, CorrespondenceRejectorTrimmed)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, CorrespondenceRejectorPipeline)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr source (new pcl::PointCloud<pcl::PointXYZ>(cloud_source));
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ>(cloud_target));
+
+  // re-do correspondence estimation
+  boost::shared_ptr<pcl::Correspondences> correspondences (new pcl::Correspondences);
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> corr_est;
+  corr_est.setInputCloud (source);
+  corr_est.setInputTarget (target);
+  corr_est.determineCorrespondences (*correspondences);
+
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorDistance> corr_rej_dist (new pcl::registration::CorrespondenceRejectorDistance);
+  corr_rej_dist->setMaximumDistance (rej_dist_max_dist);
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorMedianDistance> corr_rej_median (new pcl::registration::CorrespondenceRejectorMedianDistance);
+  corr_rej_median->setMedianFactor (4.0);
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorOneToOne> corr_rej_one_to_one (new pcl::registration::CorrespondenceRejectorOneToOne);
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorTrimmed> corr_rej_trimmed (new pcl::registration::CorrespondenceRejectorTrimmed);
+  corr_rej_trimmed->setOverlapRadio (rej_trimmed_overlap);
+
+  // apply the rejectors one after the other
+  pcl::Correspondences sequential, tmp;
+  corr_rej_median->getRemainingCorrespondences (*correspondences, tmp);
+  corr_rej_dist->getRemainingCorrespondences (tmp, sequential);
+  corr_rej_one_to_one->getRemainingCorrespondences (sequential, tmp);
+  corr_rej_trimmed->getRemainingCorrespondences (tmp, sequential);
+  EXPECT_GT ((int)sequential.size (), 0);
+
+  pcl::registration::CorrespondenceRejectorPipeline pipeline;
+  pipeline.addRejector (corr_rej_median);
+  pipeline.addRejector (corr_rej_dist);
+  pipeline.addRejector (corr_rej_one_to_one);
+  pipeline.addRejector (corr_rej_trimmed);
+  pipeline.setInputCorrespondences (correspondences);
+
+  for (unsigned int nr_threads = 1; nr_threads <= 4; nr_threads *= 2)
+  {
+    pipeline.setNumberOfThreads (nr_threads);
+    pcl::Correspondences fused;
+    pipeline.getCorrespondences (fused);
+
+    EXPECT_EQ (fused.size (), sequential.size ());
+    if (fused.size () == sequential.size ())
+      for (size_t i = 0; i < fused.size (); ++i)
+      {
+        EXPECT_EQ (fused[i].index_query, sequential[i].index_query);
+        EXPECT_EQ (fused[i].index_match, sequential[i].index_match);
+      }
+  }
+
+  // in place filtering gives the same result
+  pcl::Correspondences in_place = *correspondences;
+  pipeline.getRemainingCorrespondences (in_place, in_place);
+  EXPECT_EQ (in_place.size (), sequential.size ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, TransformationEstimationSVD)
 {
@@ -240,6 +304,153 @@ TEST (PCL, TransformationEstimationSVD)
       EXPECT_NEAR (transform_res_from_SVD(i, j), transform_from_SVD[i][j], 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Random points with random normals in a unit cube at offset, and the same points moved by transform: all of
+// them (moved), those of the odd source points (matched), and these again in reverse order with the even ones
+// left in place (target), as selected by the indices and correspondences
+void
+makeKnownTransformPairs (const Eigen::Vector3f &offset, const Eigen::Affine3f &transform,
+                         pcl::PointCloud<pcl::PointNormal> &source, pcl::PointCloud<pcl::PointNormal> &moved,
+                         pcl::PointCloud<pcl::PointNormal> &matched, pcl::PointCloud<pcl::PointNormal> &target,
+                         std::vector<int> &indices_src, std::vector<int> &indices_tgt,
+                         pcl::Correspondences &correspondences)
+{
+  srand (3);
+  source.points.clear ();
+  for (int i = 0; i < 2000; ++i)
+  {
+    pcl::PointNormal p;
+    p.getVector3fMap () = offset + Eigen::Vector3f (rand () / (float)RAND_MAX, rand () / (float)RAND_MAX, rand () / (float)RAND_MAX);
+    p.getNormalVector3fMap () = Eigen::Vector3f::Random ().normalized ();
+    source.points.push_back (p);
+  }
+  source.width = (uint32_t)source.points.size ();
+  source.height = 1;
+
+  pcl::transformPointCloudWithNormals (source, moved, transform.matrix ());
+
+  matched.points.clear ();
+  target = moved;
+  indices_src.clear ();
+  indices_tgt.clear ();
+  correspondences.clear ();
+  const int nr_points = (int)source.points.size ();
+  for (int i = 1; i < nr_points; i += 2)
+  {
+    matched.points.push_back (moved.points[i]);
+    target.points[nr_points - i] = moved.points[i];
+    indices_src.push_back (i);
+    indices_tgt.push_back (nr_points - i);
+    correspondences.push_back (pcl::Correspondence (i, nr_points - i, 0));
+  }
+  matched.width = (uint32_t)matched.points.size ();
+  matched.height = 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TransformationEstimationSVDKnownTransform)
+{
+  const Eigen::Affine3f transform = Eigen::Translation3f (0.1f, -0.2f, 0.05f) *
+                                    Eigen::AngleAxisf (0.3f, Eigen::Vector3f (1, 2, 3).normalized ());
+
+  // Near the origin, and far from it where the float coordinates limit the accuracy of the translation
+  const Eigen::Vector3f offsets[] = {Eigen::Vector3f::Zero (), Eigen::Vector3f (1000, -500, 0)};
+  const float translation_eps[] = {1e-4f, 1e-2f};
+  for (int o = 0; o < 2; ++o)
+  {
+    pcl::PointCloud<pcl::PointNormal> source, moved, matched, target;
+    std::vector<int> indices_src, indices_tgt;
+    pcl::Correspondences correspondences;
+    makeKnownTransformPairs (offsets[o], transform, source, moved, matched, target, indices_src, indices_tgt,
+                             correspondences);
+
+    for (unsigned int threads = 1; threads <= 4; threads += 3)
+    {
+      pcl::registration::TransformationEstimationSVD<pcl::PointNormal, pcl::PointNormal> trans_est_svd;
+      trans_est_svd.setNumberOfThreads (threads);
+
+      Eigen::Matrix4f results[4];
+      trans_est_svd.estimateRigidTransformation (source, moved, results[0]);
+      trans_est_svd.estimateRigidTransformation (source, indices_src, matched, results[1]);
+      trans_est_svd.estimateRigidTransformation (source, indices_src, target, indices_tgt, results[2]);
+      trans_est_svd.estimateRigidTransformation (source, target, correspondences, results[3]);
+
+      for (int r = 0; r < 4; ++r)
+      {
+        for (int i = 0; i < 3; ++i)
+        {
+          for (int j = 0; j < 3; ++j)
+            EXPECT_NEAR (results[r] (i, j), transform (i, j), 1e-5);
+          EXPECT_NEAR (results[r] (i, 3), transform (i, 3), translation_eps[o]);
+        }
+        EXPECT_EQ (results[r].row (3), Eigen::RowVector4f (0, 0, 0, 1));
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TransformationEstimationPointToPlaneLLSKnownTransform)
+{
+  // The linear approximation needs a small rotation
+  const Eigen::Affine3f transform = Eigen::Translation3f (0.01f, -0.02f, 0.005f) *
+                                    Eigen::AngleAxisf (0.001f, Eigen::Vector3f (1, 2, 3).normalized ());
+
+  // Far from the origin the rotation columns of the system are much larger than the translation columns, which
+  // makes the system ill-conditioned
+  const Eigen::Vector3f offsets[] = {Eigen::Vector3f::Zero (), Eigen::Vector3f (100, 0, 0)};
+  for (int o = 0; o < 2; ++o)
+  {
+    pcl::PointCloud<pcl::PointNormal> source, moved, matched, target;
+    std::vector<int> indices_src, indices_tgt;
+    pcl::Correspondences correspondences;
+    makeKnownTransformPairs (offsets[o], transform, source, moved, matched, target, indices_src, indices_tgt,
+                             correspondences);
+
+    for (unsigned int threads = 1; threads <= 4; threads += 3)
+    {
+      pcl::registration::TransformationEstimationPointToPlaneLLS<pcl::PointNormal, pcl::PointNormal> trans_est_lls;
+      trans_est_lls.setNumberOfThreads (threads);
+
+      Eigen::Matrix4f results[4];
+      trans_est_lls.estimateRigidTransformation (source, moved, results[0]);
+      trans_est_lls.estimateRigidTransformation (source, indices_src, matched, results[1]);
+      trans_est_lls.estimateRigidTransformation (source, indices_src, target, indices_tgt, results[2]);
+      trans_est_lls.estimateRigidTransformation (source, target, correspondences, results[3]);
+
+      for (int r = 0; r < 4; ++r)
+        for (int i = 0; i < 4; ++i)
+          for (int j = 0; j < 4; ++j)
+            EXPECT_NEAR (results[r] (i, j), transform (i, j), 1e-4);
+    }
+  }
+
+  // Correspondences on a single plane don't constrain the motion within the plane, the singular system gives the
+  // smallest motion that moves the plane onto its target
+  pcl::PointCloud<pcl::PointNormal> plane_src, plane_tgt;
+  for (int i = 0; i < 10; ++i)
+    for (int j = 0; j < 10; ++j)
+    {
+      pcl::PointNormal p;
+      p.x = 0.1f * float (i);
+      p.y = 0.1f * float (j);
+      p.z = 0;
+      p.normal_x = p.normal_y = 0;
+      p.normal_z = 1;
+      plane_src.push_back (p);
+      p.z = 0.5f;
+      plane_tgt.push_back (p);
+    }
+
+  pcl::registration::TransformationEstimationPointToPlaneLLS<pcl::PointNormal, pcl::PointNormal> trans_est_lls;
+  Eigen::Matrix4f result;
+  trans_est_lls.estimateRigidTransformation (plane_src, plane_tgt, result);
+  const Eigen::Matrix4f expected = Eigen::Affine3f (Eigen::Translation3f (0, 0, 0.5f)).matrix ();
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (result (i, j), expected (i, j), 1e-5);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, TransformationEstimationLM)
 {
@@ -273,6 +484,125 @@ TEST (PCL, TransformationEstimationLM)
 //      EXPECT_NEAR (transform_res_from_LM(i, j), transform_from_LM[i][j], 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PreparedTarget)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr source (new pcl::PointCloud<pcl::PointXYZ>(cloud_source));
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ>(cloud_target));
+
+  pcl::registration::PreparedTarget<pcl::PointXYZ>::Ptr prepared (new pcl::registration::PreparedTarget<pcl::PointXYZ>);
+  ASSERT_TRUE (prepared->setInputCloud (target));
+  prepared->setNumberOfThreads (4);
+  ASSERT_TRUE (prepared->computeCovariances (20, 0.001));
+  ASSERT_TRUE (prepared->computeNDTGrid (Eigen::Vector2f (0, 0), Eigen::Vector2f (1, 1), Eigen::Vector2f (0.05f, 0.05f)));
+  EXPECT_EQ (prepared->getCovariances ().size (), target->size ());
+  EXPECT_EQ (prepared->getNormals ()->size (), target->size ());
+  EXPECT_TRUE (prepared->hasCovariances (20, 0.001));
+  EXPECT_FALSE (prepared->hasCovariances (10, 0.001));
+
+  // GICP on a prepared target gives the same result as on a plain target
+  pcl::PointCloud<pcl::PointXYZ> output;
+  pcl::GeneralizedIterativeClosestPoint<pcl::PointXYZ, pcl::PointXYZ> gicp;
+  gicp.setInputCloud (source);
+  gicp.setInputTarget (target);
+  gicp.setMaximumIterations (10);
+  gicp.align (output);
+  Eigen::Matrix4f transformation = gicp.getFinalTransformation ();
+
+  pcl::GeneralizedIterativeClosestPoint<pcl::PointXYZ, pcl::PointXYZ> gicp_prepared;
+  gicp_prepared.setInputCloud (source);
+  gicp_prepared.setPreparedTarget (prepared);
+  gicp_prepared.setMaximumIterations (10);
+  gicp_prepared.align (output);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (gicp_prepared.getFinalTransformation () (i, j), transformation (i, j), 1e-6);
+
+  // A saved and loaded target holds the same data
+  const std::string file_name = "test_prepared_target.bin";
+  ASSERT_TRUE (prepared->save (file_name));
+  pcl::registration::PreparedTarget<pcl::PointXYZ> loaded;
+  ASSERT_TRUE (loaded.load (file_name));
+  remove (file_name.c_str ());
+
+  ASSERT_EQ (loaded.getInputCloud ()->size (), target->size ());
+  for (size_t i = 0; i < target->size (); ++i)
+    EXPECT_EQ (loaded.getInputCloud ()->points[i].getVector3fMap (), prepared->getInputCloud ()->points[i].getVector3fMap ());
+  EXPECT_TRUE (loaded.hasCovariances (20, 0.001));
+  ASSERT_EQ (loaded.getCovariances ().size (), prepared->getCovariances ().size ());
+  for (size_t i = 0; i < loaded.getCovariances ().size (); ++i)
+    EXPECT_EQ (loaded.getCovariances ()[i], prepared->getCovariances ()[i]);
+  EXPECT_EQ (loaded.getNormals ()->points[0].getNormalVector3fMap (), prepared->getNormals ()->points[0].getNormalVector3fMap ());
+  EXPECT_TRUE (loaded.hasNDTGrid (Eigen::Vector2f (0, 0), Eigen::Vector2f (1, 1), Eigen::Vector2f (0.05f, 0.05f)));
+
+  // Loading a file written for another point type fails
+  pcl::registration::PreparedTarget<pcl::PointXYZI> wrong_type;
+  ASSERT_TRUE (prepared->save (file_name));
+  EXPECT_FALSE (wrong_type.load (file_name));
+  remove (file_name.c_str ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ELCH)
+{
+  typedef pcl::registration::ELCH<pcl::PointXYZ> ELCH;
+
+  for (unsigned int threads = 1; threads <= 4; threads += 3)
+  {
+    // a trajectory of scans holding a single point each, at x = scan index
+    ELCH elch;
+    elch.setNumberOfThreads (threads);
+    for (int i = 0; i < 15; ++i)
+    {
+      pcl::PointCloud<pcl::PointXYZ>::Ptr scan (new pcl::PointCloud<pcl::PointXYZ>);
+      scan->push_back (pcl::PointXYZ (float (i), 0, 0));
+      elch.addPointCloud (scan);
+    }
+    ELCH::LoopGraphPtr graph = elch.getLoopGraph ();
+
+    // an earlier loop before the loop start and a shortcut within the new loop
+    add_edge (0, 2, *graph);
+    add_edge (5, 8, *graph);
+
+    elch.setLoopStart (3);
+    elch.setLoopEnd (12);
+    elch.setLoopTransform (Eigen::Affine3f (Eigen::Translation3f (0, 2, 0)).matrix ());
+    elch.compute ();
+
+    // weights grow along the shortest path 3-4-5-8-...-12, the detour 5-6-7-8 is interpolated between its ends,
+    // everything before the loop start keeps its pose and everything after the loop end moves with it
+    const double weights[15] = {0, 0, 0, 0, 1.0 / 7, 2.0 / 7, 1.0 / 3, 8.0 / 21, 3.0 / 7, 4.0 / 7, 5.0 / 7, 6.0 / 7, 1, 1, 1};
+    for (int i = 0; i < 15; ++i)
+    {
+      const pcl::PointXYZ &p = (*graph)[i].cloud->points[0];
+      EXPECT_NEAR (p.x, i, 1e-5);
+      EXPECT_NEAR (p.y, 2 * weights[i], 1e-5);
+      EXPECT_NEAR (p.z, 0, 1e-5);
+    }
+
+    // closing a second loop further along the trajectory leaves the first one alone
+    for (int i = 15; i < 19; ++i)
+    {
+      pcl::PointCloud<pcl::PointXYZ>::Ptr scan (new pcl::PointCloud<pcl::PointXYZ>);
+      scan->push_back (pcl::PointXYZ (float (i), 0, 0));
+      elch.addPointCloud (scan);
+    }
+
+    elch.setLoopStart (14);
+    elch.setLoopEnd (18);
+    elch.setLoopTransform (Eigen::Affine3f (Eigen::Translation3f (0, 0, 4)).matrix ());
+    elch.compute ();
+
+    for (int i = 0; i < 19; ++i)
+    {
+      const pcl::PointXYZ &p = (*graph)[i].cloud->points[0];
+      EXPECT_NEAR (p.x, i, 1e-5);
+      EXPECT_NEAR (p.y, i < 15 ? 2 * weights[i] : 0, 1e-5);
+      EXPECT_NEAR (p.z, i < 15 ? 0 : i - 14, 1e-5);
+    }
+  }
+}
+
 /* ---[ */
 int
   main (int argc, char** argv)
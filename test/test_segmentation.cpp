@@ -43,6 +43,8 @@
 #include <pcl/point_cloud.h>
 #include <pcl/io/pcd_io.h>
 
+#include <pcl/segmentation/extract_clusters.h>
+#include <pcl/segmentation/extract_labeled_clusters.h>
 #include <pcl/segmentation/extract_polygonal_prism_data.h>
 #include <pcl/segmentation/segment_differences.h>
 
@@ -104,6 +106,102 @@ TEST (ExtractPolygonalPrism, Segmentation)
   EXPECT_EQ ((int)output.indices.size (), 0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, ParallelAndVoxelGrid)
+{
+  // Two bunnies, some exact duplicates and a line of isolated points
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> (*cloud_));
+  for (size_t i = 0; i < cloud_->points.size (); ++i)
+  {
+    PointXYZ p = cloud_->points[i];
+    p.x += 1.0f;
+    cloud->points.push_back (p);
+  }
+  for (size_t i = 0; i < cloud_->points.size (); i += 7)
+    cloud->points.push_back (cloud_->points[i]);
+  for (int i = 0; i < 50; ++i)
+    cloud->points.push_back (PointXYZ (-1.0f, 0.1f * i, 0.0f));
+  cloud->width = (uint32_t)cloud->points.size ();
+  cloud->height = 1;
+
+  // Skip some points and visit the rest in a scrambled order
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+    if (i % 11 != 3)
+      indices->push_back ((int)((i * 7919) % cloud->points.size ()));
+
+  // The parallel search and the voxel grid both give the clusters of the serial search
+  const double tolerances[] = {0.002, 0.005, 0.01};
+  for (size_t t = 0; t < sizeof (tolerances) / sizeof (tolerances[0]); ++t)
+  {
+    EuclideanClusterExtraction<PointXYZ> ec;
+    ec.setInputCloud (cloud);
+    ec.setIndices (indices);
+    ec.setClusterTolerance (tolerances[t]);
+    ec.setMinClusterSize (2);
+    ec.setMaxClusterSize (300);
+
+    std::vector<PointIndices> serial, parallel, gridded;
+    ec.extract (serial);
+    ec.setNumberOfThreads (4);
+    ec.extract (parallel);
+    ec.setUseVoxelGrid (true);
+    ec.extract (gridded);
+    EXPECT_GT (serial.size (), 0u);
+
+    ASSERT_EQ (parallel.size (), serial.size ());
+    ASSERT_EQ (gridded.size (), serial.size ());
+    for (size_t c = 0; c < serial.size (); ++c)
+    {
+      EXPECT_EQ (parallel[c].indices, serial[c].indices);
+      EXPECT_EQ (gridded[c].indices, serial[c].indices);
+      EXPECT_GE (serial[c].indices.size (), 2u);
+      EXPECT_LE (serial[c].indices.size (), 300u);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (LabeledEuclideanClusterExtraction, VoxelGrid)
+{
+  // The labeled clusters never mix labels, and one grid serves all the labels
+  PointCloud<PointXYZL>::Ptr labeled (new PointCloud<PointXYZL>);
+  for (size_t i = 0; i < cloud_->points.size (); ++i)
+  {
+    PointXYZL p;
+    p.x = cloud_->points[i].x;
+    p.y = cloud_->points[i].y;
+    p.z = cloud_->points[i].z;
+    p.label = (uint32_t)(i / 50) % 3;
+    labeled->points.push_back (p);
+  }
+  labeled->width = (uint32_t)labeled->points.size ();
+  labeled->height = 1;
+
+  LabeledEuclideanClusterExtraction<PointXYZL> lec;
+  lec.setInputCloud (labeled);
+  lec.setClusterTolerance (0.005);
+  lec.setMinClusterSize (2);
+
+  std::vector<std::vector<PointIndices> > searched (3), gridded (3);
+  lec.extract (searched);
+  lec.setUseVoxelGrid (true);
+  lec.extract (gridded);
+
+  ASSERT_EQ (gridded.size (), searched.size ());
+  for (size_t l = 0; l < searched.size (); ++l)
+  {
+    EXPECT_GT (searched[l].size (), 0u);
+    ASSERT_EQ (gridded[l].size (), searched[l].size ());
+    for (size_t c = 0; c < searched[l].size (); ++c)
+    {
+      EXPECT_EQ (gridded[l][c].indices, searched[l][c].indices);
+      for (size_t i = 0; i < gridded[l][c].indices.size (); ++i)
+        EXPECT_EQ (labeled->points[gridded[l][c].indices[i]].label, l);
+    }
+  }
+}
+
 /* ---[ */
 int
   main (int argc, char** argv)